@@ -11,6 +11,18 @@ Projects = {
 		LibsRelease = {},
 		AdditionalDependencies = {}
 	},
+	{
+		-- Headless checks of the simulation and networking code which doesn't need a world or a connection
+		Name = "ErewhonChecks",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/Client/ClockSync*", "../src/Client/SnapshotDelayEstimator*", "../src/Client/SnapshotInterpolation*", "../src/Client/SpaceshipPrediction*", "../src/Relay/ArenaMirror*", "../src/Relay/DelayQueue*", "../src/Server/ReplayRecorder*", "../src/Checks/**"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {} or {"pthread"},
+		LibsDebug = {"NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
 	{
 		Name = "ErewhonClient",
 		Kind = "ConsoleApp",
@@ -22,6 +34,42 @@ Projects = {
 		LibsRelease = {"argon2", "NazaraAudio", "NazaraCore", "NazaraLua", "NazaraGraphics", "NazaraNetwork", "NazaraNoise", "NazaraRenderer", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraPlatform", "NazaraSDK", "NazaraUtility"},
 		AdditionalDependencies = {"Newton", "libsndfile-1", "soft_oal"}
 	},
+	{
+		-- Headless clients for load testing, only reuses the network part of the client
+		Name = "ErewhonLoadClient",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/Client/ClientApplication*", "../src/Client/ClientCommandStore*", "../src/Client/ClockSync*", "../src/Client/ServerConnection*", "../src/LoadClient/**"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {} or {"pthread"},
+		LibsDebug = {"argon2-d", "NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"argon2", "NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
+	{
+		-- Serialization benchmarks for the network protocol, fails on regression when given a baseline
+		Name = "ErewhonProtocolBench",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/ProtocolBench/**"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {} or {"pthread"},
+		LibsDebug = {"NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
+	{
+		-- Re-broadcasts an arena to spectators, connects to the server as a single peer
+		Name = "ErewhonRelay",
+		Kind = "ConsoleApp",
+		Defines = {"NDK_SERVER"},
+		Files = {"../include/Shared/**", "../src/Shared/**", "../src/Client/ClientApplication*", "../src/Client/ClientCommandStore*", "../src/Client/ClockSync*", "../src/Client/ServerConnection*", "../src/Relay/**"},
+		Includes = {"../thirdparty/include"},
+		Libs = os.istarget("windows") and {} or {"pthread"},
+		LibsDebug = {"NazaraCore-d", "NazaraLua-d", "NazaraNetwork-d", "NazaraNoise-d", "NazaraPhysics2D-d", "NazaraPhysics3D-d", "NazaraSDKServer-d", "NazaraUtility-d"},
+		LibsRelease = {"NazaraCore", "NazaraLua", "NazaraNetwork", "NazaraNoise", "NazaraPhysics2D", "NazaraPhysics3D", "NazaraSDKServer", "NazaraUtility"},
+		AdditionalDependencies = {"Newton"}
+	},
 	{
 		Name = "ErewhonServer",
 		Kind = "ConsoleApp",
@@ -91,6 +139,10 @@ workspace(WorkspaceName)
 			cppdialect("C++17")
 
 			defines(data.Defines)
+
+			if (_OPTIONS["profiling"]) then
+				defines("EREWHON_PROFILING")
+			end
 			
 			includedirs(data.Includes)
 			includedirs { "../include/", "../src/" }
@@ -173,6 +225,11 @@ workspace(WorkspaceName)
 			end
 	end
 
+	newoption({
+		trigger     = "profiling",
+		description = "Record instrumentation zones (exportable as a Chrome trace)"
+	})
+
 	newoption({
 		trigger     = "buildarch",
 		description = "Set the directory for the thirdparty_update",
@@ -36,7 +36,7 @@ namespace ewn
 			inline void ClearReactors();
 			inline const std::unique_ptr<NetworkReactor>& GetReactor(std::size_t reactorId);
 
-			virtual void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data) = 0;
+			virtual void HandlePeerConnection(bool outgoing, std::size_t peerId, const Nz::IpAddress& remoteAddress, Nz::UInt32 data) = 0;
 			virtual void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data) = 0;
 			virtual void HandlePeerInfo(std::size_t peerId, const NetworkReactor::PeerInfo& peerInfo);
 			virtual void HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet) = 0;
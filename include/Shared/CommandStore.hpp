@@ -9,10 +9,11 @@
 
 #include <Nazara/Network/ENetPacket.hpp>
 #include <Nazara/Network/NetPacket.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
 #include <Shared/Protocol/Packets.hpp>
-#include <functional>
+#include <array>
 #include <type_traits>
-#include <vector>
 
 namespace ewn
 {
@@ -33,15 +34,18 @@ namespace ewn
 
 			template<typename T>
 			void SerializePacket(Nz::NetPacket& packet, const T& data) const;
+			template<typename T>
+			void SerializePacket(Nz::NetPacket& packet, const CachedPacket<T>& data) const;
 
 			bool UnserializePacket(PeerRef peer, Nz::NetPacket&& packet) const;
 
-			using UnserializeFunction = std::function<void(PeerRef peer, Nz::NetPacket&& packet)>;
+			// Decodes the packet and calls the handler, returns false if the packet is malformed
+			using UnserializeFunction = bool(*)(PeerRef peer, PacketReader& reader);
 
 			struct IncomingCommand
 			{
 				bool enabled = false;
-				UnserializeFunction unserialize;
+				UnserializeFunction unserialize = nullptr;
 				const char* name;
 			};
 
@@ -54,14 +58,18 @@ namespace ewn
 			};
 
 		protected:
-			template<typename T, typename CB> void RegisterIncomingCommand(const char* name, CB&& callback);
+			// Handler is either a Peer member function taking the packet or a function taking the peer and the packet
+			template<typename T, auto Handler> void RegisterIncomingCommand(const char* name);
 			template<typename T> void RegisterOutgoingCommand(const char* name, Nz::ENetPacketFlags flags, Nz::UInt8 channelId);
 
 		private:
-			using HandleFunction = std::function<void(Nz::NetPacket& packet)>;
+			bool UnserializeMessage(PeerRef peer, Nz::UInt8 opcode, PacketReader& reader) const;
+
+			template<typename T, auto Handler> static bool Dispatch(PeerRef peer, PacketReader& reader);
+			static std::size_t GetPeerId(PeerRef peer);
 
-			std::vector<IncomingCommand> m_incomingCommands;
-			std::vector<OutgoingCommand> m_outgoingCommands;
+			std::array<IncomingCommand, PacketTypeCount> m_incomingCommands;
+			std::array<OutgoingCommand, PacketTypeCount> m_outgoingCommands;
 	};
 }
 
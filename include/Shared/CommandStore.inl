@@ -3,8 +3,10 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/CommandStore.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Protocol/PacketBundle.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
 #include <cassert>
-#include <iostream>
 
 namespace ewn
 {
@@ -35,37 +37,16 @@ namespace ewn
 	}
 
 	template<typename Peer>
-	template<typename T, typename CB>
-	void CommandStore<Peer>::RegisterIncomingCommand(const char* name, CB&& callback)
+	template<typename T, auto Handler>
+	void CommandStore<Peer>::RegisterIncomingCommand(const char* name)
 	{
 		std::size_t packetId = static_cast<std::size_t>(T::Type);
+		assert(packetId < m_incomingCommands.size());
 
-		IncomingCommand newCommand;
-		newCommand.enabled = true;
-		newCommand.unserialize = [cb = std::forward<CB>(callback)](PeerRef peer, Nz::NetPacket&& packet)
-		{
-			T data;
-			try
-			{
-				PacketSerializer serializer(packet, false);
-
-				Packets::Serialize(serializer, data);
-			}
-			catch (const std::exception&)
-			{
-				std::cerr << "Failed to unserialize packet" << std::endl;
-				return false;
-			}
-
-			cb(peer, data);
-			return true;
-		};
-		newCommand.name = name;
-
-		if (m_incomingCommands.size() <= packetId)
-			m_incomingCommands.resize(packetId + 1);
-
-		m_incomingCommands[packetId] = std::move(newCommand);
+		IncomingCommand& command = m_incomingCommands[packetId];
+		command.enabled = true;
+		command.name = name;
+		command.unserialize = &Dispatch<T, Handler>;
 	}
 
 	template<typename Peer>
@@ -73,60 +54,124 @@ namespace ewn
 	void CommandStore<Peer>::RegisterOutgoingCommand(const char* name, Nz::ENetPacketFlags flags, Nz::UInt8 channelId)
 	{
 		std::size_t packetId = static_cast<std::size_t>(T::Type);
+		assert(packetId < m_outgoingCommands.size());
 
-		OutgoingCommand newCommand;
-		newCommand.channelId = channelId;
-		newCommand.enabled = true;
-		newCommand.flags = flags;
-		newCommand.name = name;
-
-		if (m_outgoingCommands.size() <= packetId)
-			m_outgoingCommands.resize(packetId + 1);
-
-		m_outgoingCommands[packetId] = std::move(newCommand);
+		OutgoingCommand& command = m_outgoingCommands[packetId];
+		command.channelId = channelId;
+		command.enabled = true;
+		command.flags = flags;
+		command.name = name;
 	}
 
 	template<typename Peer>
 	template<typename T>
 	void CommandStore<Peer>::SerializePacket(Nz::NetPacket& packet, const T& data) const
 	{
-		packet << static_cast<Nz::UInt8>(T::Type);
+		std::size_t packetSize = sizeof(Nz::UInt8) + Packets::ComputeSize(data);
+
+		PacketWriter writer(packet, 0, packetSize);
+		writer &= static_cast<Nz::UInt8>(T::Type);
 
-		// We need to cast the const away because our serialize functions require a non-const reference as they performs both reading and writing
-		// If you have a better idea...
-		T& dataRef = const_cast<T&>(data);
+		Packets::Serialize(writer, data);
+		assert(writer.GetOffset() == packetSize);
+	}
 
-		PacketSerializer serializer(packet, true);
-		Packets::Serialize(serializer, dataRef);
+	template<typename Peer>
+	template<typename T>
+	void CommandStore<Peer>::SerializePacket(Nz::NetPacket& packet, const CachedPacket<T>& data) const
+	{
+		const std::vector<Nz::UInt8>& packetData = data.GetData();
+		packet.Reset(0, packetData.data(), packetData.size());
 	}
 
 	template<typename Peer>
 	bool CommandStore<Peer>::UnserializePacket(PeerRef peer, Nz::NetPacket&& packet) const
 	{
+		PacketReader reader(packet);
+
 		Nz::UInt8 opcode;
-		try
+		reader &= opcode;
+
+		if (reader.HasFailed())
 		{
-			packet >> opcode;
+			LogError(LogCategory::Network) << "Client #" << GetPeerId(peer) << " sent an empty packet";
+			return false;
 		}
-		catch (const std::exception&)
+
+		if (opcode != PacketBundle::Opcode)
+			return UnserializeMessage(peer, opcode, reader);
+
+		// Bundles can't be nested, a bundle opcode inside a bundle is handled as an invalid opcode
+		while (reader.GetRemainingSize() > 0)
 		{
-			std::cerr << "Failed to unserialize opcode" << std::endl;
+			CompressedUnsigned<Nz::UInt32> messageSize;
+			reader &= messageSize;
+
+			PacketReader messageReader = reader.ExtractReader(messageSize);
+
+			Nz::UInt8 messageOpcode;
+			messageReader &= messageOpcode;
+
+			if (reader.HasFailed() || messageReader.HasFailed())
+			{
+				LogError(LogCategory::Network) << "Client #" << GetPeerId(peer) << " sent a malformed bundle";
+				return false;
+			}
+
+			if (!UnserializeMessage(peer, messageOpcode, messageReader))
+				return false;
+		}
+
+		return true;
+	}
+
+	template<typename Peer>
+	std::size_t CommandStore<Peer>::GetPeerId(PeerRef peer)
+	{
+		if constexpr (std::is_pointer_v<Peer>)
+			return peer->GetPeerId();
+		else
+			return peer.GetPeerId();
+	}
+
+	template<typename Peer>
+	bool CommandStore<Peer>::UnserializeMessage(PeerRef peer, Nz::UInt8 opcode, PacketReader& reader) const
+	{
+		if (opcode >= m_incomingCommands.size() || !m_incomingCommands[opcode].enabled)
+		{
+			LogError(LogCategory::Network) << "Client #" << GetPeerId(peer) << " sent invalid opcode";
 			return false;
 		}
 
-		if (m_incomingCommands.size() <= opcode || !m_incomingCommands[opcode].enabled)
+		const IncomingCommand& command = m_incomingCommands[opcode];
+		if (!command.unserialize(peer, reader))
 		{
-			std::size_t peerId;
-			if constexpr (std::is_pointer_v<Peer>)
-				peerId = peer->GetPeerId();
-			else
-				peerId = peer.GetPeerId();
+			LogError(LogCategory::Network) << "Client #" << GetPeerId(peer) << " sent a malformed " << command.name << " packet";
+			return false;
+		}
+
+		return true;
+	}
 
-			std::cerr << "Client #" << peerId << " sent invalid opcode" << std::endl;
+	template<typename Peer>
+	template<typename T, auto Handler>
+	bool CommandStore<Peer>::Dispatch(PeerRef peer, PacketReader& reader)
+	{
+		// Packets are handled one at a time, reusing the same object keeps the capacity of its strings and arrays
+		static thread_local T data;
+		if (!Packets::Unserialize(reader, data))
 			return false;
+
+		if constexpr (std::is_member_function_pointer_v<decltype(Handler)>)
+		{
+			if constexpr (std::is_pointer_v<Peer>)
+				(peer->*Handler)(data);
+			else
+				(peer.*Handler)(data);
 		}
+		else
+			Handler(peer, data);
 
-		m_incomingCommands[opcode].unserialize(peer, std::move(packet));
 		return true;
 	}
 }
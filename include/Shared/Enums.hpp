@@ -50,7 +50,9 @@ namespace ewn
 		AccountNotFound,
 		InvalidToken,
 		PasswordMismatch,
-		ServerError
+		ServerBusy,      //< too many password hashes pending, see LoginFailure::retryAfter
+		ServerError,
+		TooManyAttempts  //< address or account rate-limited, see LoginFailure::retryAfter
 	};
 
 	enum class ModuleType : Nz::UInt8
@@ -69,7 +71,9 @@ namespace ewn
 	{
 		EmailAlreadyTaken,
 		LoginAlreadyTaken,
-		ServerError
+		ServerBusy,      //< see RegisterFailure::retryAfter
+		ServerError,
+		TooManyAttempts  //< see RegisterFailure::retryAfter
 	};
 
 	enum class SpaceshipQueryInfo : Nz::UInt8
@@ -0,0 +1,141 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_LOGGER_HPP
+#define EREWHON_SHARED_LOGGER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	enum class LogCategory : Nz::UInt8
+	{
+		Arena,
+		Chat,
+		Client,
+		Config,
+		Database,
+		Network,
+		Player,
+		Script,
+		Server,
+		Store,
+
+		Max = Store
+	};
+
+	enum class LogLevel : Nz::UInt8
+	{
+		Debug,
+		Info,
+		Warning,
+		Error
+	};
+
+	// Asynchronous logger: messages are pushed into per-thread rings and written by a background thread
+	// Logging never blocks on I/O, messages are dropped if a thread fills its ring faster than it can be written
+	class Logger
+	{
+		friend class LogMessage;
+
+		public:
+			Logger() = delete;
+			~Logger() = delete;
+
+			static void Flush();
+
+			static inline LogLevel GetMinimumLevel();
+
+			static inline void SetMinimumLevel(LogLevel level);
+			static inline void SetRateLimit(LogCategory category, unsigned int maxMessagesPerSecond);
+
+			static bool ShouldLog(LogLevel level, LogCategory category);
+
+			static constexpr std::size_t CategoryCount = static_cast<std::size_t>(LogCategory::Max) + 1;
+			static constexpr std::size_t QueueCapacity = 4096; //< per thread
+
+		private:
+			struct CategoryState
+			{
+				std::atomic<Nz::UInt64> suppressedCount = 0;
+				std::atomic<Nz::UInt64> windowStart = 0;
+				std::atomic<unsigned int> rateLimit = 0; //< 0 means unlimited
+				std::atomic<unsigned int> windowCount = 0;
+			};
+
+			struct Record
+			{
+				std::string message;
+				Nz::UInt64 timestamp; //< microseconds since epoch
+				std::size_t threadId;
+				LogCategory category;
+				LogLevel level;
+			};
+
+			// Single producer (the owning thread), single consumer (whoever holds s_drainMutex)
+			struct ThreadQueue
+			{
+				std::array<Record, QueueCapacity> records;
+				std::atomic<Nz::UInt64> droppedCount = 0;
+				std::atomic<std::size_t> readIndex = 0;
+				std::atomic<std::size_t> writeIndex = 0;
+				std::size_t threadId;
+			};
+
+			static bool Drain();
+			static ThreadQueue& GetThreadQueue();
+			static void Submit(LogLevel level, LogCategory category, std::string message);
+			static void Write(const Record& record);
+			static void WriterThread();
+
+			static std::array<CategoryState, CategoryCount> s_categories;
+			static std::atomic<LogLevel> s_minimumLevel;
+			static std::mutex s_drainMutex;
+			static std::mutex s_queueMutex;
+			static std::vector<std::shared_ptr<ThreadQueue>> s_queues;
+			static std::vector<Record> s_pendingRecords;
+	};
+
+	// Accumulates a message and submits it to the logger when destroyed, nothing is formatted if the message is filtered out
+	class LogMessage
+	{
+		public:
+			inline LogMessage(LogLevel level, LogCategory category);
+			LogMessage(const LogMessage&) = delete;
+			LogMessage(LogMessage&&) = delete;
+			inline ~LogMessage();
+
+			template<typename T> LogMessage& operator<<(const T& value);
+
+			LogMessage& operator=(const LogMessage&) = delete;
+			LogMessage& operator=(LogMessage&&) = delete;
+
+		private:
+			std::optional<std::ostringstream> m_stream;
+			LogCategory m_category;
+			LogLevel m_level;
+	};
+
+	const char* EnumToString(LogCategory category);
+	const char* EnumToString(LogLevel level);
+
+	inline LogMessage LogDebug(LogCategory category);
+	inline LogMessage LogError(LogCategory category);
+	inline LogMessage LogInfo(LogCategory category);
+	inline LogMessage LogWarning(LogCategory category);
+}
+
+#include <Shared/Logger.inl>
+
+#endif // EREWHON_SHARED_LOGGER_HPP
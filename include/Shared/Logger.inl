@@ -0,0 +1,68 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Logger.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	inline LogLevel Logger::GetMinimumLevel()
+	{
+		return s_minimumLevel.load(std::memory_order_relaxed);
+	}
+
+	inline void Logger::SetMinimumLevel(LogLevel level)
+	{
+		s_minimumLevel.store(level, std::memory_order_relaxed);
+	}
+
+	inline void Logger::SetRateLimit(LogCategory category, unsigned int maxMessagesPerSecond)
+	{
+		assert(static_cast<std::size_t>(category) < CategoryCount);
+		s_categories[static_cast<std::size_t>(category)].rateLimit.store(maxMessagesPerSecond, std::memory_order_relaxed);
+	}
+
+	inline LogMessage::LogMessage(LogLevel level, LogCategory category) :
+	m_category(category),
+	m_level(level)
+	{
+		if (Logger::ShouldLog(level, category))
+			m_stream.emplace();
+	}
+
+	inline LogMessage::~LogMessage()
+	{
+		if (m_stream)
+			Logger::Submit(m_level, m_category, m_stream->str());
+	}
+
+	template<typename T>
+	LogMessage& LogMessage::operator<<(const T& value)
+	{
+		if (m_stream)
+			*m_stream << value;
+
+		return *this;
+	}
+
+	inline LogMessage LogDebug(LogCategory category)
+	{
+		return LogMessage(LogLevel::Debug, category);
+	}
+
+	inline LogMessage LogError(LogCategory category)
+	{
+		return LogMessage(LogLevel::Error, category);
+	}
+
+	inline LogMessage LogInfo(LogCategory category)
+	{
+		return LogMessage(LogLevel::Info, category);
+	}
+
+	inline LogMessage LogWarning(LogCategory category)
+	{
+		return LogMessage(LogLevel::Warning, category);
+	}
+}
@@ -0,0 +1,66 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_MOVEMENTINPUTHISTORY_HPP
+#define EREWHON_SHARED_MOVEMENTINPUTHISTORY_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <array>
+
+namespace ewn
+{
+	// Keeps the last movement inputs sent so every PlayerMovement packet carries them again, and decodes them on the server side
+	// Inputs are quantized to steps of 1/127, the client must predict with the quantized values to apply exactly what the server does
+	class MovementInputHistory
+	{
+		public:
+			static constexpr std::size_t MaxRedundantInputs = 4;
+
+			struct Input;
+			using DecodedInputs = std::array<Input, MaxRedundantInputs + 1>;
+
+			MovementInputHistory();
+			~MovementInputHistory() = default;
+
+			inline void Clear();
+
+			Input PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation, Packets::PlayerMovement* packet);
+
+			static std::size_t DecodePacket(const Packets::PlayerMovement& packet, DecodedInputs* inputs);
+			static inline float Dequantize(Nz::UInt8 value);
+			static inline Nz::UInt8 Quantize(float value);
+
+			static constexpr Nz::UInt8 QuantizedMax = 254;
+			static constexpr Nz::UInt8 QuantizedZero = 127;
+
+			struct Input
+			{
+				Nz::UInt64 inputTime;
+				Nz::Vector3f direction;
+				Nz::Vector3f rotation;
+			};
+
+		private:
+			using QuantizedValues = std::array<Nz::UInt8, 6>;
+
+			struct SentInput
+			{
+				Nz::UInt64 inputTime;
+				QuantizedValues values;
+			};
+
+			static Input DequantizeInput(Nz::UInt64 inputTime, const QuantizedValues& values);
+
+			std::array<SentInput, MaxRedundantInputs> m_previousInputs; //< Most recent first
+			std::size_t m_previousInputCount;
+	};
+}
+
+#include <Shared/MovementInputHistory.inl>
+
+#endif // EREWHON_SHARED_MOVEMENTINPUTHISTORY_HPP
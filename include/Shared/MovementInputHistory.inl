@@ -0,0 +1,29 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/MovementInputHistory.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	inline void MovementInputHistory::Clear()
+	{
+		m_previousInputCount = 0;
+	}
+
+	inline float MovementInputHistory::Dequantize(Nz::UInt8 value)
+	{
+		return (int(std::min(value, QuantizedMax)) - QuantizedZero) / float(QuantizedZero);
+	}
+
+	inline Nz::UInt8 MovementInputHistory::Quantize(float value)
+	{
+		if (!std::isfinite(value))
+			return QuantizedZero;
+
+		return static_cast<Nz::UInt8>(std::lround(Nz::Clamp(value, -1.f, 1.f) * QuantizedZero) + QuantizedZero);
+	}
+}
@@ -9,7 +9,9 @@
 
 #include <Nazara/Core/Thread.hpp>
 #include <Nazara/Network/ENetHost.hpp>
+#include <Shared/Config.hpp>
 #include <concurrentqueue/concurrentqueue.h>
+#include <array>
 #include <atomic>
 #include <functional>
 #include <variant>
@@ -27,6 +29,7 @@ namespace ewn
 	class NetworkReactor
 	{
 		public:
+			struct ChannelStats;
 			struct PeerInfo;
 
 			NetworkReactor(std::size_t firstId, Nz::NetProtocol protocol, Nz::UInt16 port, std::size_t maxClient);
@@ -40,6 +43,9 @@ namespace ewn
 			template<typename ConnectCB, typename DisconnectCB, typename DataCB, typename InfoCB>
 			void Poll(ConnectCB&& onConnection, DisconnectCB&& onDisconnection, DataCB&& onData, InfoCB&& onInfo);
 
+			ChannelStats GetChannelStats(Nz::UInt8 channelId) const;
+			inline std::size_t GetIncomingQueueSize() const;
+			inline std::size_t GetOutgoingQueueSize() const;
 			inline Nz::NetProtocol GetProtocol() const;
 
 			void QueryInfo(std::size_t peerId);
@@ -49,6 +55,14 @@ namespace ewn
 			NetworkReactor& operator=(const NetworkReactor&) = delete;
 			NetworkReactor& operator=(NetworkReactor&&) = delete;
 
+			struct ChannelStats
+			{
+				Nz::UInt64 receivedBytes;
+				Nz::UInt64 receivedPackets;
+				Nz::UInt64 sentBytes;
+				Nz::UInt64 sentPackets;
+			};
+
 			struct PeerInfo
 			{
 				Nz::UInt32 lastReceiveTime;
@@ -63,6 +77,15 @@ namespace ewn
 			void SendPackets(const moodycamel::ProducerToken& producterToken, const moodycamel::ConsumerToken& token);
 			void WorkerThread();
 
+			// Updated by the reactor thread, read from any thread
+			struct AtomicChannelStats
+			{
+				std::atomic<Nz::UInt64> receivedBytes = 0;
+				std::atomic<Nz::UInt64> receivedPackets = 0;
+				std::atomic<Nz::UInt64> sentBytes = 0;
+				std::atomic<Nz::UInt64> sentPackets = 0;
+			};
+
 			struct ConnectionRequest
 			{
 				using Callback = std::function<void(std::size_t clientId)>;
@@ -77,6 +100,7 @@ namespace ewn
 				struct ConnectEvent
 				{
 					bool outgoingConnection;
+					Nz::IpAddress remoteAddress;
 					Nz::UInt32 data;
 				};
 
@@ -115,6 +139,7 @@ namespace ewn
 				std::variant<DisconnectEvent, PacketEvent, QueryPeerInfo> data;
 			};
 
+			std::array<AtomicChannelStats, NetworkChannelCount> m_channelStats;
 			std::atomic_bool m_running;
 			std::size_t m_firstId;
 			std::vector<Nz::ENetPeer*> m_clients;
@@ -17,7 +17,7 @@ namespace ewn
 				using T = std::decay_t<decltype(arg)>;
 				if constexpr (std::is_same_v<T, IncomingEvent::ConnectEvent>)
 				{
-					onConnection(arg.outgoingConnection, inEvent.peerId, arg.data);
+					onConnection(arg.outgoingConnection, inEvent.peerId, arg.remoteAddress, arg.data);
 				}
 				else if constexpr (std::is_same_v<T, IncomingEvent::DisconnectEvent>)
 				{
@@ -38,6 +38,16 @@ namespace ewn
 		}
 	}
 
+	inline std::size_t NetworkReactor::GetIncomingQueueSize() const
+	{
+		return m_incomingQueue.size_approx();
+	}
+
+	inline std::size_t NetworkReactor::GetOutgoingQueueSize() const
+	{
+		return m_outgoingQueue.size_approx();
+	}
+
 	inline Nz::NetProtocol NetworkReactor::GetProtocol() const
 	{
 		return m_protocol;
@@ -0,0 +1,93 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_PROFILER_HPP
+#define EREWHON_SHARED_PROFILER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Records timed zones into per-thread ring buffers, which can be exported as a Chrome trace (chrome://tracing)
+	// Zones are only recorded when compiled with EREWHON_PROFILING (premake5 --profiling), see the ProfileZone macro
+	class Profiler
+	{
+		public:
+			class Zone;
+
+			Profiler() = delete;
+			~Profiler() = delete;
+
+			static bool ExportChromeTrace(const std::string& filePath, Nz::UInt64 duration);
+
+			static constexpr bool IsEnabled();
+
+			static inline void RecordZone(const char* name, Nz::UInt64 startTime, Nz::UInt64 endTime);
+
+			static void SetThreadName(std::string name);
+
+			static constexpr std::size_t RingBufferSize = 1 << 16; //< per thread
+
+			class Zone
+			{
+				public:
+					inline Zone(const char* name);
+					Zone(const Zone&) = delete;
+					Zone(Zone&&) = delete;
+					inline ~Zone();
+
+					Zone& operator=(const Zone&) = delete;
+					Zone& operator=(Zone&&) = delete;
+
+				private:
+					const char* m_name;
+					Nz::UInt64 m_startTime;
+			};
+
+		private:
+			// Entries are atomics so they can be read while the owning thread overwrites them, torn entries are detected and dropped by the reader
+			struct ZoneEntry
+			{
+				std::atomic<const char*> name;
+				std::atomic<Nz::UInt64> startTime;
+				std::atomic<Nz::UInt64> endTime;
+			};
+
+			struct ThreadBuffer
+			{
+				std::array<ZoneEntry, RingBufferSize> zones;
+				std::atomic<Nz::UInt64> reserveIndex = 0;
+				std::atomic<Nz::UInt64> writeIndex = 0;
+				std::mutex nameMutex;
+				std::string name;
+				std::size_t threadId;
+			};
+
+			static ThreadBuffer& GetThreadBuffer();
+
+			static std::mutex s_threadBufferMutex;
+			static std::vector<std::shared_ptr<ThreadBuffer>> s_threadBuffers;
+	};
+}
+
+#define EwnProfileConcat_(a, b) a##b
+#define EwnProfileConcat(a, b) EwnProfileConcat_(a, b)
+
+#ifdef EREWHON_PROFILING
+	#define ProfileZone(Name) ewn::Profiler::Zone EwnProfileConcat(profileZone, __LINE__)(Name)
+#else
+	#define ProfileZone(Name)
+#endif
+
+#include <Shared/Profiler.inl>
+
+#endif // EREWHON_SHARED_PROFILER_HPP
@@ -0,0 +1,46 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Profiler.hpp>
+#include <Nazara/Core/Clock.hpp>
+
+namespace ewn
+{
+	constexpr bool Profiler::IsEnabled()
+	{
+#ifdef EREWHON_PROFILING
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	inline void Profiler::RecordZone(const char* name, Nz::UInt64 startTime, Nz::UInt64 endTime)
+	{
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		// Only the owning thread writes into its buffer, readers rely on reserveIndex to know which entries may be partially overwritten
+		Nz::UInt64 writeIndex = buffer.writeIndex.load(std::memory_order_relaxed);
+		buffer.reserveIndex.store(writeIndex + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+
+		ZoneEntry& entry = buffer.zones[writeIndex % RingBufferSize];
+		entry.name.store(name, std::memory_order_relaxed);
+		entry.startTime.store(startTime, std::memory_order_relaxed);
+		entry.endTime.store(endTime, std::memory_order_relaxed);
+
+		buffer.writeIndex.store(writeIndex + 1, std::memory_order_release);
+	}
+
+	inline Profiler::Zone::Zone(const char* name) :
+	m_name(name),
+	m_startTime(Nz::GetElapsedMicroseconds())
+	{
+	}
+
+	inline Profiler::Zone::~Zone()
+	{
+		RecordZone(m_name, m_startTime, Nz::GetElapsedMicroseconds());
+	}
+}
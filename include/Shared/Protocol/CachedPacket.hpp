@@ -0,0 +1,42 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_CACHEDPACKET_HPP
+#define EREWHON_SHARED_NETWORK_CACHEDPACKET_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <vector>
+
+namespace ewn
+{
+	// A packet serialized once (opcode included) and sent as is to every client needing it
+	// Its version is a hash of its content: it only changes with the content and stays valid across server restarts
+	template<typename T>
+	class CachedPacket
+	{
+		public:
+			CachedPacket();
+			~CachedPacket() = default;
+
+			const std::vector<Nz::UInt8>& GetData() const;
+			Nz::UInt32 GetVersion() const;
+
+			void Invalidate();
+			bool IsValid() const;
+
+			void Update(const T& packet);
+
+			static constexpr Nz::UInt32 InvalidVersion = 0;
+
+		private:
+			std::vector<Nz::UInt8> m_data;
+			Nz::UInt32 m_version;
+	};
+}
+
+#include <Shared/Protocol/CachedPacket.inl>
+
+#endif // EREWHON_SHARED_NETWORK_CACHEDPACKET_HPP
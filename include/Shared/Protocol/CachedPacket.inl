@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	template<typename T>
+	CachedPacket<T>::CachedPacket() :
+	m_version(InvalidVersion)
+	{
+	}
+
+	template<typename T>
+	const std::vector<Nz::UInt8>& CachedPacket<T>::GetData() const
+	{
+		assert(IsValid());
+		return m_data;
+	}
+
+	template<typename T>
+	Nz::UInt32 CachedPacket<T>::GetVersion() const
+	{
+		return m_version;
+	}
+
+	template<typename T>
+	void CachedPacket<T>::Invalidate()
+	{
+		m_data.clear();
+		m_version = InvalidVersion;
+	}
+
+	template<typename T>
+	bool CachedPacket<T>::IsValid() const
+	{
+		return m_version != InvalidVersion;
+	}
+
+	template<typename T>
+	void CachedPacket<T>::Update(const T& packet)
+	{
+		m_data.resize(sizeof(Nz::UInt8) + Packets::ComputeSize(packet));
+
+		PacketWriter writer(m_data.data(), m_data.size());
+		writer &= static_cast<Nz::UInt8>(T::Type);
+		Packets::Serialize(writer, packet);
+		assert(writer.GetOffset() == m_data.size());
+
+		// FNV-1a
+		Nz::UInt32 hash = 2166136261U;
+		for (Nz::UInt8 byte : m_data)
+		{
+			hash ^= byte;
+			hash *= 16777619U;
+		}
+
+		m_version = (hash != InvalidVersion) ? hash : 1;
+	}
+}
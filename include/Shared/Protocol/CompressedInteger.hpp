@@ -8,6 +8,8 @@
 #define EREWHON_SHARED_NETWORK_COMPRESSEDINTEGER_HPP
 
 #include <Nazara/Core/Algorithm.hpp>
+#include <climits>
+#include <limits>
 #include <type_traits>
 
 namespace ewn
@@ -45,6 +47,9 @@ namespace ewn
 		private:
 			T m_value;
 	};
+
+	template<typename T> constexpr T ZigZagDecode(std::make_unsigned_t<T> value);
+	template<typename T> constexpr std::make_unsigned_t<T> ZigZagEncode(T value);
 }
 
 namespace Nz
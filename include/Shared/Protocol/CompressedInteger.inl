@@ -44,23 +44,43 @@ namespace ewn
 		m_value = value;
 		return *this;
 	}
-}
 
-namespace Nz
-{
 	template<typename T>
-	bool Serialize(SerializationContext& context, ewn::CompressedSigned<T> value, TypeTag<ewn::CompressedSigned<T>>)
+	constexpr T ZigZagDecode(std::make_unsigned_t<T> value)
 	{
 		using UnsignedT = std::make_unsigned_t<T>;
 
-		T signedValue = value;
-		UnsignedT unsignedValue = reinterpret_cast<UnsignedT>(signedValue);
+		// ZigZag decoding:
+		// https://developers.google.com/protocol-buffers/docs/encoding
+		return static_cast<T>(static_cast<UnsignedT>(value >> 1) ^ static_cast<UnsignedT>(-static_cast<UnsignedT>(value & 1)));
+	}
+
+	template<typename T>
+	constexpr std::make_unsigned_t<T> ZigZagEncode(T value)
+	{
+		using UnsignedT = std::make_unsigned_t<T>;
 
 		// ZigZag encoding:
 		// https://developers.google.com/protocol-buffers/docs/encoding
-		unsignedValue = (unsignedValue << 1) ^ (unsignedValue >> (CHAR_BIT * sizeof(UnsignedT) - 1));
+		// The sign has to be shifted arithmetically (on the signed type) to be spread over every bit,
+		// the left shift is done on the unsigned type as shifting a negative value left is undefined
+		UnsignedT signMask = static_cast<UnsignedT>(value >> (CHAR_BIT * sizeof(T) - 1));
+		return static_cast<UnsignedT>((static_cast<UnsignedT>(value) << 1) ^ signMask);
+	}
 
-		return Serialize(context, ewn::CompressedUnsigned<UnsignedT>(unsignedValue));
+	static_assert(ZigZagEncode<Nz::Int32>(0) == 0 && ZigZagEncode<Nz::Int32>(-1) == 1 && ZigZagEncode<Nz::Int32>(1) == 2 && ZigZagEncode<Nz::Int32>(-2) == 3);
+	static_assert(ZigZagEncode<Nz::Int32>(std::numeric_limits<Nz::Int32>::min()) == std::numeric_limits<Nz::UInt32>::max());
+	static_assert(ZigZagDecode<Nz::Int32>(ZigZagEncode<Nz::Int32>(-123456)) == -123456);
+}
+
+namespace Nz
+{
+	template<typename T>
+	bool Serialize(SerializationContext& context, ewn::CompressedSigned<T> value, TypeTag<ewn::CompressedSigned<T>>)
+	{
+		using UnsignedT = std::make_unsigned_t<T>;
+
+		return Serialize(context, ewn::CompressedUnsigned<UnsignedT>(ewn::ZigZagEncode(static_cast<T>(value))));
 	}
 
 	template<typename T>
@@ -94,12 +114,7 @@ namespace Nz
 		if (!Unserialize(context, &compressedValue))
 			return false;
 
-		// ZigZag decoding:
-		// https://developers.google.com/protocol-buffers/docs/encoding
-		UnsignedT unsignedValue = compressedValue;
-		unsignedValue = (unsignedValue >> 1) ^ (-(unsignedValue & 1));
-
-		*value = reinterpret_cast<T>(unsignedValue);
+		*value = ewn::ZigZagDecode<T>(compressedValue);
 		return true;
 	}
 
@@ -27,6 +27,7 @@ namespace ewn
 			void FillStore(Nz::UInt32 firstId, std::vector<std::string> strings);
 
 			inline const std::string& GetString(Nz::UInt32 id) const;
+			inline std::size_t GetStringCount() const;
 			inline Nz::UInt32 GetStringIndex(const std::string& string) const;
 
 			inline Nz::UInt32 RegisterString(std::string string);
@@ -24,6 +24,11 @@ namespace ewn
 		return m_strings[id];
 	}
 
+	inline std::size_t NetworkStringStore::GetStringCount() const
+	{
+		return m_strings.size();
+	}
+
 	inline Nz::UInt32 NetworkStringStore::GetStringIndex(const std::string& string) const
 	{
 		auto it = m_stringMap.find(string);
@@ -0,0 +1,52 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_PACKETBUNDLE_HPP
+#define EREWHON_SHARED_NETWORK_PACKETBUNDLE_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <vector>
+
+namespace ewn
+{
+	// Groups messages sent on the same channel with the same flags so they share a single network packet
+	// Layout: Opcode, then for each message its size (as a CompressedUnsigned<UInt32>), its opcode and its content
+	class PacketBundle
+	{
+		public:
+			inline PacketBundle(std::size_t maxSize = DefaultMaxSize);
+			~PacketBundle() = default;
+
+			template<typename T> std::size_t Append(const T& data);
+			template<typename T> std::size_t Append(const CachedPacket<T>& packet);
+
+			inline void Clear();
+
+			void Flush(Nz::NetPacket& packet);
+
+			inline std::size_t GetMessageCount() const;
+			inline std::size_t GetSize() const;
+
+			inline bool IsEmpty() const;
+
+			static constexpr std::size_t DefaultMaxSize = 1200; //< Stays under ENet default MTU (1400) with protocol and command headers
+			static constexpr Nz::UInt8 Opcode = 0xFF;
+
+		private:
+			template<typename F> std::size_t AppendMessage(std::size_t messageSize, F&& writeMessage);
+
+			std::vector<Nz::UInt8> m_buffer;
+			std::size_t m_firstMessageOffset;
+			std::size_t m_maxSize;
+			std::size_t m_messageCount;
+	};
+}
+
+#include <Shared/Protocol/PacketBundle.inl>
+
+#endif // EREWHON_SHARED_NETWORK_PACKETBUNDLE_HPP
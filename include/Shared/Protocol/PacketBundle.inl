@@ -0,0 +1,98 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/PacketBundle.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <Shared/Protocol/PacketSizer.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	inline PacketBundle::PacketBundle(std::size_t maxSize) :
+	m_firstMessageOffset(0),
+	m_maxSize(maxSize),
+	m_messageCount(0)
+	{
+		m_buffer.reserve(maxSize);
+	}
+
+	// Returns the size of the message, or zero if it doesn't fit in the remaining space (the bundle is left untouched in that case)
+	template<typename T>
+	std::size_t PacketBundle::Append(const T& data)
+	{
+		static_assert(static_cast<std::size_t>(T::Type) != Opcode);
+
+		return AppendMessage(sizeof(Nz::UInt8) + Packets::ComputeSize(data), [&](PacketWriter& writer)
+		{
+			writer &= static_cast<Nz::UInt8>(T::Type);
+			Packets::Serialize(writer, data);
+		});
+	}
+
+	template<typename T>
+	std::size_t PacketBundle::Append(const CachedPacket<T>& packet)
+	{
+		const std::vector<Nz::UInt8>& data = packet.GetData();
+
+		return AppendMessage(data.size(), [&](PacketWriter& writer)
+		{
+			writer.WriteBytes(data.data(), data.size());
+		});
+	}
+
+	inline void PacketBundle::Clear()
+	{
+		m_buffer.clear();
+		m_firstMessageOffset = 0;
+		m_messageCount = 0;
+	}
+
+	inline std::size_t PacketBundle::GetMessageCount() const
+	{
+		return m_messageCount;
+	}
+
+	inline std::size_t PacketBundle::GetSize() const
+	{
+		return m_buffer.size();
+	}
+
+	inline bool PacketBundle::IsEmpty() const
+	{
+		return m_messageCount == 0;
+	}
+
+	template<typename F>
+	std::size_t PacketBundle::AppendMessage(std::size_t messageSize, F&& writeMessage)
+	{
+		PacketSizer sizer;
+		if (m_buffer.empty())
+			sizer &= Opcode;
+
+		sizer &= CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(messageSize));
+
+		std::size_t appendedSize = sizer.GetSize() + messageSize;
+		if (m_buffer.size() + appendedSize > m_maxSize)
+			return 0;
+
+		std::size_t offset = m_buffer.size();
+		m_buffer.resize(offset + appendedSize);
+
+		PacketWriter writer(m_buffer.data() + offset, appendedSize);
+		if (offset == 0)
+			writer &= Opcode;
+
+		writer &= CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(messageSize));
+
+		if (m_messageCount == 0)
+			m_firstMessageOffset = offset + writer.GetOffset();
+
+		writeMessage(writer);
+		assert(writer.GetOffset() == appendedSize);
+
+		m_messageCount++;
+		return messageSize;
+	}
+}
@@ -0,0 +1,71 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_PACKETREADER_HPP
+#define EREWHON_SHARED_NETWORK_PACKETREADER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/String.hpp>
+#include <Nazara/Math/Box.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
+#include <string>
+
+namespace ewn
+{
+	// Reads packet fields written by PacketWriter, every read is bounds-checked
+	// Malformed data doesn't throw: the reader enters a failed state where every following field is read as zero
+	class PacketReader
+	{
+		public:
+			inline PacketReader(const Nz::UInt8* data, std::size_t size);
+			inline explicit PacketReader(const Nz::NetPacket& packet);
+			~PacketReader() = default;
+
+			inline PacketReader ExtractReader(std::size_t size);
+
+			inline std::size_t GetOffset() const;
+			inline std::size_t GetRemainingSize() const;
+
+			inline bool HasFailed() const;
+
+			template<typename DataType> void Serialize(DataType& data);
+			template<typename PacketType, typename DataType> void Serialize(DataType& data);
+
+			template<typename T> void SerializeArraySize(T& array);
+
+			template<typename DataType> void operator&=(DataType& data);
+
+			static constexpr bool IsWriting = false;
+
+		private:
+			inline void Fail();
+			inline void Read(Nz::UInt8& value);
+			inline void Read(Nz::UInt16& value);
+			inline void Read(Nz::UInt32& value);
+			inline void Read(Nz::UInt64& value);
+			inline void Read(float& value);
+			inline void Read(std::string& value);
+			inline void Read(Nz::String& value);
+			inline void Read(Nz::Boxf& value);
+			inline void Read(Nz::Quaternionf& value);
+			inline void Read(Nz::Vector3f& value);
+			template<typename T> void Read(CompressedSigned<T>& value);
+			template<typename T> void Read(CompressedUnsigned<T>& value);
+			template<typename T> void ReadInteger(T& value);
+
+			const Nz::UInt8* m_data;
+			std::size_t m_offset;
+			std::size_t m_size;
+			bool m_failed;
+	};
+}
+
+#include <Shared/Protocol/PacketReader.inl>
+
+#endif // EREWHON_SHARED_NETWORK_PACKETREADER_HPP
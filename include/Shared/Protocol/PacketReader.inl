@@ -0,0 +1,241 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/PacketReader.hpp>
+#include <climits>
+#include <cstring>
+
+namespace ewn
+{
+	inline PacketReader::PacketReader(const Nz::UInt8* data, std::size_t size) :
+	m_data(data),
+	m_offset(0),
+	m_size(size),
+	m_failed(false)
+	{
+	}
+
+	inline PacketReader::PacketReader(const Nz::NetPacket& packet) :
+	PacketReader(packet.GetConstData() + Nz::NetPacket::HeaderSize, packet.GetDataSize())
+	{
+	}
+
+	// Returns a reader over the next bytes and skips them, used for nested messages
+	inline PacketReader PacketReader::ExtractReader(std::size_t size)
+	{
+		if (size > GetRemainingSize())
+		{
+			Fail();
+			return PacketReader(m_data, 0);
+		}
+
+		PacketReader reader(m_data + m_offset, size);
+		m_offset += size;
+
+		return reader;
+	}
+
+	inline std::size_t PacketReader::GetOffset() const
+	{
+		return m_offset;
+	}
+
+	inline std::size_t PacketReader::GetRemainingSize() const
+	{
+		return m_size - m_offset;
+	}
+
+	inline bool PacketReader::HasFailed() const
+	{
+		return m_failed;
+	}
+
+	template<typename DataType>
+	void PacketReader::Serialize(DataType& data)
+	{
+		Read(data);
+	}
+
+	template<typename PacketType, typename DataType>
+	void PacketReader::Serialize(DataType& data)
+	{
+		PacketType packetData;
+		Read(packetData);
+
+		data = static_cast<DataType>(packetData);
+	}
+
+	template<typename T>
+	void PacketReader::SerializeArraySize(T& array)
+	{
+		CompressedUnsigned<Nz::UInt32> arraySize;
+		Read(arraySize);
+
+		// Every element takes at least a byte, this prevents a forged size from allocating gigabytes
+		if (arraySize > GetRemainingSize())
+		{
+			Fail();
+			arraySize = 0;
+		}
+
+		array.resize(arraySize);
+	}
+
+	template<typename DataType>
+	void PacketReader::operator&=(DataType& data)
+	{
+		return Serialize(data);
+	}
+
+	inline void PacketReader::Fail()
+	{
+		m_failed = true;
+		m_offset = m_size;
+	}
+
+	inline void PacketReader::Read(Nz::UInt8& value)
+	{
+		if (m_offset >= m_size)
+		{
+			Fail();
+			value = 0;
+			return;
+		}
+
+		value = m_data[m_offset++];
+	}
+
+	inline void PacketReader::Read(Nz::UInt16& value)
+	{
+		ReadInteger(value);
+	}
+
+	inline void PacketReader::Read(Nz::UInt32& value)
+	{
+		ReadInteger(value);
+	}
+
+	inline void PacketReader::Read(Nz::UInt64& value)
+	{
+		ReadInteger(value);
+	}
+
+	inline void PacketReader::Read(float& value)
+	{
+		static_assert(sizeof(float) == sizeof(Nz::UInt32));
+
+		Nz::UInt32 bits;
+		ReadInteger(bits);
+
+		std::memcpy(&value, &bits, sizeof(float));
+	}
+
+	inline void PacketReader::Read(std::string& value)
+	{
+		Nz::UInt32 size;
+		ReadInteger(size);
+
+		if (size > GetRemainingSize())
+		{
+			Fail();
+			value.clear();
+			return;
+		}
+
+		value.assign(reinterpret_cast<const char*>(&m_data[m_offset]), size);
+		m_offset += size;
+	}
+
+	inline void PacketReader::Read(Nz::String& value)
+	{
+		Nz::UInt32 size;
+		ReadInteger(size);
+
+		if (size > GetRemainingSize())
+		{
+			Fail();
+			value.Clear();
+			return;
+		}
+
+		value.Set(reinterpret_cast<const char*>(&m_data[m_offset]), size);
+		m_offset += size;
+	}
+
+	inline void PacketReader::Read(Nz::Boxf& value)
+	{
+		Read(value.x);
+		Read(value.y);
+		Read(value.z);
+		Read(value.width);
+		Read(value.height);
+		Read(value.depth);
+	}
+
+	inline void PacketReader::Read(Nz::Quaternionf& value)
+	{
+		Read(value.w);
+		Read(value.x);
+		Read(value.y);
+		Read(value.z);
+	}
+
+	inline void PacketReader::Read(Nz::Vector3f& value)
+	{
+		Read(value.x);
+		Read(value.y);
+		Read(value.z);
+	}
+
+	template<typename T>
+	void PacketReader::Read(CompressedSigned<T>& value)
+	{
+		CompressedUnsigned<std::make_unsigned_t<T>> compressedValue;
+		Read(compressedValue);
+
+		value = ZigZagDecode<T>(compressedValue);
+	}
+
+	template<typename T>
+	void PacketReader::Read(CompressedUnsigned<T>& value)
+	{
+		constexpr std::size_t MaxByteCount = (sizeof(T) * CHAR_BIT + 6) / 7;
+
+		T integerValue = 0;
+		for (std::size_t i = 0; i < MaxByteCount; ++i)
+		{
+			Nz::UInt8 byteValue;
+			Read(byteValue);
+
+			integerValue |= T(byteValue & 0x7F) << (7 * i);
+			if ((byteValue & 0x80) == 0)
+			{
+				value = integerValue;
+				return;
+			}
+		}
+
+		// Too many continuation bits for the integer type
+		Fail();
+		value = 0;
+	}
+
+	template<typename T>
+	void PacketReader::ReadInteger(T& value)
+	{
+		if (GetRemainingSize() < sizeof(T))
+		{
+			Fail();
+			value = 0;
+			return;
+		}
+
+		T integerValue = 0;
+		for (std::size_t i = 0; i < sizeof(T); ++i)
+			integerValue = static_cast<T>((integerValue << 8) | m_data[m_offset + i]);
+
+		m_offset += sizeof(T);
+		value = integerValue;
+	}
+}
@@ -0,0 +1,58 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_PACKETSIZER_HPP
+#define EREWHON_SHARED_NETWORK_PACKETSIZER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/String.hpp>
+#include <Nazara/Math/Box.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
+#include <string>
+
+namespace ewn
+{
+	// Computes the exact number of bytes PacketWriter will write for the same fields
+	class PacketSizer
+	{
+		public:
+			inline PacketSizer();
+			~PacketSizer() = default;
+
+			inline std::size_t GetSize() const;
+
+			template<typename DataType> void Serialize(const DataType& data);
+			template<typename PacketType, typename DataType> void Serialize(const DataType& data);
+
+			template<typename T> void SerializeArraySize(const T& array);
+
+			template<typename DataType> void operator&=(const DataType& data);
+
+			static constexpr bool IsWriting = true;
+
+		private:
+			static inline std::size_t FieldSize(Nz::UInt8 value);
+			static inline std::size_t FieldSize(Nz::UInt16 value);
+			static inline std::size_t FieldSize(Nz::UInt32 value);
+			static inline std::size_t FieldSize(Nz::UInt64 value);
+			static inline std::size_t FieldSize(float value);
+			static inline std::size_t FieldSize(const std::string& value);
+			static inline std::size_t FieldSize(const Nz::String& value);
+			static inline std::size_t FieldSize(const Nz::Boxf& value);
+			static inline std::size_t FieldSize(const Nz::Quaternionf& value);
+			static inline std::size_t FieldSize(const Nz::Vector3f& value);
+			template<typename T> static std::size_t FieldSize(CompressedSigned<T> value);
+			template<typename T> static std::size_t FieldSize(CompressedUnsigned<T> value);
+
+			std::size_t m_size;
+	};
+}
+
+#include <Shared/Protocol/PacketSizer.inl>
+
+#endif // EREWHON_SHARED_NETWORK_PACKETSIZER_HPP
@@ -0,0 +1,113 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/PacketSizer.hpp>
+
+namespace ewn
+{
+	inline PacketSizer::PacketSizer() :
+	m_size(0)
+	{
+	}
+
+	inline std::size_t PacketSizer::GetSize() const
+	{
+		return m_size;
+	}
+
+	template<typename DataType>
+	void PacketSizer::Serialize(const DataType& data)
+	{
+		m_size += FieldSize(data);
+	}
+
+	template<typename PacketType, typename DataType>
+	void PacketSizer::Serialize(const DataType& data)
+	{
+		m_size += FieldSize(static_cast<PacketType>(data));
+	}
+
+	template<typename T>
+	void PacketSizer::SerializeArraySize(const T& array)
+	{
+		m_size += FieldSize(CompressedUnsigned<Nz::UInt32>(Nz::UInt32(array.size())));
+	}
+
+	template<typename DataType>
+	void PacketSizer::operator&=(const DataType& data)
+	{
+		return Serialize(data);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(Nz::UInt8 /*value*/)
+	{
+		return sizeof(Nz::UInt8);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(Nz::UInt16 /*value*/)
+	{
+		return sizeof(Nz::UInt16);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(Nz::UInt32 /*value*/)
+	{
+		return sizeof(Nz::UInt32);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(Nz::UInt64 /*value*/)
+	{
+		return sizeof(Nz::UInt64);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(float /*value*/)
+	{
+		return sizeof(float);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(const std::string& value)
+	{
+		return sizeof(Nz::UInt32) + value.size();
+	}
+
+	inline std::size_t PacketSizer::FieldSize(const Nz::String& value)
+	{
+		return sizeof(Nz::UInt32) + value.GetSize();
+	}
+
+	inline std::size_t PacketSizer::FieldSize(const Nz::Boxf& /*value*/)
+	{
+		return 6 * sizeof(float);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(const Nz::Quaternionf& /*value*/)
+	{
+		return 4 * sizeof(float);
+	}
+
+	inline std::size_t PacketSizer::FieldSize(const Nz::Vector3f& /*value*/)
+	{
+		return 3 * sizeof(float);
+	}
+
+	template<typename T>
+	std::size_t PacketSizer::FieldSize(CompressedSigned<T> value)
+	{
+		return FieldSize(CompressedUnsigned<std::make_unsigned_t<T>>(ZigZagEncode(static_cast<T>(value))));
+	}
+
+	template<typename T>
+	std::size_t PacketSizer::FieldSize(CompressedUnsigned<T> value)
+	{
+		std::size_t size = 1;
+
+		T integerValue = value;
+		while (integerValue >= 0x80)
+		{
+			integerValue >>= 7;
+			size++;
+		}
+
+		return size;
+	}
+}
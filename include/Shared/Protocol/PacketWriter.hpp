@@ -0,0 +1,65 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_NETWORK_PACKETWRITER_HPP
+#define EREWHON_SHARED_NETWORK_PACKETWRITER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/String.hpp>
+#include <Nazara/Math/Box.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <Shared/Protocol/CompressedInteger.hpp>
+#include <string>
+
+namespace ewn
+{
+	// Writes packet fields into a buffer sized beforehand with PacketSizer (integers and floats are big-endian)
+	class PacketWriter
+	{
+		public:
+			inline PacketWriter(Nz::UInt8* buffer, std::size_t size);
+			inline PacketWriter(Nz::NetPacket& packet, Nz::UInt16 netCode, std::size_t size);
+			~PacketWriter() = default;
+
+			inline std::size_t GetOffset() const;
+
+			template<typename DataType> void Serialize(const DataType& data);
+			template<typename PacketType, typename DataType> void Serialize(const DataType& data);
+
+			template<typename T> void SerializeArraySize(const T& array);
+
+			inline void WriteBytes(const void* data, std::size_t size);
+
+			template<typename DataType> void operator&=(const DataType& data);
+
+			static constexpr bool IsWriting = true;
+
+		private:
+			inline void Write(Nz::UInt8 value);
+			inline void Write(Nz::UInt16 value);
+			inline void Write(Nz::UInt32 value);
+			inline void Write(Nz::UInt64 value);
+			inline void Write(float value);
+			inline void Write(const std::string& value);
+			inline void Write(const Nz::String& value);
+			inline void Write(const Nz::Boxf& value);
+			inline void Write(const Nz::Quaternionf& value);
+			inline void Write(const Nz::Vector3f& value);
+			template<typename T> void Write(CompressedSigned<T> value);
+			template<typename T> void Write(CompressedUnsigned<T> value);
+			template<typename T> void WriteInteger(T value);
+
+			Nz::UInt8* m_buffer;
+			std::size_t m_offset;
+			std::size_t m_size;
+	};
+}
+
+#include <Shared/Protocol/PacketWriter.inl>
+
+#endif // EREWHON_SHARED_NETWORK_PACKETWRITER_HPP
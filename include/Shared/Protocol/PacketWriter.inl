@@ -0,0 +1,167 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <cassert>
+#include <cstring>
+
+namespace ewn
+{
+	inline PacketWriter::PacketWriter(Nz::UInt8* buffer, std::size_t size) :
+	m_buffer(buffer),
+	m_offset(0),
+	m_size(size)
+	{
+	}
+
+	inline PacketWriter::PacketWriter(Nz::NetPacket& packet, Nz::UInt16 netCode, std::size_t size) :
+	m_offset(0),
+	m_size(size)
+	{
+		// Allocate the whole packet once, the header is filled by Nazara when sending it
+		packet.Reset(netCode, nullptr, size);
+		m_buffer = packet.GetData() + Nz::NetPacket::HeaderSize;
+	}
+
+	inline std::size_t PacketWriter::GetOffset() const
+	{
+		return m_offset;
+	}
+
+	template<typename DataType>
+	void PacketWriter::Serialize(const DataType& data)
+	{
+		Write(data);
+	}
+
+	template<typename PacketType, typename DataType>
+	void PacketWriter::Serialize(const DataType& data)
+	{
+		Write(static_cast<PacketType>(data));
+	}
+
+	template<typename T>
+	void PacketWriter::SerializeArraySize(const T& array)
+	{
+		Write(CompressedUnsigned<Nz::UInt32>(Nz::UInt32(array.size())));
+	}
+
+	template<typename DataType>
+	void PacketWriter::operator&=(const DataType& data)
+	{
+		return Serialize(data);
+	}
+
+	inline void PacketWriter::Write(Nz::UInt8 value)
+	{
+		assert(m_offset < m_size);
+		m_buffer[m_offset++] = value;
+	}
+
+	inline void PacketWriter::Write(Nz::UInt16 value)
+	{
+		WriteInteger(value);
+	}
+
+	inline void PacketWriter::Write(Nz::UInt32 value)
+	{
+		WriteInteger(value);
+	}
+
+	inline void PacketWriter::Write(Nz::UInt64 value)
+	{
+		WriteInteger(value);
+	}
+
+	inline void PacketWriter::Write(float value)
+	{
+		static_assert(sizeof(float) == sizeof(Nz::UInt32));
+
+		Nz::UInt32 bits;
+		std::memcpy(&bits, &value, sizeof(float));
+
+		WriteInteger(bits);
+	}
+
+	inline void PacketWriter::Write(const std::string& value)
+	{
+		WriteInteger(Nz::UInt32(value.size()));
+		WriteBytes(value.data(), value.size());
+	}
+
+	inline void PacketWriter::Write(const Nz::String& value)
+	{
+		WriteInteger(Nz::UInt32(value.GetSize()));
+		WriteBytes(value.GetConstBuffer(), value.GetSize());
+	}
+
+	inline void PacketWriter::Write(const Nz::Boxf& value)
+	{
+		Write(value.x);
+		Write(value.y);
+		Write(value.z);
+		Write(value.width);
+		Write(value.height);
+		Write(value.depth);
+	}
+
+	inline void PacketWriter::Write(const Nz::Quaternionf& value)
+	{
+		Write(value.w);
+		Write(value.x);
+		Write(value.y);
+		Write(value.z);
+	}
+
+	inline void PacketWriter::Write(const Nz::Vector3f& value)
+	{
+		Write(value.x);
+		Write(value.y);
+		Write(value.z);
+	}
+
+	template<typename T>
+	void PacketWriter::Write(CompressedSigned<T> value)
+	{
+		Write(CompressedUnsigned<std::make_unsigned_t<T>>(ZigZagEncode(static_cast<T>(value))));
+	}
+
+	template<typename T>
+	void PacketWriter::Write(CompressedUnsigned<T> value)
+	{
+		// Seven bits per byte, the highest bit tells if another byte follows
+		T integerValue = value;
+		while (integerValue >= 0x80)
+		{
+			Write(static_cast<Nz::UInt8>((integerValue & 0x7F) | 0x80));
+			integerValue >>= 7;
+		}
+
+		Write(static_cast<Nz::UInt8>(integerValue));
+	}
+
+	inline void PacketWriter::WriteBytes(const void* data, std::size_t size)
+	{
+		assert(m_size - m_offset >= size);
+
+		if (size > 0)
+			std::memcpy(&m_buffer[m_offset], data, size);
+
+		m_offset += size;
+	}
+
+	template<typename T>
+	void PacketWriter::WriteInteger(T value)
+	{
+		assert(m_size - m_offset >= sizeof(T));
+
+		for (std::size_t i = sizeof(T); i > 0; --i)
+		{
+			m_buffer[m_offset + i - 1] = static_cast<Nz::UInt8>(value & 0xFF);
+			value = static_cast<T>(value >> 8);
+		}
+
+		m_offset += sizeof(T);
+	}
+}
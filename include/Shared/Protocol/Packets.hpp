@@ -9,7 +9,6 @@
 
 #include <Shared/Enums.hpp>
 #include <Shared/Protocol/CompressedInteger.hpp>
-#include <Shared/Protocol/PacketSerializer.hpp>
 #include <Nazara/Prerequisites.hpp>
 #include <Nazara/Core/String.hpp>
 #include <Nazara/Math/Box.hpp>
@@ -22,6 +21,9 @@
 
 namespace ewn
 {
+	class PacketReader;
+	class PacketWriter;
+
 	enum class PacketType
 	{
 		ArenaList,
@@ -30,25 +32,30 @@ namespace ewn
 		ArenaSounds,
 		ArenaState,
 		BotMessage,
+		CachedPacketVersion,
 		ChatMessage,
 		ControlEntity,
 		CreateEntities,
 		CreateFleet,
 		CreateFleetFailure,
 		CreateFleetSuccess,
+		CreateProjectiles,
 		CreateSpaceship,
 		CreateSpaceshipFailure,
 		CreateSpaceshipSuccess,
+		DeclareCachedPackets,
 		DeleteEntities,
 		DeleteFleet,
 		DeleteFleetFailure,
 		DeleteFleetSuccess,
+		DeleteProjectiles,
 		DeleteSpaceship,
 		DeleteSpaceshipFailure,
 		DeleteSpaceshipSuccess,
 		FleetInfo,
 		FleetList,
 		HullList,
+		InstantiateEffects,
 		InstantiateParticleSystem,
 		IntegrityUpdate,
 		JoinArena,
@@ -73,6 +80,7 @@ namespace ewn
 		Register,
 		RegisterFailure,
 		RegisterSuccess,
+		RelayLogin,
 		SpaceshipInfo,
 		SpaceshipList,
 		TimeSyncRequest,
@@ -82,9 +90,13 @@ namespace ewn
 		UpdateFleetSuccess,
 		UpdateSpaceship,
 		UpdateSpaceshipFailure,
-		UpdateSpaceshipSuccess
+		UpdateSpaceshipSuccess,
+
+		Max = UpdateSpaceshipSuccess
 	};
 
+	constexpr std::size_t PacketTypeCount = static_cast<std::size_t>(PacketType::Max) + 1;
+
 	template<PacketType PT> struct PacketTag
 	{
 		static constexpr PacketType Type = PT;
@@ -192,6 +204,13 @@ namespace ewn
 			std::string errorMessage;
 		};
 
+		DeclarePacket(CachedPacketVersion)
+		{
+			PacketType packetType;
+			Nz::UInt32 version;
+			bool useCachedPacket; //< if false, the packet itself follows
+		};
+
 		DeclarePacket(ChatMessage)
 		{
 			std::string message;
@@ -240,6 +259,22 @@ namespace ewn
 		{
 		};
 
+		DeclarePacket(CreateProjectiles)
+		{
+			struct Projectile
+			{
+				CompressedUnsigned<Nz::UInt32> projectileId;
+				CompressedUnsigned<Nz::UInt32> prefabId;
+				CompressedUnsigned<Nz::UInt64> spawnTime;
+				Nz::Vector3f direction;
+				Nz::Vector3f origin;
+				float lifeTime;
+				float speed;
+			};
+
+			std::vector<Projectile> projectiles;
+		};
+
 		DeclarePacket(CreateSpaceship)
 		{
 			struct ModuleInfo
@@ -263,6 +298,17 @@ namespace ewn
 		{
 		};
 
+		DeclarePacket(DeclareCachedPackets)
+		{
+			struct CachedPacket
+			{
+				PacketType packetType;
+				Nz::UInt32 version;
+			};
+
+			std::vector<CachedPacket> packets;
+		};
+
 		DeclarePacket(DeleteEntities)
 		{
 			using EntityId = CompressedUnsigned<Nz::UInt32>;
@@ -284,6 +330,13 @@ namespace ewn
 		{
 		};
 
+		DeclarePacket(DeleteProjectiles)
+		{
+			using ProjectileId = CompressedUnsigned<Nz::UInt32>;
+
+			std::vector<ProjectileId> projectiles;
+		};
+
 		DeclarePacket(DeleteSpaceship)
 		{
 			std::string spaceshipName;
@@ -357,6 +410,26 @@ namespace ewn
 			std::vector<HullInfo> hulls;
 		};
 
+		DeclarePacket(InstantiateEffects)
+		{
+			struct ParticleSystem
+			{
+				CompressedUnsigned<Nz::UInt32> particleSystemId;
+				Nz::Quaternionf rotation;
+				Nz::Vector3f position;
+				Nz::Vector3f scale;
+			};
+
+			struct Sound
+			{
+				CompressedUnsigned<Nz::UInt32> soundId;
+				Nz::Vector3f position;
+			};
+
+			std::vector<ParticleSystem> particleSystems;
+			std::vector<Sound> sounds;
+		};
+
 		DeclarePacket(InstantiateParticleSystem)
 		{
 			CompressedUnsigned<Nz::UInt32> particleSystemId;
@@ -395,6 +468,7 @@ namespace ewn
 		DeclarePacket(LoginFailure)
 		{
 			LoginFailureReason reason;
+			CompressedUnsigned<Nz::UInt32> retryAfter; //< milliseconds, zero unless the server asks the client to wait
 		};
 
 		DeclarePacket(LoginSuccess)
@@ -430,11 +504,18 @@ namespace ewn
 			std::string text;
 		};
 
+		// Encoded by MovementInputHistory, each packet repeats the last inputs so a lost packet doesn't lose its input
 		DeclarePacket(PlayerMovement)
 		{
+			struct PreviousInput
+			{
+				CompressedUnsigned<Nz::UInt32> timeDelta;              //< Milliseconds before the next more recent input
+				std::array<CompressedSigned<Nz::Int16>, 6> valueDeltas; //< Difference with the next more recent input values
+			};
+
 			CompressedUnsigned<Nz::UInt64> inputTime; //< Server time
-			Nz::Vector3f direction;
-			Nz::Vector3f rotation;
+			std::array<Nz::UInt8, 6> values;          //< Quantized direction then rotation
+			std::vector<PreviousInput> previousInputs; //< Most recent first
 		};
 
 		DeclarePacket(PlayerShoot)
@@ -489,12 +570,19 @@ namespace ewn
 		DeclarePacket(RegisterFailure)
 		{
 			RegisterFailureReason reason;
+			CompressedUnsigned<Nz::UInt32> retryAfter; //< milliseconds, zero unless the server asks the client to wait
 		};
 
 		DeclarePacket(RegisterSuccess)
 		{
 		};
 
+		// Sent instead of a login by spectator relays (see ErewhonRelay), which then receive arena broadcasts as spectators
+		DeclarePacket(RelayLogin)
+		{
+			std::string secret;
+		};
+
 		DeclarePacket(SpaceshipInfo)
 		{
 			struct ModuleInfo
@@ -583,65 +671,79 @@ namespace ewn
 
 #undef DeclarePacket
 
-		void Serialize(PacketSerializer& serializer, ArenaList& data);
-		void Serialize(PacketSerializer& serializer, ArenaPrefabs& data);
-		void Serialize(PacketSerializer& serializer, ArenaParticleSystems& data);
-		void Serialize(PacketSerializer& serializer, ArenaSounds& data);
-		void Serialize(PacketSerializer& serializer, ArenaState& data);
-		void Serialize(PacketSerializer& serializer, BotMessage& data);
-		void Serialize(PacketSerializer& serializer, ChatMessage& data);
-		void Serialize(PacketSerializer& serializer, ControlEntity& data);
-		void Serialize(PacketSerializer& serializer, CreateEntities& data);
-		void Serialize(PacketSerializer& serializer, CreateFleet& data);
-		void Serialize(PacketSerializer& serializer, CreateFleetFailure& data);
-		void Serialize(PacketSerializer& serializer, CreateFleetSuccess& data);
-		void Serialize(PacketSerializer& serializer, CreateSpaceship& data);
-		void Serialize(PacketSerializer& serializer, CreateSpaceshipFailure& data);
-		void Serialize(PacketSerializer& serializer, CreateSpaceshipSuccess& data);
-		void Serialize(PacketSerializer& serializer, DeleteEntities& data);
-		void Serialize(PacketSerializer& serializer, DeleteFleet& data);
-		void Serialize(PacketSerializer& serializer, DeleteFleetFailure& data);
-		void Serialize(PacketSerializer& serializer, DeleteFleetSuccess& data);
-		void Serialize(PacketSerializer& serializer, DeleteSpaceship& data);
-		void Serialize(PacketSerializer& serializer, DeleteSpaceshipFailure& data);
-		void Serialize(PacketSerializer& serializer, DeleteSpaceshipSuccess& data);
-		void Serialize(PacketSerializer& serializer, FleetInfo& data);
-		void Serialize(PacketSerializer& serializer, FleetList& data);
-		void Serialize(PacketSerializer& serializer, HullList& data);
-		void Serialize(PacketSerializer& serializer, InstantiateParticleSystem& data);
-		void Serialize(PacketSerializer& serializer, IntegrityUpdate& data);
-		void Serialize(PacketSerializer& serializer, LeaveArena& data);
-		void Serialize(PacketSerializer& serializer, JoinArena& data);
-		void Serialize(PacketSerializer& serializer, Login& data);
-		void Serialize(PacketSerializer& serializer, LoginByToken& data);
-		void Serialize(PacketSerializer& serializer, LoginFailure& data);
-		void Serialize(PacketSerializer& serializer, LoginSuccess& data);
-		void Serialize(PacketSerializer& serializer, ModuleList& data);
-		void Serialize(PacketSerializer& serializer, NetworkStrings& data);
-		void Serialize(PacketSerializer& serializer, PlayerChat& data);
-		void Serialize(PacketSerializer& serializer, PlayerMovement& data);
-		void Serialize(PacketSerializer& serializer, PlayerShoot& data);
-		void Serialize(PacketSerializer& serializer, PlaySound& data);
-		void Serialize(PacketSerializer& serializer, QueryArenaList& data);
-		void Serialize(PacketSerializer& serializer, QueryFleetInfo& data);
-		void Serialize(PacketSerializer& serializer, QueryFleetList& data);
-		void Serialize(PacketSerializer& serializer, QueryHullList& data);
-		void Serialize(PacketSerializer& serializer, QueryModuleList& data);
-		void Serialize(PacketSerializer& serializer, QuerySpaceshipInfo& data);
-		void Serialize(PacketSerializer& serializer, QuerySpaceshipList& data);
-		void Serialize(PacketSerializer& serializer, Register& data);
-		void Serialize(PacketSerializer& serializer, RegisterFailure& data);
-		void Serialize(PacketSerializer& serializer, RegisterSuccess& data);
-		void Serialize(PacketSerializer& serializer, SpaceshipInfo& data);
-		void Serialize(PacketSerializer& serializer, SpaceshipList& data);
-		void Serialize(PacketSerializer& serializer, TimeSyncRequest& data);
-		void Serialize(PacketSerializer& serializer, TimeSyncResponse& data);
-		void Serialize(PacketSerializer& serializer, UpdateFleet& data);
-		void Serialize(PacketSerializer& serializer, UpdateFleetFailure& data);
-		void Serialize(PacketSerializer& serializer, UpdateFleetSuccess& data);
-		void Serialize(PacketSerializer& serializer, UpdateSpaceship& data);
-		void Serialize(PacketSerializer& serializer, UpdateSpaceshipFailure& data);
-		void Serialize(PacketSerializer& serializer, UpdateSpaceshipSuccess& data);
+		// ComputeSize returns the exact number of bytes Serialize writes, Unserialize returns false on malformed data
+#define DeclarePacketSerializer(Type) \
+		std::size_t ComputeSize(const Type& data); \
+		void Serialize(PacketWriter& writer, const Type& data); \
+		bool Unserialize(PacketReader& reader, Type& data);
+
+		DeclarePacketSerializer(ArenaList)
+		DeclarePacketSerializer(ArenaParticleSystems)
+		DeclarePacketSerializer(ArenaPrefabs)
+		DeclarePacketSerializer(ArenaSounds)
+		DeclarePacketSerializer(ArenaState)
+		DeclarePacketSerializer(BotMessage)
+		DeclarePacketSerializer(CachedPacketVersion)
+		DeclarePacketSerializer(ChatMessage)
+		DeclarePacketSerializer(ControlEntity)
+		DeclarePacketSerializer(CreateEntities)
+		DeclarePacketSerializer(CreateFleet)
+		DeclarePacketSerializer(CreateFleetFailure)
+		DeclarePacketSerializer(CreateFleetSuccess)
+		DeclarePacketSerializer(CreateProjectiles)
+		DeclarePacketSerializer(CreateSpaceship)
+		DeclarePacketSerializer(CreateSpaceshipFailure)
+		DeclarePacketSerializer(CreateSpaceshipSuccess)
+		DeclarePacketSerializer(DeclareCachedPackets)
+		DeclarePacketSerializer(DeleteEntities)
+		DeclarePacketSerializer(DeleteFleet)
+		DeclarePacketSerializer(DeleteFleetFailure)
+		DeclarePacketSerializer(DeleteFleetSuccess)
+		DeclarePacketSerializer(DeleteProjectiles)
+		DeclarePacketSerializer(DeleteSpaceship)
+		DeclarePacketSerializer(DeleteSpaceshipFailure)
+		DeclarePacketSerializer(DeleteSpaceshipSuccess)
+		DeclarePacketSerializer(FleetInfo)
+		DeclarePacketSerializer(FleetList)
+		DeclarePacketSerializer(HullList)
+		DeclarePacketSerializer(InstantiateEffects)
+		DeclarePacketSerializer(InstantiateParticleSystem)
+		DeclarePacketSerializer(IntegrityUpdate)
+		DeclarePacketSerializer(JoinArena)
+		DeclarePacketSerializer(LeaveArena)
+		DeclarePacketSerializer(Login)
+		DeclarePacketSerializer(LoginByToken)
+		DeclarePacketSerializer(LoginFailure)
+		DeclarePacketSerializer(LoginSuccess)
+		DeclarePacketSerializer(ModuleList)
+		DeclarePacketSerializer(NetworkStrings)
+		DeclarePacketSerializer(PlaySound)
+		DeclarePacketSerializer(PlayerChat)
+		DeclarePacketSerializer(PlayerMovement)
+		DeclarePacketSerializer(PlayerShoot)
+		DeclarePacketSerializer(QueryArenaList)
+		DeclarePacketSerializer(QueryFleetInfo)
+		DeclarePacketSerializer(QueryFleetList)
+		DeclarePacketSerializer(QueryHullList)
+		DeclarePacketSerializer(QueryModuleList)
+		DeclarePacketSerializer(QuerySpaceshipInfo)
+		DeclarePacketSerializer(QuerySpaceshipList)
+		DeclarePacketSerializer(Register)
+		DeclarePacketSerializer(RegisterFailure)
+		DeclarePacketSerializer(RegisterSuccess)
+		DeclarePacketSerializer(RelayLogin)
+		DeclarePacketSerializer(SpaceshipInfo)
+		DeclarePacketSerializer(SpaceshipList)
+		DeclarePacketSerializer(TimeSyncRequest)
+		DeclarePacketSerializer(TimeSyncResponse)
+		DeclarePacketSerializer(UpdateFleet)
+		DeclarePacketSerializer(UpdateFleetFailure)
+		DeclarePacketSerializer(UpdateFleetSuccess)
+		DeclarePacketSerializer(UpdateSpaceship)
+		DeclarePacketSerializer(UpdateSpaceshipFailure)
+		DeclarePacketSerializer(UpdateSpaceshipSuccess)
+
+#undef DeclarePacketSerializer
 	}
 }
 
@@ -0,0 +1,33 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_REPLAYFORMAT_HPP
+#define EREWHON_SHARED_REPLAYFORMAT_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace ewn
+{
+	// Arena replay files (big-endian, written with PacketWriter):
+	//
+	// File header: UInt32 FileMagic, UInt16 FormatVersion, UInt64 start time (server time, ms), UInt64 start timestamp (UTC, ms), string arena name
+	// Then chunks, each starting with a keyframe (every record needed to rebuild the arena) so playback can start from any of them:
+	//   Chunk header (ChunkHeaderSize bytes): UInt32 ChunkMagic, UInt32 payload size, UInt32 keyframe size, UInt32 record count, UInt64 start time, UInt64 end time
+	//   Payload: records, the keyframe ones first
+	//     Record: CompressedUnsigned<UInt32> time since chunk start (ms), CompressedUnsigned<UInt32> message size, message (UInt8 packet type + packet, as clients receive it)
+	//
+	// A chunk is only written once complete, a truncated last chunk (server crash) is ignored by readers
+	namespace ReplayFormat
+	{
+		constexpr Nz::UInt32 ChunkMagic = 0x45574E43; //< "EWNC"
+		constexpr Nz::UInt32 FileMagic = 0x45574E52; //< "EWNR"
+		constexpr Nz::UInt16 FormatVersion = 1;
+
+		constexpr std::size_t ChunkHeaderSize = 4 * sizeof(Nz::UInt32) + 2 * sizeof(Nz::UInt64);
+	}
+}
+
+#endif // EREWHON_SHARED_REPLAYFORMAT_HPP
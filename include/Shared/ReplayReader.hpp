@@ -0,0 +1,97 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_REPLAYREADER_HPP
+#define EREWHON_SHARED_REPLAYREADER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <functional>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Memory-maps an arena replay (see ReplayFormat.hpp) and indexes its chunks when opening it
+	// Only chunk headers are read until a chunk is requested, seeking in hours of replay only touches the pages of one chunk
+	class ReplayReader
+	{
+		public:
+			struct Chunk;
+			struct Record;
+
+			using RecordCallback = std::function<bool(const Record& record)>; //< returns false to stop reading
+
+			ReplayReader();
+			ReplayReader(const ReplayReader&) = delete;
+			ReplayReader(ReplayReader&&) = delete;
+			~ReplayReader();
+
+			void Close();
+
+			std::size_t FindChunk(Nz::UInt64 time) const;
+
+			inline const std::string& GetArenaName() const;
+			inline const Chunk& GetChunk(std::size_t chunkIndex) const;
+			inline std::size_t GetChunkCount() const;
+			inline Nz::UInt64 GetEndTime() const;
+			inline Nz::UInt64 GetStartTime() const;
+			inline Nz::UInt64 GetStartTimestamp() const;
+
+			inline bool IsOpen() const;
+
+			bool Open(const std::string& filePath);
+
+			bool ReadChunk(std::size_t chunkIndex, const RecordCallback& callback) const;
+
+			std::size_t Seek(Nz::UInt64 time, const RecordCallback& callback) const;
+
+			ReplayReader& operator=(const ReplayReader&) = delete;
+			ReplayReader& operator=(ReplayReader&&) = delete;
+
+			static constexpr std::size_t InvalidChunk = std::numeric_limits<std::size_t>::max();
+
+			struct Chunk
+			{
+				std::size_t offset; //< of the payload, from the beginning of the file
+				Nz::UInt32 keyframeSize;
+				Nz::UInt32 payloadSize;
+				Nz::UInt32 recordCount;
+				Nz::UInt64 endTime;
+				Nz::UInt64 startTime;
+			};
+
+			struct Record
+			{
+				const Nz::UInt8* data; //< packet data, following the packet type (use a PacketReader and Packets::Unserialize)
+				std::size_t size;
+				Nz::UInt64 time;
+				PacketType type;
+				bool isKeyframe;
+			};
+
+		private:
+			bool BuildIndex();
+			bool MapFile(const std::string& filePath);
+			void UnmapFile();
+
+			std::string m_arenaName;
+			std::vector<Chunk> m_chunks;
+			const Nz::UInt8* m_data;
+			std::size_t m_size;
+			Nz::UInt64 m_startTime;
+			Nz::UInt64 m_startTimestamp;
+#ifdef NAZARA_PLATFORM_WINDOWS
+			void* m_fileHandle;
+			void* m_mappingHandle;
+#endif
+	};
+}
+
+#include <Shared/ReplayReader.inl>
+
+#endif // EREWHON_SHARED_REPLAYREADER_HPP
@@ -0,0 +1,48 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/ReplayReader.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	inline const std::string& ReplayReader::GetArenaName() const
+	{
+		return m_arenaName;
+	}
+
+	inline const ReplayReader::Chunk& ReplayReader::GetChunk(std::size_t chunkIndex) const
+	{
+		assert(chunkIndex < m_chunks.size());
+		return m_chunks[chunkIndex];
+	}
+
+	inline std::size_t ReplayReader::GetChunkCount() const
+	{
+		return m_chunks.size();
+	}
+
+	// Server time (in milliseconds) of the last record
+	inline Nz::UInt64 ReplayReader::GetEndTime() const
+	{
+		return (!m_chunks.empty()) ? m_chunks.back().endTime : m_startTime;
+	}
+
+	// Server time (in milliseconds) when the recording started
+	inline Nz::UInt64 ReplayReader::GetStartTime() const
+	{
+		return m_startTime;
+	}
+
+	// UTC time (in milliseconds since epoch) when the recording started
+	inline Nz::UInt64 ReplayReader::GetStartTimestamp() const
+	{
+		return m_startTimestamp;
+	}
+
+	inline bool ReplayReader::IsOpen() const
+	{
+		return m_data != nullptr;
+	}
+}
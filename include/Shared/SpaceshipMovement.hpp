@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
+#define EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+
+namespace ewn
+{
+	// How player inputs move a spaceship, used by the server InputSystem and by client-side prediction
+	// The server runs the physics engine, Integrate reproduces what it does to a lone spaceship without it
+	class SpaceshipMovement
+	{
+		public:
+			struct Parameters;
+			struct State;
+
+			SpaceshipMovement() = delete;
+			~SpaceshipMovement() = delete;
+
+			static void ApplyInput(State& state, const Parameters& parameters, float inputElapsedTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation);
+
+			static inline Nz::Vector3f ComputeBoxInertia(float mass, const Nz::Vector3f& size);
+			static inline Nz::Vector3f ComputeForce(float inputElapsedTime, const Nz::Vector3f& direction);
+			static inline Nz::Vector3f ComputeTorque(float inputElapsedTime, const Nz::Vector3f& rotation);
+
+			static void Integrate(State& state, const Parameters& parameters, float elapsedTime);
+
+			static inline Nz::Vector3f ScaleDirection(const Nz::Vector3f& direction);
+			static inline Nz::Vector3f ScaleRotation(const Nz::Vector3f& rotation);
+
+			struct Parameters
+			{
+				Nz::Vector3f angularDamping = Nz::Vector3f(0.4f);
+				Nz::Vector3f inertia = Nz::Vector3f(1.f); //< Diagonal of the inertia tensor, in local space
+				float linearDamping = 0.25f;
+				float mass = 42.f;
+			};
+
+			struct State
+			{
+				Nz::Quaternionf rotation = Nz::Quaternionf::Identity();
+				Nz::Vector3f angularVelocity = Nz::Vector3f::Zero();
+				Nz::Vector3f linearVelocity = Nz::Vector3f::Zero();
+				Nz::Vector3f position = Nz::Vector3f::Zero();
+			};
+
+			static constexpr float AngularMultiplier = 3000.f;
+			static constexpr float DirectionScale = 50.f;
+			static constexpr float ForceMultiplier = 15000.f;
+			static constexpr float RotationScale = 200.f;
+			static constexpr float StepSize = 0.005f; //< Physics world step, forces added by inputs only last one step
+	};
+}
+
+#include <Shared/SpaceshipMovement.inl>
+
+#endif // EREWHON_SHARED_SPACESHIPMOVEMENT_HPP
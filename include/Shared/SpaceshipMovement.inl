@@ -0,0 +1,38 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/SpaceshipMovement.hpp>
+
+namespace ewn
+{
+	// Inertia of a solid box, the client doesn't have spaceship colliders and uses their bounding box instead
+	inline Nz::Vector3f SpaceshipMovement::ComputeBoxInertia(float mass, const Nz::Vector3f& size)
+	{
+		Nz::Vector3f squaredSize = size * size;
+
+		return mass / 12.f * Nz::Vector3f(squaredSize.y + squaredSize.z, squaredSize.x + squaredSize.z, squaredSize.x + squaredSize.y);
+	}
+
+	// Force in local space, to be applied for a physics step
+	inline Nz::Vector3f SpaceshipMovement::ComputeForce(float inputElapsedTime, const Nz::Vector3f& direction)
+	{
+		return ForceMultiplier * inputElapsedTime * direction;
+	}
+
+	// Torque in global space, to be applied for a physics step
+	inline Nz::Vector3f SpaceshipMovement::ComputeTorque(float inputElapsedTime, const Nz::Vector3f& rotation)
+	{
+		return AngularMultiplier * inputElapsedTime * rotation;
+	}
+
+	inline Nz::Vector3f SpaceshipMovement::ScaleDirection(const Nz::Vector3f& direction)
+	{
+		return direction * DirectionScale;
+	}
+
+	inline Nz::Vector3f SpaceshipMovement::ScaleRotation(const Nz::Vector3f& rotation)
+	{
+		return rotation * RotationScale;
+	}
+}
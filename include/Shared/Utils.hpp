@@ -7,6 +7,7 @@
 #ifndef EREWHON_SHARED_UTILS_HPP
 #define EREWHON_SHARED_UTILS_HPP
 
+#include <Nazara/Math/Quaternion.hpp>
 #include <Nazara/Math/Vector3.hpp>
 #include <type_traits>
 
@@ -40,6 +41,7 @@ namespace ewn
 	template<typename... Args> constexpr OverloadResolver<Args...> Overload = {};
 
 	Nz::Vector3f DampenedString(const Nz::Vector3f& currentPos, const Nz::Vector3f& targetPos, float frametime, float springStrength = 3.f);
+	Nz::Quaternionf IntegrateRotation(const Nz::Quaternionf& rotation, const Nz::Vector3f& angularVelocity, float elapsedTime);
 }
 
 #endif // EREWHON_SHARED_UTILS_HPP
@@ -0,0 +1,18 @@
+-- Load test client, uses the regular client settings (Security parameters must match the server)
+dofile("cconfig.lua")
+
+LoadTest = {
+	ArenaIndex       = 2,          -- Sandbox
+	ClientCount      = 500,
+	ConnectRate      = 50,         -- New clients per second
+	Duration         = 300,        -- Seconds, 0 to run until killed
+	FleetName        = "",         -- Fleet spawned with /spawnfleet once in the arena, must exist for every test account
+	InputRate        = 60,         -- PlayerMovement packets per second
+	LoginPrefix      = "loadtest", -- Logins are prefix .. index and must fit in 20 characters
+	MetricsPort      = 9100,       -- Server metrics (for tick health), 0 to disable
+	Password         = "loadtestpassword",
+	ReactorCount     = 4,
+	RegisterAccounts = true,       -- Register accounts first, existing ones are reused
+	ReportInterval   = 5,          -- Seconds
+	ShootInterval    = 0.5         -- Seconds, 0 to never shoot
+}
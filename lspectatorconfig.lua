@@ -0,0 +1,12 @@
+-- Single load client watching a local relay (ErewhonLoadClient --config lspectatorconfig.lua), see INSTALL.md
+dofile("lconfig.lua")
+
+Server.Port = 2050 -- Relay.Port (see rconfig.lua)
+
+LoadTest.ArenaIndex       = 0     -- A relay only serves its own arena, as index 0
+LoadTest.ClientCount      = 1
+LoadTest.Duration         = 15
+LoadTest.MetricsPort      = 0     -- The relay has no metrics server
+LoadTest.RegisterAccounts = false -- Relays accept any login
+LoadTest.ReportInterval   = 1
+LoadTest.ShootInterval    = 0
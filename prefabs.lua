@@ -0,0 +1,75 @@
+-- Entity prefabs, used both to spawn entities server-side and to build the prefab list sent to clients
+-- Prefab ids are their index in this list (starting at zero), don't reorder existing prefabs
+
+Prefabs = {
+	{
+		Name = "earth",
+		Collider = { Type = "Sphere", Radius = 50 },
+		Signature = 0.000035,
+		VisualEffects = {
+			{ Name = "earth" }
+		}
+	},
+	{
+		Name = "light",
+		VisualEffects = {
+			{ Name = "light" }
+		}
+	},
+	{
+		-- Simulated by the arena projectile simulator, never spawned as an entity
+		Name = "plasmabeam",
+		LifeTime = 10,
+		Movable = true,
+		Projectile = { Damage = 50, DamageVariance = 10, Speed = 250 },
+		Sounds = {
+			{ Id = 3 }
+		},
+		VisualEffects = {
+			{ Name = "plasmabeam" }
+		}
+	},
+	{
+		Name = "torpedo",
+		Collider = { Type = "Sphere", Radius = 3 },
+		LifeTime = 30,
+		Movable = true,
+		Physics = { AngularDamping = 0, LinearDamping = 0, Mass = 1, Material = "torpedo" },
+		PoolSize = 16,
+		Projectile = { Damage = 200, Speed = 50 },
+		Signature = 1000,
+		Sounds = {
+			{ Id = 1 }
+		},
+		VisualEffects = {
+			{ Name = "torpedo" }
+		}
+	},
+	{
+		Name = "ball",
+		Collider = { Type = "Sphere", Radius = 18.251904 / 2 },
+		Movable = true,
+		NetworkPriority = 3,
+		Physics = { LinearDamping = 0.05, Mass = 100 },
+		Signature = 0,
+		Models = {
+			{ Path = "ball/ball.obj" }
+		}
+	},
+	{
+		Name = "spaceship",
+		Movable = true,
+		NetworkPriority = 5,
+		Models = {
+			{ Path = "spaceship/spaceship.obj", Rotation = { 0, 90, 0 }, Scale = 0.01 }
+		}
+	},
+	{
+		Name = "frigate",
+		Movable = true,
+		NetworkPriority = 5,
+		Models = {
+			{ Path = "space_frigate_6/space_frigate_6.obj", Rotation = { 0, 90, 0 }, Scale = 0.1 }
+		}
+	}
+}
@@ -0,0 +1,11 @@
+-- Spectator relay, connects to the server set in the regular client settings
+dofile("cconfig.lua")
+
+Relay = {
+	ArenaIndex    = 0,
+	Delay         = 0,    -- Milliseconds the arena is held back before spectators see it
+	MaxSpectators = 1000,
+	Port          = 2050, -- Each reactor listens on its own port, starting from this one
+	ReactorCount  = 4,
+	Secret        = ""    -- Must match the server Relay.Secret (see sconfig.lua)
+}
@@ -10,9 +10,23 @@ Database = {
 }
 
 Game = {
-	MaxClients  = 100,
-	Port        = 2050,
-	WorkerCount = 2
+	MaxClients         = 100,
+	PhysicsThreadCount = 0, -- Newton worker threads per arena, 0 steps physics on the main thread
+	Port               = 2050,
+	TickRate           = 60,
+	WorkerCount        = 2
+}
+
+Metrics = {
+	Port = 9100 -- Prometheus text format served on localhost:<Port>/metrics, 0 to disable
+}
+
+Relay = {
+	Secret = "" -- Shared with spectator relays (see rconfig.lua), empty to refuse them
+}
+
+Replay = {
+	Folder = "" -- Every arena is recorded to a <arena>_<timestamp>.ewnreplay file in this folder, empty to disable
 }
 
 DefaultSpaceship = {
@@ -32,3 +46,21 @@ Security = {
 	HashLength   = 32,
 	PasswordSalt = "<random and unique salt>",
 }
+
+-- Login protection, can be changed freely
+Security.Hashing = {
+	MaxQueueSize = 256, -- Password hashes waiting for a hashing thread, logins beyond that are refused with a retry delay
+	WorkerCount  = 2
+}
+
+-- Seconds an authenticated account and its connection token stay in memory, reconnections within that time don't wait for the database (0 to disable)
+Security.AccountCacheDuration = 3600
+
+-- Token buckets: Burst attempts at once, refilled by PerMinute every minute (a Burst of 0 disables the limit)
+-- Load tests connect from a single address, AddressBurst may need to be raised or disabled for them
+Security.LoginRateLimit = {
+	AccountBurst     = 5,
+	AccountPerMinute = 10,
+	AddressBurst     = 20,
+	AddressPerMinute = 60
+}
@@ -0,0 +1,33 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/CheckRunner.hpp>
+#include <iostream>
+
+namespace ewn
+{
+	CheckRunner::CheckRunner(std::string filter) :
+	m_filter(std::move(filter)),
+	m_checkCount(0),
+	m_failedCheckCount(0),
+	m_failedExpectationCount(0)
+	{
+	}
+
+	bool CheckRunner::Expect(bool condition, const std::string& description)
+	{
+		if (!condition)
+		{
+			std::cout << "  expected " << description << '\n';
+			m_failedExpectationCount++;
+		}
+
+		return condition;
+	}
+
+	void CheckRunner::PrintResult(const std::string& name, bool succeeded) const
+	{
+		std::cout << ((succeeded) ? "[ OK ] " : "[FAIL] ") << name << std::endl;
+	}
+}
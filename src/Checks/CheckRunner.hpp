@@ -0,0 +1,41 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_CHECKRUNNER_HPP
+#define EREWHON_CHECKS_CHECKRUNNER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string>
+
+namespace ewn
+{
+	// Runs named checks and reports which of their expectations failed
+	class CheckRunner
+	{
+		public:
+			CheckRunner(std::string filter);
+			~CheckRunner() = default;
+
+			bool Expect(bool condition, const std::string& description);
+
+			inline std::size_t GetCheckCount() const;
+			inline std::size_t GetFailedCheckCount() const;
+
+			template<typename F> void Run(const std::string& name, F&& func);
+
+		private:
+			void PrintResult(const std::string& name, bool succeeded) const;
+
+			std::string m_filter;
+			std::size_t m_checkCount;
+			std::size_t m_failedCheckCount;
+			std::size_t m_failedExpectationCount; //< of the running check
+	};
+}
+
+#include <Checks/CheckRunner.inl>
+
+#endif // EREWHON_CHECKS_CHECKRUNNER_HPP
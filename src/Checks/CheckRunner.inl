@@ -0,0 +1,36 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/CheckRunner.hpp>
+
+namespace ewn
+{
+	inline std::size_t CheckRunner::GetCheckCount() const
+	{
+		return m_checkCount;
+	}
+
+	inline std::size_t CheckRunner::GetFailedCheckCount() const
+	{
+		return m_failedCheckCount;
+	}
+
+	template<typename F>
+	void CheckRunner::Run(const std::string& name, F&& func)
+	{
+		if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+			return;
+
+		m_failedExpectationCount = 0;
+		func();
+
+		bool succeeded = (m_failedExpectationCount == 0);
+
+		m_checkCount++;
+		if (!succeeded)
+			m_failedCheckCount++;
+
+		PrintResult(name, succeeded);
+	}
+}
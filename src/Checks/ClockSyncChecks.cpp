@@ -0,0 +1,158 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/ClockSyncChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Client/ClockSync.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr Nz::UInt64 SimulationDuration = 120'000;
+		constexpr Nz::UInt64 SnapshotInterval = 33; //< BroadcastSystem sends ArenaState at 30Hz
+		constexpr Nz::UInt64 StartTime = 1000;
+		constexpr Nz::UInt64 WarmupDuration = 5000; //< Time given to the drift estimation before checking the error bound
+
+		// Same as ServerConnection
+		constexpr Nz::UInt64 SyncedTimeSyncInterval = 2000;
+		constexpr Nz::UInt64 UnsyncedTimeSyncInterval = 250;
+
+		constexpr double MaxError = 25.0; //< milliseconds, less than the jitter range, whatever the random seed
+		constexpr Nz::UInt64 MaxSyncDuration = 1000;
+
+		struct Delivery
+		{
+			Nz::UInt64 arrivalTime; //< client time
+			Nz::UInt64 serverTime;
+			Nz::UInt32 requestId; //< 0 for ArenaState
+
+			bool operator>(const Delivery& delivery) const
+			{
+				return arrivalTime > delivery.arrivalTime;
+			}
+		};
+	}
+
+	ClockSyncChecks::ClockSyncChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void ClockSyncChecks::Run()
+	{
+		// Real clocks drift by a few dozen ppm, these are a lot worse
+		m_runner.Run("ClockSync.FastServerClock", [&] { CheckSimulation(0.000'2, 3'600'000, 1); });
+		m_runner.Run("ClockSync.SlowServerClock", [&] { CheckSimulation(-0.000'3, 42, 2); });
+	}
+
+	void ClockSyncChecks::CheckSimulation(double drift, Nz::Int64 initialOffset, unsigned int seed)
+	{
+		std::mt19937 randomGenerator(seed);
+		std::bernoulli_distribution spikeDistribution(0.03);
+		std::uniform_real_distribution<double> jitterDistribution(0.0, 30.0);
+		std::uniform_real_distribution<double> spikeDelayDistribution(150.0, 600.0);
+
+		auto ServerTime = [&](Nz::UInt64 clientTime)
+		{
+			return static_cast<Nz::UInt64>(initialOffset + static_cast<Nz::Int64>(std::floor(clientTime * (1.0 + drift))));
+		};
+
+		// Jitter reorders packets sent close to each other, spikes (rare long delays) reorder them further apart
+		auto ArrivalTime = [&](Nz::UInt64 sendTime)
+		{
+			double delay = 40.0 + jitterDistribution(randomGenerator);
+			if (spikeDistribution(randomGenerator))
+				delay += spikeDelayDistribution(randomGenerator);
+
+			return sendTime + static_cast<Nz::UInt64>(std::ceil(delay));
+		};
+
+		ClockSync clockSync;
+		std::priority_queue<Delivery, std::vector<Delivery>, std::greater<Delivery>> deliveries;
+
+		Nz::UInt32 timeSyncRequestId = 0;
+		Nz::UInt64 timeSyncRequestTime = 0;
+		Nz::UInt64 nextSnapshotTime = StartTime;
+		Nz::UInt64 nextTimeSyncTime = StartTime;
+
+		Nz::UInt64 lastDeliveredServerTime = 0;
+		Nz::UInt64 lastEstimatedServerTime = 0;
+		Nz::UInt64 syncTime = 0;
+		double maxError = 0.0;
+		std::size_t backwardCount = 0;
+		std::size_t outOfOrderCount = 0;
+
+		for (Nz::UInt64 clientTime = StartTime; clientTime < StartTime + SimulationDuration; ++clientTime)
+		{
+			if (clientTime >= nextSnapshotTime)
+			{
+				deliveries.push({ ArrivalTime(clientTime), ServerTime(clientTime), 0 });
+				nextSnapshotTime += SnapshotInterval;
+			}
+
+			if (clientTime >= nextTimeSyncTime)
+			{
+				// The server answers with its time when receiving the request
+				Nz::UInt64 serverReceptionTime = ArrivalTime(clientTime);
+
+				timeSyncRequestId++;
+				timeSyncRequestTime = clientTime;
+				deliveries.push({ ArrivalTime(serverReceptionTime), ServerTime(serverReceptionTime), timeSyncRequestId });
+
+				nextTimeSyncTime = clientTime + ((clockSync.IsSynchronized()) ? SyncedTimeSyncInterval : UnsyncedTimeSyncInterval);
+			}
+
+			while (!deliveries.empty() && deliveries.top().arrivalTime <= clientTime)
+			{
+				const Delivery& delivery = deliveries.top();
+
+				if (delivery.serverTime < lastDeliveredServerTime)
+					outOfOrderCount++;
+
+				lastDeliveredServerTime = std::max(lastDeliveredServerTime, delivery.serverTime);
+
+				// Same as ServerConnection::HandleTimeSyncResponse, only the latest request can be timed
+				clockSync.AddServerTime(delivery.serverTime, clientTime);
+				if (delivery.requestId != 0 && delivery.requestId == timeSyncRequestId && timeSyncRequestTime != 0)
+				{
+					clockSync.AddRoundTrip(static_cast<double>(clientTime - timeSyncRequestTime));
+					timeSyncRequestTime = 0;
+				}
+
+				deliveries.pop();
+			}
+
+			// Updating every millisecond (instead of every frame) leaves no room for the estimated time to go back unnoticed
+			clockSync.Update(clientTime);
+			if (!clockSync.IsSynchronized())
+				continue;
+
+			if (syncTime == 0)
+				syncTime = clientTime;
+
+			// Same as ServerConnection::EstimateServerTime
+			Nz::UInt64 estimatedServerTime = static_cast<Nz::UInt64>(static_cast<Nz::Int64>(clientTime) + clockSync.GetOffset());
+			if (estimatedServerTime < lastEstimatedServerTime)
+				backwardCount++;
+
+			lastEstimatedServerTime = estimatedServerTime;
+
+			if (clientTime >= syncTime + WarmupDuration)
+				maxError = std::max(maxError, std::abs(static_cast<double>(static_cast<Nz::Int64>(estimatedServerTime - ServerTime(clientTime)))));
+		}
+
+		m_runner.Expect(outOfOrderCount > 0, "the simulated network to reorder packets");
+		m_runner.Expect(syncTime != 0 && syncTime - StartTime <= MaxSyncDuration, "to be synchronized within " + std::to_string(MaxSyncDuration) + "ms");
+		m_runner.Expect(backwardCount == 0, "estimated server time to never go backwards (went back " + std::to_string(backwardCount) + " times)");
+		m_runner.Expect(maxError <= MaxError, "estimated server time error to stay within " + std::to_string(MaxError) + "ms (was " + std::to_string(maxError) + "ms)");
+	}
+}
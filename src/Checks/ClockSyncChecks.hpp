@@ -0,0 +1,35 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_CLOCKSYNCCHECKS_HPP
+#define EREWHON_CHECKS_CLOCKSYNCCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace ewn
+{
+	class CheckRunner;
+
+	// Feeds ClockSync with what a ServerConnection would see from a simulated server, whose clock drifts from the client one,
+	// over a network with jitter, delay spikes and packets arriving out of order
+	class ClockSyncChecks
+	{
+		public:
+			ClockSyncChecks(CheckRunner& runner);
+			~ClockSyncChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckSimulation(double drift, Nz::Int64 initialOffset, unsigned int seed);
+
+			CheckRunner& m_runner;
+	};
+}
+
+#include <Checks/ClockSyncChecks.inl>
+
+#endif // EREWHON_CHECKS_CLOCKSYNCCHECKS_HPP
@@ -0,0 +1,252 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/MovementInputChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
+#include <Shared/Protocol/PacketSizer.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr std::size_t InputCount = 200;
+
+		// Applies decoded inputs like ClientSession::HandlePlayerMovement and Player::UpdateInput do
+		struct InputReceiver
+		{
+			void Receive(const Packets::PlayerMovement& packet)
+			{
+				MovementInputHistory::DecodedInputs inputs;
+				std::size_t inputCount = MovementInputHistory::DecodePacket(packet, &inputs);
+
+				for (std::size_t i = 0; i < inputCount; ++i)
+				{
+					if (inputs[i].inputTime <= lastInputTime)
+					{
+						duplicateCount++;
+						continue;
+					}
+
+					lastInputTime = inputs[i].inputTime;
+					appliedInputs.push_back(inputs[i]);
+				}
+			}
+
+			std::vector<MovementInputHistory::Input> appliedInputs;
+			std::size_t duplicateCount = 0;
+			Nz::UInt64 lastInputTime = 0;
+		};
+
+		// One input per client frame, with short pauses and a long one, longer than the maximum redundant input age
+		Nz::UInt64 MakeInputTime(std::size_t i)
+		{
+			Nz::UInt64 inputTime = 10'000 + i * 16 + (i / 50) * 300;
+			if (i >= 120)
+				inputTime += 1200;
+
+			return inputTime;
+		}
+
+		Nz::Vector3f MakeDirection(std::size_t i)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Vector3f(std::sin(value * 0.1f), std::cos(value * 0.3f), std::sin(value * 0.05f) * 1.5f);
+		}
+
+		Nz::Vector3f MakeRotation(std::size_t i)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Vector3f(std::cos(value * 0.07f), std::sin(value * 0.2f) * 0.1f, std::cos(value * 0.5f));
+		}
+	}
+
+	MovementInputChecks::MovementInputChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void MovementInputChecks::Run()
+	{
+		m_runner.Run("MovementInput.Duplicates", [&] { CheckDuplicates(); });
+		m_runner.Run("MovementInput.MaxAge", [&] { CheckMaxAge(); });
+		m_runner.Run("MovementInput.PacketLoss", [&] { CheckPacketLoss(); });
+		m_runner.Run("MovementInput.Quantization", [&] { CheckQuantization(); });
+	}
+
+	void MovementInputChecks::CheckDuplicates()
+	{
+		MovementInputHistory inputHistory;
+		InputReceiver receiver;
+
+		std::vector<MovementInputHistory::Input> sentInputs;
+		for (std::size_t i = 0; i < 20; ++i)
+		{
+			Packets::PlayerMovement packet;
+			sentInputs.push_back(inputHistory.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i), &packet));
+
+			Packets::PlayerMovement receivedPacket;
+			if (!Transmit(packet, &receivedPacket))
+				return;
+
+			// Every packet arrives twice, on top of the previous inputs it carries again
+			receiver.Receive(receivedPacket);
+			receiver.Receive(receivedPacket);
+		}
+
+		bool isEveryInputAppliedOnce = (receiver.appliedInputs.size() == sentInputs.size());
+		for (std::size_t i = 0; isEveryInputAppliedOnce && i < sentInputs.size(); ++i)
+			isEveryInputAppliedOnce = IsSameInput(receiver.appliedInputs[i], sentInputs[i]);
+
+		m_runner.Expect(isEveryInputAppliedOnce, "every input to be applied exactly once");
+		m_runner.Expect(receiver.duplicateCount > sentInputs.size(), "duplicate inputs to be received (and ignored)");
+
+		// The client clock went back after a resynchronization: the history restarts and the server ignores the input
+		Packets::PlayerMovement packet;
+		inputHistory.PushInput(MakeInputTime(10), MakeDirection(10), MakeRotation(10), &packet);
+		m_runner.Expect(packet.previousInputs.empty(), "the history to be cleared when the input time goes back");
+
+		std::size_t appliedInputCount = receiver.appliedInputs.size();
+		receiver.Receive(packet);
+		m_runner.Expect(receiver.appliedInputs.size() == appliedInputCount, "an input older than the last applied one to be ignored");
+	}
+
+	void MovementInputChecks::CheckMaxAge()
+	{
+		MovementInputHistory inputHistory;
+
+		// Input time, then how many previous inputs are still young enough to be sent again (at most one second old)
+		const std::pair<Nz::UInt64, std::size_t> steps[] = {
+			{ 1000, 0 },
+			{ 1400, 1 },
+			{ 1800, 2 },
+			{ 2000, 3 }, //< 1000 is exactly one second old
+			{ 2300, 3 }, //< 1000 isn't anymore
+			{ 4000, 0 }
+		};
+
+		for (const auto& [inputTime, previousInputCount] : steps)
+		{
+			Packets::PlayerMovement packet;
+			inputHistory.PushInput(inputTime, Nz::Vector3f::UnitX(), Nz::Vector3f::Zero(), &packet);
+
+			m_runner.Expect(packet.previousInputs.size() == previousInputCount, "input at " + std::to_string(inputTime) + " to carry " + std::to_string(previousInputCount) + " previous inputs (got " + std::to_string(packet.previousInputs.size()) + ")");
+
+			Packets::PlayerMovement receivedPacket;
+			if (!Transmit(packet, &receivedPacket))
+				return;
+
+			MovementInputHistory::DecodedInputs inputs;
+			std::size_t inputCount = MovementInputHistory::DecodePacket(receivedPacket, &inputs);
+
+			m_runner.Expect(inputCount == previousInputCount + 1 && inputs[inputCount - 1].inputTime == inputTime, "input at " + std::to_string(inputTime) + " to decode to the most recent input and the previous ones");
+		}
+	}
+
+	void MovementInputChecks::CheckPacketLoss()
+	{
+		// Lone losses, bursts up to the redundancy, a burst too long to recover from,
+		// and a loss right before the long pause (the input is too old to be sent again)
+		const std::set<std::size_t> droppedPackets = { 5, 17, 30, 31, 32, 60, 61, 62, 63, 90, 91, 92, 93, 94, 95, 119 };
+
+		MovementInputHistory inputHistory;
+		InputReceiver receiver;
+
+		std::vector<MovementInputHistory::Input> sentInputs;
+		for (std::size_t i = 0; i < InputCount; ++i)
+		{
+			Packets::PlayerMovement packet;
+			sentInputs.push_back(inputHistory.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i), &packet));
+
+			Packets::PlayerMovement receivedPacket;
+			if (!Transmit(packet, &receivedPacket))
+				return;
+
+			if (droppedPackets.find(i) == droppedPackets.end())
+				receiver.Receive(receivedPacket);
+		}
+
+		// An input arrives if a packet got through either with it or with one of the next inputs, as long as it was young enough
+		std::vector<MovementInputHistory::Input> expectedInputs;
+		for (std::size_t i = 0; i < InputCount; ++i)
+		{
+			for (std::size_t j = i; j < InputCount && j <= i + MovementInputHistory::MaxRedundantInputs; ++j)
+			{
+				if (MakeInputTime(j) - MakeInputTime(i) > 1000)
+					break;
+
+				if (droppedPackets.find(j) == droppedPackets.end())
+				{
+					expectedInputs.push_back(sentInputs[i]);
+					break;
+				}
+			}
+		}
+
+		m_runner.Expect(expectedInputs.size() < InputCount, "some inputs to be lost for good");
+
+		bool isEveryInputRecovered = (receiver.appliedInputs.size() == expectedInputs.size());
+		for (std::size_t i = 0; isEveryInputRecovered && i < expectedInputs.size(); ++i)
+			isEveryInputRecovered = IsSameInput(receiver.appliedInputs[i], expectedInputs[i]);
+
+		m_runner.Expect(isEveryInputRecovered, "every recoverable input to be applied once, in order, with the values the client used (" + std::to_string(receiver.appliedInputs.size()) + " applied, " + std::to_string(expectedInputs.size()) + " expected)");
+	}
+
+	void MovementInputChecks::CheckQuantization()
+	{
+		constexpr float Step = 1.f / MovementInputHistory::QuantizedZero;
+
+		bool isStepExact = true;
+		for (int i = -MovementInputHistory::QuantizedZero; i <= MovementInputHistory::QuantizedZero; ++i)
+		{
+			float value = i * Step;
+			Nz::UInt8 quantizedValue = MovementInputHistory::Quantize(value);
+
+			if (quantizedValue != i + MovementInputHistory::QuantizedZero || MovementInputHistory::Dequantize(quantizedValue) != i / float(MovementInputHistory::QuantizedZero))
+				isStepExact = false;
+		}
+
+		m_runner.Expect(isStepExact, "multiples of 1/127 to survive quantization");
+
+		float maxError = 0.f;
+		for (int i = -1000; i <= 1000; ++i)
+		{
+			float value = i / 1000.f;
+			maxError = std::max(maxError, std::abs(MovementInputHistory::Dequantize(MovementInputHistory::Quantize(value)) - value));
+		}
+
+		m_runner.Expect(maxError <= Step / 2.f + std::numeric_limits<float>::epsilon(), "quantization error to be at most half a step (was " + std::to_string(maxError) + ")");
+
+		m_runner.Expect(MovementInputHistory::Quantize(2.f) == MovementInputHistory::QuantizedMax && MovementInputHistory::Quantize(-2.f) == 0, "out of range values to be clamped");
+		m_runner.Expect(MovementInputHistory::Quantize(std::numeric_limits<float>::quiet_NaN()) == MovementInputHistory::QuantizedZero, "NaN to be quantized to zero");
+		m_runner.Expect(MovementInputHistory::Quantize(std::numeric_limits<float>::infinity()) == MovementInputHistory::QuantizedZero, "infinity to be quantized to zero");
+		m_runner.Expect(MovementInputHistory::Dequantize(255) == 1.f, "the unused 255 value to be clamped");
+	}
+
+	bool MovementInputChecks::Transmit(const Packets::PlayerMovement& packet, Packets::PlayerMovement* receivedPacket)
+	{
+		std::vector<Nz::UInt8> data(Packets::ComputeSize(packet));
+
+		PacketWriter writer(data.data(), data.size());
+		Packets::Serialize(writer, packet);
+
+		PacketReader reader(data.data(), data.size());
+		return m_runner.Expect(Packets::Unserialize(reader, *receivedPacket) && reader.GetRemainingSize() == 0, "PlayerMovement to survive serialization");
+	}
+
+	bool MovementInputChecks::IsSameInput(const MovementInputHistory::Input& first, const MovementInputHistory::Input& second)
+	{
+		// Exact comparison, the client predicts with these values and must apply exactly what the server does
+		return first.inputTime == second.inputTime &&
+		       first.direction.x == second.direction.x && first.direction.y == second.direction.y && first.direction.z == second.direction.z &&
+		       first.rotation.x == second.rotation.x && first.rotation.y == second.rotation.y && first.rotation.z == second.rotation.z;
+	}
+}
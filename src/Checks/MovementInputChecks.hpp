@@ -0,0 +1,42 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_MOVEMENTINPUTCHECKS_HPP
+#define EREWHON_CHECKS_MOVEMENTINPUTCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Shared/MovementInputHistory.hpp>
+
+namespace ewn
+{
+	class CheckRunner;
+
+	// Sends inputs through MovementInputHistory and the PlayerMovement wire format, and applies them as the server does
+	class MovementInputChecks
+	{
+		public:
+			MovementInputChecks(CheckRunner& runner);
+			~MovementInputChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckDuplicates();
+			void CheckMaxAge();
+			void CheckPacketLoss();
+			void CheckQuantization();
+
+			bool Transmit(const Packets::PlayerMovement& packet, Packets::PlayerMovement* receivedPacket);
+
+			static bool IsSameInput(const MovementInputHistory::Input& first, const MovementInputHistory::Input& second);
+
+			CheckRunner& m_runner;
+	};
+}
+
+#include <Checks/MovementInputChecks.inl>
+
+#endif // EREWHON_CHECKS_MOVEMENTINPUTCHECKS_HPP
@@ -0,0 +1,149 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/PredictionChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Client/SpaceshipPrediction.hpp>
+#include <cmath>
+#include <cstring>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr std::size_t InputCount = 100;
+		constexpr Nz::UInt64 InputInterval = 16; //< milliseconds, one input per client frame
+
+		// Inputs are generated from their index so every run feeds the exact same sequence
+		Nz::Vector3f MakeDirection(std::size_t i)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Vector3f(1.f, std::sin(value * 0.1f), std::cos(value * 0.05f) * 0.5f);
+		}
+
+		Nz::Vector3f MakeRotation(std::size_t i)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Vector3f(std::sin(value * 0.07f), std::cos(value * 0.13f), std::sin(value * 0.03f) * 0.2f);
+		}
+
+		Nz::UInt64 MakeInputTime(std::size_t i)
+		{
+			return 10'000 + i * InputInterval;
+		}
+
+		SpaceshipMovement::Parameters MakeParameters()
+		{
+			SpaceshipMovement::Parameters parameters;
+			parameters.inertia = SpaceshipMovement::ComputeBoxInertia(parameters.mass, Nz::Vector3f(4.f, 2.f, 8.f));
+
+			return parameters;
+		}
+	}
+
+	PredictionChecks::PredictionChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void PredictionChecks::Run()
+	{
+		m_runner.Run("Prediction.Determinism", [&] { CheckDeterminism(); });
+		m_runner.Run("Prediction.Reconciliation", [&] { CheckReconciliation(); });
+	}
+
+	void PredictionChecks::CheckDeterminism()
+	{
+		SpaceshipMovement::Parameters parameters = MakeParameters();
+
+		auto Simulate = [&]()
+		{
+			SpaceshipMovement::State state;
+			for (std::size_t i = 0; i < InputCount; ++i)
+			{
+				SpaceshipMovement::ApplyInput(state, parameters, InputInterval / 1000.f, SpaceshipMovement::ScaleDirection(MakeDirection(i)), SpaceshipMovement::ScaleRotation(MakeRotation(i)));
+				SpaceshipMovement::Integrate(state, parameters, InputInterval / 1000.f);
+			}
+
+			return state;
+		};
+
+		SpaceshipMovement::State firstState = Simulate();
+		SpaceshipMovement::State secondState = Simulate();
+
+		m_runner.Expect(firstState.position.GetSquaredLength() > 1.f, "inputs to move the spaceship");
+		m_runner.Expect(IsBitIdentical(firstState, secondState), "SpaceshipMovement to be bit-identical across runs");
+
+		SpaceshipPrediction firstPrediction(parameters, SpaceshipMovement::State());
+		SpaceshipPrediction secondPrediction(parameters, SpaceshipMovement::State());
+		for (std::size_t i = 0; i < InputCount; ++i)
+		{
+			firstPrediction.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i));
+			secondPrediction.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i));
+		}
+
+		m_runner.Expect(IsBitIdentical(firstPrediction.GetState(), secondPrediction.GetState()), "SpaceshipPrediction to be bit-identical across runs");
+	}
+
+	void PredictionChecks::CheckReconciliation()
+	{
+		constexpr std::size_t AcknowledgedInput = 40;
+
+		SpaceshipMovement::Parameters parameters = MakeParameters();
+
+		// The server is stood in by a prediction only fed what it received, it doesn't have to run the physics engine
+		// as long as it mispredicts in a known way
+		SpaceshipPrediction client(parameters, SpaceshipMovement::State());
+		SpaceshipPrediction server(parameters, SpaceshipMovement::State());
+		for (std::size_t i = 0; i < InputCount; ++i)
+		{
+			client.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i));
+			if (i <= AcknowledgedInput)
+				server.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i));
+		}
+
+		m_runner.Expect(client.GetPendingInputCount() == InputCount, "every input to be pending before any server state");
+
+		// Something the client couldn't know about (a collision) moved and slowed the spaceship on the server
+		SpaceshipMovement::State correctedState = server.GetState();
+		correctedState.position += Nz::Vector3f(25.f, 0.f, -10.f);
+		correctedState.linearVelocity *= 0.5f;
+
+		SpaceshipMovement::State mispredictedState = client.GetState();
+
+		Nz::UInt64 acknowledgedTime = MakeInputTime(AcknowledgedInput);
+		Nz::UInt64 stateTime = acknowledgedTime + InputInterval / 2;
+		client.Reconcile(stateTime, acknowledgedTime, correctedState);
+
+		m_runner.Expect(client.GetPendingInputCount() == InputCount - AcknowledgedInput - 1, "acknowledged inputs to be dropped");
+		m_runner.Expect(!IsBitIdentical(client.GetState(), mispredictedState), "the correction to move the prediction");
+
+		// The server carries on from the corrected state with the inputs it receives next
+		server.Reconcile(stateTime, acknowledgedTime, correctedState);
+		for (std::size_t i = AcknowledgedInput + 1; i < InputCount; ++i)
+			server.PushInput(MakeInputTime(i), MakeDirection(i), MakeRotation(i));
+
+		m_runner.Expect(IsBitIdentical(client.GetState(), server.GetState()), "replayed inputs to converge to the server state");
+
+		// Stale states (arriving out of order) must not rewind the prediction
+		client.Reconcile(stateTime - InputInterval, MakeInputTime(AcknowledgedInput - 10), mispredictedState);
+		m_runner.Expect(IsBitIdentical(client.GetState(), server.GetState()), "older server states to be ignored");
+
+		// Once the server acknowledged everything the prediction is the server state and nothing is left to replay
+		Nz::UInt64 lastInputTime = MakeInputTime(InputCount - 1);
+		client.Reconcile(lastInputTime, lastInputTime, server.GetState());
+
+		m_runner.Expect(client.GetPendingInputCount() == 0, "no input to be pending once all were acknowledged");
+		m_runner.Expect(IsBitIdentical(client.GetState(), server.GetState()), "the prediction to match the last server state");
+	}
+
+	// Compares representations instead of values, determinism means not even a sign of zero may differ
+	bool PredictionChecks::IsBitIdentical(const SpaceshipMovement::State& first, const SpaceshipMovement::State& second)
+	{
+		return std::memcmp(&first.angularVelocity, &second.angularVelocity, sizeof(Nz::Vector3f)) == 0 &&
+		       std::memcmp(&first.linearVelocity, &second.linearVelocity, sizeof(Nz::Vector3f)) == 0 &&
+		       std::memcmp(&first.position, &second.position, sizeof(Nz::Vector3f)) == 0 &&
+		       std::memcmp(&first.rotation, &second.rotation, sizeof(Nz::Quaternionf)) == 0;
+	}
+}
@@ -0,0 +1,39 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_PREDICTIONCHECKS_HPP
+#define EREWHON_CHECKS_PREDICTIONCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Shared/SpaceshipMovement.hpp>
+
+namespace ewn
+{
+	class CheckRunner;
+
+	// Client-side prediction must compute exactly what a replay of the same inputs computes,
+	// otherwise every reconciliation would move the spaceship even without any misprediction
+	class PredictionChecks
+	{
+		public:
+			PredictionChecks(CheckRunner& runner);
+			~PredictionChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckDeterminism();
+			void CheckReconciliation();
+
+			static bool IsBitIdentical(const SpaceshipMovement::State& first, const SpaceshipMovement::State& second);
+
+			CheckRunner& m_runner;
+	};
+}
+
+#include <Checks/PredictionChecks.inl>
+
+#endif // EREWHON_CHECKS_PREDICTIONCHECKS_HPP
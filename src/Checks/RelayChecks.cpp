@@ -0,0 +1,283 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/RelayChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Relay/ArenaMirror.hpp>
+#include <Relay/DelayQueue.hpp>
+#include <map>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr std::size_t EntityCount = 60; //< Enough for the snapshot to be split in several chunks
+		constexpr Nz::UInt64 RelayDelay = 500; //< milliseconds
+
+		// Stands for a SpectatorSession joining the relay
+		struct SnapshotRecorder
+		{
+			template<typename T>
+			void SendCachedPacket(const CachedPacket<T>& /*packet*/)
+			{
+				cachedPacketCount++;
+			}
+
+			void SendPacket(const Packets::CreateEntities& packet)
+			{
+				createEntities.push_back(packet);
+			}
+
+			void SendPacket(const Packets::CreateProjectiles& packet)
+			{
+				createProjectiles.push_back(packet);
+			}
+
+			std::vector<Packets::CreateEntities> createEntities;
+			std::vector<Packets::CreateProjectiles> createProjectiles;
+			std::size_t cachedPacketCount = 0;
+		};
+
+		Packets::CreateEntities::Entity MakeEntity(Nz::UInt32 entityId, const Nz::Vector3f& position)
+		{
+			Packets::CreateEntities::Entity entity;
+			entity.entityId = entityId;
+			entity.prefabId = entityId % 3;
+			entity.rotation = Nz::Quaternionf::Identity();
+			entity.angularVelocity = Nz::Vector3f::Zero();
+			entity.linearVelocity = Nz::Vector3f::Zero();
+			entity.position = position;
+			entity.visualName = "entity" + std::to_string(entityId);
+
+			return entity;
+		}
+
+		Packets::CreateProjectiles::Projectile MakeProjectile(Nz::UInt32 projectileId, Nz::UInt64 spawnTime, float lifeTime)
+		{
+			Packets::CreateProjectiles::Projectile projectile;
+			projectile.projectileId = projectileId;
+			projectile.prefabId = 0;
+			projectile.spawnTime = spawnTime;
+			projectile.direction = Nz::Vector3f::Forward();
+			projectile.origin = Nz::Vector3f::Zero();
+			projectile.lifeTime = lifeTime;
+			projectile.speed = 100.f;
+
+			return projectile;
+		}
+
+		// Entities sent to a spectator joining now, counting entities sent more than once
+		std::map<Nz::UInt32, Nz::Vector3f> TakeSnapshot(const ArenaMirror& mirror, std::size_t* duplicateCount = nullptr, SnapshotRecorder* recorder = nullptr)
+		{
+			SnapshotRecorder localRecorder;
+			if (!recorder)
+				recorder = &localRecorder;
+
+			mirror.SendSnapshot(*recorder);
+
+			std::map<Nz::UInt32, Nz::Vector3f> entities;
+			for (const Packets::CreateEntities& createEntities : recorder->createEntities)
+			{
+				for (const auto& entity : createEntities.entities)
+				{
+					if (!entities.emplace(entity.entityId, entity.position).second && duplicateCount)
+						(*duplicateCount)++;
+				}
+			}
+
+			return entities;
+		}
+	}
+
+	RelayChecks::RelayChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void RelayChecks::Run()
+	{
+		m_runner.Run("Relay.Delay", [&] { CheckDelay(); });
+		m_runner.Run("Relay.MirrorSnapshot", [&] { CheckMirrorSnapshot(); });
+	}
+
+	// Packets go through the delay queue like RelayServer::OnRelayedPacket and RelayServer::ReleasePackets do, releasing every millisecond
+	void RelayChecks::CheckDelay()
+	{
+		using RelayedPacket = std::variant<Packets::ArenaState, Packets::CreateEntities, Packets::DeleteEntities>;
+
+		struct PushedPacket
+		{
+			Nz::UInt64 pushTime;
+			RelayedPacket packet;
+		};
+
+		std::vector<PushedPacket> pushedPackets;
+		{
+			Packets::CreateEntities createFirst;
+			createFirst.entities.push_back(MakeEntity(1, Nz::Vector3f::Zero()));
+			pushedPackets.push_back({ 100, createFirst });
+
+			Packets::ArenaState statePacket;
+			statePacket.stateId = 0;
+			statePacket.serverTime = 150;
+			statePacket.lastProcessedInputTime = 0;
+			auto& entityState = statePacket.entities.emplace_back();
+			entityState.id = 1;
+			entityState.angularVelocity = Nz::Vector3f::Zero();
+			entityState.linearVelocity = Nz::Vector3f::Zero();
+			entityState.position = Nz::Vector3f(5.f, 0.f, 0.f);
+			entityState.rotation = Nz::Quaternionf::Identity();
+			pushedPackets.push_back({ 150, statePacket });
+
+			Packets::DeleteEntities deleteFirst;
+			deleteFirst.entities.emplace_back(1);
+			pushedPackets.push_back({ 300, deleteFirst });
+
+			Packets::CreateEntities createSecond;
+			createSecond.entities.push_back(MakeEntity(2, Nz::Vector3f::Zero()));
+			pushedPackets.push_back({ 300, createSecond }); //< same time, must be released in order
+		}
+
+		ArenaMirror mirror;
+		DelayQueue<RelayedPacket> delayQueue(RelayDelay);
+
+		std::vector<Nz::UInt64> releaseTimes;
+		std::size_t nextPacketIndex = 0;
+		std::map<Nz::UInt64, std::map<Nz::UInt32, Nz::Vector3f>> snapshots; //< what a spectator joining at that time receives
+		bool isOrderValid = true;
+
+		for (Nz::UInt64 now = 0; now <= 1000; ++now)
+		{
+			while (nextPacketIndex < pushedPackets.size() && pushedPackets[nextPacketIndex].pushTime == now)
+				delayQueue.Push(now, pushedPackets[nextPacketIndex++].packet);
+
+			delayQueue.Release(now, [&](const RelayedPacket& packet)
+			{
+				if (packet.index() != pushedPackets[releaseTimes.size()].packet.index())
+					isOrderValid = false;
+
+				releaseTimes.push_back(now);
+				std::visit([&](const auto& relayedPacket) { mirror.Apply(relayedPacket); }, packet);
+			});
+
+			if (now == 599 || now == 600 || now == 650 || now == 799 || now == 800)
+				snapshots[now] = TakeSnapshot(mirror);
+		}
+
+		if (!m_runner.Expect(releaseTimes.size() == pushedPackets.size(), "every packet to be released (" + std::to_string(releaseTimes.size()) + "/" + std::to_string(pushedPackets.size()) + ")"))
+			return;
+
+		for (std::size_t i = 0; i < pushedPackets.size(); ++i)
+			m_runner.Expect(releaseTimes[i] == pushedPackets[i].pushTime + RelayDelay, "packet #" + std::to_string(i) + " to be released " + std::to_string(RelayDelay) + "ms after it was received (after " + std::to_string(releaseTimes[i] - pushedPackets[i].pushTime) + "ms)");
+
+		m_runner.Expect(isOrderValid, "packets to be released in the order they were received");
+		m_runner.Expect(delayQueue.GetSize() == 0, "the delay queue to be empty");
+
+		m_runner.Expect(snapshots[599].empty(), "spectators not to see an entity before the delay passed");
+		m_runner.Expect(snapshots[600].size() == 1 && snapshots[600].count(1) == 1 && snapshots[600][1] == Nz::Vector3f::Zero(), "spectators to see the entity once the delay passed");
+		m_runner.Expect(snapshots[650].count(1) == 1 && snapshots[650][1] == Nz::Vector3f(5.f, 0.f, 0.f), "spectators to see the delayed entity state");
+		m_runner.Expect(snapshots[799].count(1) == 1 && snapshots[799].count(2) == 0, "the deleted entity to stay until its deletion is released");
+		m_runner.Expect(snapshots[800].count(1) == 0 && snapshots[800].count(2) == 1, "the deletion and the next creation to be released together");
+	}
+
+	void RelayChecks::CheckMirrorSnapshot()
+	{
+		ArenaMirror mirror;
+		std::map<Nz::UInt32, Nz::Vector3f> expectedEntities;
+
+		Packets::CreateEntities createEntities;
+		for (Nz::UInt32 entityId = 1; entityId <= EntityCount; ++entityId)
+		{
+			Nz::Vector3f position(float(entityId), 0.f, 0.f);
+
+			createEntities.entities.push_back(MakeEntity(entityId, position));
+			expectedEntities[entityId] = position;
+		}
+		mirror.Apply(createEntities);
+
+		Packets::DeleteEntities deleteEntities;
+		for (Nz::UInt32 entityId = 4; entityId <= EntityCount; entityId += 4)
+		{
+			deleteEntities.entities.emplace_back(entityId);
+			expectedEntities.erase(entityId);
+		}
+		mirror.Apply(deleteEntities);
+
+		// An entity id can be reused once its entity was deleted
+		Packets::CreateEntities recreateEntity;
+		recreateEntity.entities.push_back(MakeEntity(8, Nz::Vector3f(800.f, 0.f, 0.f)));
+		expectedEntities[8] = Nz::Vector3f(800.f, 0.f, 0.f);
+		mirror.Apply(recreateEntity);
+
+		Packets::CreateProjectiles createProjectiles;
+		createProjectiles.projectiles.push_back(MakeProjectile(1, 500, 0.4f)); //< expires at 900
+		createProjectiles.projectiles.push_back(MakeProjectile(2, 900, 1.f));
+		mirror.Apply(createProjectiles);
+
+		m_runner.Expect(!mirror.HasState(), "the mirror not to have a state before receiving one");
+
+		// States move odd entities and also mention a deleted and an unknown entity, which must not be created by it
+		Packets::ArenaState statePacket;
+		statePacket.stateId = 1;
+		statePacket.serverTime = 1000;
+		statePacket.lastProcessedInputTime = 0;
+		for (Nz::UInt32 entityId : { 1u, 3u, 4u, 5u, 9u, 1000u })
+		{
+			auto& entityState = statePacket.entities.emplace_back();
+			entityState.id = entityId;
+			entityState.angularVelocity = Nz::Vector3f::Zero();
+			entityState.linearVelocity = Nz::Vector3f::Up();
+			entityState.position = Nz::Vector3f(float(entityId), 1.f, 0.f);
+			entityState.rotation = Nz::Quaternionf::Identity();
+
+			auto it = expectedEntities.find(entityId);
+			if (it != expectedEntities.end())
+				it->second = Nz::Vector3f(float(entityId), 1.f, 0.f);
+		}
+		mirror.Apply(statePacket);
+
+		m_runner.Expect(!mirror.HasState(), "the mirror not to have a state without the network strings");
+
+		Packets::NetworkStrings networkStrings;
+		networkStrings.startId = 0;
+		networkStrings.strings = { "entity" };
+		mirror.Apply(networkStrings);
+
+		m_runner.Expect(mirror.HasState(), "the mirror to have a state after a state and the network strings");
+
+		SnapshotRecorder recorder;
+		std::size_t duplicateCount = 0;
+		std::map<Nz::UInt32, Nz::Vector3f> snapshotEntities = TakeSnapshot(mirror, &duplicateCount, &recorder);
+
+		m_runner.Expect(duplicateCount == 0, "every entity to be sent once (" + std::to_string(duplicateCount) + " duplicates)");
+		m_runner.Expect(snapshotEntities.size() == expectedEntities.size(), "the snapshot to hold " + std::to_string(expectedEntities.size()) + " entities (got " + std::to_string(snapshotEntities.size()) + ")");
+
+		std::size_t mismatchCount = 0;
+		for (const auto& [entityId, position] : expectedEntities)
+		{
+			auto it = snapshotEntities.find(entityId);
+			if (it == snapshotEntities.end() || it->second != position)
+				mismatchCount++;
+		}
+		m_runner.Expect(mismatchCount == 0, "every entity to be at its last state position (" + std::to_string(mismatchCount) + " mismatches)");
+
+		bool areChunksValid = true;
+		for (const Packets::CreateEntities& chunk : recorder.createEntities)
+		{
+			if (chunk.entities.size() > 1 && Packets::ComputeSize(chunk) > ArenaMirror::JoinChunkSize)
+				areChunksValid = false;
+		}
+		m_runner.Expect(recorder.createEntities.size() > 1, "the snapshot to be split in several chunks (" + std::to_string(recorder.createEntities.size()) + " chunks)");
+		m_runner.Expect(areChunksValid, "every chunk to fit in " + std::to_string(ArenaMirror::JoinChunkSize) + " bytes");
+
+		bool areProjectilesValid = (recorder.createProjectiles.size() == 1 && recorder.createProjectiles.front().projectiles.size() == 1 && recorder.createProjectiles.front().projectiles.front().projectileId == 2u);
+		m_runner.Expect(areProjectilesValid, "expired projectiles to be left out of the snapshot");
+
+		mirror.Clear();
+		m_runner.Expect(!mirror.HasState() && TakeSnapshot(mirror).empty(), "a cleared mirror to be empty");
+	}
+}
@@ -0,0 +1,35 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_RELAYCHECKS_HPP
+#define EREWHON_CHECKS_RELAYCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace ewn
+{
+	class CheckRunner;
+
+	// Feeds the relay arena mirror with entity creations, deletions and states, through the delay queue the relay holds them back with
+	class RelayChecks
+	{
+		public:
+			RelayChecks(CheckRunner& runner);
+			~RelayChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckDelay();
+			void CheckMirrorSnapshot();
+
+			CheckRunner& m_runner;
+	};
+}
+
+#include <Checks/RelayChecks.inl>
+
+#endif // EREWHON_CHECKS_RELAYCHECKS_HPP
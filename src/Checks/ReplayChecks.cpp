@@ -0,0 +1,260 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/ReplayChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Server/ReplayRecorder.hpp>
+#include <Shared/ReplayFormat.hpp>
+#include <Shared/ReplayReader.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr Nz::UInt64 RecordDuration = 3 * ReplayRecorder::KeyframeInterval + 5000; //< Four chunks, the last one shorter
+		constexpr Nz::UInt64 StartTime = 100'000;
+		constexpr Nz::UInt64 TickInterval = 50;
+
+		const std::string ArenaName = "Checks";
+		const std::string ReplayPath = "ErewhonChecks.replay";
+		const std::string TruncatedReplayPath = "ErewhonChecks_truncated.replay";
+	}
+
+	ReplayChecks::ReplayChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void ReplayChecks::Run()
+	{
+		m_runner.Run("Replay.RoundTrip", [&] { CheckRoundTrip(); });
+		m_runner.Run("Replay.Seek", [&] { CheckSeek(); });
+		m_runner.Run("Replay.TruncatedChunk", [&] { CheckTruncatedChunk(); });
+
+		std::remove(ReplayPath.c_str());
+		std::remove(TruncatedReplayPath.c_str());
+	}
+
+	void ReplayChecks::CheckRoundTrip()
+	{
+		if (!RecordReplay(ReplayPath))
+			return;
+
+		ReplayReader reader;
+		if (!OpenReplay(reader, ReplayPath))
+			return;
+
+		m_runner.Expect(reader.GetArenaName() == ArenaName && reader.GetStartTime() == StartTime, "the file header to be read back");
+
+		if (!m_runner.Expect(reader.GetChunkCount() == m_keyframeTimes.size(), "one chunk per keyframe (" + std::to_string(reader.GetChunkCount()) + " chunks, " + std::to_string(m_keyframeTimes.size()) + " keyframes)"))
+			return;
+
+		std::vector<Nz::UInt64> stateTimes;
+		bool areRecordsValid = true;
+		for (std::size_t chunkIndex = 0; chunkIndex < reader.GetChunkCount(); ++chunkIndex)
+		{
+			m_runner.Expect(reader.GetChunk(chunkIndex).startTime == m_keyframeTimes[chunkIndex], "chunk #" + std::to_string(chunkIndex) + " to start with its keyframe");
+
+			std::size_t keyframeRecordCount = 0;
+			bool succeeded = reader.ReadChunk(chunkIndex, [&](const ReplayReader::Record& record)
+			{
+				if (record.isKeyframe)
+				{
+					keyframeRecordCount++;
+					areRecordsValid &= (record.type == PacketType::ChatMessage && record.time == m_keyframeTimes[chunkIndex]);
+					return true;
+				}
+
+				Packets::ArenaState statePacket;
+				PacketReader packetReader(record.data, record.size);
+
+				if (record.type != PacketType::ArenaState || !Packets::Unserialize(packetReader, statePacket) || Nz::UInt64(statePacket.serverTime) != record.time)
+					areRecordsValid = false;
+
+				stateTimes.push_back(record.time);
+				return true;
+			});
+
+			m_runner.Expect(succeeded, "chunk #" + std::to_string(chunkIndex) + " to be read");
+			m_runner.Expect(keyframeRecordCount == 1, "chunk #" + std::to_string(chunkIndex) + " to hold its keyframe");
+		}
+
+		m_runner.Expect(areRecordsValid, "every record to decode to the packet recorded at its time");
+		m_runner.Expect(stateTimes == m_stateTimes, "every recorded packet to be read back once, in order");
+		m_runner.Expect(reader.GetEndTime() == m_stateTimes.back(), "the replay to end with the last record");
+	}
+
+	void ReplayChecks::CheckSeek()
+	{
+		if (!RecordReplay(ReplayPath))
+			return;
+
+		ReplayReader reader;
+		if (!OpenReplay(reader, ReplayPath))
+			return;
+
+		if (!m_runner.Expect(reader.GetChunkCount() == m_keyframeTimes.size(), "one chunk per keyframe"))
+			return;
+
+		std::size_t lastChunk = reader.GetChunkCount() - 1;
+
+		m_runner.Expect(reader.FindChunk(0) == 0, "times before the recording to map to the first chunk");
+		m_runner.Expect(reader.FindChunk(std::numeric_limits<Nz::UInt64>::max()) == lastChunk, "times after the recording to map to the last chunk");
+
+		for (std::size_t chunkIndex = 1; chunkIndex < reader.GetChunkCount(); ++chunkIndex)
+		{
+			Nz::UInt64 keyframeTime = m_keyframeTimes[chunkIndex];
+			m_runner.Expect(reader.FindChunk(keyframeTime) == chunkIndex, "a keyframe time to map to its chunk");
+			m_runner.Expect(reader.FindChunk(keyframeTime - 1) == chunkIndex - 1, "the time right before a keyframe to map to the previous chunk");
+		}
+
+		// On, right before and between chunk boundaries, then the end of the replay
+		const Nz::UInt64 seekTimes[] = {
+			m_keyframeTimes[1],
+			m_keyframeTimes[2] - 1,
+			m_keyframeTimes[2],
+			m_keyframeTimes[2] + TickInterval / 2,
+			m_stateTimes.back()
+		};
+
+		for (Nz::UInt64 seekTime : seekTimes)
+		{
+			std::size_t keyframeRecordCount = 0;
+			std::vector<Nz::UInt64> stateTimes;
+
+			std::size_t chunkIndex = reader.Seek(seekTime, [&](const ReplayReader::Record& record)
+			{
+				if (record.isKeyframe)
+					keyframeRecordCount++;
+				else
+					stateTimes.push_back(record.time);
+
+				return true;
+			});
+
+			std::string seekName = "seeking to " + std::to_string(seekTime);
+
+			if (!m_runner.Expect(chunkIndex != ReplayReader::InvalidChunk && chunkIndex == reader.FindChunk(seekTime), seekName + " to read the chunk found by FindChunk"))
+				continue;
+
+			// Every state of the chunk up to the seek time (included), and none after
+			std::vector<Nz::UInt64> expectedStateTimes;
+			for (Nz::UInt64 stateTime : m_stateTimes)
+			{
+				if (stateTime >= reader.GetChunk(chunkIndex).startTime && stateTime <= seekTime)
+					expectedStateTimes.push_back(stateTime);
+			}
+
+			m_runner.Expect(keyframeRecordCount == 1, seekName + " to replay the chunk keyframe");
+			m_runner.Expect(stateTimes == expectedStateTimes, seekName + " to replay every record up to it and none after (" + std::to_string(stateTimes.size()) + " replayed, " + std::to_string(expectedStateTimes.size()) + " expected)");
+		}
+	}
+
+	void ReplayChecks::CheckTruncatedChunk()
+	{
+		if (!RecordReplay(ReplayPath))
+			return;
+
+		std::size_t completeChunkCount;
+		ReplayReader::Chunk lastChunk;
+		Nz::UInt64 completeEndTime;
+		{
+			ReplayReader reader;
+			if (!OpenReplay(reader, ReplayPath) || !m_runner.Expect(reader.GetChunkCount() >= 2, "at least two chunks"))
+				return;
+
+			completeChunkCount = reader.GetChunkCount() - 1;
+			completeEndTime = reader.GetChunk(completeChunkCount - 1).endTime;
+			lastChunk = reader.GetChunk(completeChunkCount);
+		}
+
+		std::ifstream replayFile(ReplayPath, std::ios::binary);
+		std::vector<char> replayData((std::istreambuf_iterator<char>(replayFile)), std::istreambuf_iterator<char>());
+		replayFile.close();
+
+		// The server crashed while writing the last chunk, in its payload or in its header
+		const std::size_t truncatedSizes[] = {
+			lastChunk.offset + lastChunk.payloadSize / 2,
+			lastChunk.offset + lastChunk.payloadSize - 1,
+			lastChunk.offset - ReplayFormat::ChunkHeaderSize / 2
+		};
+
+		for (std::size_t truncatedSize : truncatedSizes)
+		{
+			{
+				std::ofstream truncatedFile(TruncatedReplayPath, std::ios::binary | std::ios::trunc);
+				truncatedFile.write(replayData.data(), truncatedSize);
+			}
+
+			ReplayReader reader;
+			if (!OpenReplay(reader, TruncatedReplayPath))
+				continue;
+
+			std::string truncationName = "a replay truncated to " + std::to_string(truncatedSize) + " bytes";
+
+			m_runner.Expect(reader.GetChunkCount() == completeChunkCount, truncationName + " to only index its complete chunks");
+			m_runner.Expect(reader.GetEndTime() == completeEndTime, truncationName + " to end with its last complete chunk");
+
+			bool succeeded = true;
+			for (std::size_t chunkIndex = 0; chunkIndex < reader.GetChunkCount(); ++chunkIndex)
+				succeeded &= reader.ReadChunk(chunkIndex, [](const ReplayReader::Record& /*record*/) { return true; });
+
+			m_runner.Expect(succeeded, truncationName + " to have its complete chunks readable");
+		}
+	}
+
+	bool ReplayChecks::OpenReplay(ReplayReader& reader, const std::string& filePath)
+	{
+		return m_runner.Expect(reader.Open(filePath), filePath + " to be opened");
+	}
+
+	bool ReplayChecks::RecordReplay(const std::string& filePath)
+	{
+		m_keyframeTimes.clear();
+		m_stateTimes.clear();
+
+		try
+		{
+			// Chunks are written by the recorder thread, they are all on disk once it's destroyed
+			ReplayRecorder recorder(filePath, ArenaName, StartTime);
+
+			for (Nz::UInt64 time = StartTime; time <= StartTime + RecordDuration; time += TickInterval)
+			{
+				// Same order as the arena: a keyframe first if needed, then what the tick broadcasts
+				if (recorder.IsKeyframeNeeded(time))
+				{
+					Packets::ChatMessage keyframePacket;
+					keyframePacket.message = "Keyframe at " + std::to_string(time);
+
+					recorder.BeginKeyframe(time);
+					recorder.RecordPacket(time, keyframePacket);
+					recorder.EndKeyframe();
+
+					m_keyframeTimes.push_back(time);
+				}
+
+				Packets::ArenaState statePacket;
+				statePacket.lastProcessedInputTime = 0;
+				statePacket.serverTime = time;
+				statePacket.stateId = static_cast<Nz::UInt16>(m_stateTimes.size());
+
+				recorder.RecordPacket(time, statePacket);
+
+				m_stateTimes.push_back(time);
+			}
+		}
+		catch (const std::exception& e)
+		{
+			return m_runner.Expect(false, "replay to be recorded to " + filePath + " (" + e.what() + ")");
+		}
+
+		return true;
+	}
+}
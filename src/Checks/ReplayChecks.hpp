@@ -0,0 +1,44 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_REPLAYCHECKS_HPP
+#define EREWHON_CHECKS_REPLAYCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	class CheckRunner;
+	class ReplayReader;
+
+	// Records an arena-like packet stream with ReplayRecorder across several keyframe intervals and reads it back with ReplayReader
+	class ReplayChecks
+	{
+		public:
+			ReplayChecks(CheckRunner& runner);
+			~ReplayChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckRoundTrip();
+			void CheckSeek();
+			void CheckTruncatedChunk();
+
+			bool OpenReplay(ReplayReader& reader, const std::string& filePath);
+			bool RecordReplay(const std::string& filePath);
+
+			CheckRunner& m_runner;
+			std::vector<Nz::UInt64> m_keyframeTimes;
+			std::vector<Nz::UInt64> m_stateTimes;
+	};
+}
+
+#include <Checks/ReplayChecks.inl>
+
+#endif // EREWHON_CHECKS_REPLAYCHECKS_HPP
@@ -0,0 +1,204 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Checks/SnapshotChecks.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Client/SnapshotDelayEstimator.hpp>
+#include <Client/SnapshotInterpolation.hpp>
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr float InitialDelay = 5 * 1000.f / 30.f; //< Same as ServerMatchEntities
+		constexpr Nz::UInt64 PhaseDuration = 20'000;
+		constexpr Nz::UInt64 SnapshotInterval = 33; //< BroadcastSystem sends ArenaState at 30Hz
+		constexpr Nz::UInt64 TransitTime = 50;
+
+		constexpr float MaxDelayError = 5.f; //< milliseconds, from the delay the measured jitter and losses call for
+		constexpr float MaxDelayIncreaseRate = 100.f; //< ms per second, same as SnapshotDelayEstimator
+		constexpr float MaxPositionError = 0.001f;
+
+		SnapshotInterpolation::State MakeState(Nz::UInt64 serverTime, const Nz::Vector3f& position, const Nz::Vector3f& linearVelocity)
+		{
+			SnapshotInterpolation::State state;
+			state.serverTime = serverTime;
+			state.rotation = Nz::Quaternionf::Identity();
+			state.angularVelocity = Nz::Vector3f::Zero();
+			state.linearVelocity = linearVelocity;
+			state.position = position;
+
+			return state;
+		}
+
+		bool IsNear(const Nz::Vector3f& position, const Nz::Vector3f& expectedPosition)
+		{
+			return (position - expectedPosition).GetLength() <= MaxPositionError;
+		}
+
+		std::string ToString(const Nz::Vector3f& position)
+		{
+			return "(" + std::to_string(position.x) + ", " + std::to_string(position.y) + ", " + std::to_string(position.z) + ")";
+		}
+	}
+
+	SnapshotChecks::SnapshotChecks(CheckRunner& runner) :
+	m_runner(runner)
+	{
+	}
+
+	void SnapshotChecks::Run()
+	{
+		m_runner.Run("Snapshot.Delay", [&] { CheckDelay(); });
+		m_runner.Run("Snapshot.Extrapolation", [&] { CheckExtrapolation(); });
+		m_runner.Run("Snapshot.Hermite", [&] { CheckHermite(); });
+	}
+
+	// Snapshots arrive with jitter, then without, then with losses, the delay must follow each time
+	void SnapshotChecks::CheckDelay()
+	{
+		std::mt19937 randomGenerator(1);
+
+		SnapshotDelayEstimator estimator(InitialDelay);
+		Nz::UInt64 serverTime = 1000;
+		Nz::UInt16 stateId = 0;
+		float maxDelayChange = 0.f;
+
+		// Jitter stays under the snapshot interval, so snapshots aren't reordered
+		auto Simulate = [&](float maxJitter, unsigned int lossInterval)
+		{
+			std::uniform_real_distribution<float> jitterDistribution(0.f, maxJitter);
+
+			for (Nz::UInt64 elapsedTime = 0; elapsedTime < PhaseDuration; elapsedTime += SnapshotInterval)
+			{
+				serverTime += SnapshotInterval;
+				stateId++;
+
+				if (lossInterval == 0 || stateId % lossInterval != 0)
+				{
+					Nz::UInt64 arrivalTime = serverTime + TransitTime + static_cast<Nz::UInt64>(std::round(jitterDistribution(randomGenerator)));
+					estimator.OnSnapshot(stateId, serverTime, arrivalTime);
+				}
+
+				float previousDelay = estimator.GetDelay();
+				estimator.Update(SnapshotInterval / 1000.f);
+				maxDelayChange = std::max(maxDelayChange, std::abs(estimator.GetDelay() - previousDelay));
+			}
+		};
+
+		// Jitter as defined by RFC 3550 is the mean transit time difference, a third of the range for an uniform distribution
+		Simulate(30.f, 0);
+
+		float jitterDelay = estimator.GetDelay();
+		m_runner.Expect(std::abs(estimator.GetSnapshotInterval() - SnapshotInterval) < 1.f, "the snapshot interval to be measured (" + std::to_string(estimator.GetSnapshotInterval()) + "ms)");
+		m_runner.Expect(estimator.GetJitter() > 6.f && estimator.GetJitter() < 14.f, "the jitter to be about 10ms (" + std::to_string(estimator.GetJitter()) + "ms)");
+		m_runner.Expect(std::abs(jitterDelay - estimator.ComputeTargetDelay()) < MaxDelayError, "the delay to converge under jitter (" + std::to_string(jitterDelay) + "ms, target " + std::to_string(estimator.ComputeTargetDelay()) + "ms)");
+		m_runner.Expect(jitterDelay > SnapshotInterval + 2.f * 6.f, "the delay to leave a margin for the jitter (" + std::to_string(jitterDelay) + "ms)");
+
+		Simulate(0.f, 0);
+
+		float steadyDelay = estimator.GetDelay();
+		m_runner.Expect(estimator.GetJitter() < 1.f, "the jitter to vanish once snapshots arrive regularly (" + std::to_string(estimator.GetJitter()) + "ms)");
+		m_runner.Expect(steadyDelay < jitterDelay && std::abs(steadyDelay - SnapshotInterval) < MaxDelayError, "the delay to shrink back to one snapshot interval (" + std::to_string(steadyDelay) + "ms)");
+
+		Simulate(0.f, 10);
+
+		float lossDelay = estimator.GetDelay();
+		m_runner.Expect(estimator.GetLossRate() > 0.05f && estimator.GetLossRate() < 0.2f, "the loss rate to be about 10% (" + std::to_string(estimator.GetLossRate() * 100.f) + "%)");
+		m_runner.Expect(lossDelay > 2.f * SnapshotInterval - MaxDelayError, "the delay to bridge a lost snapshot (" + std::to_string(lossDelay) + "ms)");
+
+		m_runner.Expect(maxDelayChange <= MaxDelayIncreaseRate * SnapshotInterval / 1000.f + 0.001f, "the delay to change progressively (" + std::to_string(maxDelayChange) + "ms at once)");
+	}
+
+	// Snapshots arrive regularly until the network stalls for longer than the maximum extrapolation time, entities move in a straight line
+	void SnapshotChecks::CheckExtrapolation()
+	{
+		constexpr Nz::UInt64 DisplayDelay = 100;
+		constexpr Nz::UInt64 StallStartTime = 330; //< First server time held back
+		constexpr Nz::UInt64 StallEndTime = 900; //< Client time the held back snapshots arrive at
+
+		const Nz::Vector3f velocity(10.f, 0.f, -5.f);
+
+		std::vector<SnapshotInterpolation::State> receivedStates;
+		std::size_t extrapolatedFrameCount = 0;
+		std::size_t interpolatedFrameCount = 0;
+		std::size_t unexpectedExtrapolationCount = 0;
+		Nz::UInt64 maxExtrapolationTime = 0;
+		bool arePositionsValid = true;
+
+		for (Nz::UInt64 now = DisplayDelay; now <= 1500; ++now)
+		{
+			receivedStates.clear();
+			for (Nz::UInt64 serverTime = 0; serverTime <= now; serverTime += SnapshotInterval)
+			{
+				Nz::UInt64 arrivalTime = (serverTime >= StallStartTime && serverTime + TransitTime < StallEndTime) ? StallEndTime : serverTime + TransitTime;
+				if (arrivalTime <= now)
+					receivedStates.push_back(MakeState(serverTime, velocity * (serverTime / 1000.f), velocity));
+			}
+
+			Nz::UInt64 displayTime = now - DisplayDelay;
+
+			bool isExtrapolated;
+			SnapshotInterpolation::State state = SnapshotInterpolation::Sample(receivedStates.data(), receivedStates.size(), displayTime, &isExtrapolated);
+
+			const SnapshotInterpolation::State* lastState = &receivedStates.back();
+			if (isExtrapolated)
+			{
+				extrapolatedFrameCount++;
+
+				// Only while the next snapshot is late
+				if (displayTime < StallStartTime - SnapshotInterval || now >= StallEndTime)
+					unexpectedExtrapolationCount++;
+
+				Nz::UInt64 extrapolationTime = std::min(displayTime - lastState->serverTime, SnapshotInterpolation::MaxExtrapolationTime);
+				maxExtrapolationTime = std::max(maxExtrapolationTime, displayTime - lastState->serverTime);
+
+				arePositionsValid &= IsNear(state.position, lastState->position + velocity * (extrapolationTime / 1000.f));
+			}
+			else
+			{
+				interpolatedFrameCount++;
+				arePositionsValid &= IsNear(state.position, velocity * (displayTime / 1000.f));
+			}
+		}
+
+		m_runner.Expect(interpolatedFrameCount > 0 && extrapolatedFrameCount > 0, "both interpolation (" + std::to_string(interpolatedFrameCount) + " frames) and extrapolation (" + std::to_string(extrapolatedFrameCount) + " frames) to be used");
+		m_runner.Expect(unexpectedExtrapolationCount == 0, "extrapolation to be used only when the next snapshot is late (" + std::to_string(unexpectedExtrapolationCount) + " frames otherwise)");
+		m_runner.Expect(maxExtrapolationTime > SnapshotInterpolation::MaxExtrapolationTime, "the stall to last longer than the extrapolation limit (" + std::to_string(maxExtrapolationTime) + "ms)");
+		m_runner.Expect(arePositionsValid, "entities to follow their path, and to stop " + std::to_string(SnapshotInterpolation::MaxExtrapolationTime) + "ms after the last snapshot");
+	}
+
+	// Velocities are the spline tangents, scaled by the time between both snapshots
+	void SnapshotChecks::CheckHermite()
+	{
+		SnapshotInterpolation::State from = MakeState(1000, Nz::Vector3f::Zero(), Nz::Vector3f(20.f, 0.f, 0.f));
+		SnapshotInterpolation::State to = MakeState(1100, Nz::Vector3f(1.f, 0.f, 0.f), Nz::Vector3f(0.f, 10.f, 0.f));
+
+		// h00 = h01 = 0.5, h10 = 0.125 and h11 = -0.125 at the midpoint, over a 0.1s interval
+		Nz::Vector3f expectedMidpoint(0.5f + 0.125f * 0.1f * 20.f, -0.125f * 0.1f * 10.f, 0.f);
+
+		SnapshotInterpolation::State midpoint = SnapshotInterpolation::Interpolate(from, to, 1050);
+		m_runner.Expect(IsNear(midpoint.position, expectedMidpoint), "the midpoint to be at " + ToString(expectedMidpoint) + " (got " + ToString(midpoint.position) + ")");
+		m_runner.Expect(IsNear(midpoint.linearVelocity, Nz::Vector3f(10.f, 5.f, 0.f)), "the midpoint velocity to be the average velocity");
+
+		m_runner.Expect(IsNear(SnapshotInterpolation::Interpolate(from, to, 1000).position, from.position), "the spline to start on the first snapshot");
+		m_runner.Expect(IsNear(SnapshotInterpolation::Interpolate(from, to, 1100).position, to.position), "the spline to end on the second snapshot");
+
+		// Snapshots of an entity moving in a straight line at constant speed, the spline must follow it
+		const Nz::Vector3f velocity(3.f, -2.f, 7.f);
+		SnapshotInterpolation::State straightFrom = MakeState(2000, Nz::Vector3f(1.f, 1.f, 1.f), velocity);
+		SnapshotInterpolation::State straightTo = MakeState(2033, straightFrom.position + velocity * 0.033f, velocity);
+
+		bool isStraight = true;
+		for (Nz::UInt64 displayTime = 2000; displayTime <= 2033; ++displayTime)
+			isStraight &= IsNear(SnapshotInterpolation::Interpolate(straightFrom, straightTo, displayTime).position, straightFrom.position + velocity * ((displayTime - 2000) / 1000.f));
+
+		m_runner.Expect(isStraight, "a straight line at constant speed to be followed");
+	}
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CHECKS_SNAPSHOTCHECKS_HPP
+#define EREWHON_CHECKS_SNAPSHOTCHECKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace ewn
+{
+	class CheckRunner;
+
+	// Feeds synthetic snapshot arrival times to the snapshot delay estimator and checks how entities are displayed between and after snapshots
+	class SnapshotChecks
+	{
+		public:
+			SnapshotChecks(CheckRunner& runner);
+			~SnapshotChecks() = default;
+
+			void Run();
+
+		private:
+			void CheckDelay();
+			void CheckExtrapolation();
+			void CheckHermite();
+
+			CheckRunner& m_runner;
+	};
+}
+
+#include <Checks/SnapshotChecks.inl>
+
+#endif // EREWHON_CHECKS_SNAPSHOTCHECKS_HPP
@@ -0,0 +1,70 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Checks" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <Checks/CheckRunner.hpp>
+#include <Checks/ClockSyncChecks.hpp>
+#include <Checks/MovementInputChecks.hpp>
+#include <Checks/PredictionChecks.hpp>
+#include <Checks/RelayChecks.hpp>
+#include <Checks/ReplayChecks.hpp>
+#include <Checks/SnapshotChecks.hpp>
+#include <Shared/Logger.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Usage: ErewhonChecks [--filter <name>]
+// Exits with a failure code if any check failed
+int main(int argc, char* argv[])
+{
+	std::string filter;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (arg == "--filter")
+			filter = argv[++i];
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	Nz::Initializer<Nz::Network> nazara;
+
+	ewn::CheckRunner runner(std::move(filter));
+
+	ewn::ClockSyncChecks clockSyncChecks(runner);
+	clockSyncChecks.Run();
+
+	ewn::MovementInputChecks movementInputChecks(runner);
+	movementInputChecks.Run();
+
+	ewn::PredictionChecks predictionChecks(runner);
+	predictionChecks.Run();
+
+	ewn::RelayChecks relayChecks(runner);
+	relayChecks.Run();
+
+	ewn::ReplayChecks replayChecks(runner);
+	replayChecks.Run();
+
+	ewn::SnapshotChecks snapshotChecks(runner);
+	snapshotChecks.Run();
+
+	std::cout << runner.GetCheckCount() - runner.GetFailedCheckCount() << '/' << runner.GetCheckCount() << " checks passed" << std::endl;
+
+	ewn::Logger::Flush();
+
+	return (runner.GetFailedCheckCount() == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -5,27 +5,56 @@
 #include <Client/ClientApplication.hpp>
 #include <Nazara/Network/Algorithm.hpp>
 #include <Shared/Config.hpp>
+#include <Shared/Logger.hpp>
 #include <Shared/Protocol/Packets.hpp>
-#include <iostream>
 
 namespace ewn
 {
-	ClientApplication::ClientApplication()
+	ClientApplication::ClientApplication() :
+	m_maxPeerPerReactor(1)
 	{
 		RegisterConfig();
 	}
 
 	ClientApplication::~ClientApplication() = default;
 
+	NetworkReactor::ChannelStats ClientApplication::GetNetworkStats()
+	{
+		NetworkReactor::ChannelStats totalStats = {};
+
+		std::size_t reactorCount = GetReactorCount();
+		for (std::size_t reactorIndex = 0; reactorIndex < reactorCount; ++reactorIndex)
+		{
+			const std::unique_ptr<NetworkReactor>& reactor = GetReactor(reactorIndex);
+			for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			{
+				NetworkReactor::ChannelStats stats = reactor->GetChannelStats(static_cast<Nz::UInt8>(channelId));
+				totalStats.receivedBytes += stats.receivedBytes;
+				totalStats.receivedPackets += stats.receivedPackets;
+				totalStats.sentBytes += stats.sentBytes;
+				totalStats.sentPackets += stats.sentPackets;
+			}
+		}
+
+		return totalStats;
+	}
+
 	bool ClientApplication::Run()
 	{
-		return BaseApplication::Run();
+		if (!BaseApplication::Run())
+			return false;
+
+		for (ServerConnection* server : m_servers)
+		{
+			if (server)
+				server->Update();
+		}
+
+		return true;
 	}
 
 	bool ClientApplication::ConnectNewServer(const Nz::String& serverHostname, Nz::UInt32 data, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor)
 	{
-		constexpr std::size_t MaxPeerCount = 1;
-
 		Nz::UInt16 port = m_config.GetIntegerOption<Nz::UInt16>("Server.Port");
 
 		Nz::NetProtocol hostnameProtocol = (m_config.GetBoolOption("Options.ForceIPv4")) ? Nz::NetProtocol_IPv4 : Nz::NetProtocol_Any;
@@ -34,7 +63,7 @@ namespace ewn
 		std::vector<Nz::HostnameInfo> results = Nz::IpAddress::ResolveHostname(hostnameProtocol, serverHostname, Nz::String::Number(port), &resolveError);
 		if (results.empty())
 		{
-			std::cerr << "Failed to resolve server hostname: " << Nz::ErrorToString(resolveError) << std::endl;
+			LogError(LogCategory::Client) << "Failed to resolve server hostname: " << Nz::ErrorToString(resolveError);
 			return false;
 		}
 
@@ -44,10 +73,7 @@ namespace ewn
 		{
 			std::size_t newPeerId = reactor->ConnectTo(serverAddress, data);
 			if (newPeerId == NetworkReactor::InvalidPeerId)
-			{
-				std::cerr << "Failed to allocate new peer" << std::endl;
 				return false;
-			}
 
 			*peerId = newPeerId;
 			*peerReactor = reactor;
@@ -67,15 +93,23 @@ namespace ewn
 			if (reactor->GetProtocol() != serverAddress.GetProtocol())
 				continue;
 
-			return ConnectWithReactor(reactor.get());
+			// Reactor may be full, try the next one
+			if (ConnectWithReactor(reactor.get()))
+				return true;
+		}
+
+		// We don't have any reactor compatible with the server's protocol (or they're all full), allocate a new one
+		std::size_t reactorId = AddReactor(std::make_unique<NetworkReactor>(reactorCount * m_maxPeerPerReactor, serverAddress.GetProtocol(), 0, m_maxPeerPerReactor));
+		if (!ConnectWithReactor(GetReactor(reactorId).get()))
+		{
+			LogError(LogCategory::Client) << "Failed to allocate new peer";
+			return false;
 		}
 
-		// We don't have any reactor compatible with the server's protocol, allocate a new one
-		std::size_t reactorId = AddReactor(std::make_unique<NetworkReactor>(reactorCount * MaxPeerCount, serverAddress.GetProtocol(), 0, MaxPeerCount));
-		return ConnectWithReactor(GetReactor(reactorId).get());
+		return true;
 	}
 
-	void ClientApplication::HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data)
+	void ClientApplication::HandlePeerConnection(bool outgoing, std::size_t peerId, const Nz::IpAddress& /*remoteAddress*/, Nz::UInt32 data)
 	{
 		m_servers[peerId]->NotifyConnected(data);
 	}
@@ -27,12 +27,16 @@ namespace ewn
 
 			virtual ~ClientApplication();
 
+			NetworkReactor::ChannelStats GetNetworkStats();
+
 			bool Run() override;
 
+			inline void SetMaxPeerPerReactor(std::size_t maxPeerCount);
+
 		private:
 			bool ConnectNewServer(const Nz::String& serverHostname, Nz::UInt32 data, ServerConnection* connection, std::size_t* peerId, NetworkReactor** peerReactor);
 
-			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data) override;
+			void HandlePeerConnection(bool outgoing, std::size_t peerId, const Nz::IpAddress& remoteAddress, Nz::UInt32 data) override;
 			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data) override;
 			void HandlePeerInfo(std::size_t peerId, const NetworkReactor::PeerInfo& peerInfo) override;
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet) override;
@@ -40,6 +44,7 @@ namespace ewn
 			void RegisterConfig();
 
 			std::vector<ServerConnection*> m_servers;
+			std::size_t m_maxPeerPerReactor;
 	};
 }
 
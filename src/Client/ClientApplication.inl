@@ -3,7 +3,15 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/ClientApplication.hpp>
+#include <cassert>
 
 namespace ewn
 {
+	inline void ClientApplication::SetMaxPeerPerReactor(std::size_t maxPeerCount)
+	{
+		assert(maxPeerCount > 0);
+		assert(GetReactorCount() == 0); //< Peer ids are computed from the reactor capacity
+
+		m_maxPeerPerReactor = maxPeerCount;
+	}
 }
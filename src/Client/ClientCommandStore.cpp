@@ -7,12 +7,18 @@
 
 namespace ewn
 {
+	namespace
+	{
+		template<typename T, auto Signal>
+		void EmitSignal(ServerConnection* server, const T& data)
+		{
+			(server->*Signal)(server, data);
+		}
+	}
+
 	ClientCommandStore::ClientCommandStore(ServerConnection* server)
 	{
-#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](ServerConnection* server, const Packets::Type& data) \
-{ \
-	server->On##Type(server, data); \
-})
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type, &EmitSignal<Packets::Type, &ServerConnection::On##Type>>(#Type)
 #define OutgoingCommand(Type, Flags, Channel) RegisterOutgoingCommand<Packets::Type>(#Type, Flags, Channel)
 
 		// Incoming commands
@@ -22,21 +28,25 @@ namespace ewn
 		IncomingCommand(ArenaSounds);
 		IncomingCommand(ArenaState);
 		IncomingCommand(BotMessage);
+		IncomingCommand(CachedPacketVersion);
 		IncomingCommand(ChatMessage);
 		IncomingCommand(ControlEntity);
 		IncomingCommand(CreateEntities);
 		IncomingCommand(CreateFleetFailure);
 		IncomingCommand(CreateFleetSuccess);
+		IncomingCommand(CreateProjectiles);
 		IncomingCommand(CreateSpaceshipFailure);
 		IncomingCommand(CreateSpaceshipSuccess);
 		IncomingCommand(DeleteEntities);
 		IncomingCommand(DeleteFleetFailure);
 		IncomingCommand(DeleteFleetSuccess);
+		IncomingCommand(DeleteProjectiles);
 		IncomingCommand(DeleteSpaceshipFailure);
 		IncomingCommand(DeleteSpaceshipSuccess);
 		IncomingCommand(FleetInfo);
 		IncomingCommand(FleetList);
 		IncomingCommand(HullList);
+		IncomingCommand(InstantiateEffects);
 		IncomingCommand(InstantiateParticleSystem);
 		IncomingCommand(IntegrityUpdate);
 		IncomingCommand(LoginFailure);
@@ -55,29 +65,30 @@ namespace ewn
 		IncomingCommand(UpdateSpaceshipSuccess);
 
 		// Outgoing commands
-		OutgoingCommand(ControlEntity,      Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(CreateFleet,        Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(CreateSpaceship,    Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(DeleteFleet,        Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(DeleteSpaceship,    Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(JoinArena,          Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(LeaveArena,         Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(Login,              Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(LoginByToken,       Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(PlayerChat,         Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(PlayerMovement,     0,                           0);
-		OutgoingCommand(PlayerShoot,        Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QueryArenaList,     Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QueryFleetInfo,     Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QueryFleetList,     Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QueryHullList,      Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QueryModuleList,    Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QuerySpaceshipInfo, Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(QuerySpaceshipList, Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(Register,           Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(TimeSyncRequest,    0,                           0);
-		OutgoingCommand(UpdateFleet,        Nz::ENetPacketFlag_Reliable, 0);
-		OutgoingCommand(UpdateSpaceship,    Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ControlEntity,        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CreateFleet,          Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CreateSpaceship,      Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeclareCachedPackets, Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeleteFleet,          Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeleteSpaceship,      Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(JoinArena,            Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(LeaveArena,           Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(Login,                Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(LoginByToken,         Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(PlayerChat,           Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(PlayerMovement,       0,                           0);
+		OutgoingCommand(PlayerShoot,          Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QueryArenaList,       Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QueryFleetInfo,       Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QueryFleetList,       Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QueryHullList,        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QueryModuleList,      Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QuerySpaceshipInfo,   Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(QuerySpaceshipList,   Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(Register,             Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(TimeSyncRequest,      0,                           0);
+		OutgoingCommand(UpdateFleet,          Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(UpdateSpaceship,      Nz::ENetPacketFlag_Reliable, 0);
 
 #undef IncomingCommand
 #undef OutgoingCommand
@@ -0,0 +1,173 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/ClockSync.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr double MaxDrift = 0.001;           //< Real clocks drift by a few dozen ppm, anything above is noise
+		constexpr double MaxSlewRate = 0.02;         //< Estimated server time runs at most 2% faster or slower while catching up
+		constexpr std::size_t MinFitMeasureCount = 4;
+		constexpr double StepThreshold = 250.0;      //< Above this error the server clock most likely jumped, slewing would take too long
+		constexpr Nz::UInt64 WindowDuration = 1000;
+	}
+
+	ClockSync::ClockSync() :
+	m_measures(m_measureData.begin(), m_measureData.end()),
+	m_roundTrips(m_roundTripData.begin(), m_roundTripData.end())
+	{
+		Reset();
+	}
+
+	void ClockSync::AddRoundTrip(double roundTripTime)
+	{
+		if (!std::isfinite(roundTripTime) || roundTripTime < 0.0)
+			return;
+
+		if (m_roundTrips.full())
+			m_roundTrips.pop_front();
+
+		m_roundTrips.push_back(roundTripTime);
+
+		// Queuing only ever adds delay, the fastest round trip is the closest to the real network latency
+		m_minRoundTripTime = *std::min_element(m_roundTrips.begin(), m_roundTrips.end());
+	}
+
+	// Server time when sending the packet, client time when receiving it
+	void ClockSync::AddServerTime(Nz::UInt64 serverTime, Nz::UInt64 clientTime)
+	{
+		// serverTime - clientTime is the offset minus the time the packet spent in flight, so the highest value is the most accurate
+		double sample = static_cast<double>(static_cast<Nz::Int64>(serverTime) - static_cast<Nz::Int64>(clientTime));
+
+		if (!m_hasWindowSample)
+		{
+			m_hasWindowSample = true;
+			m_windowMaxSample = sample;
+			m_windowStartTime = clientTime;
+		}
+		else
+			m_windowMaxSample = std::max(m_windowMaxSample, sample);
+	}
+
+	double ClockSync::EstimateOffset(Nz::UInt64 clientTime) const
+	{
+		if (m_measures.empty())
+			return m_appliedOffset;
+
+		return m_fitOffset + m_drift * static_cast<double>(static_cast<Nz::Int64>(clientTime - m_fitReferenceTime));
+	}
+
+	void ClockSync::Reset()
+	{
+		while (!m_measures.empty())
+			m_measures.pop_front();
+
+		while (!m_roundTrips.empty())
+			m_roundTrips.pop_front();
+
+		m_lastUpdateTime = 0;
+		m_windowStartTime = 0;
+		m_fitReferenceTime = 0;
+		m_hasWindowSample = false;
+		m_isSynchronized = false;
+		m_appliedOffset = 0.0;
+		m_drift = 0.0;
+		m_fitOffset = 0.0;
+		m_minRoundTripTime = 0.0;
+		m_windowMaxSample = 0.0;
+	}
+
+	void ClockSync::Update(Nz::UInt64 clientTime)
+	{
+		// One measure per window, except for the first one which shouldn't keep the client waiting
+		if (m_hasWindowSample && !m_roundTrips.empty() && (!m_isSynchronized || clientTime - m_windowStartTime >= WindowDuration))
+		{
+			AddMeasure(clientTime, m_windowMaxSample + m_minRoundTripTime / 2.0);
+			m_hasWindowSample = false;
+		}
+
+		if (!m_measures.empty())
+		{
+			double targetOffset = EstimateOffset(clientTime);
+			double error = targetOffset - m_appliedOffset;
+
+			if (!m_isSynchronized || std::abs(error) > StepThreshold)
+			{
+				m_appliedOffset = targetOffset;
+				m_isSynchronized = true;
+			}
+			else
+			{
+				double maxChange = MaxSlewRate * static_cast<double>(clientTime - m_lastUpdateTime);
+				m_appliedOffset += Nz::Clamp(error, -maxChange, maxChange);
+			}
+		}
+
+		m_lastUpdateTime = clientTime;
+	}
+
+	void ClockSync::AddMeasure(Nz::UInt64 clientTime, double offset)
+	{
+		// The server clock jumped (restart?), previous measures are meaningless
+		if (!m_measures.empty() && std::abs(offset - EstimateOffset(clientTime)) > StepThreshold)
+		{
+			while (!m_measures.empty())
+				m_measures.pop_front();
+		}
+
+		if (m_measures.full())
+			m_measures.pop_front();
+
+		Measure measure;
+		measure.clientTime = clientTime;
+		measure.offset = offset;
+
+		m_measures.push_back(measure);
+
+		FitMeasures();
+	}
+
+	void ClockSync::FitMeasures()
+	{
+		// Times are taken relative to the last measure to keep a good precision
+		m_fitReferenceTime = m_measures.back().clientTime;
+
+		double count = static_cast<double>(m_measures.size());
+		double meanTime = 0.0;
+		double meanOffset = 0.0;
+		for (const Measure& measure : m_measures)
+		{
+			meanTime += static_cast<double>(static_cast<Nz::Int64>(measure.clientTime - m_fitReferenceTime));
+			meanOffset += measure.offset;
+		}
+		meanTime /= count;
+		meanOffset /= count;
+
+		// Not enough measures to tell drift from noise
+		if (m_measures.size() < MinFitMeasureCount)
+		{
+			m_drift = 0.0;
+			m_fitOffset = meanOffset;
+			return;
+		}
+
+		// Least squares line through the measures
+		double covariance = 0.0;
+		double variance = 0.0;
+		for (const Measure& measure : m_measures)
+		{
+			double time = static_cast<double>(static_cast<Nz::Int64>(measure.clientTime - m_fitReferenceTime)) - meanTime;
+			covariance += time * (measure.offset - meanOffset);
+			variance += time * time;
+		}
+
+		m_drift = (variance > 0.0) ? Nz::Clamp(covariance / variance, -MaxDrift, MaxDrift) : 0.0;
+		m_fitOffset = meanOffset - m_drift * meanTime;
+	}
+}
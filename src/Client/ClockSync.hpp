@@ -0,0 +1,77 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CLIENT_CLOCKSYNC_HPP
+#define EREWHON_CLIENT_CLOCKSYNC_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <nonstd/ring_span.hpp>
+#include <array>
+
+namespace ewn
+{
+	// Keeps track of the offset between the client and the server clocks, all times are in milliseconds
+	// Every timestamped packet from the server bounds the offset, the smallest round trip tells how much time packets spend in flight
+	// Offset measures are fitted over time to follow clock drift, and the applied offset is slewed toward the estimate instead of jumping
+	class ClockSync
+	{
+		public:
+			ClockSync();
+			ClockSync(const ClockSync&) = delete;
+			ClockSync(ClockSync&&) = delete;
+			~ClockSync() = default;
+
+			void AddRoundTrip(double roundTripTime);
+			void AddServerTime(Nz::UInt64 serverTime, Nz::UInt64 clientTime);
+
+			double EstimateOffset(Nz::UInt64 clientTime) const;
+
+			inline double GetDrift() const;
+			inline double GetMinRoundTripTime() const;
+			inline Nz::Int64 GetOffset() const;
+
+			inline bool IsSynchronized() const;
+
+			void Reset();
+
+			void Update(Nz::UInt64 clientTime);
+
+			ClockSync& operator=(const ClockSync&) = delete;
+			ClockSync& operator=(ClockSync&&) = delete;
+
+			static constexpr std::size_t MaxMeasureCount = 32;
+			static constexpr std::size_t MaxRoundTripCount = 16;
+
+		private:
+			struct Measure
+			{
+				Nz::UInt64 clientTime;
+				double offset;
+			};
+
+			void AddMeasure(Nz::UInt64 clientTime, double offset);
+			void FitMeasures();
+
+			std::array<Measure, MaxMeasureCount> m_measureData;
+			std::array<double, MaxRoundTripCount> m_roundTripData;
+			nonstd::ring_span<Measure> m_measures;
+			nonstd::ring_span<double> m_roundTrips;
+			Nz::UInt64 m_lastUpdateTime;
+			Nz::UInt64 m_windowStartTime;
+			Nz::UInt64 m_fitReferenceTime;
+			bool m_hasWindowSample;
+			bool m_isSynchronized;
+			double m_appliedOffset;
+			double m_drift;
+			double m_fitOffset;
+			double m_minRoundTripTime;
+			double m_windowMaxSample;
+	};
+}
+
+#include <Client/ClockSync.inl>
+
+#endif // EREWHON_CLIENT_CLOCKSYNC_HPP
@@ -0,0 +1,32 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/ClockSync.hpp>
+#include <cmath>
+
+namespace ewn
+{
+	// Milliseconds of offset gained per millisecond
+	inline double ClockSync::GetDrift() const
+	{
+		return m_drift;
+	}
+
+	// Milliseconds
+	inline double ClockSync::GetMinRoundTripTime() const
+	{
+		return m_minRoundTripTime;
+	}
+
+	// Milliseconds to add to the client time to get the server time
+	inline Nz::Int64 ClockSync::GetOffset() const
+	{
+		return static_cast<Nz::Int64>(std::llround(m_appliedOffset));
+	}
+
+	inline bool ClockSync::IsSynchronized() const
+	{
+		return m_isSynchronized;
+	}
+}
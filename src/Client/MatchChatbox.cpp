@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/MatchChatbox.hpp>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -54,7 +55,7 @@ namespace ewn
 
 	void MatchChatbox::PrintMessage(const std::string& message)
 	{
-		std::cout << message << std::endl;
+		LogInfo(LogCategory::Client) << message;
 
 		m_chatLines.emplace_back(message);
 		if (m_chatLines.size() > maxChatLines)
@@ -3,10 +3,19 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Client/ServerConnection.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Client/ClientApplication.hpp>
+#include <Shared/Logger.hpp>
+#include <type_traits>
 
 namespace ewn
 {
+	namespace
+	{
+		constexpr Nz::UInt64 SyncedTimeSyncInterval = 2000;
+		constexpr Nz::UInt64 UnsyncedTimeSyncInterval = 250;
+	}
+
 	bool ServerConnection::Connect(const Nz::String& serverHostname, Nz::UInt32 data)
 	{
 		if (IsConnected())
@@ -18,7 +27,132 @@ namespace ewn
 
 	Nz::UInt64 ServerConnection::EstimateServerTime() const
 	{
-		return m_application.GetAppTime() + m_deltaTime;
+		return static_cast<Nz::UInt64>(static_cast<Nz::Int64>(m_application.GetAppTime()) + m_clockSync.GetOffset());
+	}
+
+	void ServerConnection::SendCachedPacketVersions()
+	{
+		Packets::DeclareCachedPackets declareCachedPackets;
+
+		auto DeclarePacket = [&](const auto& cachedPacket)
+		{
+			using Packet = std::decay_t<decltype(cachedPacket.packet)>;
+
+			if (cachedPacket.version == 0)
+				return;
+
+			auto& packetInfo = declareCachedPackets.packets.emplace_back();
+			packetInfo.packetType = Packet::Type;
+			packetInfo.version = cachedPacket.version;
+		};
+
+		DeclarePacket(m_cachedArenaParticleSystems);
+		DeclarePacket(m_cachedArenaPrefabs);
+		DeclarePacket(m_cachedArenaSounds);
+		DeclarePacket(m_cachedNetworkStrings);
+
+		// The server waits for this packet before sending anything
+		SendPacket(declareCachedPackets);
+	}
+
+	void ServerConnection::Update()
+	{
+		if (!IsConnected())
+			return;
+
+		Nz::UInt64 now = m_application.GetAppTime();
+		m_clockSync.Update(now);
+
+		// Round trips are only needed to know how long packets take to arrive, the offset itself comes from every server timestamp
+		// The server ignores these until we're logged in
+		if (now >= m_nextTimeSyncTime)
+		{
+			Packets::TimeSyncRequest timeSyncRequest;
+			timeSyncRequest.requestId = ++m_timeSyncRequestId;
+
+			SendPacket(timeSyncRequest);
+
+			m_nextTimeSyncTime = now + ((m_clockSync.IsSynchronized()) ? SyncedTimeSyncInterval : UnsyncedTimeSyncInterval);
+			m_timeSyncRequestTime = Nz::GetElapsedMicroseconds();
+		}
+	}
+
+	void ServerConnection::HandleArenaState(ServerConnection* server, const Packets::ArenaState& data)
+	{
+		assert(server == this);
+
+		m_clockSync.AddServerTime(data.serverTime, m_application.GetAppTime());
+	}
+
+	void ServerConnection::HandleCachedPacketVersion(ServerConnection* server, const Packets::CachedPacketVersion& data)
+	{
+		assert(server == this);
+
+		std::size_t packetId = static_cast<std::size_t>(data.packetType);
+		if (packetId >= m_pendingCachedVersions.size())
+		{
+			LogError(LogCategory::Network) << "Server sent a cached packet version for invalid packet type #" << packetId;
+			return;
+		}
+
+		if (!data.useCachedPacket)
+		{
+			// The packet follows and will be cached under this version
+			m_pendingCachedVersions[packetId] = data.version;
+			return;
+		}
+
+		auto ReplayPacket = [&](const auto& cachedPacket, auto& signal)
+		{
+			if (cachedPacket.version != data.version)
+			{
+				LogError(LogCategory::Network) << "Server assumed we hold version " << data.version << " of packet type #" << packetId << " but we have version " << cachedPacket.version;
+				return;
+			}
+
+			signal(this, cachedPacket.packet);
+		};
+
+		switch (data.packetType)
+		{
+			case PacketType::ArenaParticleSystems:
+				ReplayPacket(m_cachedArenaParticleSystems, OnArenaParticleSystems);
+				break;
+
+			case PacketType::ArenaPrefabs:
+				ReplayPacket(m_cachedArenaPrefabs, OnArenaPrefabs);
+				break;
+
+			case PacketType::ArenaSounds:
+				ReplayPacket(m_cachedArenaSounds, OnArenaSounds);
+				break;
+
+			case PacketType::NetworkStrings:
+				ReplayPacket(m_cachedNetworkStrings, OnNetworkStrings);
+				break;
+
+			default:
+				LogError(LogCategory::Network) << "Server asked to use a cached packet of type #" << packetId << " which isn't cached";
+				break;
+		}
+	}
+
+	void ServerConnection::HandleTimeSyncResponse(ServerConnection* server, const Packets::TimeSyncResponse& data)
+	{
+		assert(server == this);
+
+		m_clockSync.AddServerTime(data.serverTime, m_application.GetAppTime());
+
+		// Only our latest request can be timed, an older response would only make the round trip look longer
+		if (m_timeSyncRequestTime == 0 || data.requestId != m_timeSyncRequestId)
+			return;
+
+		Nz::UInt64 roundTripTime = Nz::GetElapsedMicroseconds() - m_timeSyncRequestTime;
+		m_timeSyncRequestTime = 0;
+
+		m_clockSync.AddRoundTrip(roundTripTime / 1000.0);
+
+		OnRoundTrip(this, roundTripTime);
 	}
 
 	void ServerConnection::UpdateNetworkStrings(ServerConnection* server, const Packets::NetworkStrings& data)
@@ -10,8 +10,10 @@
 #include <Shared/Protocol/NetworkStringStore.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/ClientCommandStore.hpp>
+#include <Client/ClockSync.hpp>
 #include <Nazara/Core/Signal.hpp>
 #include <Nazara/Core/String.hpp>
+#include <array>
 
 namespace ewn
 {
@@ -38,6 +40,7 @@ namespace ewn
 
 			inline ClientApplication& GetApp();
 			inline const ClientApplication& GetApp() const;
+			inline const ClockSync& GetClockSync() const;
 			inline const ConnectionInfo& GetConnectionInfo() const;
 			inline const NetworkStringStore& GetNetworkStringStore() const;
 			inline std::size_t GetPeerId() const;
@@ -48,14 +51,13 @@ namespace ewn
 
 			template<typename T> void SendPacket(const T& packet);
 
-			inline void UpdateServerTimeDelta(Nz::UInt64 deltaTime);
-
 			ServerConnection& operator=(const ServerConnection&) = delete;
 			ServerConnection& operator=(ServerConnection&&) = delete;
 
 			NazaraSignal(OnConnected,            ServerConnection* /*server*/, Nz::UInt32 /*data*/);
 			NazaraSignal(OnConnectionInfoUpdate, ServerConnection* /*server*/, const ConnectionInfo& /*info*/);
 			NazaraSignal(OnDisconnected,         ServerConnection* /*server*/, Nz::UInt32 /*data*/);
+			NazaraSignal(OnRoundTrip,            ServerConnection* /*server*/, Nz::UInt64 /*roundTripTime*/); //< microseconds, measured by clock synchronization
 
 			// Packet reception signals
 			NazaraSignal(OnArenaList,                 ServerConnection* /*server*/, const Packets::ArenaList&                 /*data*/);
@@ -64,21 +66,25 @@ namespace ewn
 			NazaraSignal(OnArenaSounds,               ServerConnection* /*server*/, const Packets::ArenaSounds&               /*data*/);
 			NazaraSignal(OnArenaState,                ServerConnection* /*server*/, const Packets::ArenaState&                /*data*/);
 			NazaraSignal(OnBotMessage,                ServerConnection* /*server*/, const Packets::BotMessage&                /*data*/);
+			NazaraSignal(OnCachedPacketVersion,       ServerConnection* /*server*/, const Packets::CachedPacketVersion&       /*data*/);
 			NazaraSignal(OnChatMessage,               ServerConnection* /*server*/, const Packets::ChatMessage&               /*data*/);
 			NazaraSignal(OnControlEntity,             ServerConnection* /*server*/, const Packets::ControlEntity&             /*data*/);
 			NazaraSignal(OnCreateEntities,            ServerConnection* /*server*/, const Packets::CreateEntities&            /*data*/);
 			NazaraSignal(OnCreateFleetFailure,        ServerConnection* /*server*/, const Packets::CreateFleetFailure&        /*data*/);
 			NazaraSignal(OnCreateFleetSuccess,        ServerConnection* /*server*/, const Packets::CreateFleetSuccess&        /*data*/);
+			NazaraSignal(OnCreateProjectiles,         ServerConnection* /*server*/, const Packets::CreateProjectiles&         /*data*/);
 			NazaraSignal(OnCreateSpaceshipFailure,    ServerConnection* /*server*/, const Packets::CreateSpaceshipFailure&    /*data*/);
 			NazaraSignal(OnCreateSpaceshipSuccess,    ServerConnection* /*server*/, const Packets::CreateSpaceshipSuccess&    /*data*/);
 			NazaraSignal(OnDeleteEntities,            ServerConnection* /*server*/, const Packets::DeleteEntities&            /*data*/);
 			NazaraSignal(OnDeleteFleetFailure,        ServerConnection* /*server*/, const Packets::DeleteFleetFailure&        /*data*/);
 			NazaraSignal(OnDeleteFleetSuccess,        ServerConnection* /*server*/, const Packets::DeleteFleetSuccess&        /*data*/);
+			NazaraSignal(OnDeleteProjectiles,         ServerConnection* /*server*/, const Packets::DeleteProjectiles&         /*data*/);
 			NazaraSignal(OnDeleteSpaceshipFailure,    ServerConnection* /*server*/, const Packets::DeleteSpaceshipFailure&    /*data*/);
 			NazaraSignal(OnDeleteSpaceshipSuccess,    ServerConnection* /*server*/, const Packets::DeleteSpaceshipSuccess&    /*data*/);
 			NazaraSignal(OnFleetInfo,                 ServerConnection* /*server*/, const Packets::FleetInfo&                 /*data*/);
 			NazaraSignal(OnFleetList,                 ServerConnection* /*server*/, const Packets::FleetList&                 /*data*/);
 			NazaraSignal(OnHullList,                  ServerConnection* /*server*/, const Packets::HullList&                  /*data*/);
+			NazaraSignal(OnInstantiateEffects,        ServerConnection* /*server*/, const Packets::InstantiateEffects&        /*data*/);
 			NazaraSignal(OnInstantiateParticleSystem, ServerConnection* /*server*/, const Packets::InstantiateParticleSystem& /*data*/);
 			NazaraSignal(OnIntegrityUpdate,           ServerConnection* /*server*/, const Packets::IntegrityUpdate&           /*data*/);
 			NazaraSignal(OnLoginFailure,              ServerConnection* /*server*/, const Packets::LoginFailure&              /*data*/);
@@ -103,20 +109,42 @@ namespace ewn
 			};
 
 		private:
+			// Last version received of a packet the server may skip (see ClientSession::SendCachedPacket)
+			template<typename T>
+			struct CachedPacketEntry
+			{
+				T packet;
+				Nz::UInt32 version = 0;
+			};
+
+			void SendCachedPacketVersions();
 			inline void DispatchIncomingPacket(Nz::NetPacket&& packet);
 			inline void NotifyConnected(Nz::UInt32 data);
 			inline void NotifyDisconnected(Nz::UInt32 data);
+			void Update();
 			inline void UpdateInfo(const ConnectionInfo& connectionInfo);
 
+			void HandleArenaState(ServerConnection* server, const Packets::ArenaState& data);
+			void HandleCachedPacketVersion(ServerConnection* server, const Packets::CachedPacketVersion& data);
+			void HandleTimeSyncResponse(ServerConnection* server, const Packets::TimeSyncResponse& data);
+			template<typename T> void StoreCachedPacket(CachedPacketEntry<T>& cachedPacket, const T& data);
 			void UpdateNetworkStrings(ServerConnection* server, const Packets::NetworkStrings& data);
 
+			std::array<Nz::UInt32, PacketTypeCount> m_pendingCachedVersions;
+			CachedPacketEntry<Packets::ArenaParticleSystems> m_cachedArenaParticleSystems;
+			CachedPacketEntry<Packets::ArenaPrefabs> m_cachedArenaPrefabs;
+			CachedPacketEntry<Packets::ArenaSounds> m_cachedArenaSounds;
+			CachedPacketEntry<Packets::NetworkStrings> m_cachedNetworkStrings;
 			ClientApplication& m_application;
 			ClientCommandStore m_commandStore;
+			ClockSync m_clockSync;
 			NetworkStringStore m_stringStore;
 			NetworkReactor* m_networkReactor;
 			ConnectionInfo m_connectionInfo;
-			Nz::UInt64 m_deltaTime;
+			Nz::UInt64 m_nextTimeSyncTime;
+			Nz::UInt64 m_timeSyncRequestTime; //< microseconds, 0 if no request is pending
 			std::size_t m_peerId;
+			Nz::UInt8 m_timeSyncRequestId;
 			bool m_connected;
 	};
 }
@@ -13,10 +13,26 @@ namespace ewn
 	m_application(application),
 	m_commandStore(this),
 	m_networkReactor(nullptr),
+	m_nextTimeSyncTime(0),
+	m_timeSyncRequestTime(0),
 	m_peerId(NetworkReactor::InvalidPeerId),
+	m_timeSyncRequestId(0),
 	m_connected(false)
 	{
+		m_pendingCachedVersions.fill(0);
+
+		OnCachedPacketVersion.Connect([this](ServerConnection* server, const Packets::CachedPacketVersion& data) { HandleCachedPacketVersion(server, data); });
 		OnNetworkStrings.Connect([this](ServerConnection* server, const Packets::NetworkStrings& data) { UpdateNetworkStrings(server, data); });
+
+		// Connected first so the clock is already up to date when anyone else handles these
+		OnArenaState.Connect([this](ServerConnection* server, const Packets::ArenaState& data) { HandleArenaState(server, data); });
+		OnTimeSyncResponse.Connect([this](ServerConnection* server, const Packets::TimeSyncResponse& data) { HandleTimeSyncResponse(server, data); });
+
+		// Cached packets are kept across connections, so reconnecting to the same server doesn't download them again
+		OnArenaParticleSystems.Connect([this](ServerConnection*, const Packets::ArenaParticleSystems& data) { StoreCachedPacket(m_cachedArenaParticleSystems, data); });
+		OnArenaPrefabs.Connect([this](ServerConnection*, const Packets::ArenaPrefabs& data) { StoreCachedPacket(m_cachedArenaPrefabs, data); });
+		OnArenaSounds.Connect([this](ServerConnection*, const Packets::ArenaSounds& data) { StoreCachedPacket(m_cachedArenaSounds, data); });
+		OnNetworkStrings.Connect([this](ServerConnection*, const Packets::NetworkStrings& data) { StoreCachedPacket(m_cachedNetworkStrings, data); });
 	}
 
 	inline void ServerConnection::Disconnect(Nz::UInt32 data)
@@ -34,6 +50,11 @@ namespace ewn
 		return m_application;
 	}
 
+	inline const ClockSync& ServerConnection::GetClockSync() const
+	{
+		return m_clockSync;
+	}
+
 	inline const ServerConnection::ConnectionInfo& ServerConnection::GetConnectionInfo() const
 	{
 		return m_connectionInfo;
@@ -62,11 +83,6 @@ namespace ewn
 		m_networkReactor->QueryInfo(m_peerId);
 	}
 
-	inline void ServerConnection::UpdateServerTimeDelta(Nz::UInt64 deltaTime)
-	{
-		m_deltaTime = deltaTime;
-	}
-
 	template<typename T>
 	void ServerConnection::SendPacket(const T& packet)
 	{
@@ -81,6 +97,19 @@ namespace ewn
 		m_networkReactor->SendData(m_peerId, command.channelId, command.flags, std::move(data));
 	}
 
+	template<typename T>
+	void ServerConnection::StoreCachedPacket(CachedPacketEntry<T>& cachedPacket, const T& data)
+	{
+		Nz::UInt32& pendingVersion = m_pendingCachedVersions[static_cast<std::size_t>(T::Type)];
+		if (pendingVersion == 0)
+			return; //< Not announced as cacheable (or replayed from the cache)
+
+		cachedPacket.packet = data;
+		cachedPacket.version = pendingVersion;
+
+		pendingVersion = 0;
+	}
+
 	inline void ServerConnection::DispatchIncomingPacket(Nz::NetPacket&& packet)
 	{
 		m_commandStore.UnserializePacket(this, std::move(packet));
@@ -90,6 +119,13 @@ namespace ewn
 	{
 		m_connected = true;
 
+		// Another server means another clock
+		m_clockSync.Reset();
+		m_nextTimeSyncTime = 0;
+		m_timeSyncRequestTime = 0;
+
+		SendCachedPacketVersions();
+
 		OnConnected(this, data);
 	}
 
@@ -97,6 +133,7 @@ namespace ewn
 	{
 		m_connected = false;
 		m_peerId = NetworkReactor::InvalidPeerId;
+		m_pendingCachedVersions.fill(0);
 		m_stringStore.Clear();
 
 		OnDisconnected(this, data);
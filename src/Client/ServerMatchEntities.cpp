@@ -21,29 +21,38 @@
 #include <NDK/Components.hpp>
 #include <Client/ClientApplication.hpp>
 #include <Client/Components/SoundEmitterComponent.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Utils.hpp>
+#include <algorithm>
 #include <iostream>
 
 namespace ewn
 {
 	static constexpr bool showServerGhosts = false;
 
+	namespace
+	{
+		constexpr float InitialSnapshotDelay = 5 * 1000.f / 30.f; //< Five snapshots, until the network has been measured
+	}
+
 	ServerMatchEntities::ServerMatchEntities(ClientApplication* app, ServerConnection* server, Ndk::WorldHandle world) :
-	m_jitterBuffer(m_jitterBufferData.begin(), m_jitterBufferData.end()),
 	m_world(std::move(world)),
+	m_delayEstimator(InitialSnapshotDelay),
+	m_predictedEntityId(0),
 	m_app(app),
 	m_server(server),
 	m_stateHandlingEnabled(true),
-	m_correctionAccumulator(0.f),
-	m_snapshotUpdateAccumulator(0.f)
+	m_correctionAccumulator(0.f)
 	{
-		m_snapshotDelay = m_jitterBuffer.size() * 1000 / 30 /* + ping? */;
-
 		m_onArenaParticleSystemsSlot.Connect(server->OnArenaParticleSystems, this, &ServerMatchEntities::OnArenaParticleSystems);
 		m_onArenaPrefabsSlot.Connect(server->OnArenaPrefabs, this, &ServerMatchEntities::OnArenaPrefabs);
 		m_onArenaSoundsSlot.Connect(server->OnArenaSounds, this,   &ServerMatchEntities::OnArenaSounds);
 		m_onArenaStateSlot.Connect(server->OnArenaState, this,     &ServerMatchEntities::OnArenaState);
 		m_onCreateEntitySlot.Connect(server->OnCreateEntities, this, &ServerMatchEntities::OnCreateEntities);
+		m_onCreateProjectilesSlot.Connect(server->OnCreateProjectiles, this, &ServerMatchEntities::OnCreateProjectiles);
 		m_onDeleteEntitySlot.Connect(server->OnDeleteEntities, this, &ServerMatchEntities::OnDeleteEntities);
+		m_onDeleteProjectilesSlot.Connect(server->OnDeleteProjectiles, this, &ServerMatchEntities::OnDeleteProjectiles);
+		m_onInstantiateEffectsSlot.Connect(server->OnInstantiateEffects, this, &ServerMatchEntities::OnInstantiateEffects);
 		m_onInstantiateParticleSystemSlot.Connect(server->OnInstantiateParticleSystem, this, &ServerMatchEntities::OnInstantiateParticleSystem);
 		m_onPlaySoundSlot.Connect(server->OnPlaySound, this,       &ServerMatchEntities::OnPlaySound);
 
@@ -77,19 +86,56 @@ namespace ewn
 		}
 	}
 
+	void ServerMatchEntities::DisablePrediction()
+	{
+		m_prediction.reset();
+	}
+
+	void ServerMatchEntities::EnablePrediction(std::size_t id)
+	{
+		ServerEntity& data = GetServerEntity(id);
+
+		auto& entityPhys = data.entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+		SpaceshipMovement::State initialState;
+		initialState.angularVelocity = entityPhys.GetAngularVelocity();
+		initialState.linearVelocity = entityPhys.GetLinearVelocity();
+		initialState.position = entityPhys.GetPosition();
+		initialState.rotation = entityPhys.GetRotation();
+
+		// We don't know the spaceship collider the server computes inertia from, use the model bounding box instead
+		SpaceshipMovement::Parameters parameters;
+		if (data.entity->HasComponent<Ndk::GraphicsComponent>())
+		{
+			auto& entityGfx = data.entity->GetComponent<Ndk::GraphicsComponent>();
+
+			Nz::Vector3f size = entityGfx.GetBoundingVolume().obb.localBox.GetLengths();
+			if (size.x > 0.f && size.y > 0.f && size.z > 0.f)
+				parameters.inertia = SpaceshipMovement::ComputeBoxInertia(parameters.mass, size);
+		}
+
+		m_prediction.emplace(parameters, initialState);
+		m_predictedEntityId = id;
+	}
+
+	void ServerMatchEntities::PredictInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation)
+	{
+		if (!m_prediction)
+			return;
+
+		m_prediction->PushInput(inputTime, direction, rotation);
+		ApplyPrediction();
+	}
+
 	void ServerMatchEntities::Update(float elapsedTime)
 	{
+		m_delayEstimator.Update(elapsedTime);
+
 		HandlePlayingSounds();
+		UpdateProjectiles();
 
 		if (m_stateHandlingEnabled)
-		{
-			Nz::UInt64 serverTime = m_server->EstimateServerTime();
-			if (!m_jitterBuffer.empty() && serverTime >= m_jitterBuffer.front().applyTime)
-			{
-				ApplySnapshot(m_jitterBuffer.front());
-				m_jitterBuffer.pop_back();
-			}
-		}
+			InterpolateEntities(GetDisplayTime());
 
 		constexpr float errorCorrectionInterval = 1.f / 60.f;
 
@@ -144,8 +190,8 @@ namespace ewn
 			if (m_debugStateSocket.ReceivePacket(&packet, nullptr))
 			{
 				Packets::ArenaState arenaState;
-				PacketSerializer serializer(packet, false);
-				Packets::Serialize(serializer, arenaState);
+				PacketReader reader(packet);
+				Packets::Unserialize(reader, arenaState);
 
 				for (auto& serverData : arenaState.entities)
 				{
@@ -254,6 +300,46 @@ namespace ewn
 		}
 	}
 
+	void ServerMatchEntities::InstantiateParticleSystem(std::size_t particleSystemId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
+	{
+		ParticleSystem& particleSystem = m_particleSystems[particleSystemId];
+		for (const auto& particleGroup : particleSystem.particleGroups)
+			particleGroup.instantiate(particleGroup.particleGroup, position, rotation);
+	}
+
+	void ServerMatchEntities::InstantiateSound(std::size_t soundId, const Nz::Vector3f& position)
+	{
+		Nz::Sound& sound = m_playingSounds.emplace_back();
+		sound.SetBuffer(m_soundLibrary[soundId]);
+		sound.EnableSpatialization(true);
+		sound.SetPosition(position);
+		sound.SetMinDistance(50.f);
+
+		sound.Play();
+	}
+
+	void ServerMatchEntities::UpdateProjectiles()
+	{
+		// Projectiles are displayed with the same delay as snapshot-driven entities
+		Nz::UInt64 displayTime = GetDisplayTime();
+
+		for (auto it = m_projectiles.begin(); it != m_projectiles.end();)
+		{
+			if (displayTime >= it->expirationTime)
+			{
+				it = m_projectiles.erase(it);
+				continue;
+			}
+
+			float elapsedTime = (displayTime > it->spawnTime) ? (displayTime - it->spawnTime) / 1000.f : 0.f;
+
+			auto& projectileNode = it->entity->GetComponent<Ndk::NodeComponent>();
+			projectileNode.SetPosition(it->origin + it->velocity * elapsedTime);
+
+			++it;
+		}
+	}
+
 	void ServerMatchEntities::OnArenaPrefabs(ServerConnection* server, const Packets::ArenaPrefabs& arenaPrefabs)
 	{
 		m_prefabs.erase(m_prefabs.begin() + arenaPrefabs.startId, m_prefabs.end());
@@ -306,7 +392,7 @@ namespace ewn
 				if (Nz::ModelRef model = Nz::ModelManager::Get(filePath))
 					graphicsComponent.Attach(model, transformMatrix);
 				else
-					std::cerr << "Failed to load " << filePath << std::endl;
+					LogError(LogCategory::Client) << "Failed to load " << filePath;
 			}
 
 			auto& physComponent = entity->AddComponent<Ndk::PhysicsComponent3D>();
@@ -697,7 +783,7 @@ namespace ewn
 
 			Nz::SoundBufferRef soundBuffer = Nz::SoundBuffer::LoadFromFile(filePath, fileParams);
 			if (!soundBuffer)
-				std::cerr << "Failed to load " << filePath << std::endl;
+				LogError(LogCategory::Client) << "Failed to load " << filePath;
 
 			m_soundLibrary.emplace_back(std::move(soundBuffer));
 		}
@@ -705,31 +791,55 @@ namespace ewn
 
 	void ServerMatchEntities::OnArenaState(ServerConnection* server, const Packets::ArenaState& arenaState)
 	{
-		// For now, allocate a new snapshot, we will recycle them in a further iteration (to prevent memory allocation)
-		Snapshot snapshot;
-		snapshot.entities.resize(arenaState.entities.size());
-		for (std::size_t i = 0; i < snapshot.entities.size(); ++i)
+		m_delayEstimator.OnSnapshot(arenaState.stateId, arenaState.serverTime, m_app->GetAppTime());
+
+		for (const Packets::ArenaState::Entity& packetEntity : arenaState.entities)
 		{
-			Snapshot::Entity& entity = snapshot.entities[i];
-			const Packets::ArenaState::Entity& packetEntity = arenaState.entities[i];
-
-			entity.id = packetEntity.id;
-			entity.angularVelocity = packetEntity.angularVelocity;
-			entity.linearVelocity = packetEntity.linearVelocity;
-			entity.position = packetEntity.position;
-			entity.rotation = packetEntity.rotation;
-		}
+			if (!IsServerEntityValid(packetEntity.id))
+				continue;
+
+			// Our own spaceship isn't displayed in the past, we're already ahead of the server for it
+			if (m_prediction && packetEntity.id == m_predictedEntityId)
+			{
+				if (!m_stateHandlingEnabled)
+					continue;
+
+				SpaceshipMovement::State serverState;
+				serverState.angularVelocity = packetEntity.angularVelocity;
+				serverState.linearVelocity = packetEntity.linearVelocity;
+				serverState.position = packetEntity.position;
+				serverState.rotation = packetEntity.rotation;
 
-		snapshot.applyTime = arenaState.serverTime + m_snapshotDelay;
-		snapshot.stateId = arenaState.stateId;
+				// Inputs are timestamped when sent but processed by the server a one-way trip later, express the state time the same way
+				Nz::UInt64 halfPing = server->GetConnectionInfo().ping / 2;
+				Nz::UInt64 stateTime = (arenaState.serverTime > halfPing) ? arenaState.serverTime - halfPing : 0;
 
-		m_jitterBuffer.push_back(std::move(snapshot));
+				m_prediction->Reconcile(stateTime, arenaState.lastProcessedInputTime, serverState);
+				ApplyPrediction();
+				continue;
+			}
+
+			StateSample sample;
+			sample.serverTime = arenaState.serverTime;
+			sample.angularVelocity = packetEntity.angularVelocity;
+			sample.linearVelocity = packetEntity.linearVelocity;
+			sample.position = packetEntity.position;
+			sample.rotation = packetEntity.rotation;
+
+			PushStateSample(GetServerEntity(packetEntity.id), sample);
+		}
 	}
 
 	void ServerMatchEntities::OnCreateEntities(ServerConnection*, const Packets::CreateEntities& createPacket)
 	{
 		for (const auto& entityData : createPacket.entities)
 		{
+			if (!IsPrefabValid(entityData.prefabId))
+			{
+				LogWarning(LogCategory::Client) << "Entity #" << Nz::UInt32(entityData.entityId) << " uses unknown prefab #" << Nz::UInt32(entityData.prefabId) << ", ignoring it";
+				continue;
+			}
+
 			ServerEntity& data = CreateServerEntity(entityData.entityId);
 
 			data.positionError = Nz::Vector3f::Zero();
@@ -774,10 +884,47 @@ namespace ewn
 		}
 	}
 
+	void ServerMatchEntities::OnCreateProjectiles(ServerConnection*, const Packets::CreateProjectiles& createPacket)
+	{
+		for (const auto& projectileData : createPacket.projectiles)
+		{
+			if (!IsPrefabValid(projectileData.prefabId))
+			{
+				LogWarning(LogCategory::Client) << "Projectile #" << Nz::UInt32(projectileData.projectileId) << " uses unknown prefab #" << Nz::UInt32(projectileData.prefabId) << ", ignoring it";
+				continue;
+			}
+
+			Projectile& projectile = m_projectiles.emplace_back();
+			projectile.entity = m_prefabs[projectileData.prefabId]->Clone();
+			projectile.expirationTime = projectileData.spawnTime + static_cast<Nz::UInt64>(projectileData.lifeTime * 1000.f);
+			projectile.origin = projectileData.origin;
+			projectile.projectileId = projectileData.projectileId;
+			projectile.spawnTime = projectileData.spawnTime;
+			projectile.velocity = projectileData.direction * projectileData.speed;
+
+			// Projectiles are moved along their trajectory, they don't need a physics body
+			projectile.entity->RemoveComponent<Ndk::PhysicsComponent3D>();
+
+			auto& projectileNode = projectile.entity->GetComponent<Ndk::NodeComponent>();
+			projectileNode.SetPosition(projectileData.origin);
+			projectileNode.SetRotation(Nz::Quaternionf::RotationBetween(Nz::Vector3f::Forward(), projectileData.direction));
+
+			if (projectile.entity->HasComponent<SoundEmitterComponent>())
+			{
+				auto& soundEmitter = projectile.entity->GetComponent<SoundEmitterComponent>();
+				soundEmitter.Play();
+			}
+		}
+	}
+
 	void ServerMatchEntities::OnDeleteEntities(ServerConnection*, const Packets::DeleteEntities& deletePacket)
 	{
 		for (std::size_t entityId : deletePacket.entities)
 		{
+			// The server streams the world after joining, an entity may be deleted before we received it
+			if (!IsServerEntityValid(entityId))
+				continue;
+
 			ServerEntity& data = GetServerEntity(entityId);
 
 			if (data.debugGhostEntity)
@@ -793,63 +940,137 @@ namespace ewn
 		}
 	}
 
-	void ServerMatchEntities::OnInstantiateParticleSystem(ServerConnection* server, const Packets::InstantiateParticleSystem& instantiatePacket)
+	void ServerMatchEntities::OnDeleteProjectiles(ServerConnection*, const Packets::DeleteProjectiles& deletePacket)
 	{
-		ParticleSystem& particleSystem = m_particleSystems[instantiatePacket.particleSystemId];
-		for (const auto& particleGroup : particleSystem.particleGroups)
+		// The server notifies us when a projectile hits something, make it disappear when our display time reaches that point
+		Nz::UInt64 serverTime = m_server->EstimateServerTime();
+
+		for (Nz::UInt32 projectileId : deletePacket.projectiles)
 		{
-			particleGroup.instantiate(particleGroup.particleGroup, instantiatePacket.position, instantiatePacket.rotation);
+			auto it = std::find_if(m_projectiles.begin(), m_projectiles.end(), [&](const Projectile& projectile) { return projectile.projectileId == projectileId; });
+			if (it != m_projectiles.end())
+				it->expirationTime = std::min(it->expirationTime, serverTime);
 		}
 	}
 
+	void ServerMatchEntities::OnInstantiateEffects(ServerConnection* server, const Packets::InstantiateEffects& instantiatePacket)
+	{
+		for (const auto& particleSystemData : instantiatePacket.particleSystems)
+			InstantiateParticleSystem(particleSystemData.particleSystemId, particleSystemData.position, particleSystemData.rotation);
+
+		for (const auto& soundData : instantiatePacket.sounds)
+			InstantiateSound(soundData.soundId, soundData.position);
+	}
+
+	void ServerMatchEntities::OnInstantiateParticleSystem(ServerConnection* server, const Packets::InstantiateParticleSystem& instantiatePacket)
+	{
+		InstantiateParticleSystem(instantiatePacket.particleSystemId, instantiatePacket.position, instantiatePacket.rotation);
+	}
+
 	void ServerMatchEntities::OnPlaySound(ServerConnection* server, const Packets::PlaySound& playSound)
 	{
-		Nz::Sound& sound = m_playingSounds.emplace_back();
-		sound.SetBuffer(m_soundLibrary[playSound.soundId]);
-		sound.EnableSpatialization(true);
-		sound.SetPosition(playSound.position);
-		sound.SetMinDistance(50.f);
+		InstantiateSound(playSound.soundId, playSound.position);
+	}
 
-		sound.Play();
+	void ServerMatchEntities::ApplyPrediction()
+	{
+		if (!IsServerEntityValid(m_predictedEntityId))
+			return;
+
+		ServerEntity& data = GetServerEntity(m_predictedEntityId);
+
+		auto& entityPhys = data.entity->GetComponent<Ndk::PhysicsComponent3D>();
+
+		const SpaceshipMovement::State& predictedState = m_prediction->GetState();
+
+		// Corrections are smoothed the same way as snapshots
+		data.positionError += entityPhys.GetPosition() - predictedState.position;
+		data.rotationError = data.rotationError * predictedState.rotation.GetConjugate() * entityPhys.GetRotation();
+
+		entityPhys.SetAngularVelocity(predictedState.angularVelocity);
+		entityPhys.SetLinearVelocity(predictedState.linearVelocity);
+		entityPhys.SetPosition(predictedState.position);
+		entityPhys.SetRotation(predictedState.rotation);
 	}
 
-	void ServerMatchEntities::ApplySnapshot(const Snapshot& snapshot)
+	void ServerMatchEntities::InterpolateEntities(Nz::UInt64 displayTime)
 	{
-		//std::cout << "Applied snapshot #" << snapshot.stateId << " after " << (m_server->EstimateServerTime() - snapshot.applyTime) << "ms" << std::endl;
-		for (const Snapshot::Entity& entityData : snapshot.entities)
+		for (ServerEntity& data : m_serverEntities)
 		{
-			if (!IsServerEntityValid(entityData.id))
+			if (!data.isValid || data.stateSampleCount == 0)
 				continue;
 
-			ServerEntity& data = GetServerEntity(entityData.id);
+			if (m_prediction && data.serverId == m_predictedEntityId)
+				continue;
+
+			// Only keep the last state before display time and the ones after it
+			auto samplesBegin = data.stateSamples.begin();
+
+			std::size_t firstSample = 0;
+			while (firstSample + 1 < data.stateSampleCount && data.stateSamples[firstSample + 1].serverTime <= displayTime)
+				firstSample++;
+
+			if (firstSample > 0)
+			{
+				std::move(samplesBegin + firstSample, samplesBegin + data.stateSampleCount, samplesBegin);
+				data.stateSampleCount -= firstSample;
+			}
+
+			const StateSample& from = data.stateSamples[0];
+			if (from.serverTime > displayTime)
+				continue; //< Entity appeared after display time, keep its creation state
 
-			auto& entityNode = data.entity->GetComponent<Ndk::NodeComponent>();
 			auto& entityPhys = data.entity->GetComponent<Ndk::PhysicsComponent3D>();
 
-			// Compute visual error
-			Nz::Quaternionf visualRotation = entityNode.GetRotation();
-			Nz::Vector3f visualPosition = entityNode.GetPosition();
+			// Next state may be late, the entity then keeps moving for a while
+			bool isExtrapolating;
+			StateSample state = SnapshotInterpolation::Sample(data.stateSamples.data(), data.stateSampleCount, displayTime, &isExtrapolating);
 
-			/*data.positionError = Nz::Vector3f::Zero();
-			data.rotationError = Nz::Quaternionf::Identity();*/
+			// Physics state holds where extrapolation went, smooth the way back
+			if (data.isExtrapolating && !isExtrapolating)
+			{
+				data.positionError += entityPhys.GetPosition() - state.position;
+				data.rotationError = data.rotationError * state.rotation.GetConjugate() * entityPhys.GetRotation();
+			}
 
-			data.positionError += entityPhys.GetPosition() - entityData.position;
-			data.rotationError = data.rotationError * entityData.rotation.GetConjugate() * entityPhys.GetRotation();
+			data.isExtrapolating = isExtrapolating;
 
-			/*if (float diff = Nz::Vector3f::Distance(entityPhys.GetPosition() + data.positionError, visualPosition); diff > 0.0001f)
-				std::cout << "Distance: " << Nz::Vector3f::Distance(entityPhys.GetPosition() + data.positionError, visualPosition) << std::endl;
+			entityPhys.SetAngularVelocity(state.angularVelocity);
+			entityPhys.SetLinearVelocity(state.linearVelocity);
+			entityPhys.SetPosition(state.position);
+			entityPhys.SetRotation(state.rotation);
+		}
+	}
 
-			Nz::Quaternionf test = visualRotation * (entityPhys.GetRotation() * data.rotationError).GetInverse();
-			Nz::Vector3f testVec(test.x, test.y, test.z);
+	void ServerMatchEntities::PushStateSample(ServerEntity& entityData, const StateSample& sample)
+	{
+		auto samplesBegin = entityData.stateSamples.begin();
+		auto samplesEnd = samplesBegin + entityData.stateSampleCount;
 
-			if (float diff = std::atan2(testVec.GetLength(), test.w); diff > 0.0001f)
-				std::cout << "Rotation: " << diff << std::endl;*/
+		// Snapshots may arrive out of order
+		auto it = std::upper_bound(samplesBegin, samplesEnd, sample.serverTime, [](Nz::UInt64 serverTime, const StateSample& stateSample)
+		{
+			return serverTime < stateSample.serverTime;
+		});
 
-			// Hard apply physics state
-			entityPhys.SetAngularVelocity(entityData.angularVelocity);
-			entityPhys.SetLinearVelocity(entityData.linearVelocity);
-			entityPhys.SetPosition(entityData.position);
-			entityPhys.SetRotation(entityData.rotation);
+		if (it != samplesBegin && std::prev(it)->serverTime == sample.serverTime)
+			return;
+
+		if (entityData.stateSampleCount == MaxStateSamples)
+		{
+			// Drop the oldest state to make room
+			if (it == samplesBegin)
+				return;
+
+			std::move(samplesBegin + 1, it, samplesBegin);
+			*std::prev(it) = sample;
+		}
+		else
+		{
+			std::move_backward(it, samplesEnd, samplesEnd + 1);
+			*it = sample;
+
+			entityData.stateSampleCount++;
 		}
 	}
 }
@@ -16,8 +16,11 @@
 #include <NDK/World.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/ServerConnection.hpp>
-#include <nonstd/ring_span.hpp>
+#include <Client/SnapshotDelayEstimator.hpp>
+#include <Client/SnapshotInterpolation.hpp>
+#include <Client/SpaceshipPrediction.hpp>
 #include <array>
+#include <optional>
 #include <random>
 #include <vector>
 
@@ -29,31 +32,44 @@ namespace ewn
 	{
 		public:
 			struct ServerEntity;
+			using StateSample = SnapshotInterpolation::State;
 
 			ServerMatchEntities(ClientApplication* app, ServerConnection* server, Ndk::WorldHandle world);
 			ServerMatchEntities(const ServerMatchEntities&) = delete;
 			ServerMatchEntities(ServerMatchEntities&&) = delete;
 			~ServerMatchEntities();
 
+			void DisablePrediction();
+
+			void EnablePrediction(std::size_t id);
 			inline void EnableSnapshotHandling(bool enable);
 			inline ServerEntity& GetServerEntity(std::size_t id);
 			inline std::size_t GetServerEntityCount() const;
+			inline const SnapshotDelayEstimator& GetSnapshotDelayEstimator() const;
 			inline bool IsSnapshotHandlingEnabled() const;
 			inline bool IsServerEntityValid(std::size_t id) const;
 
+			void PredictInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation);
+
 			void Update(float elapsedTime);
 
 			ServerMatchEntities& operator=(const ServerMatchEntities&) = delete;
 			ServerMatchEntities& operator=(ServerMatchEntities&&) = delete;
 
+			static constexpr std::size_t MaxStateSamples = 8;
+
 			struct ServerEntity
 			{
+				// Snapshots only contain the entities with the highest priority, so each entity keeps its own states, sorted by time
+				std::array<StateSample, MaxStateSamples> stateSamples;
+				std::size_t stateSampleCount = 0;
 				Ndk::EntityHandle debugGhostEntity;
 				Ndk::EntityHandle entity;
 				Ndk::EntityHandle textEntity;
 				Nz::Quaternionf rotationError;
 				Nz::Vector3f positionError;
 				Nz::UInt32 serverId;
+				bool isExtrapolating = false;
 				bool isValid = false;
 				std::string name; //< remove asap, used for temporary client-side radar
 			};
@@ -62,22 +78,30 @@ namespace ewn
 			NazaraSignal(OnEntityDelete,  ServerMatchEntities* /*emitter*/, ServerEntity& /*entity*/);
 
 		private:
-			struct Snapshot;
-
 			inline ServerEntity& CreateServerEntity(Nz::UInt32 id);
 			void FillVisualEffectFactory();
+			inline Nz::UInt64 GetDisplayTime() const;
 			void HandlePlayingSounds();
+			void InstantiateParticleSystem(std::size_t particleSystemId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
+			void InstantiateSound(std::size_t soundId, const Nz::Vector3f& position);
+			void InterpolateEntities(Nz::UInt64 displayTime);
+			inline bool IsPrefabValid(std::size_t prefabId) const;
+			static void PushStateSample(ServerEntity& entityData, const StateSample& sample);
+			void UpdateProjectiles();
 
 			void OnArenaPrefabs(ServerConnection* server, const Packets::ArenaPrefabs& arenaPrefabs);
 			void OnArenaParticleSystems(ServerConnection* server, const Packets::ArenaParticleSystems& arenaParticleSystems);
 			void OnArenaSounds(ServerConnection* server, const Packets::ArenaSounds& arenaSounds);
 			void OnArenaState(ServerConnection* server, const Packets::ArenaState& arenaState);
 			void OnCreateEntities(ServerConnection* server, const Packets::CreateEntities& createPacket);
+			void OnCreateProjectiles(ServerConnection* server, const Packets::CreateProjectiles& createPacket);
 			void OnDeleteEntities(ServerConnection* server, const Packets::DeleteEntities& deletePacket);
+			void OnDeleteProjectiles(ServerConnection* server, const Packets::DeleteProjectiles& deletePacket);
+			void OnInstantiateEffects(ServerConnection* server, const Packets::InstantiateEffects& instantiatePacket);
 			void OnInstantiateParticleSystem(ServerConnection* server, const Packets::InstantiateParticleSystem& instantiatePacket);
 			void OnPlaySound(ServerConnection* server, const Packets::PlaySound& playSound);
 
-			void ApplySnapshot(const Snapshot& snapshot);
+			void ApplyPrediction();
 
 			struct ParticleSystem
 			{
@@ -91,20 +115,14 @@ namespace ewn
 				std::vector<ParticleGroup> particleGroups;
 			};
 
-			struct Snapshot
+			struct Projectile
 			{
-				struct Entity
-				{
-					Nz::UInt32 id;
-					Nz::Vector3f angularVelocity;
-					Nz::Vector3f linearVelocity;
-					Nz::Vector3f position;
-					Nz::Quaternionf rotation;
-				};
-
-				Nz::UInt64 applyTime;
-				Nz::UInt16 stateId;
-				std::vector<Entity> entities;
+				Ndk::EntityOwner entity;
+				Nz::UInt32 projectileId;
+				Nz::UInt64 expirationTime;
+				Nz::UInt64 spawnTime;
+				Nz::Vector3f origin;
+				Nz::Vector3f velocity;
 			};
 
 			NazaraSlot(ServerConnection, OnArenaParticleSystems,      m_onArenaParticleSystemsSlot);
@@ -112,29 +130,32 @@ namespace ewn
 			NazaraSlot(ServerConnection, OnArenaSounds,               m_onArenaSoundsSlot);
 			NazaraSlot(ServerConnection, OnArenaState,                m_onArenaStateSlot);
 			NazaraSlot(ServerConnection, OnCreateEntities,            m_onCreateEntitySlot);
+			NazaraSlot(ServerConnection, OnCreateProjectiles,         m_onCreateProjectilesSlot);
 			NazaraSlot(ServerConnection, OnDeleteEntities,            m_onDeleteEntitySlot);
+			NazaraSlot(ServerConnection, OnDeleteProjectiles,         m_onDeleteProjectilesSlot);
+			NazaraSlot(ServerConnection, OnInstantiateEffects,        m_onInstantiateEffectsSlot);
 			NazaraSlot(ServerConnection, OnInstantiateParticleSystem, m_onInstantiateParticleSystemSlot);
 			NazaraSlot(ServerConnection, OnPlaySound,                 m_onPlaySoundSlot);
 
 			using PrefabFactoryFunction = std::function<void(ClientApplication* app, const Ndk::EntityHandle& entity)>;
 
-			std::array<Snapshot, 5> m_jitterBufferData;
-			nonstd::ring_span<Snapshot> m_jitterBuffer;
 			std::mt19937 m_randomGenerator;
+			std::optional<SpaceshipPrediction> m_prediction;
 			std::unordered_map<std::string, PrefabFactoryFunction> m_visualEffectFactory;
 			std::vector<Ndk::EntityOwner> m_prefabs;
 			std::vector<Nz::Sound> m_playingSounds;
 			std::vector<ParticleSystem> m_particleSystems;
+			std::vector<Projectile> m_projectiles;
 			std::vector<Nz::SoundBufferRef> m_soundLibrary;
 			std::vector<ServerEntity> m_serverEntities;
 			Ndk::WorldHandle m_world;
 			Nz::UdpSocket m_debugStateSocket;
-			Nz::UInt64 m_snapshotDelay;
+			SnapshotDelayEstimator m_delayEstimator;
+			std::size_t m_predictedEntityId;
 			ClientApplication* m_app;
 			ServerConnection* m_server;
 			bool m_stateHandlingEnabled;
 			float m_correctionAccumulator;
-			float m_snapshotUpdateAccumulator;
 	};
 }
 
@@ -20,11 +20,22 @@ namespace ewn
 		assert(!data.isValid);
 
 		data.serverId = id;
+		data.stateSampleCount = 0;
+		data.isExtrapolating = false;
 		data.isValid = true;
 
 		return data;
 	}
 
+	// Server time at which entities are displayed, late enough to have received the states around it
+	inline Nz::UInt64 ServerMatchEntities::GetDisplayTime() const
+	{
+		Nz::UInt64 serverTime = m_server->EstimateServerTime();
+		Nz::UInt64 delay = static_cast<Nz::UInt64>(m_delayEstimator.GetDelay());
+
+		return (serverTime > delay) ? serverTime - delay : 0;
+	}
+
 	inline ServerMatchEntities::ServerEntity& ServerMatchEntities::GetServerEntity(std::size_t id)
 	{
 		assert(IsServerEntityValid(id));
@@ -36,11 +47,22 @@ namespace ewn
 		return m_serverEntities.size();
 	}
 
+	inline const SnapshotDelayEstimator& ServerMatchEntities::GetSnapshotDelayEstimator() const
+	{
+		return m_delayEstimator;
+	}
+
 	inline bool ServerMatchEntities::IsSnapshotHandlingEnabled() const
 	{
 		return m_stateHandlingEnabled;
 	}
 
+	// Prefab ids come from the network, the prefab list may be stale or the packet malformed
+	inline bool ServerMatchEntities::IsPrefabValid(std::size_t prefabId) const
+	{
+		return prefabId < m_prefabs.size() && m_prefabs[prefabId];
+	}
+
 	inline bool ServerMatchEntities::IsServerEntityValid(std::size_t id) const
 	{
 		return id < m_serverEntities.size() && m_serverEntities[id].isValid;
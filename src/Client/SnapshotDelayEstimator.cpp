@@ -0,0 +1,93 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/SnapshotDelayEstimator.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr float DelayDecreaseRate = 20.f;  //< ms per second, display time runs 2% faster while catching up
+		constexpr float DelayIncreaseRate = 100.f; //< ms per second, display time runs 10% slower while falling back
+		constexpr float JitterFactor = 3.f;
+		constexpr float MaxBridgedLosses = 3.f;
+		constexpr float MissProbability = 0.01f;
+		constexpr float Smoothing = 1.f / 16.f;
+	}
+
+	SnapshotDelayEstimator::SnapshotDelayEstimator(float initialDelay) :
+	m_lastArrivalTime(0),
+	m_lastServerTime(0),
+	m_lastStateId(0),
+	m_hasReceivedSnapshot(false),
+	m_delay(initialDelay),
+	m_jitter(0.f),
+	m_lossRate(0.f),
+	m_snapshotInterval(1000.f / 30.f)
+	{
+	}
+
+	float SnapshotDelayEstimator::ComputeTargetDelay() const
+	{
+		// Interpolation needs the next snapshot to have arrived, plus a margin for arrival time variations
+		float delay = m_snapshotInterval + JitterFactor * m_jitter;
+
+		// Bridge enough consecutive losses to miss less than 1% of the time
+		if (m_lossRate > 0.001f)
+		{
+			float bridgedLosses = std::ceil(std::log(MissProbability) / std::log(m_lossRate)) - 1.f;
+			delay += Nz::Clamp(bridgedLosses, 0.f, MaxBridgedLosses) * m_snapshotInterval;
+		}
+
+		return Nz::Clamp(delay, m_snapshotInterval, MaxDelay);
+	}
+
+	void SnapshotDelayEstimator::OnSnapshot(Nz::UInt16 stateId, Nz::UInt64 serverTime, Nz::UInt64 arrivalTime)
+	{
+		if (!m_hasReceivedSnapshot)
+		{
+			m_hasReceivedSnapshot = true;
+			m_lastArrivalTime = arrivalTime;
+			m_lastServerTime = serverTime;
+			m_lastStateId = stateId;
+			return;
+		}
+
+		// Duplicated or reordered snapshot, it was already counted as lost
+		Nz::UInt16 sequenceDiff = static_cast<Nz::UInt16>(stateId - m_lastStateId);
+		if (sequenceDiff == 0 || sequenceDiff >= 0x8000 || serverTime <= m_lastServerTime)
+			return;
+
+		// Each missing state id counts as a loss, a long gap is more likely a stall than losses
+		constexpr Nz::UInt16 MaxCountedLosses = 16;
+
+		Nz::UInt16 lostCount = std::min<Nz::UInt16>(sequenceDiff - 1, MaxCountedLosses);
+		for (Nz::UInt16 i = 0; i < lostCount; ++i)
+			m_lossRate += (1.f - m_lossRate) * Smoothing;
+
+		m_lossRate -= m_lossRate * Smoothing;
+
+		float interval = float(serverTime - m_lastServerTime) / sequenceDiff;
+		m_snapshotInterval += (interval - m_snapshotInterval) * Smoothing;
+
+		// Interarrival jitter, as defined by RFC 3550
+		Nz::Int64 transitDifference = Nz::Int64(arrivalTime - m_lastArrivalTime) - Nz::Int64(serverTime - m_lastServerTime);
+		m_jitter += (std::abs(float(transitDifference)) - m_jitter) * Smoothing;
+
+		m_lastArrivalTime = arrivalTime;
+		m_lastServerTime = serverTime;
+		m_lastStateId = stateId;
+	}
+
+	void SnapshotDelayEstimator::Update(float elapsedTime)
+	{
+		float targetDelay = ComputeTargetDelay();
+		float maxChange = ((targetDelay > m_delay) ? DelayIncreaseRate : DelayDecreaseRate) * elapsedTime;
+
+		m_delay += Nz::Clamp(targetDelay - m_delay, -maxChange, maxChange);
+	}
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CLIENT_SNAPSHOTDELAYESTIMATOR_HPP
+#define EREWHON_CLIENT_SNAPSHOTDELAYESTIMATOR_HPP
+
+#include <Nazara/Prerequisites.hpp>
+
+namespace ewn
+{
+	// Measures how irregularly snapshots arrive and how many are lost, and deduces how far behind the server entities must be displayed
+	// The delay only moves progressively, so the display time never jumps back
+	class SnapshotDelayEstimator
+	{
+		public:
+			SnapshotDelayEstimator(float initialDelay);
+			~SnapshotDelayEstimator() = default;
+
+			float ComputeTargetDelay() const;
+
+			inline float GetDelay() const;
+			inline float GetJitter() const;
+			inline float GetLossRate() const;
+			inline float GetSnapshotInterval() const;
+
+			void OnSnapshot(Nz::UInt16 stateId, Nz::UInt64 serverTime, Nz::UInt64 arrivalTime);
+
+			void Update(float elapsedTime);
+
+			static constexpr float MaxDelay = 500.f;
+
+		private:
+			Nz::UInt64 m_lastArrivalTime;
+			Nz::UInt64 m_lastServerTime;
+			Nz::UInt16 m_lastStateId;
+			bool m_hasReceivedSnapshot;
+			float m_delay;
+			float m_jitter;
+			float m_lossRate;
+			float m_snapshotInterval;
+	};
+}
+
+#include <Client/SnapshotDelayEstimator.inl>
+
+#endif // EREWHON_CLIENT_SNAPSHOTDELAYESTIMATOR_HPP
@@ -0,0 +1,31 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/SnapshotDelayEstimator.hpp>
+
+namespace ewn
+{
+	// Milliseconds
+	inline float SnapshotDelayEstimator::GetDelay() const
+	{
+		return m_delay;
+	}
+
+	// Milliseconds
+	inline float SnapshotDelayEstimator::GetJitter() const
+	{
+		return m_jitter;
+	}
+
+	inline float SnapshotDelayEstimator::GetLossRate() const
+	{
+		return m_lossRate;
+	}
+
+	// Milliseconds
+	inline float SnapshotDelayEstimator::GetSnapshotInterval() const
+	{
+		return m_snapshotInterval;
+	}
+}
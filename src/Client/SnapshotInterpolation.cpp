@@ -0,0 +1,65 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/SnapshotInterpolation.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <Shared/Utils.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace ewn
+{
+	// Keeps the entity moving with its last velocities, for MaxExtrapolationTime at most
+	auto SnapshotInterpolation::Extrapolate(const State& from, Nz::UInt64 displayTime) -> State
+	{
+		float elapsedTime = std::min(displayTime - from.serverTime, MaxExtrapolationTime) / 1000.f;
+
+		State state;
+		state.serverTime = displayTime;
+		state.angularVelocity = from.angularVelocity;
+		state.linearVelocity = from.linearVelocity;
+		state.position = from.position + from.linearVelocity * elapsedTime;
+		state.rotation = IntegrateRotation(from.rotation, from.angularVelocity, elapsedTime);
+
+		return state;
+	}
+
+	auto SnapshotInterpolation::Interpolate(const State& from, const State& to, Nz::UInt64 displayTime) -> State
+	{
+		float interval = (to.serverTime - from.serverTime) / 1000.f;
+		float t = float(displayTime - from.serverTime) / (to.serverTime - from.serverTime);
+		float t2 = t * t;
+		float t3 = t2 * t;
+
+		State state;
+		state.serverTime = displayTime;
+
+		// Cubic Hermite spline, using velocities as tangents
+		state.position = (2.f * t3 - 3.f * t2 + 1.f) * from.position + (t3 - 2.f * t2 + t) * interval * from.linearVelocity +
+		                 (-2.f * t3 + 3.f * t2) * to.position + (t3 - t2) * interval * to.linearVelocity;
+
+		state.rotation = Nz::Quaternionf::Slerp(from.rotation, to.rotation, t);
+		state.angularVelocity = Nz::Lerp(from.angularVelocity, to.angularVelocity, t);
+		state.linearVelocity = Nz::Lerp(from.linearVelocity, to.linearVelocity, t);
+
+		return state;
+	}
+
+	// States must be sorted by server time, the first one being at or before display time
+	// Interpolates from the last state before display time if the next one was received, extrapolates from it otherwise
+	auto SnapshotInterpolation::Sample(const State* states, std::size_t stateCount, Nz::UInt64 displayTime, bool* isExtrapolated) -> State
+	{
+		assert(stateCount > 0 && states[0].serverTime <= displayTime);
+
+		std::size_t fromIndex = 0;
+		while (fromIndex + 1 < stateCount && states[fromIndex + 1].serverTime <= displayTime)
+			fromIndex++;
+
+		*isExtrapolated = (fromIndex + 1 == stateCount);
+		if (*isExtrapolated)
+			return Extrapolate(states[fromIndex], displayTime);
+		else
+			return Interpolate(states[fromIndex], states[fromIndex + 1], displayTime);
+	}
+}
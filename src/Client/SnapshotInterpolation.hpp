@@ -0,0 +1,45 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CLIENT_SNAPSHOTINTERPOLATION_HPP
+#define EREWHON_CLIENT_SNAPSHOTINTERPOLATION_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Quaternion.hpp>
+#include <Nazara/Math/Vector3.hpp>
+
+namespace ewn
+{
+	// Where an entity is displayed between two of its server states, or after the last one while the next one is late
+	class SnapshotInterpolation
+	{
+		public:
+			struct State;
+
+			SnapshotInterpolation() = delete;
+			~SnapshotInterpolation() = delete;
+
+			static State Extrapolate(const State& from, Nz::UInt64 displayTime);
+			static State Interpolate(const State& from, const State& to, Nz::UInt64 displayTime);
+
+			static State Sample(const State* states, std::size_t stateCount, Nz::UInt64 displayTime, bool* isExtrapolated);
+
+			struct State
+			{
+				Nz::UInt64 serverTime;
+				Nz::Quaternionf rotation;
+				Nz::Vector3f angularVelocity;
+				Nz::Vector3f linearVelocity;
+				Nz::Vector3f position;
+			};
+
+			static constexpr Nz::UInt64 MaxExtrapolationTime = 250; //< milliseconds
+	};
+}
+
+#include <Client/SnapshotInterpolation.inl>
+
+#endif // EREWHON_CLIENT_SNAPSHOTINTERPOLATION_HPP
@@ -12,6 +12,7 @@
 #include <Client/ClientApplication.hpp>
 #include <Client/MatchChatbox.hpp>
 #include <Client/ServerMatchEntities.hpp>
+#include <Shared/Logger.hpp>
 #include <string>
 
 namespace ewn
@@ -93,7 +94,7 @@ namespace ewn
 				m_controlScript.Push(elapsedTime);
 
 				if (!m_controlScript.Call(3))
-					std::cerr << "OnUpdate failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnUpdate failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -129,7 +130,7 @@ namespace ewn
 				m_controlScript.Push(botError.errorMessage);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnBotError failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnBotError failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -149,7 +150,7 @@ namespace ewn
 					PushToLua(event);
 
 					if (!m_controlScript.Call(1))
-						std::cerr << "OnKeyPressed failed: " << m_controlScript.GetLastError() << std::endl;
+						LogError(LogCategory::Script) << "OnKeyPressed failed: " << m_controlScript.GetLastError();
 				}
 				else
 					m_controlScript.Pop();
@@ -166,7 +167,7 @@ namespace ewn
 				PushToLua(event);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnKeyReleased failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnKeyReleased failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -180,7 +181,7 @@ namespace ewn
 			if (m_controlScript.GetGlobal("OnLostFocus") == Nz::LuaType_Function)
 			{
 				if (!m_controlScript.Call(0))
-					std::cerr << "OnLostFocus failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnLostFocus failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -200,7 +201,7 @@ namespace ewn
 				m_controlScript.Push(integrityPct);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnIntegrityUpdate failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnIntegrityUpdate failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -216,7 +217,7 @@ namespace ewn
 				PushToLua(event);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnMouseButtonPressed failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnMouseButtonPressed failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -232,7 +233,7 @@ namespace ewn
 				PushToLua(event);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnMouseButtonReleased failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnMouseButtonReleased failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -248,7 +249,7 @@ namespace ewn
 				PushToLua(event);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnMouseMoved failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnMouseMoved failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -266,7 +267,7 @@ namespace ewn
 					m_controlScript.PushField("height", renderTarget->GetSize().y);
 
 				if (!m_controlScript.Call(1))
-					std::cerr << "OnWindowSizeChanged failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "OnWindowSizeChanged failed: " << m_controlScript.GetLastError();
 			}
 			else
 				m_controlScript.Pop();
@@ -285,10 +286,10 @@ namespace ewn
 
 		const std::string& scriptName = m_app->GetConfig().GetStringOption("ClientScript.Filename");
 
-		std::cout << "Loading " << scriptName << std::endl;
+		LogInfo(LogCategory::Script) << "Loading " << scriptName;
 		if (!m_controlScript.ExecuteFromFile(scriptName))
 		{
-			std::cerr << "Failed to load " << scriptName << ": " << m_controlScript.GetLastError() << std::endl;
+			LogError(LogCategory::Script) << "Failed to load " << scriptName << ": " << m_controlScript.GetLastError();
 			m_executeScript = false;
 			return;
 		}
@@ -296,7 +297,7 @@ namespace ewn
 		// Check existence of some functions
 		if (m_controlScript.GetGlobal("UpdateInput") != Nz::LuaType_Function)
 		{
-			std::cerr << scriptName << ": UpdateInput is not a valid function!" << std::endl;
+			LogError(LogCategory::Script) << scriptName << ": UpdateInput is not a valid function!";
 			m_executeScript = false;
 		}
 		m_controlScript.Pop();
@@ -691,7 +692,7 @@ namespace ewn
 			if (m_controlScript.GetGlobal("Init") == Nz::LuaType_Function)
 			{
 				if (!m_controlScript.Call(0))
-					std::cerr << "Init failed: " << m_controlScript.GetLastError() << std::endl;
+					LogError(LogCategory::Script) << "Init failed: " << m_controlScript.GetLastError();
 			}
 		}
 	}
@@ -769,21 +770,21 @@ namespace ewn
 				}
 				catch (const std::exception&)
 				{
-					std::cerr << "UpdateInput failed: returned values are invalid:\n";
-					std::cerr << m_controlScript.DumpStack() << std::endl;
+					LogError(LogCategory::Script) << "UpdateInput failed: returned values are invalid:\n" << m_controlScript.DumpStack();
 					return;
 				}
 
-				// Send input to server
+				// Send input to server, along with the last ones in case their packets got lost
 				Packets::PlayerMovement movementPacket;
-				movementPacket.inputTime = m_server->EstimateServerTime();
-				movementPacket.direction = movement;
-				movementPacket.rotation = rotation;
+				MovementInputHistory::Input input = m_inputHistory.PushInput(m_server->EstimateServerTime(), movement, rotation, &movementPacket);
 
 				m_server->SendPacket(movementPacket);
+
+				// Predict with the quantized input, which is what the server will apply
+				m_entities.PredictInput(input.inputTime, input.direction, input.rotation);
 			}
 			else
-				std::cerr << "UpdateInput failed: " << m_controlScript.GetLastError() << std::endl;
+				LogError(LogCategory::Script) << "UpdateInput failed: " << m_controlScript.GetLastError();
 		}
 	}
 
@@ -13,6 +13,7 @@
 #include <Nazara/Renderer/RenderWindow.hpp>
 #include <NDK/Entity.hpp>
 #include <NDK/EntityOwner.hpp>
+#include <Shared/MovementInputHistory.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/ServerConnection.hpp>
 
@@ -85,6 +86,7 @@ namespace ewn
 			Ndk::EntityOwner m_healthBarEntity;
 			Ndk::EntityHandle m_spaceship;
 			Nz::LuaInstance m_controlScript;
+			MovementInputHistory m_inputHistory;
 			Nz::SpriteRef m_cursorOrientationSprite;
 			Nz::SpriteRef m_healthBarSprite;
 			Nz::Sound m_shootSound;
@@ -0,0 +1,92 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/SpaceshipPrediction.hpp>
+#include <Nazara/Math/Algorithm.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	SpaceshipPrediction::SpaceshipPrediction(const SpaceshipMovement::Parameters& parameters, const SpaceshipMovement::State& initialState) :
+	m_pendingInputs(m_pendingInputData.begin(), m_pendingInputData.end()),
+	m_parameters(parameters),
+	m_state(initialState),
+	m_lastProcessedInputTime(0),
+	m_stateTime(0)
+	{
+	}
+
+	void SpaceshipPrediction::PushInput(Nz::UInt64 inputTime, Nz::Vector3f direction, Nz::Vector3f rotation)
+	{
+		Nz::UInt64 previousInputTime = (!m_pendingInputs.empty()) ? m_pendingInputs.back().inputTime : m_lastProcessedInputTime;
+		if (inputTime <= previousInputTime)
+			return; //< The server would drop it too
+
+		if (!std::isfinite(direction.x) || !std::isfinite(direction.y) || !std::isfinite(direction.z) ||
+		    !std::isfinite(rotation.x) || !std::isfinite(rotation.y) || !std::isfinite(rotation.z))
+			return;
+
+		// Same as Player::UpdateInput
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			direction[i] = Nz::Clamp(direction[i], -1.f, 1.f);
+			rotation[i] = Nz::Clamp(rotation[i], -1.f, 1.f);
+		}
+
+		// If the server hasn't acknowledged anything for that long, the oldest inputs won't be replayed anymore
+		if (m_pendingInputs.full())
+			m_lastProcessedInputTime = m_pendingInputs.pop_front().inputTime;
+
+		Input input;
+		input.inputTime = inputTime;
+		input.direction = SpaceshipMovement::ScaleDirection(direction);
+		input.rotation = SpaceshipMovement::ScaleRotation(rotation);
+
+		m_pendingInputs.push_back(input);
+
+		ApplyInput(input, previousInputTime);
+	}
+
+	void SpaceshipPrediction::Reconcile(Nz::UInt64 stateTime, Nz::UInt64 lastProcessedInputTime, const SpaceshipMovement::State& serverState)
+	{
+		// Older than what we already know (snapshots may arrive out of order)
+		if (lastProcessedInputTime < m_lastProcessedInputTime)
+			return;
+
+		while (!m_pendingInputs.empty() && m_pendingInputs.front().inputTime <= lastProcessedInputTime)
+			m_pendingInputs.pop_front();
+
+		m_lastProcessedInputTime = lastProcessedInputTime;
+
+		// Rewind to the server state and replay what it hasn't seen yet
+		m_state = serverState;
+		m_stateTime = std::max(stateTime, lastProcessedInputTime);
+		if (!m_pendingInputs.empty())
+			m_stateTime = std::min(m_stateTime, m_pendingInputs.front().inputTime);
+
+		Nz::UInt64 previousInputTime = lastProcessedInputTime;
+		for (const Input& input : m_pendingInputs)
+		{
+			ApplyInput(input, previousInputTime);
+			previousInputTime = input.inputTime;
+		}
+	}
+
+	void SpaceshipPrediction::ApplyInput(const Input& input, Nz::UInt64 previousInputTime)
+	{
+		// A long gap means inputs stopped for a while, server states will have caught up with it anyway
+		constexpr Nz::UInt64 MaxIntegrationTime = 1000;
+
+		if (m_stateTime != 0 && input.inputTime > m_stateTime)
+			SpaceshipMovement::Integrate(m_state, m_parameters, std::min(input.inputTime - m_stateTime, MaxIntegrationTime) / 1000.f);
+
+		m_stateTime = std::max(m_stateTime, input.inputTime);
+
+		// Like InputSystem, the first input ever received has no effect
+		float inputElapsedTime = (previousInputTime != 0) ? (input.inputTime - previousInputTime) / 1000.f : 0.f;
+
+		SpaceshipMovement::ApplyInput(m_state, m_parameters, inputElapsedTime, input.direction, input.rotation);
+	}
+}
@@ -0,0 +1,62 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_CLIENT_SPACESHIPPREDICTION_HPP
+#define EREWHON_CLIENT_SPACESHIPPREDICTION_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <Shared/SpaceshipMovement.hpp>
+#include <nonstd/ring_span.hpp>
+#include <array>
+
+namespace ewn
+{
+	// Predicts the movement of the controlled spaceship from the inputs sent to the server
+	// Server states rewind the prediction to what the server computed, inputs it hasn't processed yet are then replayed
+	// Has no dependency on the world or the network, so it can run headless
+	class SpaceshipPrediction
+	{
+		public:
+			SpaceshipPrediction(const SpaceshipMovement::Parameters& parameters, const SpaceshipMovement::State& initialState);
+			SpaceshipPrediction(const SpaceshipPrediction&) = delete;
+			SpaceshipPrediction(SpaceshipPrediction&&) = delete;
+			~SpaceshipPrediction() = default;
+
+			inline std::size_t GetPendingInputCount() const;
+			inline const SpaceshipMovement::State& GetState() const;
+
+			void PushInput(Nz::UInt64 inputTime, Nz::Vector3f direction, Nz::Vector3f rotation);
+
+			void Reconcile(Nz::UInt64 stateTime, Nz::UInt64 lastProcessedInputTime, const SpaceshipMovement::State& serverState);
+
+			SpaceshipPrediction& operator=(const SpaceshipPrediction&) = delete;
+			SpaceshipPrediction& operator=(SpaceshipPrediction&&) = delete;
+
+			static constexpr std::size_t MaxPendingInputs = 128; //< About two seconds of inputs
+
+		private:
+			struct Input
+			{
+				Nz::UInt64 inputTime;
+				Nz::Vector3f direction;
+				Nz::Vector3f rotation;
+			};
+
+			void ApplyInput(const Input& input, Nz::UInt64 previousInputTime);
+
+			std::array<Input, MaxPendingInputs> m_pendingInputData;
+			nonstd::ring_span<Input> m_pendingInputs;
+			SpaceshipMovement::Parameters m_parameters;
+			SpaceshipMovement::State m_state;
+			Nz::UInt64 m_lastProcessedInputTime;
+			Nz::UInt64 m_stateTime;
+	};
+}
+
+#include <Client/SpaceshipPrediction.inl>
+
+#endif // EREWHON_CLIENT_SPACESHIPPREDICTION_HPP
@@ -0,0 +1,18 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Client/SpaceshipPrediction.hpp>
+
+namespace ewn
+{
+	inline std::size_t SpaceshipPrediction::GetPendingInputCount() const
+	{
+		return m_pendingInputs.size();
+	}
+
+	inline const SpaceshipMovement::State& SpaceshipPrediction::GetState() const
+	{
+		return m_state;
+	}
+}
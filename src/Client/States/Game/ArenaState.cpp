@@ -137,9 +137,13 @@ namespace ewn
 
 			m_spaceshipOverviewController.reset();
 			m_spaceshipController.emplace(stateData.app, stateData.server, *stateData.window, *stateData.world2D, *m_chatbox, *m_matchEntities, stateData.camera3D, data.entity);
+
+			m_matchEntities->EnablePrediction(entityId);
 		}
 		else
 		{
+			m_matchEntities->DisablePrediction();
+
 			m_spaceshipController.reset();
 			auto& controller = m_spaceshipOverviewController.emplace(*stateData.window, stateData.camera3D, *m_chatbox, *m_matchEntities, stateData.world3D);
 			controller.OnEntityClick.Connect([this](SpaceshipOverviewController*, std::size_t entityId)
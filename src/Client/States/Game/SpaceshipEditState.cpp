@@ -10,6 +10,7 @@
 #include <NDK/Components/LightComponent.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/StateMachine.hpp>
+#include <Shared/Logger.hpp>
 #include <cassert>
 
 namespace ewn
@@ -375,7 +376,7 @@ namespace ewn
 		Nz::LuaInstance lua;
 		if (!lua.Load(content))
 		{
-			std::cerr << "Parsing error in " << fileName << ": " << lua.GetLastError() << std::endl;
+			LogError(LogCategory::Client) << "Parsing error in " << fileName << ": " << lua.GetLastError();
 			UpdateStatus("Parsing error: " + lua.GetLastError(), Nz::Color::Red);
 			return;
 		}
@@ -11,6 +11,7 @@
 #include <NDK/Components/LightComponent.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <NDK/StateMachine.hpp>
+#include <Shared/Logger.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/States/Game/SpaceshipEditState.hpp>
 #include <cassert>
@@ -249,7 +250,7 @@ namespace ewn
 			hullInfo.hullModel = Nz::ModelManager::Get(assetsFolder + '/' + hullInfo.hullPath);
 			if (!hullInfo.hullModel)
 			{
-				std::cerr << "Failed to load model for " << hullData.name << std::endl;
+				LogError(LogCategory::Client) << "Failed to load model for " << hullData.name;
 				continue;
 			}
 
@@ -15,10 +15,10 @@
 #include <NDK/EntityOwner.hpp>
 #include <NDK/State.hpp>
 #include <NDK/World.hpp>
-#include <vector>
 
 namespace ewn
 {
+	// Waits for ServerConnection to synchronize its clock before entering the arena, which only takes a round trip or two
 	class TimeSyncState final : public AbstractState
 	{
 		public:
@@ -32,20 +32,15 @@ namespace ewn
 
 			void LayoutWidgets() override;
 
-			void OnTimeSyncResponse(ServerConnection* server, const Packets::TimeSyncResponse& response);
+			void EnterArena();
+
+			void OnKeyPressed(const Nz::EventHandler* eventHandler, const Nz::WindowEvent::KeyEvent& event);
 			void UpdateStatus(const Nz::String& status, const Nz::Color& color = Nz::Color::White);
 
 			Ndk::EntityOwner m_statusText;
 			Nz::TextSpriteRef m_statusSprite;
-			Nz::UInt8 m_expectedRequestId;
-			Nz::UInt64 m_pingAccumulator;
-			Nz::UInt64 m_requestTime;
 			Nz::UInt8 m_arenaIndex;
-			std::vector<Nz::UInt64> m_results;
 			bool m_finished;
-			bool m_isClientYounger;
-			float m_accumulator;
-			float m_nextStepTime;
 	};
 }
 
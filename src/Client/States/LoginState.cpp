@@ -11,6 +11,7 @@
 #include <NDK/Widgets/CheckboxWidget.hpp>
 #include <NDK/Widgets/LabelWidget.hpp>
 #include <NDK/Widgets/TextAreaWidget.hpp>
+#include <Shared/Logger.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <Client/States/ConnectedState.hpp>
 #include <Client/States/Game/MainMenuState.hpp>
@@ -125,10 +126,18 @@ namespace ewn
 					reason = "password mismatch";
 					break;
 
+				case LoginFailureReason::ServerBusy:
+					reason = "server busy, please try again in " + std::to_string((loginFailure.retryAfter + 999) / 1000) + "s";
+					break;
+
 				case LoginFailureReason::ServerError:
 					reason = "server error, please try again later";
 					break;
 
+				case LoginFailureReason::TooManyAttempts:
+					reason = "too many attempts, please try again in " + std::to_string((loginFailure.retryAfter + 999) / 1000) + "s";
+					break;
+
 				default:
 					reason = "<packet error>";
 					break;
@@ -161,7 +170,7 @@ namespace ewn
 					loginFile.Write(login + '\n' + tokenAsString);
 				}
 				else
-					std::cerr << "Failed to open remember me file" << std::endl;
+					LogError(LogCategory::Client) << "Failed to open remember me file";
 			}
 
 			m_connectionToken.clear();
@@ -7,7 +7,7 @@
 #include <NDK/StateMachine.hpp>
 #include <Client/ClientApplication.hpp>
 #include <Client/States/LoginState.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -149,7 +149,7 @@ namespace ewn
 		Nz::File optionFile("coptions.lua", Nz::OpenMode_Truncate | Nz::OpenMode_WriteOnly);
 		if (!optionFile.IsOpen())
 		{
-			std::cerr << "Failed to open option file" << std::endl;
+			LogError(LogCategory::Client) << "Failed to open option file";
 			return;
 		}
 
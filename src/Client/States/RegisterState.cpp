@@ -119,10 +119,18 @@ namespace ewn
 					reason = "login already taken";
 					break;
 
+				case RegisterFailureReason::ServerBusy:
+					reason = "server busy, please try again in " + std::to_string((registerFailure.retryAfter + 999) / 1000) + "s";
+					break;
+
 				case RegisterFailureReason::ServerError:
 					reason = "server error, please try again later";
 					break;
 
+				case RegisterFailureReason::TooManyAttempts:
+					reason = "too many attempts, please try again in " + std::to_string((registerFailure.retryAfter + 999) / 1000) + "s";
+					break;
+
 				default:
 					reason = "<packet error>";
 					break;
@@ -25,7 +25,7 @@
 #include <Client/States/DisconnectionState.hpp>
 #include <Client/States/LoginState.hpp>
 #include <Client/Systems/SoundEmitterSystem.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 int main()
 {
@@ -37,7 +37,7 @@ int main()
 	ewn::ClientApplication app;
 	if (!app.LoadConfig("cconfig.lua"))
 	{
-		std::cerr << "Failed to load config file" << std::endl;
+		ewn::LogError(ewn::LogCategory::Client) << "Failed to load config file";
 		return EXIT_FAILURE;
 	}
 
@@ -120,7 +120,7 @@ int main()
 
 	Nz::SoundBufferRef shootSound = Nz::SoundBuffer::LoadFromFile(assetsFolder + "/sounds/laserTurretlow.ogg", soundParams);
 	if (!shootSound)
-		std::cerr << "Failed to load shoot sound" << std::endl;
+		ewn::LogError(ewn::LogCategory::Client) << "Failed to load shoot sound";
 
 	Nz::SoundBufferLibrary::Register("ShootSound", std::move(shootSound));
 
@@ -0,0 +1,317 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadClient/LoadTester.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Nazara/Core/String.hpp>
+#include <Nazara/Network/TcpClient.hpp>
+#include <Client/ClientApplication.hpp>
+#include <Shared/ConfigFile.hpp>
+#include <Shared/Logger.hpp>
+#include <argon2/argon2.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+
+namespace ewn
+{
+	LoadTester::LoadTester(ClientApplication& app, const ConfigFile& config) :
+	m_config(config),
+	m_app(app),
+	m_lastReceivedBytes(0),
+	m_lastSentBytes(0)
+	{
+		m_clientCount = config.GetIntegerOption<std::size_t>("LoadTest.ClientCount");
+		m_loginPrefix = config.GetStringOption("LoadTest.LoginPrefix");
+		m_metricsPort = config.GetIntegerOption<Nz::UInt16>("LoadTest.MetricsPort");
+		m_password = config.GetStringOption("LoadTest.Password");
+		m_reportInterval = config.GetIntegerOption<Nz::UInt64>("LoadTest.ReportInterval") * 1'000'000;
+		m_spawnInterval = 1'000'000 / config.GetIntegerOption<Nz::UInt64>("LoadTest.ConnectRate");
+
+		m_clientSettings.arenaIndex = config.GetIntegerOption<Nz::UInt8>("LoadTest.ArenaIndex");
+		m_clientSettings.fleetName = config.GetStringOption("LoadTest.FleetName");
+		m_clientSettings.inputInterval = 1'000'000 / config.GetIntegerOption<Nz::UInt64>("LoadTest.InputRate");
+		m_clientSettings.registerAccount = config.GetBoolOption("LoadTest.RegisterAccounts");
+		m_clientSettings.shootInterval = static_cast<Nz::UInt64>(config.GetFloatOption<double>("LoadTest.ShootInterval") * 1'000'000.0);
+
+		// Password hashing is expensive (it's meant to be), don't compute too many hashes at once
+		m_maxConcurrentHashes = std::max(std::thread::hardware_concurrency(), 1U);
+
+		// Spread clients over a few reactors, each one having its own thread
+		std::size_t reactorCount = config.GetIntegerOption<std::size_t>("LoadTest.ReactorCount");
+		m_app.SetMaxPeerPerReactor((m_clientCount + reactorCount - 1) / reactorCount);
+
+		m_clients.reserve(m_clientCount);
+
+		Nz::UInt64 duration = config.GetIntegerOption<Nz::UInt64>("LoadTest.Duration");
+
+		m_startTime = Nz::GetElapsedMicroseconds();
+		m_endTime = (duration > 0) ? m_startTime + duration * 1'000'000 : 0;
+		m_lastReportTime = m_startTime;
+		m_nextReportTime = m_startTime + m_reportInterval;
+		m_nextSpawnTime = m_startTime;
+
+		LogInfo(LogCategory::Client) << "Starting load test with " << m_clientCount << " clients over " << reactorCount << " reactors";
+	}
+
+	LoadTester::~LoadTester()
+	{
+		if (m_pendingServerMetrics.valid())
+			m_pendingServerMetrics.wait();
+	}
+
+	// Also fails if some clients were never spawned, the test ended too early for them
+	bool LoadTester::HasEveryClientReceivedArena() const
+	{
+		if (m_clients.size() < m_clientCount)
+			return false;
+
+		return std::all_of(m_clients.begin(), m_clients.end(), [](const std::unique_ptr<VirtualClient>& client) { return client->HasReceivedArena(); });
+	}
+
+	bool LoadTester::Update()
+	{
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+
+		if (m_clients.size() < m_clientCount && now >= m_nextSpawnTime)
+		{
+			std::size_t hashingClientCount = std::count_if(m_clients.begin(), m_clients.end(), [](const std::unique_ptr<VirtualClient>& client) { return client->IsHashing(); });
+			if (hashingClientCount < m_maxConcurrentHashes)
+			{
+				SpawnClient();
+				m_nextSpawnTime += m_spawnInterval;
+			}
+		}
+
+		for (const auto& clientPtr : m_clients)
+			clientPtr->Update(now);
+
+		if (m_pendingServerMetrics.valid() && m_pendingServerMetrics.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			ServerMetrics serverMetrics = m_pendingServerMetrics.get();
+			if (!serverMetrics.empty())
+			{
+				m_previousServerMetrics = std::move(m_lastServerMetrics);
+				m_lastServerMetrics = std::move(serverMetrics);
+			}
+		}
+
+		if (m_endTime != 0 && now >= m_endTime)
+		{
+			PrintReport(now, true);
+
+			for (const auto& clientPtr : m_clients)
+				clientPtr->Disconnect();
+
+			return false;
+		}
+
+		if (now >= m_nextReportTime)
+		{
+			PrintReport(now, false);
+
+			m_nextReportTime += m_reportInterval;
+		}
+
+		return true;
+	}
+
+	void LoadTester::RegisterConfigOptions(ConfigFile& config)
+	{
+		config.RegisterIntegerOption("LoadTest.ArenaIndex", 0, 0xFF);
+		config.RegisterIntegerOption("LoadTest.ClientCount", 1, 0xFFFF);
+		config.RegisterIntegerOption("LoadTest.ConnectRate", 1, 10'000);
+		config.RegisterIntegerOption("LoadTest.Duration", 0, 7 * 24 * 3600);
+		config.RegisterStringOption("LoadTest.FleetName");
+		config.RegisterIntegerOption("LoadTest.InputRate", 1, 240);
+		config.RegisterStringOption("LoadTest.LoginPrefix");
+		config.RegisterIntegerOption("LoadTest.MetricsPort", 0, 0xFFFF);
+		config.RegisterStringOption("LoadTest.Password");
+		config.RegisterIntegerOption("LoadTest.ReactorCount", 1, 64);
+		config.RegisterBoolOption("LoadTest.RegisterAccounts");
+		config.RegisterIntegerOption("LoadTest.ReportInterval", 1, 3600);
+		config.RegisterFloatOption("LoadTest.ShootInterval", 0.0, 60.0);
+	}
+
+	std::future<std::string> LoadTester::HashPassword(const std::string& login) const
+	{
+		// Same as LoginState::ComputePassword
+		int iCost = m_config.GetIntegerOption<int>("Security.Argon2.IterationCost");
+		int mCost = m_config.GetIntegerOption<int>("Security.Argon2.MemoryCost");
+		int tCost = m_config.GetIntegerOption<int>("Security.Argon2.ThreadCost");
+		int hashLength = m_config.GetIntegerOption<int>("Security.HashLength");
+		const std::string& salt = m_config.GetStringOption("Security.PasswordSalt");
+
+		Nz::String saltedPassword = Nz::String(login).ToLower() + m_password;
+
+		return std::async(std::launch::async, [pwd = std::move(saltedPassword), &salt, iCost, mCost, tCost, hashLength]() -> std::string
+		{
+			std::string hash(hashLength, '\0');
+			if (argon2_hash(iCost, mCost, tCost, pwd.GetConstBuffer(), pwd.GetSize(), salt.data(), salt.size(), hash.data(), hash.size(), nullptr, 0, argon2_type::Argon2_id, ARGON2_VERSION_13) != ARGON2_OK)
+				hash.clear();
+
+			return hash;
+		});
+	}
+
+	void LoadTester::PrintReport(Nz::UInt64 now, bool final)
+	{
+		std::size_t failedCount = 0;
+		std::size_t playingCount = 0;
+		std::size_t receivedArenaCount = 0;
+		VirtualClient::Stats totalStats = {};
+
+		for (const auto& clientPtr : m_clients)
+		{
+			switch (clientPtr->GetState())
+			{
+				case VirtualClient::State::Failed:
+					failedCount++;
+					break;
+
+				case VirtualClient::State::Playing:
+					playingCount++;
+					break;
+
+				default:
+					break;
+			}
+
+			if (clientPtr->HasReceivedArena())
+				receivedArenaCount++;
+
+			const VirtualClient::Stats& stats = clientPtr->GetStats();
+			totalStats.createdEntityCount += stats.createdEntityCount;
+			totalStats.inputCount += stats.inputCount;
+			totalStats.retryCount += stats.retryCount;
+			totalStats.rttCount += stats.rttCount;
+			totalStats.rttMax = std::max(totalStats.rttMax, stats.rttMax);
+			totalStats.rttSum += stats.rttSum;
+			totalStats.snapshotCount += stats.snapshotCount;
+
+			clientPtr->ResetStats();
+		}
+
+		NetworkReactor::ChannelStats networkStats = m_app.GetNetworkStats();
+
+		double elapsedTime = (now - m_lastReportTime) / 1'000'000.0;
+		double perClientFactor = (playingCount > 0) ? 1.0 / (elapsedTime * playingCount) : 0.0;
+
+		std::ostringstream report;
+		report << std::fixed << std::setprecision(1);
+		report << ((final) ? "Final report" : "Report") << " at " << (now - m_startTime) / 1'000'000 << "s: ";
+		report << m_clients.size() << "/" << m_clientCount << " clients (" << playingCount << " playing, " << failedCount << " failed)";
+		if (totalStats.retryCount > 0)
+			report << " | " << totalStats.retryCount << " logins delayed by the server";
+		report << " | RTT avg " << ((totalStats.rttCount > 0) ? totalStats.rttSum / 1000.0 / totalStats.rttCount : 0.0) << "ms max " << totalStats.rttMax / 1000.0 << "ms";
+		report << " | per client: " << totalStats.snapshotCount * perClientFactor << " snapshots/s, " << totalStats.createdEntityCount * perClientFactor << " created entities/s, " << totalStats.inputCount * perClientFactor << " inputs/s";
+		report << ", " << (networkStats.receivedBytes - m_lastReceivedBytes) * perClientFactor / 1024.0 << " KiB/s in";
+		report << ", " << (networkStats.sentBytes - m_lastSentBytes) * perClientFactor / 1024.0 << " KiB/s out";
+
+		if (m_metricsPort != 0)
+		{
+			auto GetServerMetric = [](const ServerMetrics& metrics, const std::string& name) -> double
+			{
+				auto it = metrics.find(name);
+				return (it != metrics.end()) ? it->second : 0.0;
+			};
+
+			auto GetServerCounterDelta = [&](const std::string& name) -> double
+			{
+				return GetServerMetric(m_lastServerMetrics, name) - GetServerMetric(m_previousServerMetrics, name);
+			};
+
+			// Scraping is asynchronous, this shows the two previous scrapes
+			if (!m_previousServerMetrics.empty())
+			{
+				report << " | server: " << GetServerMetric(m_lastServerMetrics, "erewhon_sessions") << " sessions, ";
+				report << GetServerCounterDelta("erewhon_ticks_total") << " ticks, ";
+				report << GetServerCounterDelta("erewhon_tick_overruns_total") << " overruns, ";
+				report << GetServerCounterDelta("erewhon_tick_skipped_total") << " skipped";
+			}
+			else
+				report << " | server: waiting for metrics";
+
+			if (!m_pendingServerMetrics.valid())
+				m_pendingServerMetrics = std::async(std::launch::async, &LoadTester::FetchServerMetrics, m_metricsPort);
+		}
+
+		if (final)
+			report << " | " << receivedArenaCount << "/" << m_clientCount << " clients received the arena (entities and state)";
+
+		LogInfo(LogCategory::Client) << report.str();
+
+		m_lastReceivedBytes = networkStats.receivedBytes;
+		m_lastReportTime = now;
+		m_lastSentBytes = networkStats.sentBytes;
+	}
+
+	void LoadTester::SpawnClient()
+	{
+		std::size_t clientIndex = m_clients.size();
+		std::string login = m_loginPrefix + std::to_string(clientIndex);
+
+		m_clients.emplace_back(std::make_unique<VirtualClient>(m_app, m_clientSettings, clientIndex, login, HashPassword(login)));
+	}
+
+	auto LoadTester::FetchServerMetrics(Nz::UInt16 port) -> ServerMetrics
+	{
+		constexpr Nz::UInt64 Timeout = 1000; //< ms
+
+		// Metrics server only listens on loopback
+		Nz::IpAddress serverAddress = Nz::IpAddress::LoopbackIpV4;
+		serverAddress.SetPort(port);
+
+		Nz::TcpClient client;
+		if (client.Connect(serverAddress) == Nz::SocketState_Connecting)
+			client.WaitForConnected(Timeout);
+
+		if (client.GetState() != Nz::SocketState_Connected)
+			return {};
+
+		std::string request = "GET /metrics HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+		if (!client.Send(request.data(), request.size()))
+			return {};
+
+		std::string response;
+		std::array<char, 4096> buffer;
+		std::size_t received;
+		while (client.Receive(buffer.data(), buffer.size(), &received) && received > 0)
+			response.append(buffer.data(), received);
+
+		std::size_t bodyStart = response.find("\r\n\r\n");
+		if (response.compare(0, 12, "HTTP/1.1 200") != 0 || bodyStart == std::string::npos)
+			return {};
+
+		// Text exposition format: "name{labels} value", samples with labels are summed up
+		ServerMetrics metrics;
+
+		std::istringstream body(response.substr(bodyStart + 4));
+		std::string line;
+		while (std::getline(body, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			std::size_t nameEnd = line.find_first_of("{ ");
+			std::size_t valueStart = line.find_last_of(' ');
+			if (nameEnd == std::string::npos || valueStart == std::string::npos)
+				continue;
+
+			try
+			{
+				metrics[line.substr(0, nameEnd)] += std::stod(line.substr(valueStart + 1));
+			}
+			catch (const std::exception&)
+			{
+				// Ignore malformed lines
+			}
+		}
+
+		return metrics;
+	}
+}
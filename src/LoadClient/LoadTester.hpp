@@ -0,0 +1,76 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_LOADCLIENT_LOADTESTER_HPP
+#define EREWHON_LOADCLIENT_LOADTESTER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <LoadClient/VirtualClient.hpp>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ewn
+{
+	class ClientApplication;
+	class ConfigFile;
+
+	// Spawns virtual clients at a fixed rate and periodically reports what they (and the server) experience
+	class LoadTester
+	{
+		public:
+			LoadTester(ClientApplication& app, const ConfigFile& config);
+			LoadTester(const LoadTester&) = delete;
+			LoadTester(LoadTester&&) = delete;
+			~LoadTester();
+
+			bool HasEveryClientReceivedArena() const;
+
+			bool Update();
+
+			LoadTester& operator=(const LoadTester&) = delete;
+			LoadTester& operator=(LoadTester&&) = delete;
+
+			static void RegisterConfigOptions(ConfigFile& config);
+
+		private:
+			using ServerMetrics = std::unordered_map<std::string, double>;
+
+			std::future<std::string> HashPassword(const std::string& login) const;
+			void PrintReport(Nz::UInt64 now, bool final);
+			void SpawnClient();
+
+			static ServerMetrics FetchServerMetrics(Nz::UInt16 port);
+
+			const ConfigFile& m_config;
+			std::future<ServerMetrics> m_pendingServerMetrics;
+			std::string m_loginPrefix;
+			std::string m_password;
+			std::vector<std::unique_ptr<VirtualClient>> m_clients;
+			ClientApplication& m_app;
+			ServerMetrics m_lastServerMetrics;
+			ServerMetrics m_previousServerMetrics;
+			VirtualClient::Settings m_clientSettings;
+			Nz::UInt64 m_endTime;
+			Nz::UInt64 m_lastReceivedBytes;
+			Nz::UInt64 m_lastReportTime;
+			Nz::UInt64 m_lastSentBytes;
+			Nz::UInt64 m_nextReportTime;
+			Nz::UInt64 m_nextSpawnTime;
+			Nz::UInt64 m_reportInterval;
+			Nz::UInt64 m_spawnInterval;
+			Nz::UInt64 m_startTime;
+			Nz::UInt16 m_metricsPort;
+			std::size_t m_clientCount;
+			std::size_t m_maxConcurrentHashes;
+	};
+}
+
+#include <LoadClient/LoadTester.inl>
+
+#endif // EREWHON_LOADCLIENT_LOADTESTER_HPP
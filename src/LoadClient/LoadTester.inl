@@ -0,0 +1,9 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadClient/LoadTester.hpp>
+
+namespace ewn
+{
+}
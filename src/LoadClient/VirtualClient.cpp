@@ -0,0 +1,271 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadClient/VirtualClient.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Client/ClientApplication.hpp>
+#include <Shared/Logger.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace ewn
+{
+	VirtualClient::VirtualClient(ClientApplication& app, const Settings& settings, std::size_t clientIndex, std::string login, std::future<std::string> passwordHash) :
+	m_settings(settings),
+	m_passwordHashFuture(std::move(passwordHash)),
+	m_clientIndex(clientIndex),
+	m_login(std::move(login)),
+	m_connection(app),
+	m_state(State::Hashing),
+	m_nextInputTime(0),
+	m_nextShootTime(0),
+	m_retryTime(0),
+	m_hasReceivedEntities(false),
+	m_hasReceivedState(false)
+	{
+		ResetStats();
+
+		m_connection.OnArenaState.Connect(this, &VirtualClient::OnArenaState);
+		m_connection.OnConnected.Connect(this, &VirtualClient::OnConnected);
+		m_connection.OnCreateEntities.Connect(this, &VirtualClient::OnCreateEntities);
+		m_connection.OnDisconnected.Connect(this, &VirtualClient::OnDisconnected);
+		m_connection.OnLoginFailure.Connect(this, &VirtualClient::OnLoginFailure);
+		m_connection.OnLoginSuccess.Connect(this, &VirtualClient::OnLoginSuccess);
+		m_connection.OnRegisterFailure.Connect(this, &VirtualClient::OnRegisterFailure);
+		m_connection.OnRegisterSuccess.Connect(this, &VirtualClient::OnRegisterSuccess);
+		m_connection.OnRoundTrip.Connect(this, &VirtualClient::OnRoundTrip);
+	}
+
+	void VirtualClient::Update(Nz::UInt64 now)
+	{
+		switch (m_state)
+		{
+			case State::Hashing:
+			{
+				if (m_passwordHashFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+					break;
+
+				m_passwordHash = m_passwordHashFuture.get();
+				if (m_passwordHash.empty())
+				{
+					Fail("failed to hash password");
+					break;
+				}
+
+				// Load tests must never leave the machine
+				m_state = State::Connecting;
+				if (!m_connection.Connect("127.0.0.1"))
+					Fail("failed to initiate connection");
+
+				break;
+			}
+
+			case State::TimeSyncing:
+			{
+				// The connection synchronizes its clock in the background once logged in
+				if (m_connection.GetClockSync().IsSynchronized())
+					JoinArena(now);
+
+				break;
+			}
+
+			case State::Playing:
+			{
+				if (now >= m_nextInputTime)
+				{
+					SendInput(now);
+
+					// Don't try to catch up if we're late, a real client would not either
+					m_nextInputTime = std::max(m_nextInputTime + m_settings.inputInterval, now);
+				}
+
+				if (m_settings.shootInterval > 0 && now >= m_nextShootTime)
+				{
+					m_connection.SendPacket(Packets::PlayerShoot());
+					m_nextShootTime = now + m_settings.shootInterval;
+				}
+
+				break;
+			}
+
+			case State::Registering:
+			case State::LoggingIn:
+			{
+				// The server asked us to wait (rate limiting or busy password hashing)
+				if (m_retryTime != 0 && now >= m_retryTime)
+				{
+					m_retryTime = 0;
+					if (m_state == State::Registering)
+						SendRegister();
+					else
+						SendLogin();
+				}
+
+				break;
+			}
+
+			case State::Connecting:
+			case State::Disconnected:
+			case State::Failed:
+				break;
+		}
+	}
+
+	void VirtualClient::Fail(const char* reason)
+	{
+		LogWarning(LogCategory::Client) << m_login << ": " << reason;
+
+		m_state = State::Failed;
+		if (m_connection.IsConnected())
+			m_connection.Disconnect();
+	}
+
+	void VirtualClient::JoinArena(Nz::UInt64 now)
+	{
+		Packets::JoinArena joinArena;
+		joinArena.arenaIndex = m_settings.arenaIndex;
+		m_connection.SendPacket(joinArena);
+
+		if (!m_settings.fleetName.empty())
+		{
+			Packets::PlayerChat chatPacket;
+			chatPacket.text = "/spawnfleet " + m_settings.fleetName;
+			m_connection.SendPacket(chatPacket);
+		}
+
+		m_state = State::Playing;
+		m_nextInputTime = now;
+		m_nextShootTime = now + m_settings.shootInterval;
+	}
+
+	void VirtualClient::OnArenaState(ServerConnection* /*server*/, const Packets::ArenaState& /*arenaState*/)
+	{
+		m_hasReceivedState = true;
+		m_stats.snapshotCount++;
+	}
+
+	void VirtualClient::OnConnected(ServerConnection* /*server*/, Nz::UInt32 /*data*/)
+	{
+		if (m_settings.registerAccount)
+			SendRegister();
+		else
+			SendLogin();
+	}
+
+	void VirtualClient::OnCreateEntities(ServerConnection* /*server*/, const Packets::CreateEntities& createEntities)
+	{
+		m_hasReceivedEntities = true;
+		m_stats.createdEntityCount += createEntities.entities.size();
+	}
+
+	void VirtualClient::OnDisconnected(ServerConnection* /*server*/, Nz::UInt32 /*data*/)
+	{
+		if (m_state != State::Disconnected && m_state != State::Failed)
+			Fail("disconnected by server");
+	}
+
+	void VirtualClient::OnLoginFailure(ServerConnection* /*server*/, const Packets::LoginFailure& loginFailure)
+	{
+		switch (loginFailure.reason)
+		{
+			case LoginFailureReason::AccountNotFound:
+				Fail("login failed: account not found");
+				break;
+
+			case LoginFailureReason::InvalidToken:
+				Fail("login failed: invalid token");
+				break;
+
+			case LoginFailureReason::PasswordMismatch:
+				Fail("login failed: password mismatch");
+				break;
+
+			case LoginFailureReason::ServerBusy:
+			case LoginFailureReason::TooManyAttempts:
+				m_retryTime = Nz::GetElapsedMicroseconds() + Nz::UInt64(loginFailure.retryAfter) * 1000;
+				m_stats.retryCount++;
+				break;
+
+			case LoginFailureReason::ServerError:
+				Fail("login failed: server error");
+				break;
+		}
+	}
+
+	void VirtualClient::OnLoginSuccess(ServerConnection* /*server*/, const Packets::LoginSuccess& /*loginSuccess*/)
+	{
+		m_state = State::TimeSyncing;
+	}
+
+	void VirtualClient::OnRegisterFailure(ServerConnection* /*server*/, const Packets::RegisterFailure& registerFailure)
+	{
+		switch (registerFailure.reason)
+		{
+			// Accounts are kept between runs, an existing account is fine as long as the password matches
+			case RegisterFailureReason::LoginAlreadyTaken:
+				SendLogin();
+				break;
+
+			case RegisterFailureReason::ServerBusy:
+			case RegisterFailureReason::TooManyAttempts:
+				m_retryTime = Nz::GetElapsedMicroseconds() + Nz::UInt64(registerFailure.retryAfter) * 1000;
+				m_stats.retryCount++;
+				break;
+
+			default:
+				Fail("registration failed");
+				break;
+		}
+	}
+
+	void VirtualClient::OnRegisterSuccess(ServerConnection* /*server*/, const Packets::RegisterSuccess& /*registerSuccess*/)
+	{
+		SendLogin();
+	}
+
+	void VirtualClient::OnRoundTrip(ServerConnection* /*server*/, Nz::UInt64 roundTripTime)
+	{
+		m_stats.rttCount++;
+		m_stats.rttMax = std::max(m_stats.rttMax, roundTripTime);
+		m_stats.rttSum += roundTripTime;
+	}
+
+	void VirtualClient::SendInput(Nz::UInt64 now)
+	{
+		// Each client flies its own pattern so the server doesn't get identical inputs
+		float time = static_cast<float>(now / 1000) / 1000.f + m_clientIndex * 0.37f;
+
+		Nz::Vector3f direction(1.f, std::sin(time) * 0.5f, 0.f);
+		Nz::Vector3f rotation(0.f, std::cos(time * 0.5f) * 30.f, std::sin(time * 0.25f) * 10.f);
+
+		Packets::PlayerMovement movementPacket;
+		m_inputHistory.PushInput(m_connection.EstimateServerTime(), direction, rotation, &movementPacket);
+
+		m_connection.SendPacket(movementPacket);
+		m_stats.inputCount++;
+	}
+
+	void VirtualClient::SendLogin()
+	{
+		Packets::Login loginPacket;
+		loginPacket.generateConnectionToken = false;
+		loginPacket.login = m_login;
+		loginPacket.passwordHash = m_passwordHash;
+
+		m_connection.SendPacket(loginPacket);
+		m_state = State::LoggingIn;
+	}
+
+	void VirtualClient::SendRegister()
+	{
+		Packets::Register registerPacket;
+		registerPacket.email = m_login + "@erewhon.test";
+		registerPacket.login = m_login;
+		registerPacket.passwordHash = m_passwordHash;
+
+		m_connection.SendPacket(registerPacket);
+		m_state = State::Registering;
+	}
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_LOADCLIENT_VIRTUALCLIENT_HPP
+#define EREWHON_LOADCLIENT_VIRTUALCLIENT_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Client/ServerConnection.hpp>
+#include <Shared/MovementInputHistory.hpp>
+#include <future>
+#include <string>
+
+namespace ewn
+{
+	class ClientApplication;
+
+	// Headless player scripting the whole client flow: register/login, time sync, arena join and gameplay inputs
+	class VirtualClient
+	{
+		public:
+			struct Settings;
+			struct Stats;
+
+			enum class State
+			{
+				Hashing,
+				Connecting,
+				Registering,
+				LoggingIn,
+				TimeSyncing,
+				Playing,
+				Disconnected,
+				Failed
+			};
+
+			VirtualClient(ClientApplication& app, const Settings& settings, std::size_t clientIndex, std::string login, std::future<std::string> passwordHash);
+			VirtualClient(const VirtualClient&) = delete;
+			VirtualClient(VirtualClient&&) = delete;
+			~VirtualClient() = default;
+
+			inline void Disconnect();
+
+			inline const std::string& GetLogin() const;
+			inline State GetState() const;
+			inline const Stats& GetStats() const;
+
+			inline bool HasReceivedArena() const;
+
+			inline bool IsHashing() const;
+
+			inline void ResetStats();
+
+			void Update(Nz::UInt64 now);
+
+			VirtualClient& operator=(const VirtualClient&) = delete;
+			VirtualClient& operator=(VirtualClient&&) = delete;
+
+			struct Settings
+			{
+				std::string fleetName;       //< Spawned with /spawnfleet once in the arena, if not empty
+				Nz::UInt64 inputInterval;    //< microseconds
+				Nz::UInt64 shootInterval;    //< microseconds, 0 to never shoot
+				Nz::UInt8 arenaIndex;
+				bool registerAccount;
+			};
+
+			struct Stats
+			{
+				Nz::UInt64 createdEntityCount;
+				Nz::UInt64 inputCount;
+				Nz::UInt64 retryCount; //< login/register requests the server asked to send again later
+				Nz::UInt64 rttCount; //< measured by the connection clock synchronization
+				Nz::UInt64 rttMax;  //< microseconds
+				Nz::UInt64 rttSum;  //< microseconds
+				Nz::UInt64 snapshotCount;
+			};
+
+		private:
+			void Fail(const char* reason);
+			void JoinArena(Nz::UInt64 now);
+			void OnArenaState(ServerConnection* server, const Packets::ArenaState& arenaState);
+			void OnConnected(ServerConnection* server, Nz::UInt32 data);
+			void OnCreateEntities(ServerConnection* server, const Packets::CreateEntities& createEntities);
+			void OnDisconnected(ServerConnection* server, Nz::UInt32 data);
+			void OnLoginFailure(ServerConnection* server, const Packets::LoginFailure& loginFailure);
+			void OnLoginSuccess(ServerConnection* server, const Packets::LoginSuccess& loginSuccess);
+			void OnRegisterFailure(ServerConnection* server, const Packets::RegisterFailure& registerFailure);
+			void OnRegisterSuccess(ServerConnection* server, const Packets::RegisterSuccess& registerSuccess);
+			void OnRoundTrip(ServerConnection* server, Nz::UInt64 roundTripTime);
+			void SendInput(Nz::UInt64 now);
+			void SendLogin();
+			void SendRegister();
+
+			const Settings& m_settings;
+			std::future<std::string> m_passwordHashFuture;
+			std::size_t m_clientIndex;
+			std::string m_login;
+			std::string m_passwordHash;
+			MovementInputHistory m_inputHistory;
+			ServerConnection m_connection;
+			State m_state;
+			Stats m_stats;
+			Nz::UInt64 m_nextInputTime;
+			Nz::UInt64 m_nextShootTime;
+			Nz::UInt64 m_retryTime; //< when to send the login/register request again, 0 if not waiting
+			bool m_hasReceivedEntities;
+			bool m_hasReceivedState;
+	};
+}
+
+#include <LoadClient/VirtualClient.inl>
+
+#endif // EREWHON_LOADCLIENT_VIRTUALCLIENT_HPP
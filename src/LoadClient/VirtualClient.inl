@@ -0,0 +1,55 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <LoadClient/VirtualClient.hpp>
+
+namespace ewn
+{
+	inline void VirtualClient::Disconnect()
+	{
+		if (m_state == State::Failed)
+			return;
+
+		m_state = State::Disconnected;
+		if (m_connection.IsConnected())
+			m_connection.Disconnect();
+	}
+
+	inline const std::string& VirtualClient::GetLogin() const
+	{
+		return m_login;
+	}
+
+	inline auto VirtualClient::GetState() const -> State
+	{
+		return m_state;
+	}
+
+	inline auto VirtualClient::GetStats() const -> const Stats&
+	{
+		return m_stats;
+	}
+
+	// Whether the arena reached this client at least once (entities and a state), those aren't reset with the stats
+	inline bool VirtualClient::HasReceivedArena() const
+	{
+		return m_hasReceivedEntities && m_hasReceivedState;
+	}
+
+	inline bool VirtualClient::IsHashing() const
+	{
+		return m_state == State::Hashing;
+	}
+
+	inline void VirtualClient::ResetStats()
+	{
+		m_stats.createdEntityCount = 0;
+		m_stats.inputCount = 0;
+		m_stats.retryCount = 0;
+		m_stats.rttCount = 0;
+		m_stats.rttMax = 0;
+		m_stats.rttSum = 0;
+		m_stats.snapshotCount = 0;
+	}
+}
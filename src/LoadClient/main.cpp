@@ -0,0 +1,73 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Load Client" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <NDK/Sdk.hpp>
+#include <Client/ClientApplication.hpp>
+#include <LoadClient/LoadTester.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
+#include <iostream>
+#include <string>
+
+// Usage: ErewhonLoadClient [--config <file>]
+// Exits with a failure code if a client never received the arena (entities and state) before the end of the test
+int main(int argc, char* argv[])
+{
+	std::string configPath = "lconfig.lua";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (arg == "--config")
+			configPath = argv[++i];
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	ewn::Profiler::SetThreadName("Main");
+
+	// Thousands of clients failing at once would flood the console
+	ewn::Logger::SetRateLimit(ewn::LogCategory::Client, 20);
+
+	Nz::Initializer<Nz::Network, Ndk::Sdk> nazara;
+
+	ewn::ClientApplication app;
+	ewn::LoadTester::RegisterConfigOptions(app.GetConfig());
+
+	if (!app.LoadConfig(configPath))
+	{
+		ewn::LogError(ewn::LogCategory::Client) << "Failed to load config file";
+		return EXIT_FAILURE;
+	}
+
+	ewn::LoadTester loadTester(app, app.GetConfig());
+
+	while (app.Run() && loadTester.Update())
+		Nz::Thread::Sleep(1);
+
+	// Give reactors some time to send disconnection packets, instead of letting the server time out every client
+	for (unsigned int i = 0; i < 100 && app.Run(); ++i)
+		Nz::Thread::Sleep(10);
+
+	bool succeeded = loadTester.HasEveryClientReceivedArena();
+	if (!succeeded)
+		ewn::LogError(ewn::LogCategory::Client) << "Some clients never received the arena";
+
+	ewn::LogInfo(ewn::LogCategory::Client) << "Load test over";
+	ewn::Logger::Flush();
+
+	return (succeeded) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
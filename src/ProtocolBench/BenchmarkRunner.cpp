@@ -0,0 +1,166 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ProtocolBench/BenchmarkRunner.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <unordered_map>
+
+namespace
+{
+	// Per thread so allocations from the logger thread (or any other) don't pollute results
+	thread_local Nz::UInt64 s_allocationCount = 0;
+
+	void* CountedAllocate(std::size_t size)
+	{
+		s_allocationCount++;
+
+		if (void* ptr = std::malloc((size > 0) ? size : 1))
+			return ptr;
+
+		throw std::bad_alloc();
+	}
+}
+
+void* operator new(std::size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::size_t /*size*/) noexcept
+{
+	std::free(ptr);
+}
+
+namespace ewn
+{
+	BenchmarkRunner::BenchmarkRunner(std::string filter) :
+	m_filter(std::move(filter))
+	{
+		std::cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(12) << "ns/op" << std::setw(12) << "MB/s" << std::setw(12) << "allocs/op" << std::setw(10) << "bytes" << '\n';
+	}
+
+	bool BenchmarkRunner::CompareToBaseline(const std::string& filePath, double timeThreshold) const
+	{
+		std::ifstream file(filePath);
+		if (!file)
+		{
+			std::cerr << "Failed to open baseline file " << filePath << std::endl;
+			return false;
+		}
+
+		std::unordered_map<std::string, Result> baseline;
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (line.empty() || line.front() == '#')
+				continue;
+
+			Result entry;
+
+			std::istringstream lineStream(line);
+			if (!(lineStream >> entry.name >> entry.nanosecondsPerOp >> entry.allocationsPerOp >> entry.byteCount))
+			{
+				std::cerr << "Invalid baseline line: " << line << std::endl;
+				return false;
+			}
+
+			baseline.emplace(entry.name, std::move(entry));
+		}
+
+		bool regressed = false;
+		for (const Result& result : m_results)
+		{
+			auto it = baseline.find(result.name);
+			if (it == baseline.end())
+			{
+				std::cout << result.name << ": not in baseline\n";
+				continue;
+			}
+
+			const Result& reference = it->second;
+
+			// Allocation count and encoded size are deterministic, any increase is a regression
+			if (result.nanosecondsPerOp > reference.nanosecondsPerOp * (1.0 + timeThreshold))
+			{
+				std::cout << result.name << ": " << std::fixed << std::setprecision(1) << result.nanosecondsPerOp << " ns/op, was " << reference.nanosecondsPerOp << " ns/op (+" << (result.nanosecondsPerOp / reference.nanosecondsPerOp - 1.0) * 100.0 << "%)\n";
+				regressed = true;
+			}
+
+			if (result.allocationsPerOp > reference.allocationsPerOp + 0.01)
+			{
+				std::cout << result.name << ": " << std::fixed << std::setprecision(2) << result.allocationsPerOp << " allocs/op, was " << reference.allocationsPerOp << '\n';
+				regressed = true;
+			}
+
+			if (result.byteCount > reference.byteCount)
+			{
+				std::cout << result.name << ": " << result.byteCount << " bytes, was " << reference.byteCount << '\n';
+				regressed = true;
+			}
+		}
+
+		return !regressed;
+	}
+
+	bool BenchmarkRunner::SaveBaseline(const std::string& filePath) const
+	{
+		std::ofstream file(filePath, std::ios::trunc);
+		if (!file)
+		{
+			std::cerr << "Failed to open " << filePath << " for writing" << std::endl;
+			return false;
+		}
+
+		file << "# name ns/op allocs/op bytes\n";
+		for (const Result& result : m_results)
+			file << result.name << ' ' << result.nanosecondsPerOp << ' ' << result.allocationsPerOp << ' ' << result.byteCount << '\n';
+
+		return file.good();
+	}
+
+	Nz::UInt64 BenchmarkRunner::GetAllocationCount()
+	{
+		return s_allocationCount;
+	}
+
+	void BenchmarkRunner::PrintResult(const Result& result)
+	{
+		std::cout << std::left << std::setw(40) << result.name << std::right << std::fixed;
+		std::cout << std::setprecision(1) << std::setw(12) << result.nanosecondsPerOp;
+
+		// Bytes per nanosecond to megabytes per second
+		if (result.byteCount > 0)
+			std::cout << std::setw(12) << result.byteCount * 1000.0 / result.nanosecondsPerOp;
+		else
+			std::cout << std::setw(12) << '-';
+
+		std::cout << std::setprecision(2) << std::setw(12) << result.allocationsPerOp << std::setw(10) << result.byteCount << std::endl;
+	}
+}
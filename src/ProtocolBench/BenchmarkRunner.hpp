@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_PROTOCOLBENCH_BENCHMARKRUNNER_HPP
+#define EREWHON_PROTOCOLBENCH_BENCHMARKRUNNER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Times a function over enough iterations to get stable results, and counts heap allocations it performs
+	class BenchmarkRunner
+	{
+		public:
+			struct Result;
+
+			BenchmarkRunner(std::string filter);
+			~BenchmarkRunner() = default;
+
+			bool CompareToBaseline(const std::string& filePath, double timeThreshold) const;
+
+			inline const std::vector<Result>& GetResults() const;
+
+			template<typename F> void Run(const std::string& name, std::size_t byteCount, F&& func);
+
+			bool SaveBaseline(const std::string& filePath) const;
+
+			static Nz::UInt64 GetAllocationCount();
+
+			struct Result
+			{
+				std::string name;
+				std::size_t byteCount; //< bytes processed per operation, 0 if meaningless
+				double allocationsPerOp;
+				double nanosecondsPerOp;
+			};
+
+			static constexpr std::size_t SampleCount = 5;
+			static constexpr Nz::UInt64 MinSampleDuration = 10'000'000; //< nanoseconds
+
+		private:
+			template<typename F> static Nz::UInt64 Measure(F& func, std::size_t iterationCount);
+			static void PrintResult(const Result& result);
+
+			std::string m_filter;
+			std::vector<Result> m_results;
+	};
+}
+
+#include <ProtocolBench/BenchmarkRunner.inl>
+
+#endif // EREWHON_PROTOCOLBENCH_BENCHMARKRUNNER_HPP
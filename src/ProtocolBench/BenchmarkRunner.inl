@@ -0,0 +1,55 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ProtocolBench/BenchmarkRunner.hpp>
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+namespace ewn
+{
+	inline auto BenchmarkRunner::GetResults() const -> const std::vector<Result>&
+	{
+		return m_results;
+	}
+
+	template<typename F>
+	void BenchmarkRunner::Run(const std::string& name, std::size_t byteCount, F&& func)
+	{
+		if (!m_filter.empty() && name.find(m_filter) == std::string::npos)
+			return;
+
+		// Warm up caches and memory pools while looking for an iteration count filling a sample
+		std::size_t iterationCount = 1;
+		while (Measure(func, iterationCount) < MinSampleDuration)
+			iterationCount *= 2;
+
+		Result result;
+		result.byteCount = byteCount;
+		result.name = name;
+		result.nanosecondsPerOp = std::numeric_limits<double>::infinity();
+
+		Nz::UInt64 allocationCount = GetAllocationCount();
+		for (std::size_t i = 0; i < SampleCount; ++i)
+		{
+			// Keep the fastest sample, slower ones only measure noise from the rest of the system
+			Nz::UInt64 duration = Measure(func, iterationCount);
+			result.nanosecondsPerOp = std::min(result.nanosecondsPerOp, double(duration) / iterationCount);
+		}
+		result.allocationsPerOp = double(GetAllocationCount() - allocationCount) / (SampleCount * iterationCount);
+
+		PrintResult(result);
+		m_results.emplace_back(std::move(result));
+	}
+
+	template<typename F>
+	Nz::UInt64 BenchmarkRunner::Measure(F& func, std::size_t iterationCount)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (std::size_t i = 0; i < iterationCount; ++i)
+			func();
+
+		return static_cast<Nz::UInt64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+	}
+}
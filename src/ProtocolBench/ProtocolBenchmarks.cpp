@@ -0,0 +1,769 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ProtocolBench/ProtocolBenchmarks.hpp>
+#include <Nazara/Math/EulerAngles.hpp>
+#include <Shared/CommandStore.hpp>
+#include <Shared/MovementInputHistory.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/PacketBundle.hpp>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+namespace ewn
+{
+	namespace
+	{
+		struct BenchmarkPeer
+		{
+			std::size_t GetPeerId() const
+			{
+				return 0;
+			}
+
+			std::size_t receivedCount = 0;
+		};
+
+		template<typename T>
+		void HandlePacket(BenchmarkPeer* peer, const T& /*data*/)
+		{
+			peer->receivedCount++;
+		}
+
+		class BenchmarkCommandStore final : public CommandStore<BenchmarkPeer*>
+		{
+			public:
+				BenchmarkCommandStore()
+				{
+					RegisterIncomingCommand<Packets::ArenaState, &HandlePacket<Packets::ArenaState>>("ArenaState");
+					RegisterIncomingCommand<Packets::BotMessage, &HandlePacket<Packets::BotMessage>>("BotMessage");
+					RegisterIncomingCommand<Packets::ChatMessage, &HandlePacket<Packets::ChatMessage>>("ChatMessage");
+					RegisterIncomingCommand<Packets::CreateProjectiles, &HandlePacket<Packets::CreateProjectiles>>("CreateProjectiles");
+					RegisterIncomingCommand<Packets::DeleteProjectiles, &HandlePacket<Packets::DeleteProjectiles>>("DeleteProjectiles");
+					RegisterIncomingCommand<Packets::IntegrityUpdate, &HandlePacket<Packets::IntegrityUpdate>>("IntegrityUpdate");
+					RegisterIncomingCommand<Packets::PlayerMovement, &HandlePacket<Packets::PlayerMovement>>("PlayerMovement");
+					RegisterIncomingCommand<Packets::PlaySound, &HandlePacket<Packets::PlaySound>>("PlaySound");
+				}
+		};
+
+		// Values are generated from the index so runs are comparable with each other
+		Nz::Vector3f MakeVector(std::size_t i, float scale)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Vector3f(std::sin(value * 0.7f), std::cos(value * 1.3f), std::sin(value * 2.1f)) * scale;
+		}
+
+		Nz::Quaternionf MakeRotation(std::size_t i)
+		{
+			float value = static_cast<float>(i);
+			return Nz::Quaternionf(Nz::EulerAnglesf(std::sin(value) * 90.f, std::cos(value) * 180.f, value));
+		}
+
+		// Steady state packet, carrying as many previous inputs as it can
+		Packets::PlayerMovement MakePlayerMovement()
+		{
+			MovementInputHistory inputHistory;
+
+			Packets::PlayerMovement movementPacket;
+			for (std::size_t i = 0; i <= MovementInputHistory::MaxRedundantInputs; ++i)
+			{
+				float time = static_cast<float>(i) * 0.016f;
+				Nz::Vector3f direction(1.f, std::sin(time) * 0.5f, 0.f);
+				Nz::Vector3f rotation(0.f, std::cos(time * 0.5f), std::sin(time * 0.25f));
+
+				inputHistory.PushInput(3'600'000 + i * 16, direction, rotation, &movementPacket);
+			}
+
+			return movementPacket;
+		}
+
+		std::string MakeScript(std::size_t length)
+		{
+			static const char snippet[] = "function Spaceship:OnTick(elapsedTime)\n\tlocal pos = self.Core:GetPosition()\n\tself.Engine:Impulse(Vec3(1, 0, 0), 1)\nend\n";
+
+			std::string script;
+			script.reserve(length);
+			while (script.size() < length)
+				script += snippet;
+
+			script.resize(length);
+			return script;
+		}
+
+		Packets::ArenaState MakeArenaState(std::size_t entityCount)
+		{
+			Packets::ArenaState arenaState;
+			arenaState.stateId = 4242;
+			arenaState.serverTime = 3'600'000;
+			arenaState.lastProcessedInputTime = 3'599'950;
+
+			arenaState.entities.resize(entityCount);
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& entity = arenaState.entities[i];
+				entity.id = static_cast<Nz::UInt32>(i * 7 + 1);
+				entity.angularVelocity = MakeVector(i, 2.f);
+				entity.linearVelocity = MakeVector(i + 1, 50.f);
+				entity.position = MakeVector(i + 2, 1000.f);
+				entity.rotation = MakeRotation(i);
+			}
+
+			return arenaState;
+		}
+
+		Packets::CreateEntities MakeCreateEntities(std::size_t entityCount)
+		{
+			Packets::CreateEntities createEntities;
+
+			createEntities.entities.resize(entityCount);
+			for (std::size_t i = 0; i < entityCount; ++i)
+			{
+				auto& entity = createEntities.entities[i];
+				entity.angularVelocity = MakeVector(i, 2.f);
+				entity.entityId = static_cast<Nz::UInt32>(i * 3 + 1);
+				entity.linearVelocity = MakeVector(i + 1, 50.f);
+				entity.position = MakeVector(i + 2, 1000.f);
+				entity.prefabId = static_cast<Nz::UInt32>(i % 12);
+				entity.rotation = MakeRotation(i);
+				entity.visualName = ("Player #" + std::to_string(i)).c_str();
+			}
+
+			return createEntities;
+		}
+
+		Packets::FleetInfo MakeFleetInfo(std::size_t typeCount, std::size_t spaceshipCount)
+		{
+			Packets::FleetInfo fleetInfo;
+			fleetInfo.fleetName = "Benchmark fleet";
+			fleetInfo.spaceshipInfo = SpaceshipQueryInfo::Code | SpaceshipQueryInfo::HullModelPath | SpaceshipQueryInfo::Modules | SpaceshipQueryInfo::Name;
+
+			fleetInfo.spaceshipTypes.resize(typeCount);
+			for (std::size_t i = 0; i < typeCount; ++i)
+			{
+				auto& spaceshipType = fleetInfo.spaceshipTypes[i];
+				spaceshipType.dimensions = Nz::Boxf(-5.f, -2.f, -8.f, 10.f, 4.f, 16.f);
+				spaceshipType.hullModelPath = "Spaceship/hull_" + std::to_string(i) + "/hull.obj";
+				spaceshipType.name = "Spaceship type " + std::to_string(i);
+				spaceshipType.scale = 1.f + i * 0.5f;
+				spaceshipType.script = MakeScript(2048);
+
+				spaceshipType.modules.resize(6);
+				for (std::size_t j = 0; j < spaceshipType.modules.size(); ++j)
+				{
+					spaceshipType.modules[j].currentModule = static_cast<Nz::UInt16>(j + 1);
+					spaceshipType.modules[j].type = static_cast<ModuleType>(j % 4);
+				}
+			}
+
+			fleetInfo.spaceships.resize(spaceshipCount);
+			for (std::size_t i = 0; i < spaceshipCount; ++i)
+			{
+				fleetInfo.spaceships[i].position = MakeVector(i, 100.f);
+				fleetInfo.spaceships[i].spaceshipType = i % typeCount;
+			}
+
+			return fleetInfo;
+		}
+
+		Packets::NetworkStrings MakeNetworkStrings(std::size_t stringCount)
+		{
+			Packets::NetworkStrings networkStrings;
+			networkStrings.startId = 0;
+
+			networkStrings.strings.reserve(stringCount);
+			for (std::size_t i = 0; i < stringCount; ++i)
+				networkStrings.strings.emplace_back("Models/spaceship_" + std::to_string(i) + "/spaceship.obj");
+
+			return networkStrings;
+		}
+	}
+
+	ProtocolBenchmarks::ProtocolBenchmarks(BenchmarkRunner& runner) :
+	m_runner(runner),
+	m_failed(false)
+	{
+	}
+
+	bool ProtocolBenchmarks::Run()
+	{
+		BenchmarkCompressedIntegers();
+		BenchmarkPackets();
+		BenchmarkDispatch();
+		BenchmarkBundle();
+
+		for (std::size_t i = 0; i < PacketTypeCount; ++i)
+		{
+			if (!m_coveredPackets.test(i))
+			{
+				std::cerr << "Packet type #" << i << " has no benchmark" << std::endl;
+				m_failed = true;
+			}
+		}
+
+		return !m_failed;
+	}
+
+	void ProtocolBenchmarks::BenchmarkCompressedIntegers()
+	{
+		constexpr std::size_t ValueCount = 1024;
+
+		// Spread values over every encoded length, as real ids, times and sizes are
+		std::mt19937_64 randomGenerator(42);
+
+		std::vector<Nz::UInt32> unsigned32(ValueCount);
+		std::vector<Nz::UInt64> unsigned64(ValueCount);
+		std::vector<Nz::Int32> signed32(ValueCount);
+		std::vector<Nz::Int64> signed64(ValueCount);
+		for (std::size_t i = 0; i < ValueCount; ++i)
+		{
+			Nz::UInt64 value = randomGenerator() >> (randomGenerator() % 64);
+			bool negative = (randomGenerator() & 1) != 0;
+
+			unsigned32[i] = static_cast<Nz::UInt32>(value >> 32);
+			unsigned64[i] = value;
+			signed32[i] = static_cast<Nz::Int32>(value >> 33) * (negative ? -1 : 1);
+			signed64[i] = static_cast<Nz::Int64>(value >> 1) * (negative ? -1 : 1);
+		}
+
+		BenchmarkCompressedInteger<CompressedUnsigned<Nz::UInt32>>("CompressedUnsigned32", unsigned32);
+		BenchmarkCompressedInteger<CompressedUnsigned<Nz::UInt64>>("CompressedUnsigned64", unsigned64);
+		BenchmarkCompressedInteger<CompressedSigned<Nz::Int32>>("CompressedSigned32", signed32);
+		BenchmarkCompressedInteger<CompressedSigned<Nz::Int64>>("CompressedSigned64", signed64);
+	}
+
+	void ProtocolBenchmarks::BenchmarkDispatch()
+	{
+		BenchmarkCommandStore commandStore;
+		BenchmarkPeer peer;
+
+		auto BenchmarkCommand = [&](const std::string& name, const auto& packet)
+		{
+			Nz::NetPacket encodedPacket;
+			commandStore.SerializePacket(encodedPacket, packet);
+
+			const Nz::UInt8* encodedPtr = encodedPacket.GetConstData() + Nz::NetPacket::HeaderSize;
+			std::vector<Nz::UInt8> encoded(encodedPtr, encodedPtr + encodedPacket.GetDataSize());
+
+			std::size_t receivedCount = peer.receivedCount;
+			if (!commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size())) || peer.receivedCount != receivedCount + 1)
+			{
+				std::cerr << name << ": packet was not dispatched" << std::endl;
+				m_failed = true;
+				return;
+			}
+
+			// A malformed packet must be reported without reaching the handler
+			if (commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size() - 1)) || peer.receivedCount != receivedCount + 1)
+			{
+				std::cerr << name << ": truncated packet was dispatched" << std::endl;
+				m_failed = true;
+				return;
+			}
+
+			m_runner.Run(name, encoded.size(), [&]()
+			{
+				commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size()));
+			});
+		};
+
+		BenchmarkCommand("Dispatch/PlayerMovement", MakePlayerMovement());
+		BenchmarkCommand("Dispatch/ArenaState/20", MakeArenaState(20));
+	}
+
+	void ProtocolBenchmarks::BenchmarkBundle()
+	{
+		BenchmarkCommandStore commandStore;
+		BenchmarkPeer peer;
+
+		// Reliable messages a player in a fight receives during a single tick, they used to be sent as eight packets
+		Packets::BotMessage botMessage;
+		botMessage.errorMessage = "[string \"spaceship\"]:12: attempt to index a nil value (field 'Engine')";
+		botMessage.messageType = BotMessageType::Error;
+
+		Packets::ChatMessage chatMessage;
+		chatMessage.message = "Player #12: focus the frigate!";
+
+		Packets::CreateProjectiles createProjectiles;
+		Packets::DeleteProjectiles deleteProjectiles;
+		for (std::size_t i = 0; i < 2; ++i)
+		{
+			createProjectiles.projectiles.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(100 + i)), CompressedUnsigned<Nz::UInt32>(3), CompressedUnsigned<Nz::UInt64>(3'600'000 + i * 16), MakeVector(i, 1.f), MakeVector(i + 1, 1000.f), 5.f, 200.f });
+			deleteProjectiles.projectiles.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(90 + i)) });
+		}
+
+		Packets::IntegrityUpdate integrityUpdate;
+		integrityUpdate.integrityValue = 180;
+
+		Packets::PlaySound playSound;
+		playSound.position = MakeVector(1, 1000.f);
+		playSound.soundId = 4;
+
+		auto FillBundle = [&](PacketBundle& bundle)
+		{
+			bool fits = true;
+			fits &= bundle.Append(createProjectiles) > 0;
+			fits &= bundle.Append(deleteProjectiles) > 0;
+			fits &= bundle.Append(integrityUpdate) > 0;
+			fits &= bundle.Append(playSound) > 0;
+			fits &= bundle.Append(playSound) > 0;
+			fits &= bundle.Append(integrityUpdate) > 0;
+			fits &= bundle.Append(botMessage) > 0;
+			fits &= bundle.Append(chatMessage) > 0;
+
+			return fits;
+		};
+
+		PacketBundle bundle;
+		if (!FillBundle(bundle))
+		{
+			std::cerr << "Bundle/CombatTick: messages don't fit in a bundle" << std::endl;
+			m_failed = true;
+			return;
+		}
+
+		std::size_t messageCount = bundle.GetMessageCount();
+
+		Nz::NetPacket bundlePacket;
+		bundle.Flush(bundlePacket);
+
+		const Nz::UInt8* bundlePtr = bundlePacket.GetConstData() + Nz::NetPacket::HeaderSize;
+		std::vector<Nz::UInt8> encoded(bundlePtr, bundlePtr + bundlePacket.GetDataSize());
+
+		std::size_t receivedCount = peer.receivedCount;
+		if (!commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size())) || peer.receivedCount != receivedCount + messageCount)
+		{
+			std::cerr << "Bundle/CombatTick: bundled messages were not all dispatched" << std::endl;
+			m_failed = true;
+			return;
+		}
+
+		if (commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size() - 1)))
+		{
+			std::cerr << "Bundle/CombatTick: truncated bundle was accepted" << std::endl;
+			m_failed = true;
+			return;
+		}
+
+		// Server side: appending the tick messages and building the packet
+		m_runner.Run("Bundle/CombatTick", encoded.size(), [&]()
+		{
+			FillBundle(bundle);
+
+			Nz::NetPacket packet;
+			bundle.Flush(packet);
+		});
+
+		m_runner.Run("Dispatch/Bundle/CombatTick", encoded.size(), [&]()
+		{
+			commandStore.UnserializePacket(&peer, Nz::NetPacket(0, encoded.data(), encoded.size()));
+		});
+	}
+
+	void ProtocolBenchmarks::BenchmarkPackets()
+	{
+		// Packets with data are filled with what a typical session sends, empty ones still pay the dispatch and buffer costs
+		{
+			Packets::ArenaList arenaList;
+			for (std::size_t i = 0; i < 8; ++i)
+				arenaList.arenas.push_back({ "Arena #" + std::to_string(i) });
+
+			BenchmarkPacket("ArenaList", std::move(arenaList));
+		}
+
+		{
+			Packets::ArenaParticleSystems particleSystems;
+			particleSystems.startId = 0;
+			particleSystems.particleSystems.resize(20);
+			for (std::size_t i = 0; i < particleSystems.particleSystems.size(); ++i)
+			{
+				for (std::size_t j = 0; j < 3; ++j)
+					particleSystems.particleSystems[i].particleGroups.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i * 3 + j)) });
+			}
+
+			BenchmarkPacket("ArenaParticleSystems", std::move(particleSystems));
+		}
+
+		{
+			Packets::ArenaPrefabs prefabs;
+			prefabs.startId = 0;
+			prefabs.prefabs.resize(50);
+			for (std::size_t i = 0; i < prefabs.prefabs.size(); ++i)
+			{
+				auto& prefab = prefabs.prefabs[i];
+				prefab.models.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i)), MakeRotation(i), MakeVector(i, 5.f), Nz::Vector3f::Unit() });
+				prefab.models.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i + 1)), MakeRotation(i + 1), MakeVector(i + 1, 5.f), Nz::Vector3f(0.5f) });
+				prefab.sounds.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i % 10)), MakeVector(i, 1.f) });
+				prefab.visualEffects.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i % 5)), MakeRotation(i), MakeVector(i, 2.f), Nz::Vector3f::Unit() });
+			}
+
+			BenchmarkCachedPacket("ArenaPrefabs/cached", prefabs);
+			BenchmarkPacket("ArenaPrefabs", std::move(prefabs));
+		}
+
+		{
+			Packets::ArenaSounds sounds;
+			sounds.startId = 0;
+			for (std::size_t i = 0; i < 30; ++i)
+				sounds.sounds.push_back({ "Sounds/sound_" + std::to_string(i) + ".wav" });
+
+			BenchmarkPacket("ArenaSounds", std::move(sounds));
+		}
+
+		BenchmarkPacket("ArenaState/1", MakeArenaState(1));
+		BenchmarkPacket("ArenaState/20", MakeArenaState(20));
+		BenchmarkPacket("ArenaState/60", MakeArenaState(60));
+
+		{
+			Packets::BotMessage botMessage;
+			botMessage.errorMessage = "[string \"spaceship\"]:12: attempt to index a nil value (field 'Engine')";
+			botMessage.messageType = BotMessageType::Error;
+
+			BenchmarkPacket("BotMessage", std::move(botMessage));
+		}
+
+		{
+			Packets::CachedPacketVersion cachedPacketVersion;
+			cachedPacketVersion.packetType = PacketType::ArenaPrefabs;
+			cachedPacketVersion.useCachedPacket = true;
+			cachedPacketVersion.version = 0xDEADBEEF;
+
+			BenchmarkPacket("CachedPacketVersion", std::move(cachedPacketVersion));
+		}
+
+		{
+			Packets::ChatMessage chatMessage;
+			chatMessage.message = "Player #12: anyone up for a match in the second arena?";
+
+			BenchmarkPacket("ChatMessage", std::move(chatMessage));
+		}
+
+		{
+			Packets::ControlEntity controlEntity;
+			controlEntity.id = 1337;
+
+			BenchmarkPacket("ControlEntity", std::move(controlEntity));
+		}
+
+		BenchmarkPacket("CreateEntities/500", MakeCreateEntities(500));
+
+		{
+			Packets::CreateFleet createFleet;
+			createFleet.fleetName = "Benchmark fleet";
+			createFleet.spaceshipNames = { "Scout", "Fighter", "Bomber" };
+			for (std::size_t i = 0; i < 12; ++i)
+				createFleet.spaceships.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i % 3)), MakeVector(i, 100.f) });
+
+			BenchmarkPacket("CreateFleet", std::move(createFleet));
+		}
+
+		{
+			Packets::CreateProjectiles createProjectiles;
+			for (std::size_t i = 0; i < 20; ++i)
+				createProjectiles.projectiles.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i + 5000)), CompressedUnsigned<Nz::UInt32>(3), CompressedUnsigned<Nz::UInt64>(3'600'000 + i * 16), MakeVector(i, 1.f), MakeVector(i + 1, 1000.f), 5.f, 200.f });
+
+			BenchmarkPacket("CreateProjectiles/20", std::move(createProjectiles));
+		}
+
+		{
+			Packets::CreateSpaceship createSpaceship;
+			createSpaceship.hullId = 2;
+			createSpaceship.spaceshipCode = MakeScript(2048);
+			createSpaceship.spaceshipName = "Fighter";
+			for (std::size_t i = 0; i < 6; ++i)
+				createSpaceship.modules.push_back({ static_cast<ModuleType>(i % 4), CompressedUnsigned<Nz::UInt16>(static_cast<Nz::UInt16>(i + 1)) });
+
+			BenchmarkPacket("CreateSpaceship", std::move(createSpaceship));
+		}
+
+		{
+			Packets::DeclareCachedPackets declareCachedPackets;
+			declareCachedPackets.packets.push_back({ PacketType::ArenaParticleSystems, 0x12345678 });
+			declareCachedPackets.packets.push_back({ PacketType::ArenaPrefabs, 0xDEADBEEF });
+			declareCachedPackets.packets.push_back({ PacketType::ArenaSounds, 0x0BADF00D });
+			declareCachedPackets.packets.push_back({ PacketType::NetworkStrings, 0xCAFEBABE });
+
+			BenchmarkPacket("DeclareCachedPackets", std::move(declareCachedPackets));
+		}
+
+		{
+			Packets::DeleteEntities deleteEntities;
+			for (std::size_t i = 0; i < 50; ++i)
+				deleteEntities.entities.emplace_back(static_cast<Nz::UInt32>(i * 7 + 1));
+
+			BenchmarkPacket("DeleteEntities/50", std::move(deleteEntities));
+		}
+
+		{
+			Packets::DeleteFleet deleteFleet;
+			deleteFleet.fleetName = "Benchmark fleet";
+
+			BenchmarkPacket("DeleteFleet", std::move(deleteFleet));
+		}
+
+		{
+			Packets::DeleteProjectiles deleteProjectiles;
+			for (std::size_t i = 0; i < 20; ++i)
+				deleteProjectiles.projectiles.emplace_back(static_cast<Nz::UInt32>(i + 5000));
+
+			BenchmarkPacket("DeleteProjectiles/20", std::move(deleteProjectiles));
+		}
+
+		{
+			Packets::DeleteSpaceship deleteSpaceship;
+			deleteSpaceship.spaceshipName = "Fighter";
+
+			BenchmarkPacket("DeleteSpaceship", std::move(deleteSpaceship));
+		}
+
+		BenchmarkPacket("FleetInfo", MakeFleetInfo(3, 12));
+
+		{
+			Packets::FleetList fleetList;
+			for (std::size_t i = 0; i < 10; ++i)
+				fleetList.fleets.push_back({ "Fleet #" + std::to_string(i) });
+
+			BenchmarkPacket("FleetList", std::move(fleetList));
+		}
+
+		{
+			Packets::HullList hullList;
+			for (std::size_t i = 0; i < 5; ++i)
+			{
+				Packets::HullList::HullInfo hullInfo;
+				hullInfo.description = "A hull fitting most playstyles, with room for " + std::to_string(4 + i) + " modules";
+				hullInfo.hullId = static_cast<Nz::UInt32>(i + 1);
+				hullInfo.hullModelPathId = static_cast<Nz::UInt32>(i + 10);
+				hullInfo.name = "Hull #" + std::to_string(i);
+				for (std::size_t j = 0; j < 4 + i; ++j)
+					hullInfo.slots.push_back({ static_cast<ModuleType>(j % 4) });
+
+				hullList.hulls.emplace_back(std::move(hullInfo));
+			}
+
+			BenchmarkPacket("HullList", std::move(hullList));
+		}
+
+		{
+			Packets::InstantiateEffects instantiateEffects;
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				instantiateEffects.particleSystems.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i)), MakeRotation(i), MakeVector(i, 1000.f), Nz::Vector3f::Unit() });
+				instantiateEffects.sounds.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i)), MakeVector(i, 1000.f) });
+			}
+
+			BenchmarkPacket("InstantiateEffects", std::move(instantiateEffects));
+		}
+
+		{
+			Packets::InstantiateParticleSystem instantiateParticleSystem;
+			instantiateParticleSystem.particleSystemId = 3;
+			instantiateParticleSystem.position = MakeVector(1, 1000.f);
+			instantiateParticleSystem.rotation = MakeRotation(1);
+			instantiateParticleSystem.scale = Nz::Vector3f::Unit();
+
+			BenchmarkPacket("InstantiateParticleSystem", std::move(instantiateParticleSystem));
+		}
+
+		{
+			Packets::IntegrityUpdate integrityUpdate;
+			integrityUpdate.integrityValue = 200;
+
+			BenchmarkPacket("IntegrityUpdate", std::move(integrityUpdate));
+		}
+
+		{
+			Packets::JoinArena joinArena;
+			joinArena.arenaIndex = 1;
+
+			BenchmarkPacket("JoinArena", std::move(joinArena));
+		}
+
+		{
+			Packets::Login login;
+			login.generateConnectionToken = true;
+			login.login = "benchmark";
+			login.passwordHash = std::string(64, 'f');
+
+			BenchmarkPacket("Login", std::move(login));
+		}
+
+		{
+			Packets::LoginByToken loginByToken;
+			loginByToken.connectionToken.assign(64, 0xAB);
+			loginByToken.generateConnectionToken = true;
+
+			BenchmarkPacket("LoginByToken", std::move(loginByToken));
+		}
+
+		{
+			Packets::LoginFailure loginFailure;
+			loginFailure.reason = LoginFailureReason::TooManyAttempts;
+			loginFailure.retryAfter = 2500;
+
+			BenchmarkPacket("LoginFailure", std::move(loginFailure));
+		}
+
+		{
+			Packets::LoginSuccess loginSuccess;
+			loginSuccess.connectionToken.assign(64, 0xAB);
+
+			BenchmarkPacket("LoginSuccess", std::move(loginSuccess));
+		}
+
+		{
+			Packets::ModuleList moduleList;
+			for (std::size_t i = 0; i < 4; ++i)
+			{
+				Packets::ModuleList::ModuleTypeInfo typeInfo;
+				typeInfo.type = static_cast<ModuleType>(i);
+				for (std::size_t j = 0; j < 5; ++j)
+					typeInfo.availableModules.push_back({ CompressedUnsigned<Nz::UInt16>(static_cast<Nz::UInt16>(i * 5 + j)), "Module #" + std::to_string(i * 5 + j) });
+
+				moduleList.modules.emplace_back(std::move(typeInfo));
+			}
+
+			BenchmarkPacket("ModuleList", std::move(moduleList));
+		}
+
+		BenchmarkPacket("NetworkStrings/200", MakeNetworkStrings(200));
+
+		{
+			Packets::PlayerChat playerChat;
+			playerChat.text = "anyone up for a match in the second arena?";
+
+			BenchmarkPacket("PlayerChat", std::move(playerChat));
+		}
+
+		BenchmarkPacket("PlayerMovement", MakePlayerMovement());
+
+		{
+			Packets::PlaySound playSound;
+			playSound.position = MakeVector(1, 1000.f);
+			playSound.soundId = 4;
+
+			BenchmarkPacket("PlaySound", std::move(playSound));
+		}
+
+		{
+			Packets::QueryFleetInfo queryFleetInfo;
+			queryFleetInfo.fleetName = "Benchmark fleet";
+			queryFleetInfo.spaceshipInfo = SpaceshipQueryInfo::Code | SpaceshipQueryInfo::HullModelPath | SpaceshipQueryInfo::Modules | SpaceshipQueryInfo::Name;
+
+			BenchmarkPacket("QueryFleetInfo", std::move(queryFleetInfo));
+		}
+
+		{
+			Packets::QuerySpaceshipInfo querySpaceshipInfo;
+			querySpaceshipInfo.info = SpaceshipQueryInfo::Code | SpaceshipQueryInfo::Modules;
+			querySpaceshipInfo.spaceshipName = "Fighter";
+
+			BenchmarkPacket("QuerySpaceshipInfo", std::move(querySpaceshipInfo));
+		}
+
+		{
+			Packets::Register registerPacket;
+			registerPacket.email = "benchmark@erewhon.test";
+			registerPacket.login = "benchmark";
+			registerPacket.passwordHash = std::string(64, 'f');
+
+			BenchmarkPacket("Register", std::move(registerPacket));
+		}
+
+		{
+			Packets::RegisterFailure registerFailure;
+			registerFailure.reason = RegisterFailureReason::LoginAlreadyTaken;
+
+			BenchmarkPacket("RegisterFailure", std::move(registerFailure));
+		}
+
+		{
+			Packets::RelayLogin relayLogin;
+			relayLogin.secret = std::string(32, 's');
+
+			BenchmarkPacket("RelayLogin", std::move(relayLogin));
+		}
+
+		{
+			Packets::SpaceshipInfo spaceshipInfo;
+			spaceshipInfo.code = MakeScript(2048);
+			spaceshipInfo.collisionBox = Nz::Boxf(-5.f, -2.f, -8.f, 10.f, 4.f, 16.f);
+			spaceshipInfo.hullId = 2;
+			spaceshipInfo.hullModelPath = "Spaceship/hull_2/hull.obj";
+			spaceshipInfo.info = SpaceshipQueryInfo::Code | SpaceshipQueryInfo::HullModelPath | SpaceshipQueryInfo::Modules | SpaceshipQueryInfo::Name;
+			spaceshipInfo.scale = 1.5f;
+			spaceshipInfo.spaceshipName = "Fighter";
+			for (std::size_t i = 0; i < 6; ++i)
+				spaceshipInfo.modules.push_back({ static_cast<ModuleType>(i % 4), CompressedUnsigned<Nz::UInt16>(static_cast<Nz::UInt16>(i + 1)) });
+
+			BenchmarkPacket("SpaceshipInfo", std::move(spaceshipInfo));
+		}
+
+		{
+			Packets::SpaceshipList spaceshipList;
+			for (std::size_t i = 0; i < 10; ++i)
+				spaceshipList.spaceships.push_back({ "Spaceship #" + std::to_string(i) });
+
+			BenchmarkPacket("SpaceshipList", std::move(spaceshipList));
+		}
+
+		{
+			Packets::TimeSyncRequest timeSyncRequest;
+			timeSyncRequest.requestId = 12;
+
+			BenchmarkPacket("TimeSyncRequest", std::move(timeSyncRequest));
+		}
+
+		{
+			Packets::TimeSyncResponse timeSyncResponse;
+			timeSyncResponse.requestId = 12;
+			timeSyncResponse.serverTime = 3'600'000;
+
+			BenchmarkPacket("TimeSyncResponse", std::move(timeSyncResponse));
+		}
+
+		{
+			Packets::UpdateFleet updateFleet;
+			updateFleet.fleetName = "Benchmark fleet";
+			updateFleet.newFleetName = "Renamed fleet";
+			updateFleet.spaceshipNames = { "Scout", "Fighter", "Bomber" };
+			for (std::size_t i = 0; i < 12; ++i)
+				updateFleet.spaceships.push_back({ CompressedUnsigned<Nz::UInt32>(static_cast<Nz::UInt32>(i % 3)), MakeVector(i, 100.f) });
+
+			BenchmarkPacket("UpdateFleet", std::move(updateFleet));
+		}
+
+		{
+			Packets::UpdateSpaceship updateSpaceship;
+			updateSpaceship.newSpaceshipCode = MakeScript(2048);
+			updateSpaceship.newSpaceshipName = "Heavy fighter";
+			updateSpaceship.spaceshipName = "Fighter";
+			updateSpaceship.modifiedModules.push_back({ ModuleType::Engine, "Basic engine", "Improved engine" });
+
+			BenchmarkPacket("UpdateSpaceship", std::move(updateSpaceship));
+		}
+
+		// Packets made of a single enum or without any field
+		BenchmarkPacket("CreateFleetFailure", Packets::CreateFleetFailure{});
+		BenchmarkPacket("CreateFleetSuccess", Packets::CreateFleetSuccess{});
+		BenchmarkPacket("CreateSpaceshipFailure", Packets::CreateSpaceshipFailure{});
+		BenchmarkPacket("CreateSpaceshipSuccess", Packets::CreateSpaceshipSuccess{});
+		BenchmarkPacket("DeleteFleetFailure", Packets::DeleteFleetFailure{});
+		BenchmarkPacket("DeleteFleetSuccess", Packets::DeleteFleetSuccess{});
+		BenchmarkPacket("DeleteSpaceshipFailure", Packets::DeleteSpaceshipFailure{});
+		BenchmarkPacket("DeleteSpaceshipSuccess", Packets::DeleteSpaceshipSuccess{});
+		BenchmarkPacket("LeaveArena", Packets::LeaveArena{});
+		BenchmarkPacket("PlayerShoot", Packets::PlayerShoot{});
+		BenchmarkPacket("QueryArenaList", Packets::QueryArenaList{});
+		BenchmarkPacket("QueryFleetList", Packets::QueryFleetList{});
+		BenchmarkPacket("QueryHullList", Packets::QueryHullList{});
+		BenchmarkPacket("QueryModuleList", Packets::QueryModuleList{});
+		BenchmarkPacket("QuerySpaceshipList", Packets::QuerySpaceshipList{});
+		BenchmarkPacket("RegisterSuccess", Packets::RegisterSuccess{});
+		BenchmarkPacket("UpdateFleetFailure", Packets::UpdateFleetFailure{});
+		BenchmarkPacket("UpdateFleetSuccess", Packets::UpdateFleetSuccess{});
+		BenchmarkPacket("UpdateSpaceshipFailure", Packets::UpdateSpaceshipFailure{});
+		BenchmarkPacket("UpdateSpaceshipSuccess", Packets::UpdateSpaceshipSuccess{});
+	}
+}
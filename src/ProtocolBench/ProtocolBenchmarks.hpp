@@ -0,0 +1,50 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_PROTOCOLBENCH_PROTOCOLBENCHMARKS_HPP
+#define EREWHON_PROTOCOLBENCH_PROTOCOLBENCHMARKS_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <bitset>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	class BenchmarkRunner;
+
+	// Serialization, unserialization and dispatch of every packet with representative data
+	// Each packet is checked first: exact ComputeSize, lossless round trip and rejection of truncated data
+	class ProtocolBenchmarks
+	{
+		public:
+			ProtocolBenchmarks(BenchmarkRunner& runner);
+			~ProtocolBenchmarks() = default;
+
+			bool Run();
+
+		private:
+			void BenchmarkBundle();
+			void BenchmarkCompressedIntegers();
+			template<typename C, typename T> void BenchmarkCompressedInteger(const std::string& name, const std::vector<T>& values);
+			void BenchmarkDispatch();
+			template<typename T> void BenchmarkCachedPacket(const std::string& name, const T& packet);
+			template<typename T> void BenchmarkPacket(const std::string& name, T packet);
+			void BenchmarkPackets();
+
+			template<typename T> static bool CheckPacket(const std::string& name, const T& packet);
+			template<typename T> static std::vector<Nz::UInt8> EncodePacket(const T& packet);
+
+			BenchmarkRunner& m_runner;
+			std::bitset<PacketTypeCount> m_coveredPackets;
+			bool m_failed;
+	};
+}
+
+#include <ProtocolBench/ProtocolBenchmarks.inl>
+
+#endif // EREWHON_PROTOCOLBENCH_PROTOCOLBENCHMARKS_HPP
@@ -0,0 +1,183 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <ProtocolBench/ProtocolBenchmarks.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+#include <ProtocolBench/BenchmarkRunner.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
+#include <Shared/Protocol/PacketSizer.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <algorithm>
+#include <iostream>
+
+namespace ewn
+{
+	template<typename C, typename T>
+	void ProtocolBenchmarks::BenchmarkCompressedInteger(const std::string& name, const std::vector<T>& values)
+	{
+		PacketSizer sizer;
+		for (T value : values)
+			sizer &= C(value);
+
+		std::vector<Nz::UInt8> encoded(sizer.GetSize());
+
+		auto Encode = [&]()
+		{
+			PacketWriter writer(encoded.data(), encoded.size());
+			for (T value : values)
+				writer &= C(value);
+		};
+
+		auto Decode = [&](std::vector<T>& decodedValues)
+		{
+			PacketReader reader(encoded.data(), encoded.size());
+			for (T& value : decodedValues)
+			{
+				C compressedValue;
+				reader &= compressedValue;
+
+				value = compressedValue;
+			}
+		};
+
+		Encode();
+
+		std::vector<T> decoded(values.size());
+		Decode(decoded);
+
+		if (decoded != values)
+		{
+			std::cerr << name << ": decoded values don't match encoded ones" << std::endl;
+			m_failed = true;
+			return;
+		}
+
+		m_runner.Run(name + "/encode", encoded.size(), Encode);
+
+		m_runner.Run(name + "/decode", encoded.size(), [&]()
+		{
+			Decode(decoded);
+		});
+	}
+
+	template<typename T>
+	void ProtocolBenchmarks::BenchmarkCachedPacket(const std::string& name, const T& packet)
+	{
+		CachedPacket<T> cachedPacket;
+		cachedPacket.Update(packet);
+
+		// Cached data must be what the command store would send, and its version must only depend on the content
+		std::vector<Nz::UInt8> expectedData = EncodePacket(packet);
+		expectedData.insert(expectedData.begin(), static_cast<Nz::UInt8>(T::Type));
+
+		CachedPacket<T> otherCachedPacket;
+		otherCachedPacket.Update(packet);
+
+		if (cachedPacket.GetData() != expectedData || otherCachedPacket.GetVersion() != cachedPacket.GetVersion())
+		{
+			std::cerr << name << ": cached packet doesn't match its serialized content" << std::endl;
+			m_failed = true;
+			return;
+		}
+
+		const std::vector<Nz::UInt8>& data = cachedPacket.GetData();
+
+		// To be compared with the serialize benchmark: what sending the packet to each joining player costs
+		m_runner.Run(name + "/send", data.size(), [&]()
+		{
+			Nz::NetPacket buffer(0, data.data(), data.size());
+		});
+	}
+
+	template<typename T>
+	void ProtocolBenchmarks::BenchmarkPacket(const std::string& name, T packet)
+	{
+		m_coveredPackets.set(static_cast<std::size_t>(T::Type));
+
+		// Benchmarking a broken serializer would be pointless
+		if (!CheckPacket(name, packet))
+		{
+			m_failed = true;
+			return;
+		}
+
+		std::vector<Nz::UInt8> encoded = EncodePacket(packet);
+
+		// Both measure what the network code does: a fresh packet per message
+		m_runner.Run(name + "/serialize", encoded.size(), [&]()
+		{
+			Nz::NetPacket buffer;
+			PacketWriter writer(buffer, 0, Packets::ComputeSize(packet));
+			Packets::Serialize(writer, packet);
+		});
+
+		m_runner.Run(name + "/unserialize", encoded.size(), [&]()
+		{
+			Nz::NetPacket buffer(0, encoded.data(), encoded.size());
+			PacketReader reader(buffer);
+
+			T data;
+			Packets::Unserialize(reader, data);
+		});
+	}
+
+	template<typename T>
+	bool ProtocolBenchmarks::CheckPacket(const std::string& name, const T& packet)
+	{
+		std::size_t packetSize = Packets::ComputeSize(packet);
+
+		std::vector<Nz::UInt8> encoded(packetSize);
+		PacketWriter writer(encoded.data(), encoded.size());
+		Packets::Serialize(writer, packet);
+
+		if (writer.GetOffset() != packetSize)
+		{
+			std::cerr << name << ": ComputeSize returned " << packetSize << " bytes but " << writer.GetOffset() << " were written" << std::endl;
+			return false;
+		}
+
+		T decoded;
+		PacketReader reader(encoded.data(), encoded.size());
+		if (!Packets::Unserialize(reader, decoded) || reader.GetRemainingSize() != 0)
+		{
+			std::cerr << name << ": failed to unserialize packet" << std::endl;
+			return false;
+		}
+
+		if (EncodePacket(decoded) != encoded)
+		{
+			std::cerr << name << ": packet doesn't survive a round trip" << std::endl;
+			return false;
+		}
+
+		// Truncated data must be rejected, not throw or read out of bounds
+		constexpr std::size_t MaxTruncationCount = 64;
+
+		std::size_t step = std::max<std::size_t>(packetSize / MaxTruncationCount, 1);
+		for (std::size_t truncatedSize = 0; truncatedSize < packetSize; truncatedSize += step)
+		{
+			T truncatedPacket;
+			PacketReader truncatedReader(encoded.data(), truncatedSize);
+			if (Packets::Unserialize(truncatedReader, truncatedPacket))
+			{
+				std::cerr << name << ": packet truncated to " << truncatedSize << " bytes was accepted" << std::endl;
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	template<typename T>
+	std::vector<Nz::UInt8> ProtocolBenchmarks::EncodePacket(const T& packet)
+	{
+		std::vector<Nz::UInt8> encoded(Packets::ComputeSize(packet));
+
+		PacketWriter writer(encoded.data(), encoded.size());
+		Packets::Serialize(writer, packet);
+
+		return encoded;
+	}
+}
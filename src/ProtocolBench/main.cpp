@@ -0,0 +1,68 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Protocol Bench" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <ProtocolBench/BenchmarkRunner.hpp>
+#include <ProtocolBench/ProtocolBenchmarks.hpp>
+#include <Shared/Logger.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+// Usage: ErewhonProtocolBench [--filter <name>] [--baseline <file>] [--threshold <percent>] [--save <file>]
+// Exits with a failure code if a benchmark is broken or if a result regressed compared to the baseline
+int main(int argc, char* argv[])
+{
+	std::string baselinePath;
+	std::string filter;
+	std::string savePath;
+	double threshold = 10.0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (i + 1 >= argc)
+		{
+			std::cerr << "Missing value for " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		if (arg == "--baseline")
+			baselinePath = argv[++i];
+		else if (arg == "--filter")
+			filter = argv[++i];
+		else if (arg == "--save")
+			savePath = argv[++i];
+		else if (arg == "--threshold")
+			threshold = std::atof(argv[++i]);
+		else
+		{
+			std::cerr << "Unknown option " << arg << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	Nz::Initializer<Nz::Network> nazara;
+
+	ewn::BenchmarkRunner runner(std::move(filter));
+	ewn::ProtocolBenchmarks benchmarks(runner);
+
+	bool succeeded = benchmarks.Run();
+
+	if (!savePath.empty() && !runner.SaveBaseline(savePath))
+		succeeded = false;
+
+	if (!baselinePath.empty())
+	{
+		if (runner.CompareToBaseline(baselinePath, threshold / 100.0))
+			std::cout << "No regression against " << baselinePath << std::endl;
+		else
+			succeeded = false;
+	}
+
+	ewn::Logger::Flush();
+
+	return (succeeded) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
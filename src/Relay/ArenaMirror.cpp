@@ -0,0 +1,76 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/ArenaMirror.hpp>
+
+namespace ewn
+{
+	ArenaMirror::ArenaMirror() :
+	m_lastStateTime(0)
+	{
+	}
+
+	void ArenaMirror::Apply(const Packets::ArenaState& arenaState)
+	{
+		for (const auto& entityState : arenaState.entities)
+		{
+			auto it = m_entities.find(entityState.id);
+			if (it == m_entities.end())
+				continue;
+
+			Packets::CreateEntities::Entity& entity = it->second;
+			entity.angularVelocity = entityState.angularVelocity;
+			entity.linearVelocity = entityState.linearVelocity;
+			entity.position = entityState.position;
+			entity.rotation = entityState.rotation;
+		}
+
+		m_lastStateTime = arenaState.serverTime;
+
+		// Clients let projectiles expire by themselves, the server doesn't delete them
+		for (auto it = m_projectiles.begin(); it != m_projectiles.end();)
+		{
+			const Packets::CreateProjectiles::Projectile& projectile = it->second;
+			if (projectile.spawnTime + static_cast<Nz::UInt64>(projectile.lifeTime * 1000.f) <= m_lastStateTime)
+				it = m_projectiles.erase(it);
+			else
+				++it;
+		}
+	}
+
+	void ArenaMirror::Apply(const Packets::CreateEntities& createEntities)
+	{
+		for (const auto& entity : createEntities.entities)
+			m_entities[entity.entityId] = entity;
+	}
+
+	void ArenaMirror::Apply(const Packets::CreateProjectiles& createProjectiles)
+	{
+		for (const auto& projectile : createProjectiles.projectiles)
+			m_projectiles[projectile.projectileId] = projectile;
+	}
+
+	void ArenaMirror::Apply(const Packets::DeleteEntities& deleteEntities)
+	{
+		for (Nz::UInt32 entityId : deleteEntities.entities)
+			m_entities.erase(entityId);
+	}
+
+	void ArenaMirror::Apply(const Packets::DeleteProjectiles& deleteProjectiles)
+	{
+		for (Nz::UInt32 projectileId : deleteProjectiles.projectiles)
+			m_projectiles.erase(projectileId);
+	}
+
+	void ArenaMirror::Clear()
+	{
+		m_entities.clear();
+		m_projectiles.clear();
+		m_arenaParticleSystems.Invalidate();
+		m_arenaPrefabs.Invalidate();
+		m_arenaSounds.Invalidate();
+		m_networkStrings.Invalidate();
+		m_lastStateTime = 0;
+	}
+}
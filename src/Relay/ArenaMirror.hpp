@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_RELAY_ARENAMIRROR_HPP
+#define EREWHON_RELAY_ARENAMIRROR_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <unordered_map>
+
+namespace ewn
+{
+	// State of the relayed arena as spectators currently see it (delay included), built from the packets released to them
+	// Spectators joining later receive it the same way the server sends its world to joining players
+	class ArenaMirror
+	{
+		public:
+			ArenaMirror();
+			ArenaMirror(const ArenaMirror&) = delete;
+			ArenaMirror(ArenaMirror&&) = delete;
+			~ArenaMirror() = default;
+
+			void Apply(const Packets::ArenaState& arenaState);
+			inline void Apply(const Packets::ArenaParticleSystems& arenaParticleSystems);
+			inline void Apply(const Packets::ArenaPrefabs& arenaPrefabs);
+			inline void Apply(const Packets::ArenaSounds& arenaSounds);
+			void Apply(const Packets::CreateEntities& createEntities);
+			void Apply(const Packets::CreateProjectiles& createProjectiles);
+			void Apply(const Packets::DeleteEntities& deleteEntities);
+			void Apply(const Packets::DeleteProjectiles& deleteProjectiles);
+			inline void Apply(const Packets::NetworkStrings& networkStrings);
+			template<typename T> void Apply(const T& packet); //< packets without lasting effect (sounds, chat, ...)
+
+			void Clear();
+
+			inline const CachedPacket<Packets::NetworkStrings>& GetNetworkStrings() const;
+
+			inline bool HasState() const;
+
+			template<typename S> void SendSnapshot(S& session) const; //< S being SpectatorSession, or anything sending packets the same way
+
+			ArenaMirror& operator=(const ArenaMirror&) = delete;
+			ArenaMirror& operator=(ArenaMirror&&) = delete;
+
+			static constexpr std::size_t JoinChunkSize = 1024; //< Same as the server (see Arena.cpp), each chunk fits in a single bundle
+
+		private:
+			std::unordered_map<Nz::UInt32, Packets::CreateEntities::Entity> m_entities;
+			std::unordered_map<Nz::UInt32, Packets::CreateProjectiles::Projectile> m_projectiles;
+			CachedPacket<Packets::ArenaParticleSystems> m_arenaParticleSystems;
+			CachedPacket<Packets::ArenaPrefabs> m_arenaPrefabs;
+			CachedPacket<Packets::ArenaSounds> m_arenaSounds;
+			CachedPacket<Packets::NetworkStrings> m_networkStrings;
+			Nz::UInt64 m_lastStateTime; //< server time of the last state, 0 until one was received
+	};
+}
+
+#include <Relay/ArenaMirror.inl>
+
+#endif // EREWHON_RELAY_ARENAMIRROR_HPP
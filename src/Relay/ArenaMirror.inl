@@ -0,0 +1,88 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/ArenaMirror.hpp>
+
+namespace ewn
+{
+	inline void ArenaMirror::Apply(const Packets::ArenaParticleSystems& arenaParticleSystems)
+	{
+		m_arenaParticleSystems.Update(arenaParticleSystems);
+	}
+
+	inline void ArenaMirror::Apply(const Packets::ArenaPrefabs& arenaPrefabs)
+	{
+		m_arenaPrefabs.Update(arenaPrefabs);
+	}
+
+	inline void ArenaMirror::Apply(const Packets::ArenaSounds& arenaSounds)
+	{
+		m_arenaSounds.Update(arenaSounds);
+	}
+
+	// The server always sends every string at once (see ServerApplication::GetNetworkStringsPacket)
+	inline void ArenaMirror::Apply(const Packets::NetworkStrings& networkStrings)
+	{
+		m_networkStrings.Update(networkStrings);
+	}
+
+	template<typename T>
+	void ArenaMirror::Apply(const T& /*packet*/)
+	{
+	}
+
+	inline const CachedPacket<Packets::NetworkStrings>& ArenaMirror::GetNetworkStrings() const
+	{
+		return m_networkStrings;
+	}
+
+	// Spectators can only join once the arena itself was received
+	inline bool ArenaMirror::HasState() const
+	{
+		return m_lastStateTime != 0 && m_networkStrings.IsValid();
+	}
+
+	// Networked strings aren't part of it, they're sent as soon as the spectator connects (see SpectatorSession::HandleDeclareCachedPackets)
+	template<typename S>
+	void ArenaMirror::SendSnapshot(S& session) const
+	{
+		if (m_arenaParticleSystems.IsValid())
+			session.SendCachedPacket(m_arenaParticleSystems);
+
+		if (m_arenaSounds.IsValid())
+			session.SendCachedPacket(m_arenaSounds);
+
+		if (m_arenaPrefabs.IsValid())
+			session.SendCachedPacket(m_arenaPrefabs);
+
+		Packets::CreateEntities createEntities;
+		for (const auto& pair : m_entities)
+		{
+			createEntities.entities.push_back(pair.second);
+
+			// A chunk holds at least one entity, even if it's bigger than a chunk on its own
+			if (createEntities.entities.size() > 1 && Packets::ComputeSize(createEntities) > JoinChunkSize)
+			{
+				createEntities.entities.pop_back();
+				session.SendPacket(createEntities);
+
+				createEntities.entities.clear();
+				createEntities.entities.push_back(pair.second);
+			}
+		}
+
+		if (!createEntities.entities.empty())
+			session.SendPacket(createEntities);
+
+		if (!m_projectiles.empty())
+		{
+			Packets::CreateProjectiles createProjectiles;
+			createProjectiles.projectiles.reserve(m_projectiles.size());
+			for (const auto& pair : m_projectiles)
+				createProjectiles.projectiles.push_back(pair.second);
+
+			session.SendPacket(createProjectiles);
+		}
+	}
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_RELAY_DELAYQUEUE_HPP
+#define EREWHON_RELAY_DELAYQUEUE_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <deque>
+
+namespace ewn
+{
+	// Holds values back for a fixed delay, releasing them in the order they were pushed
+	template<typename T>
+	class DelayQueue
+	{
+		public:
+			inline DelayQueue(Nz::UInt64 delay = 0);
+			DelayQueue(const DelayQueue&) = delete;
+			DelayQueue(DelayQueue&&) = delete;
+			~DelayQueue() = default;
+
+			inline void Clear();
+
+			inline Nz::UInt64 GetDelay() const;
+			inline std::size_t GetSize() const;
+
+			inline void Push(Nz::UInt64 now, T value);
+
+			template<typename F> void Release(Nz::UInt64 now, F&& callback);
+
+			inline void SetDelay(Nz::UInt64 delay);
+
+			DelayQueue& operator=(const DelayQueue&) = delete;
+			DelayQueue& operator=(DelayQueue&&) = delete;
+
+		private:
+			struct Entry
+			{
+				Nz::UInt64 releaseTime;
+				T value;
+			};
+
+			std::deque<Entry> m_entries;
+			Nz::UInt64 m_delay;
+	};
+}
+
+#include <Relay/DelayQueue.inl>
+
+#endif // EREWHON_RELAY_DELAYQUEUE_HPP
@@ -0,0 +1,59 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/DelayQueue.hpp>
+#include <utility>
+
+namespace ewn
+{
+	template<typename T>
+	DelayQueue<T>::DelayQueue(Nz::UInt64 delay) :
+	m_delay(delay)
+	{
+	}
+
+	template<typename T>
+	void DelayQueue<T>::Clear()
+	{
+		m_entries.clear();
+	}
+
+	template<typename T>
+	Nz::UInt64 DelayQueue<T>::GetDelay() const
+	{
+		return m_delay;
+	}
+
+	template<typename T>
+	std::size_t DelayQueue<T>::GetSize() const
+	{
+		return m_entries.size();
+	}
+
+	template<typename T>
+	void DelayQueue<T>::Push(Nz::UInt64 now, T value)
+	{
+		Entry& entry = m_entries.emplace_back();
+		entry.releaseTime = now + m_delay;
+		entry.value = std::move(value);
+	}
+
+	// Values are released once their delay has fully passed, a shorter delay set meanwhile doesn't reorder them
+	template<typename T>
+	template<typename F>
+	void DelayQueue<T>::Release(Nz::UInt64 now, F&& callback)
+	{
+		while (!m_entries.empty() && m_entries.front().releaseTime <= now)
+		{
+			callback(m_entries.front().value);
+			m_entries.pop_front();
+		}
+	}
+
+	template<typename T>
+	void DelayQueue<T>::SetDelay(Nz::UInt64 delay)
+	{
+		m_delay = delay;
+	}
+}
@@ -0,0 +1,49 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/RelayCommandStore.hpp>
+#include <Relay/SpectatorSession.hpp>
+
+namespace ewn
+{
+	RelayCommandStore::RelayCommandStore()
+	{
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type, &SpectatorSession::Handle##Type>(#Type)
+#define OutgoingCommand(Type, Flags, Channel) RegisterOutgoingCommand<Packets::Type>(#Type, Flags, Channel)
+
+		// Incoming commands
+		IncomingCommand(DeclareCachedPackets);
+		IncomingCommand(JoinArena);
+		IncomingCommand(LeaveArena);
+		IncomingCommand(Login);
+		IncomingCommand(LoginByToken);
+		IncomingCommand(PlayerChat);
+		IncomingCommand(PlayerMovement);
+		IncomingCommand(PlayerShoot);
+		IncomingCommand(QueryArenaList);
+		IncomingCommand(TimeSyncRequest);
+
+		// Outgoing commands, same flags and channels as the server (see ServerCommandStore)
+		OutgoingCommand(ArenaList,                 Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ArenaPrefabs,              Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ArenaParticleSystems,      Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ArenaSounds,               Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ArenaState,                0,                           1);
+		OutgoingCommand(CachedPacketVersion,       Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(ChatMessage,               Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CreateEntities,            Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CreateProjectiles,         Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeleteEntities,            Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeleteProjectiles,         Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(InstantiateEffects,        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(InstantiateParticleSystem, Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(LoginSuccess,              Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(NetworkStrings,            Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(PlaySound,                 Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(TimeSyncResponse,          0,                           0);
+
+#undef IncomingCommand
+#undef OutgoingCommand
+	}
+}
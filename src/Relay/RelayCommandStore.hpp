@@ -0,0 +1,26 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_RELAY_COMMANDSTORE_HPP
+#define EREWHON_RELAY_COMMANDSTORE_HPP
+
+#include <Shared/CommandStore.hpp>
+
+namespace ewn
+{
+	class SpectatorSession;
+
+	class RelayCommandStore final : public CommandStore<SpectatorSession>
+	{
+		public:
+			RelayCommandStore();
+			~RelayCommandStore() = default;
+	};
+}
+
+#include <Relay/RelayCommandStore.inl>
+
+#endif // EREWHON_RELAY_COMMANDSTORE_HPP
@@ -0,0 +1,325 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/RelayServer.hpp>
+#include <Client/ClientApplication.hpp>
+#include <Shared/ConfigFile.hpp>
+#include <Shared/Logger.hpp>
+#include <algorithm>
+#include <type_traits>
+
+namespace ewn
+{
+	static constexpr Nz::UInt64 ReconnectDelay = 5'000; //< milliseconds
+
+	RelayServer::RelayServer(ClientApplication& app, const ConfigFile& config) :
+	m_app(app),
+	m_server(app),
+	m_upstreamState(UpstreamState::Disconnected),
+	m_reconnectTime(0),
+	m_spectatorCount(0),
+	m_running(true)
+	{
+		m_arenaIndex = config.GetIntegerOption<Nz::UInt8>("Relay.ArenaIndex");
+		m_delayedPackets.SetDelay(config.GetIntegerOption<Nz::UInt64>("Relay.Delay"));
+		m_secret = config.GetStringOption("Relay.Secret");
+		m_serverAddress = config.GetStringOption("Server.Address");
+
+		m_bundleFlags.fill(Nz::ENetPacketFlag_Reliable);
+
+		// Spread spectators over a few reactors listening on consecutive ports, each one having its own thread
+		std::size_t maxSpectators = config.GetIntegerOption<std::size_t>("Relay.MaxSpectators");
+		std::size_t reactorCount = config.GetIntegerOption<std::size_t>("Relay.ReactorCount");
+		Nz::UInt16 firstPort = config.GetIntegerOption<Nz::UInt16>("Relay.Port");
+
+		m_peerPerReactor = (maxSpectators + reactorCount - 1) / reactorCount;
+		m_spectators.resize(m_peerPerReactor * reactorCount);
+
+		for (std::size_t i = 0; i < reactorCount; ++i)
+			m_reactors.emplace_back(std::make_unique<NetworkReactor>(m_peerPerReactor * i, Nz::NetProtocol_Any, Nz::UInt16(firstPort + i), m_peerPerReactor));
+
+		m_server.OnArenaList.Connect(this, &RelayServer::OnArenaList);
+		m_server.OnConnected.Connect(this, &RelayServer::OnConnected);
+		m_server.OnDisconnected.Connect(this, &RelayServer::OnDisconnected);
+		m_server.OnLoginFailure.Connect(this, &RelayServer::OnLoginFailure);
+		m_server.OnLoginSuccess.Connect(this, &RelayServer::OnLoginSuccess);
+
+		// Everything the arena sends to its spectators goes through the delay queue
+		m_server.OnArenaParticleSystems.Connect(this,      &RelayServer::OnRelayedPacket<Packets::ArenaParticleSystems>);
+		m_server.OnArenaPrefabs.Connect(this,              &RelayServer::OnRelayedPacket<Packets::ArenaPrefabs>);
+		m_server.OnArenaSounds.Connect(this,               &RelayServer::OnRelayedPacket<Packets::ArenaSounds>);
+		m_server.OnArenaState.Connect(this,                &RelayServer::OnRelayedPacket<Packets::ArenaState>);
+		m_server.OnChatMessage.Connect(this,               &RelayServer::OnRelayedPacket<Packets::ChatMessage>);
+		m_server.OnCreateEntities.Connect(this,            &RelayServer::OnRelayedPacket<Packets::CreateEntities>);
+		m_server.OnCreateProjectiles.Connect(this,         &RelayServer::OnRelayedPacket<Packets::CreateProjectiles>);
+		m_server.OnDeleteEntities.Connect(this,            &RelayServer::OnRelayedPacket<Packets::DeleteEntities>);
+		m_server.OnDeleteProjectiles.Connect(this,         &RelayServer::OnRelayedPacket<Packets::DeleteProjectiles>);
+		m_server.OnInstantiateEffects.Connect(this,        &RelayServer::OnRelayedPacket<Packets::InstantiateEffects>);
+		m_server.OnInstantiateParticleSystem.Connect(this, &RelayServer::OnRelayedPacket<Packets::InstantiateParticleSystem>);
+		m_server.OnNetworkStrings.Connect(this,            &RelayServer::OnRelayedPacket<Packets::NetworkStrings>);
+		m_server.OnPlaySound.Connect(this,                 &RelayServer::OnRelayedPacket<Packets::PlaySound>);
+
+		LogInfo(LogCategory::Network) << "Relay listening on port " << firstPort << " for up to " << m_peerPerReactor * reactorCount << " spectators over " << reactorCount << " reactors";
+	}
+
+	RelayServer::~RelayServer()
+	{
+		Disconnect();
+	}
+
+	// Stops relaying for good, the server connection must outlive its disconnection event (see ClientApplication::HandlePeerDisconnection)
+	void RelayServer::Disconnect()
+	{
+		m_running = false;
+
+		DisconnectSpectators();
+
+		if (m_server.IsConnected())
+			m_server.Disconnect();
+	}
+
+	// The relay clock runs behind the server one by the delay, so interpolation works on delayed states as usual
+	Nz::UInt64 RelayServer::GetSpectatorTime() const
+	{
+		Nz::UInt64 serverTime = m_server.EstimateServerTime();
+		Nz::UInt64 delay = m_delayedPackets.GetDelay();
+		return (serverTime > delay) ? serverTime - delay : 0;
+	}
+
+	bool RelayServer::Update()
+	{
+		Nz::UInt64 now = m_app.GetAppTime();
+
+		if (m_upstreamState == UpstreamState::Disconnected && m_running && now >= m_reconnectTime)
+			ConnectToServer(now);
+
+		for (const auto& reactor : m_reactors)
+		{
+			reactor->Poll([&](bool /*outgoing*/, std::size_t peerId, const Nz::IpAddress& remoteAddress, Nz::UInt32 /*data*/) { HandleSpectatorConnection(peerId, remoteAddress); },
+			              [&](std::size_t peerId, Nz::UInt32 /*data*/) { HandleSpectatorDisconnection(peerId); },
+			              [&](std::size_t peerId, Nz::NetPacket&& packet) { HandleSpectatorPacket(peerId, std::move(packet)); },
+			              [&](std::size_t /*peerId*/, const NetworkReactor::PeerInfo& /*peerInfo*/) {});
+		}
+
+		ReleasePackets(now);
+
+		for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			BroadcastBundle(static_cast<Nz::UInt8>(channelId));
+
+		return m_running;
+	}
+
+	void RelayServer::RegisterConfigOptions(ConfigFile& config)
+	{
+		config.RegisterIntegerOption("Relay.ArenaIndex", 0, 0xFF);
+		config.RegisterIntegerOption("Relay.Delay", 0, 10 * 60 * 1000); //< milliseconds
+		config.RegisterIntegerOption("Relay.MaxSpectators", 1, 0xFFFF);
+		config.RegisterIntegerOption("Relay.Port", 1, 0xFFFF);
+		config.RegisterIntegerOption("Relay.ReactorCount", 1, 64);
+		config.RegisterStringOption("Relay.Secret");
+	}
+
+	void RelayServer::BroadcastBundle(Nz::UInt8 channelId)
+	{
+		PacketBundle& bundle = m_bundles[channelId];
+		if (bundle.IsEmpty())
+			return;
+
+		Nz::NetPacket packet;
+		bundle.Flush(packet);
+
+		BroadcastData(channelId, m_bundleFlags[channelId], packet);
+	}
+
+	// Messages are serialized once, each spectator only gets a copy of the bytes
+	void RelayServer::BroadcastData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& packet)
+	{
+		const Nz::UInt8* data = static_cast<const Nz::UInt8*>(packet.GetConstData()) + Nz::NetPacket::HeaderSize;
+		std::size_t size = packet.GetDataSize();
+
+		for (const auto& spectator : m_spectators)
+		{
+			if (!spectator || !spectator->IsSpectating())
+				continue;
+
+			Nz::NetPacket copy;
+			copy.Reset(0, data, size);
+
+			spectator->SendData(channelId, flags, std::move(copy));
+		}
+	}
+
+	void RelayServer::ConnectToServer(Nz::UInt64 now)
+	{
+		LogInfo(LogCategory::Network) << "Connecting to " << m_serverAddress << "...";
+
+		m_upstreamState = UpstreamState::Connecting;
+		if (!m_server.Connect(m_serverAddress))
+		{
+			LogError(LogCategory::Network) << "Failed to connect to " << m_serverAddress << ", retrying in " << ReconnectDelay / 1000 << "s";
+
+			m_upstreamState = UpstreamState::Disconnected;
+			m_reconnectTime = now + ReconnectDelay;
+		}
+	}
+
+	// Spectators would otherwise keep watching a frozen arena, they can reconnect once the relay is back
+	void RelayServer::DisconnectSpectators()
+	{
+		for (auto& spectator : m_spectators)
+		{
+			if (!spectator)
+				continue;
+
+			spectator->Disconnect();
+			spectator.reset();
+		}
+
+		m_spectatorCount = 0;
+	}
+
+	void RelayServer::ReleasePackets(Nz::UInt64 now)
+	{
+		m_delayedPackets.Release(now, [&](const RelayedPacket& relayedPacket)
+		{
+			std::visit([&](const auto& packet)
+			{
+				using T = std::decay_t<decltype(packet)>;
+
+				m_arenaMirror.Apply(packet);
+
+				// Arena data is only sent by the server when joining, spectators get it with the snapshot (see ArenaMirror::SendSnapshot)
+				if constexpr (!std::is_same_v<T, Packets::ArenaParticleSystems> &&
+				              !std::is_same_v<T, Packets::ArenaPrefabs> &&
+				              !std::is_same_v<T, Packets::ArenaSounds> &&
+				              !std::is_same_v<T, Packets::NetworkStrings>)
+				{
+					Broadcast(packet);
+				}
+			}, relayedPacket);
+		});
+	}
+
+	void RelayServer::ResetStream()
+	{
+		m_arenaMirror.Clear();
+		m_delayedPackets.Clear();
+
+		for (PacketBundle& bundle : m_bundles)
+			bundle.Clear();
+	}
+
+	void RelayServer::HandleSpectatorConnection(std::size_t peerId, const Nz::IpAddress& remoteAddress)
+	{
+		NetworkReactor& reactor = *m_reactors[peerId / m_peerPerReactor];
+
+		// Spectators joining before the arena is known would get an empty snapshot
+		if (!IsStreaming())
+		{
+			reactor.DisconnectPeer(peerId);
+			return;
+		}
+
+		m_spectators[peerId] = std::make_unique<SpectatorSession>(*this, peerId, reactor, m_commandStore);
+		m_spectatorCount++;
+
+		LogInfo(LogCategory::Network) << "Spectator #" << peerId << " connected from " << remoteAddress.ToString().ToStdString() << " (" << m_spectatorCount << " spectators)";
+	}
+
+	void RelayServer::HandleSpectatorDisconnection(std::size_t peerId)
+	{
+		// Refused peers and spectators disconnected by the relay don't have a session anymore
+		if (!m_spectators[peerId])
+			return;
+
+		m_spectators[peerId].reset();
+		m_spectatorCount--;
+
+		LogInfo(LogCategory::Network) << "Spectator #" << peerId << " disconnected (" << m_spectatorCount << " spectators)";
+	}
+
+	void RelayServer::HandleSpectatorPacket(std::size_t peerId, Nz::NetPacket&& packet)
+	{
+		SpectatorSession* spectator = m_spectators[peerId].get();
+		if (!spectator)
+			return;
+
+		if (!m_commandStore.UnserializePacket(*spectator, std::move(packet)))
+			spectator->Disconnect();
+	}
+
+	void RelayServer::OnArenaList(ServerConnection* server, const Packets::ArenaList& arenaList)
+	{
+		if (m_upstreamState != UpstreamState::QueryingArenas)
+			return;
+
+		if (m_arenaIndex >= arenaList.arenas.size())
+		{
+			LogError(LogCategory::Network) << "Server has no arena #" << unsigned(m_arenaIndex) << " (" << arenaList.arenas.size() << " arenas)";
+
+			m_running = false;
+			server->Disconnect();
+			return;
+		}
+
+		m_arenaName = arenaList.arenas[m_arenaIndex].arenaName;
+		m_upstreamState = UpstreamState::Relaying;
+
+		Packets::JoinArena joinArena;
+		joinArena.arenaIndex = m_arenaIndex;
+
+		server->SendPacket(joinArena);
+
+		LogInfo(LogCategory::Network) << "Relaying arena " << m_arenaName << " with a delay of " << m_delayedPackets.GetDelay() << "ms";
+	}
+
+	void RelayServer::OnConnected(ServerConnection* server, Nz::UInt32 /*data*/)
+	{
+		m_upstreamState = UpstreamState::LoggingIn;
+
+		Packets::RelayLogin relayLogin;
+		relayLogin.secret = m_secret;
+
+		server->SendPacket(relayLogin);
+	}
+
+	void RelayServer::OnDisconnected(ServerConnection* /*server*/, Nz::UInt32 /*data*/)
+	{
+		if (m_running)
+			LogWarning(LogCategory::Network) << "Lost connection to the server, reconnecting in " << ReconnectDelay / 1000 << "s";
+
+		DisconnectSpectators();
+		ResetStream();
+
+		m_upstreamState = UpstreamState::Disconnected;
+		m_reconnectTime = std::max(m_reconnectTime, m_app.GetAppTime() + ReconnectDelay);
+	}
+
+	void RelayServer::OnLoginFailure(ServerConnection* server, const Packets::LoginFailure& loginFailure)
+	{
+		// A wrong secret won't get any better by retrying
+		if (loginFailure.reason == LoginFailureReason::PasswordMismatch)
+		{
+			LogError(LogCategory::Network) << "Server refused the relay secret (Relay.Secret must match the server one)";
+			m_running = false;
+		}
+		else
+		{
+			LogWarning(LogCategory::Network) << "Server refused the relay (reason " << unsigned(loginFailure.reason) << ")";
+			m_reconnectTime = m_app.GetAppTime() + loginFailure.retryAfter;
+		}
+
+		server->Disconnect();
+	}
+
+	void RelayServer::OnLoginSuccess(ServerConnection* server, const Packets::LoginSuccess& /*loginSuccess*/)
+	{
+		if (m_upstreamState != UpstreamState::LoggingIn)
+			return;
+
+		m_upstreamState = UpstreamState::QueryingArenas;
+
+		server->SendPacket(Packets::QueryArenaList());
+	}
+}
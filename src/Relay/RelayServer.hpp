@@ -0,0 +1,123 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_RELAY_RELAYSERVER_HPP
+#define EREWHON_RELAY_RELAYSERVER_HPP
+
+#include <Shared/Config.hpp>
+#include <Shared/NetworkReactor.hpp>
+#include <Shared/Protocol/PacketBundle.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <Client/ServerConnection.hpp>
+#include <Relay/ArenaMirror.hpp>
+#include <Relay/DelayQueue.hpp>
+#include <Relay/RelayCommandStore.hpp>
+#include <Relay/SpectatorSession.hpp>
+#include <array>
+#include <memory>
+#include <string>
+#include <variant>
+#include <vector>
+
+namespace ewn
+{
+	class ClientApplication;
+	class ConfigFile;
+
+	// Connects to the game server as a single privileged peer and re-broadcasts one arena to many spectators,
+	// every message is serialized once for all of them and may be held back by a configurable delay
+	class RelayServer
+	{
+		public:
+			RelayServer(ClientApplication& app, const ConfigFile& config);
+			RelayServer(const RelayServer&) = delete;
+			RelayServer(RelayServer&&) = delete;
+			~RelayServer();
+
+			void Disconnect();
+
+			inline const ArenaMirror& GetArenaMirror() const;
+			inline const std::string& GetArenaName() const;
+			Nz::UInt64 GetSpectatorTime() const;
+
+			inline bool IsStreaming() const;
+
+			bool Update();
+
+			RelayServer& operator=(const RelayServer&) = delete;
+			RelayServer& operator=(RelayServer&&) = delete;
+
+			static void RegisterConfigOptions(ConfigFile& config);
+
+		private:
+			enum class UpstreamState
+			{
+				Disconnected,
+				Connecting,
+				LoggingIn,
+				QueryingArenas,
+				Relaying
+			};
+
+			using RelayedPacket = std::variant<
+				Packets::ArenaParticleSystems,
+				Packets::ArenaPrefabs,
+				Packets::ArenaSounds,
+				Packets::ArenaState,
+				Packets::ChatMessage,
+				Packets::CreateEntities,
+				Packets::CreateProjectiles,
+				Packets::DeleteEntities,
+				Packets::DeleteProjectiles,
+				Packets::InstantiateEffects,
+				Packets::InstantiateParticleSystem,
+				Packets::NetworkStrings,
+				Packets::PlaySound
+			>;
+
+			template<typename T> void Broadcast(const T& packet);
+			void BroadcastBundle(Nz::UInt8 channelId);
+			void BroadcastData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, const Nz::NetPacket& packet);
+			void ConnectToServer(Nz::UInt64 now);
+			void DisconnectSpectators();
+			void ReleasePackets(Nz::UInt64 now);
+			void ResetStream();
+
+			void HandleSpectatorConnection(std::size_t peerId, const Nz::IpAddress& remoteAddress);
+			void HandleSpectatorDisconnection(std::size_t peerId);
+			void HandleSpectatorPacket(std::size_t peerId, Nz::NetPacket&& packet);
+
+			void OnArenaList(ServerConnection* server, const Packets::ArenaList& arenaList);
+			void OnConnected(ServerConnection* server, Nz::UInt32 data);
+			void OnDisconnected(ServerConnection* server, Nz::UInt32 data);
+			void OnLoginFailure(ServerConnection* server, const Packets::LoginFailure& loginFailure);
+			void OnLoginSuccess(ServerConnection* server, const Packets::LoginSuccess& loginSuccess);
+			template<typename T> void OnRelayedPacket(ServerConnection* server, const T& packet);
+
+			std::array<Nz::ENetPacketFlags, NetworkChannelCount> m_bundleFlags;
+			std::array<PacketBundle, NetworkChannelCount> m_bundles;
+			std::string m_arenaName;
+			std::string m_secret;
+			std::string m_serverAddress;
+			std::vector<std::unique_ptr<NetworkReactor>> m_reactors;
+			std::vector<std::unique_ptr<SpectatorSession>> m_spectators; //< indexed by peer id
+			ArenaMirror m_arenaMirror;
+			DelayQueue<RelayedPacket> m_delayedPackets; //< milliseconds
+			ClientApplication& m_app;
+			RelayCommandStore m_commandStore;
+			ServerConnection m_server;
+			UpstreamState m_upstreamState;
+			Nz::UInt64 m_reconnectTime;
+			Nz::UInt8 m_arenaIndex;
+			std::size_t m_peerPerReactor;
+			std::size_t m_spectatorCount;
+			bool m_running;
+	};
+}
+
+#include <Relay/RelayServer.inl>
+
+#endif // EREWHON_RELAY_RELAYSERVER_HPP
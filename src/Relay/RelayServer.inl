@@ -0,0 +1,58 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/RelayServer.hpp>
+#include <Client/ClientApplication.hpp>
+
+namespace ewn
+{
+	inline const ArenaMirror& RelayServer::GetArenaMirror() const
+	{
+		return m_arenaMirror;
+	}
+
+	inline const std::string& RelayServer::GetArenaName() const
+	{
+		return m_arenaName;
+	}
+
+	// Spectators can only join once the arena was received and their clock can be synchronized
+	inline bool RelayServer::IsStreaming() const
+	{
+		return m_upstreamState == UpstreamState::Relaying && m_arenaMirror.HasState() && m_server.GetClockSync().IsSynchronized();
+	}
+
+	// Same as ClientSession::QueuePacket, except the bundle is shared by every spectator
+	template<typename T>
+	void RelayServer::Broadcast(const T& packet)
+	{
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+
+		PacketBundle& bundle = m_bundles[command.channelId];
+		if (!bundle.IsEmpty() && m_bundleFlags[command.channelId] != command.flags)
+			BroadcastBundle(command.channelId);
+
+		m_bundleFlags[command.channelId] = command.flags;
+
+		if (bundle.Append(packet) > 0)
+			return;
+
+		BroadcastBundle(command.channelId);
+
+		if (bundle.Append(packet) > 0)
+			return;
+
+		// Too big to share a packet with anything else
+		Nz::NetPacket data;
+		m_commandStore.SerializePacket(data, packet);
+
+		BroadcastData(command.channelId, command.flags, data);
+	}
+
+	template<typename T>
+	void RelayServer::OnRelayedPacket(ServerConnection* /*server*/, const T& packet)
+	{
+		m_delayedPackets.Push(m_app.GetAppTime(), packet);
+	}
+}
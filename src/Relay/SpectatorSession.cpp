@@ -0,0 +1,116 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/SpectatorSession.hpp>
+#include <Relay/RelayServer.hpp>
+
+namespace ewn
+{
+	SpectatorSession::SpectatorSession(RelayServer& relay, std::size_t peerId, NetworkReactor& reactor, const RelayCommandStore& commandStore) :
+	m_peerId(peerId),
+	m_networkReactor(reactor),
+	m_relay(relay),
+	m_commandStore(commandStore),
+	m_isAuthenticated(false),
+	m_isSpectating(false)
+	{
+		m_cachedPacketVersions.fill(0);
+	}
+
+	void SpectatorSession::HandleDeclareCachedPackets(const Packets::DeclareCachedPackets& data)
+	{
+		for (const auto& cachedPacket : data.packets)
+		{
+			// Unknown packet types are ignored, they may come from a more recent client
+			std::size_t packetId = static_cast<std::size_t>(cachedPacket.packetType);
+			if (packetId < m_cachedPacketVersions.size())
+				m_cachedPacketVersions[packetId] = cachedPacket.version;
+		}
+
+		// Spectators are only accepted once the arena was received, networked strings included
+		SendCachedPacket(m_relay.GetArenaMirror().GetNetworkStrings());
+	}
+
+	void SpectatorSession::HandleJoinArena(const Packets::JoinArena& data)
+	{
+		if (!m_isAuthenticated || m_isSpectating)
+			return;
+
+		// Only one arena is relayed, see HandleQueryArenaList
+		if (data.arenaIndex != 0)
+			return;
+
+		m_relay.GetArenaMirror().SendSnapshot(*this);
+		m_isSpectating = true;
+	}
+
+	void SpectatorSession::HandleLeaveArena(const Packets::LeaveArena& /*data*/)
+	{
+		m_isSpectating = false;
+	}
+
+	// Anyone can watch, credentials aren't checked (the relay doesn't have access to the accounts anyway)
+	void SpectatorSession::HandleLogin(const Packets::Login& /*data*/)
+	{
+		if (m_isAuthenticated)
+			return;
+
+		m_isAuthenticated = true;
+		SendPacket(Packets::LoginSuccess());
+	}
+
+	void SpectatorSession::HandleLoginByToken(const Packets::LoginByToken& /*data*/)
+	{
+		if (m_isAuthenticated)
+			return;
+
+		m_isAuthenticated = true;
+		SendPacket(Packets::LoginSuccess());
+	}
+
+	void SpectatorSession::HandlePlayerChat(const Packets::PlayerChat& /*data*/)
+	{
+		if (!m_isAuthenticated)
+			return;
+
+		Packets::ChatMessage chatPacket;
+		chatPacket.message = "You are spectating through a relay, chat is disabled";
+
+		SendPacket(chatPacket);
+	}
+
+	void SpectatorSession::HandlePlayerMovement(const Packets::PlayerMovement& /*data*/)
+	{
+		// Spectators don't control anything
+	}
+
+	void SpectatorSession::HandlePlayerShoot(const Packets::PlayerShoot& /*data*/)
+	{
+		// Spectators don't control anything
+	}
+
+	void SpectatorSession::HandleQueryArenaList(const Packets::QueryArenaList& /*data*/)
+	{
+		if (!m_isAuthenticated)
+			return;
+
+		Packets::ArenaList listPacket;
+		auto& arenaData = listPacket.arenas.emplace_back();
+		arenaData.arenaName = m_relay.GetArenaName();
+
+		SendPacket(listPacket);
+	}
+
+	void SpectatorSession::HandleTimeSyncRequest(const Packets::TimeSyncRequest& data)
+	{
+		if (!m_isAuthenticated)
+			return;
+
+		Packets::TimeSyncResponse response;
+		response.requestId = data.requestId;
+		response.serverTime = m_relay.GetSpectatorTime();
+
+		SendPacket(response);
+	}
+}
@@ -0,0 +1,69 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_RELAY_SPECTATORSESSION_HPP
+#define EREWHON_RELAY_SPECTATORSESSION_HPP
+
+#include <Shared/NetworkReactor.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <Relay/RelayCommandStore.hpp>
+#include <array>
+
+namespace ewn
+{
+	class RelayServer;
+
+	// A regular client connected to the relay, it goes through the usual login and arena selection but can only watch
+	class SpectatorSession
+	{
+		friend class RelayCommandStore;
+
+		public:
+			SpectatorSession(RelayServer& relay, std::size_t peerId, NetworkReactor& reactor, const RelayCommandStore& commandStore);
+			SpectatorSession(const SpectatorSession&) = delete;
+			SpectatorSession(SpectatorSession&&) = delete;
+			~SpectatorSession() = default;
+
+			inline void Disconnect(Nz::UInt32 data = 0);
+
+			inline std::size_t GetPeerId() const;
+
+			inline bool IsSpectating() const;
+
+			template<typename T> void SendCachedPacket(const CachedPacket<T>& packet);
+			inline void SendData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet);
+			template<typename T> void SendPacket(const T& packet);
+			template<typename T> void SendPacket(const CachedPacket<T>& packet);
+
+			SpectatorSession& operator=(const SpectatorSession&) = delete;
+			SpectatorSession& operator=(SpectatorSession&&) = delete;
+
+		private:
+			void HandleDeclareCachedPackets(const Packets::DeclareCachedPackets& data);
+			void HandleJoinArena(const Packets::JoinArena& data);
+			void HandleLeaveArena(const Packets::LeaveArena& data);
+			void HandleLogin(const Packets::Login& data);
+			void HandleLoginByToken(const Packets::LoginByToken& data);
+			void HandlePlayerChat(const Packets::PlayerChat& data);
+			void HandlePlayerMovement(const Packets::PlayerMovement& data);
+			void HandlePlayerShoot(const Packets::PlayerShoot& data);
+			void HandleQueryArenaList(const Packets::QueryArenaList& data);
+			void HandleTimeSyncRequest(const Packets::TimeSyncRequest& data);
+
+			std::array<Nz::UInt32, PacketTypeCount> m_cachedPacketVersions; //< versions held by the client
+			std::size_t m_peerId;
+			NetworkReactor& m_networkReactor;
+			RelayServer& m_relay;
+			const RelayCommandStore& m_commandStore;
+			bool m_isAuthenticated;
+			bool m_isSpectating;
+	};
+}
+
+#include <Relay/SpectatorSession.inl>
+
+#endif // EREWHON_RELAY_SPECTATORSESSION_HPP
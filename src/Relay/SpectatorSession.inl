@@ -0,0 +1,72 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Relay/SpectatorSession.hpp>
+#include <Nazara/Network/NetPacket.hpp>
+
+namespace ewn
+{
+	inline void SpectatorSession::Disconnect(Nz::UInt32 data)
+	{
+		m_networkReactor.DisconnectPeer(m_peerId, data);
+	}
+
+	inline std::size_t SpectatorSession::GetPeerId() const
+	{
+		return m_peerId;
+	}
+
+	inline bool SpectatorSession::IsSpectating() const
+	{
+		return m_isSpectating;
+	}
+
+	// Same as ClientSession::SendCachedPacket, spectators coming back don't download arena data again
+	template<typename T>
+	void SpectatorSession::SendCachedPacket(const CachedPacket<T>& packet)
+	{
+		Nz::UInt32& clientVersion = m_cachedPacketVersions[static_cast<std::size_t>(T::Type)];
+
+		Packets::CachedPacketVersion versionPacket;
+		versionPacket.packetType = T::Type;
+		versionPacket.version = packet.GetVersion();
+		versionPacket.useCachedPacket = (clientVersion == packet.GetVersion());
+
+		SendPacket(versionPacket);
+		if (versionPacket.useCachedPacket)
+			return;
+
+		clientVersion = packet.GetVersion();
+
+		SendPacket(packet);
+	}
+
+	inline void SpectatorSession::SendData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet)
+	{
+		m_networkReactor.SendData(m_peerId, channelId, flags, std::move(packet));
+	}
+
+	// Messages meant for a single spectator are rare (login, arena join), they aren't bundled
+	template<typename T>
+	void SpectatorSession::SendPacket(const T& packet)
+	{
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+
+		Nz::NetPacket data;
+		m_commandStore.SerializePacket(data, packet);
+
+		SendData(command.channelId, command.flags, std::move(data));
+	}
+
+	template<typename T>
+	void SpectatorSession::SendPacket(const CachedPacket<T>& packet)
+	{
+		const auto& command = m_commandStore.GetOutgoingCommand<T>();
+
+		Nz::NetPacket data;
+		m_commandStore.SerializePacket(data, packet);
+
+		SendData(command.channelId, command.flags, std::move(data));
+	}
+}
@@ -0,0 +1,52 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Relay" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Nazara/Core/Initializer.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Nazara/Network/Network.hpp>
+#include <NDK/Sdk.hpp>
+#include <Client/ClientApplication.hpp>
+#include <Relay/RelayServer.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
+#include <memory>
+
+int main()
+{
+	ewn::Profiler::SetThreadName("Main");
+
+	Nz::Initializer<Nz::Network, Ndk::Sdk> nazara;
+
+	ewn::ClientApplication app;
+	ewn::RelayServer::RegisterConfigOptions(app.GetConfig());
+
+	if (!app.LoadConfig("rconfig.lua"))
+	{
+		ewn::LogError(ewn::LogCategory::Network) << "Failed to load config file";
+		return EXIT_FAILURE;
+	}
+
+	std::unique_ptr<ewn::RelayServer> relay;
+	try
+	{
+		relay = std::make_unique<ewn::RelayServer>(app, app.GetConfig());
+	}
+	catch (const std::exception& e)
+	{
+		ewn::LogError(ewn::LogCategory::Network) << "Failed to start relay: " << e.what();
+		ewn::Logger::Flush();
+		return EXIT_FAILURE;
+	}
+
+	while (app.Run() && relay->Update())
+		Nz::Thread::Sleep(1);
+
+	// Give reactors some time to send disconnection packets, instead of letting spectators and the server time out
+	relay->Disconnect();
+	for (unsigned int i = 0; i < 100 && app.Run(); ++i)
+		Nz::Thread::Sleep(10);
+
+	ewn::LogInfo(ewn::LogCategory::Network) << "Relay stopped";
+	ewn::Logger::Flush();
+}
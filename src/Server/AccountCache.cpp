@@ -0,0 +1,93 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/AccountCache.hpp>
+
+namespace ewn
+{
+	auto AccountCache::FindAccount(Nz::Int32 accountId, Nz::UInt64 now) const -> const AccountData*
+	{
+		auto it = m_accounts.find(accountId);
+		if (it == m_accounts.end() || now >= it->second.expirationTime)
+			return nullptr;
+
+		return &it->second.data;
+	}
+
+	bool AccountCache::FindAccountByToken(const std::string& token, Nz::UInt64 now, Nz::Int32* accountId) const
+	{
+		auto it = m_tokens.find(token);
+		if (it == m_tokens.end() || now >= it->second.expirationTime)
+			return false;
+
+		*accountId = it->second.accountId;
+		return true;
+	}
+
+	void AccountCache::Prune(Nz::UInt64 now)
+	{
+		for (auto it = m_accounts.begin(); it != m_accounts.end();)
+		{
+			if (now >= it->second.expirationTime)
+				it = m_accounts.erase(it);
+			else
+				++it;
+		}
+
+		for (auto it = m_tokens.begin(); it != m_tokens.end();)
+		{
+			if (now >= it->second.expirationTime)
+			{
+				m_accountTokens.erase(it->second.accountId);
+				it = m_tokens.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	void AccountCache::RemoveToken(const std::string& token)
+	{
+		auto it = m_tokens.find(token);
+		if (it == m_tokens.end())
+			return;
+
+		m_accountTokens.erase(it->second.accountId);
+		m_tokens.erase(it);
+	}
+
+	void AccountCache::StoreAccount(Nz::Int32 accountId, AccountData data, Nz::UInt64 now)
+	{
+		if (m_duration == 0)
+			return;
+
+		AccountEntry& entry = m_accounts[accountId];
+		entry.data = std::move(data);
+		entry.expirationTime = now + m_duration;
+	}
+
+	void AccountCache::StoreToken(Nz::Int32 accountId, std::string token, Nz::UInt64 now)
+	{
+		if (m_duration == 0)
+			return;
+
+		// Generating a token replaces the previous one, as in the database
+		std::string& accountToken = m_accountTokens[accountId];
+		if (!accountToken.empty())
+			m_tokens.erase(accountToken);
+
+		accountToken = token;
+
+		TokenEntry& entry = m_tokens[std::move(token)];
+		entry.accountId = accountId;
+		entry.expirationTime = now + m_duration;
+	}
+
+	void AccountCache::UpdatePermissionLevel(Nz::Int32 accountId, Nz::UInt16 permissionLevel)
+	{
+		auto it = m_accounts.find(accountId);
+		if (it != m_accounts.end())
+			it->second.data.permissionLevel = permissionLevel;
+	}
+}
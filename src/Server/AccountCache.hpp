@@ -0,0 +1,72 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_ACCOUNTCACHE_HPP
+#define EREWHON_SERVER_ACCOUNTCACHE_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace ewn
+{
+	// Recently authenticated accounts and their connection tokens, so reconnections don't have to wait for the database
+	// Entries are written along the database (which stays the reference) and expire after a fixed duration, main thread only
+	class AccountCache
+	{
+		public:
+			struct AccountData;
+
+			inline AccountCache();
+			~AccountCache() = default;
+
+			const AccountData* FindAccount(Nz::Int32 accountId, Nz::UInt64 now) const;
+			bool FindAccountByToken(const std::string& token, Nz::UInt64 now, Nz::Int32* accountId) const;
+
+			inline std::size_t GetAccountCount() const;
+			inline std::size_t GetTokenCount() const;
+
+			void Prune(Nz::UInt64 now);
+
+			void RemoveToken(const std::string& token);
+
+			inline void SetDuration(Nz::UInt64 duration);
+
+			void StoreAccount(Nz::Int32 accountId, AccountData data, Nz::UInt64 now);
+			void StoreToken(Nz::Int32 accountId, std::string token, Nz::UInt64 now);
+
+			void UpdatePermissionLevel(Nz::Int32 accountId, Nz::UInt16 permissionLevel);
+
+			struct AccountData
+			{
+				std::string displayName;
+				std::string login;
+				Nz::UInt16 permissionLevel;
+			};
+
+		private:
+			struct AccountEntry
+			{
+				AccountData data;
+				Nz::UInt64 expirationTime;
+			};
+
+			struct TokenEntry
+			{
+				Nz::Int32 accountId;
+				Nz::UInt64 expirationTime;
+			};
+
+			std::unordered_map<Nz::Int32, AccountEntry> m_accounts;
+			std::unordered_map<Nz::Int32, std::string> m_accountTokens; //< an account has at most one token
+			std::unordered_map<std::string, TokenEntry> m_tokens;
+			Nz::UInt64 m_duration; //< milliseconds
+	};
+}
+
+#include <Server/AccountCache.inl>
+
+#endif // EREWHON_SERVER_ACCOUNTCACHE_HPP
@@ -0,0 +1,36 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/AccountCache.hpp>
+
+namespace ewn
+{
+	inline AccountCache::AccountCache() :
+	m_duration(0)
+	{
+	}
+
+	inline std::size_t AccountCache::GetAccountCount() const
+	{
+		return m_accounts.size();
+	}
+
+	inline std::size_t AccountCache::GetTokenCount() const
+	{
+		return m_tokens.size();
+	}
+
+	// A zero duration disables the cache
+	inline void AccountCache::SetDuration(Nz::UInt64 duration)
+	{
+		m_duration = duration;
+
+		if (m_duration == 0)
+		{
+			m_accounts.clear();
+			m_accountTokens.clear();
+			m_tokens.clear();
+		}
+	}
+}
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Arena.hpp>
+#include <Nazara/Core/Directory.hpp>
 #include <Nazara/Physics3D/PhysWorld3D.hpp>
 #include <NDK/Components/CollisionComponent3D.hpp>
 #include <NDK/Components/NodeComponent.hpp>
@@ -18,6 +19,7 @@
 #include <Server/Components/NavigationComponent.hpp>
 #include <Server/Components/OwnerComponent.hpp>
 #include <Server/Components/PlayerControlledComponent.hpp>
+#include <Server/Components/PooledComponent.hpp>
 #include <Server/Components/ProjectileComponent.hpp>
 #include <Server/Components/SignatureComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
@@ -28,17 +30,35 @@
 #include <Server/Systems/NavigationSystem.hpp>
 #include <Server/Systems/ScriptSystem.hpp>
 #include <Server/Systems/InputSystem.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
+#include <Shared/SpaceshipMovement.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <algorithm>
 #include <cassert>
+#include <cctype>
+#include <chrono>
+#include <cmath>
 #include <stdexcept>
 
 namespace ewn
 {
 	static constexpr bool sendServerGhosts = false;
 
+	// Joining players receive the world in chunks fitting in a single bundle (see PacketBundle::DefaultMaxSize)
+	static constexpr std::size_t JoinChunkSize = 1024;
+
 	Arena::Arena(ServerApplication* app, std::string name, std::string scriptName) :
+	m_projectiles(m_world),
 	m_name(std::move(name)),
 	m_scriptName(std::move(scriptName)),
-	m_app(app)
+	m_app(app),
+	m_worldUpdateCount(0),
+	m_physicsUpdateMaxTime(0),
+	m_physicsUpdateTimeSum(0),
+	m_worldUpdateMaxTime(0),
+	m_worldUpdateTimeSum(0),
+	m_worldStatsTimer(0.f)
 	{
 		auto& broadcastSystem = m_world.AddSystem<BroadcastSystem>(m_app);
 		broadcastSystem.BroadcastEntitiesCreation.Connect(this,    &Arena::OnBroadcastEntitiesCreation);
@@ -48,16 +68,40 @@ namespace ewn
 		if (sendServerGhosts)
 			broadcastSystem.SetMaximumUpdateRate(60.f);
 
-		m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld().SetThreadCount(0);
+		SetPhysicsThreadCount(m_app->GetConfig().GetIntegerOption<unsigned int>("Game.PhysicsThreadCount"));
 
 		m_world.AddSystem<InputSystem>();
 		m_world.AddSystem<LifeTimeSystem>();
 		m_world.AddSystem<NavigationSystem>(m_app);
 		m_world.AddSystem<ScriptSystem>(m_app, this);
 
+		AlignSystemsToTick(m_app->GetTickScheduler().GetTickRate());
+
+		BuildArenaData();
+
+		MetricsRegistry& metrics = m_app->GetMetrics();
+		MetricsRegistry::Labels labels = { { "arena", m_name } };
+		m_metrics.bots = &metrics.GetGauge("erewhon_arena_bots", "Number of bots in the arena", labels);
+		m_metrics.broadcastBytes = &metrics.GetCounter("erewhon_arena_broadcast_bytes_total", "Bytes of packets broadcasted to the arena players", labels);
+		m_metrics.entities = &metrics.GetGauge("erewhon_arena_entities", "Number of entities in the arena", labels);
+		m_metrics.players = &metrics.GetGauge("erewhon_arena_players", "Number of players in the arena", labels);
+		m_metrics.updateDuration = &metrics.GetHistogram("erewhon_arena_update_duration_seconds", "Time spent updating the arena each tick", labels);
+
+		auto RegisterSystemTimings = [&](const std::string& systemName, SystemUpdateTimings& systemTimings)
+		{
+			systemTimings.SetMetric(&metrics.GetHistogram("erewhon_arena_system_update_duration_seconds", "Time spent in each arena system update", { { "arena", m_name }, { "system", systemName } }));
+			m_updateTimings.systems.emplace_back(systemName, &systemTimings);
+		};
+
+		RegisterSystemTimings("PhysicsSystem3D", m_updateTimings.physics);
+		RegisterSystemTimings("BroadcastSystem", broadcastSystem.GetUpdateTimings());
+		RegisterSystemTimings("InputSystem", m_world.GetSystem<InputSystem>().GetUpdateTimings());
+		RegisterSystemTimings("LifeTimeSystem", m_world.GetSystem<LifeTimeSystem>().GetUpdateTimings());
+		RegisterSystemTimings("NavigationSystem", m_world.GetSystem<NavigationSystem>().GetUpdateTimings());
+		RegisterSystemTimings("ScriptSystem", m_world.GetSystem<ScriptSystem>().GetUpdateTimings());
+
 		Nz::PhysWorld3D& world = m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
 		int defaultMaterial = world.GetMaterial("default");
-		m_plasmaMaterial = world.CreateMaterial("plasma");
 		m_torpedoMaterial = world.CreateMaterial("torpedo");
 
 		world.SetMaterialCollisionCallback(defaultMaterial, defaultMaterial, nullptr, [this](const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
@@ -65,25 +109,33 @@ namespace ewn
 			return HandleDefaultDefaultCollision(firstBody, secondBody);
 		});
 
-		world.SetMaterialCollisionCallback(m_plasmaMaterial, m_plasmaMaterial, nullptr, [this](const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
+		world.SetMaterialCollisionCallback(defaultMaterial, m_torpedoMaterial, nullptr, [this](const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
 		{
-			return false;
+			return HandleTorpedoProjectileCollision(firstBody, secondBody);
 		});
 
-		world.SetMaterialCollisionCallback(defaultMaterial, m_plasmaMaterial, nullptr, [this](const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
-		{
-			return HandlePlasmaProjectileCollision(firstBody, secondBody);
-		});
+		m_projectiles.OnProjectileHit.Connect(this, &Arena::OnPlasmaProjectileHit);
 
-		world.SetMaterialCollisionCallback(defaultMaterial, m_torpedoMaterial, nullptr, [this](const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
+		const PrefabStore& prefabStore = m_app->GetPrefabStore();
+		m_frigatePrefabId = prefabStore.GetEntryByName("frigate");
+		m_plasmaBeamPrefabId = prefabStore.GetEntryByName("plasmabeam");
+		m_spaceshipPrefabId = prefabStore.GetEntryByName("spaceship");
+		m_torpedoPrefabId = prefabStore.GetEntryByName("torpedo");
+
+		m_prefabPools.resize(prefabStore.GetEntryCount());
+		for (std::size_t prefabId = 0; prefabId < prefabStore.GetEntryCount(); ++prefabId)
 		{
-			return HandleTorpedoProjectileCollision(firstBody, secondBody);
-		});
+			if (prefabStore.GetEntryPoolSize(prefabId) > 0)
+				m_prefabPools[prefabId] = std::make_unique<EntityPool>(m_world, [this, prefabId](const Ndk::EntityHandle& entity) { InitializePooledEntity(prefabId, entity); });
+		}
 
 		LoadScript(m_scriptName);
 
 		Reset();
 
+		if (const std::string& replayFolder = m_app->GetConfig().GetStringOption("Replay.Folder"); !replayFolder.empty())
+			StartReplayRecording(replayFolder);
+
 		if constexpr (sendServerGhosts)
 		{
 			m_debugSocket.Create(Nz::NetProtocol_IPv4);
@@ -96,24 +148,44 @@ namespace ewn
 		m_world.Clear();
 	}
 
-	const Ndk::EntityHandle& Arena::CreatePlasmaProjectile(Player* owner, const Ndk::EntityHandle& emitter, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
+	Nz::UInt32 Arena::CreatePlasmaProjectile(const Ndk::EntityHandle& emitter, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
 	{
-		const Ndk::EntityHandle& projectile = CreateEntity("plasmabeam", {}, owner, position, rotation);
-		projectile->GetComponent<ProjectileComponent>().MarkAsHit(emitter);
-
-		auto& projectilePhys = projectile->GetComponent<Ndk::PhysicsComponent3D>();
-		projectilePhys.SetLinearVelocity(emitter->GetComponent<Ndk::NodeComponent>().GetForward() * 250.f);
-
-		return projectile;
+		const PrefabStore& prefabStore = m_app->GetPrefabStore();
+		const PrefabStore::ProjectileInfo& plasmaBeam = prefabStore.GetEntryProjectileInfo(m_plasmaBeamPrefabId);
+		float plasmaBeamLifeTime = prefabStore.GetEntryLifeTime(m_plasmaBeamPrefabId);
+
+		Nz::UInt64 currentTime = m_app->GetAppTime();
+		Nz::UInt16 damage = plasmaBeam.damage;
+		if (plasmaBeam.damageVariance > 0)
+			damage = Nz::UInt16(damage + ((currentTime % (2 * plasmaBeam.damageVariance + 1)) - plasmaBeam.damageVariance)); //< Aléatoire du pauvre
+
+		Nz::Vector3f direction = rotation * Nz::Vector3f::Forward();
+
+		Nz::UInt32 prefabId = static_cast<Nz::UInt32>(m_plasmaBeamPrefabId);
+		Nz::UInt32 projectileId = m_projectiles.Spawn(prefabId, emitter, position, direction, plasmaBeam.speed, plasmaBeamLifeTime, damage);
+
+		// Clients only receive spawn parameters and simulate the beam by themselves
+		auto& projectile = m_pendingProjectileCreations.projectiles.emplace_back();
+		projectile.direction = direction;
+		projectile.lifeTime = plasmaBeamLifeTime;
+		projectile.origin = position;
+		projectile.prefabId = prefabId;
+		projectile.projectileId = projectileId;
+		projectile.spawnTime = currentTime;
+		projectile.speed = plasmaBeam.speed;
+
+		return projectileId;
 	}
 
 	const Ndk::EntityHandle& Arena::CreateTorpedo(Player* owner, const Ndk::EntityHandle & emitter, const Nz::Vector3f & position, const Nz::Quaternionf & rotation)
 	{
-		const Ndk::EntityHandle& projectile = CreateEntity("torpedo", {}, owner, position, rotation);
+		float torpedoSpeed = m_app->GetPrefabStore().GetEntryProjectileInfo(m_torpedoPrefabId).speed;
+
+		const Ndk::EntityHandle& projectile = CreatePrefab(m_torpedoPrefabId, {}, owner, position, rotation);
 		projectile->GetComponent<ProjectileComponent>().MarkAsHit(emitter);
 
 		auto& projectilePhys = projectile->GetComponent<Ndk::PhysicsComponent3D>();
-		projectilePhys.SetLinearVelocity(emitter->GetComponent<Ndk::NodeComponent>().GetForward() * 50.f);
+		projectilePhys.SetLinearVelocity(emitter->GetComponent<Ndk::NodeComponent>().GetForward() * torpedoSpeed);
 
 		return projectile;
 	}
@@ -134,11 +206,13 @@ namespace ewn
 		bool shouldPrintMessage = true;
 		if (m_script.GetGlobal("OnPlayerChat") == Nz::LuaType_Function)
 		{
+			ProfileZone("Arena::OnPlayerChat (Lua)");
+
 			m_script.Push(sender);
 			m_script.Push(message);
 
 			if (!m_script.Call(2, 1))
-				std::cerr << "An error occurred during OnPlayerChat call: " << m_script.GetLastError() << std::endl;
+				LogError(LogCategory::Script) << "An error occurred during OnPlayerChat call: " << m_script.GetLastError();
 
 			shouldPrintMessage = m_script.ToBoolean(-1);
 		}
@@ -162,13 +236,16 @@ namespace ewn
 
 	void Arena::PrintChatMessage(const std::string& message)
 	{
-		std::cout << "(" << m_name << ") " << message << std::endl;
+		LogInfo(LogCategory::Chat) << "(" << m_name << ") " << message;
 
 		Packets::ChatMessage chatPacket;
 		chatPacket.message = message;
 
 		for (Player* player : m_players)
 			player->SendPacket(chatPacket);
+
+		for (Player* relay : m_relays)
+			relay->SendPacket(chatPacket);
 	}
 
 	void Arena::Reload()
@@ -184,15 +261,46 @@ namespace ewn
 
 		m_world.Clear();
 
+		m_pendingCollisionDamages.clear();
+		m_pendingTorpedoHits.clear();
+		m_integrityChangedEntities.Clear();
+		m_pendingDeaths.clear();
+		m_pendingEffects.particleSystems.clear();
+		m_pendingEffects.sounds.clear();
+
+		for (Nz::UInt32 projectileId : m_projectiles.GetProjectileIds())
+			m_pendingProjectileDeletions.projectiles.emplace_back(projectileId);
+
+		m_pendingProjectileCreations.projectiles.clear();
+		m_projectiles.Clear();
+		FlushProjectileUpdates();
+
 		m_world.CreateEntity(); //< Reserve entity #0
 
+		// Prebuild dormant entities for pooled prefabs
+		const PrefabStore& prefabStore = m_app->GetPrefabStore();
+		for (std::size_t prefabId = 0; prefabId < m_prefabPools.size(); ++prefabId)
+		{
+			if (EntityPool* pool = m_prefabPools[prefabId].get())
+			{
+				pool->Clear();
+				pool->Reserve(prefabStore.GetEntryPoolSize(prefabId));
+			}
+		}
+
 		if (m_script.GetGlobal("OnReset") == Nz::LuaType_Function)
 		{
+			ProfileZone("Arena::OnReset (Lua)");
+
 			if (!m_script.Call(0))
-				std::cerr << "An error occurred during OnReset call: " << m_script.GetLastError() << std::endl;
+				LogError(LogCategory::Script) << "An error occurred during OnReset call: " << m_script.GetLastError();
 		}
 		else
 			m_script.Pop();
+
+		// The whole world was rebuilt, replays seeking past this point shouldn't have to go through it
+		if (m_replayRecorder)
+			m_replayRecorder->RequestKeyframe();
 	}
 
 	void Arena::SpawnFleet(Player* owner, const std::string& fleetName)
@@ -244,7 +352,7 @@ namespace ewn
 		m_app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipByOwnerIdAndName", { owner->GetDatabaseId(), spaceshipName }, [=, sessionId = owner->GetSessionId()](DatabaseResult& result)
 		{
 			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Find spaceship query failed: " << result.GetLastErrorMessage();
 
 			Player* ply = m_app->GetPlayerBySession(sessionId);
 			if (!ply)
@@ -275,7 +383,7 @@ namespace ewn
 		m_app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipByIdAndOwnerId", { spaceshipId, owner->GetDatabaseId() }, [=, sessionId = owner->GetSessionId()](DatabaseResult& result)
 		{
 			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Find spaceship query failed: " << result.GetLastErrorMessage();
 
 			Player* ply = m_app->GetPlayerBySession(sessionId);
 			if (!ply)
@@ -294,107 +402,158 @@ namespace ewn
 		});
 	}
 
+	void Arena::SetPhysicsThreadCount(unsigned int threadCount)
+	{
+		m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld().SetThreadCount(threadCount);
+		m_physicsThreadCount = threadCount;
+	}
+
 	void Arena::Update(float elapsedTime)
 	{
-		m_world.Update(elapsedTime);
+		ProfileZone("Arena::Update");
+
+		Nz::UInt64 updateStartTime = Nz::GetElapsedMicroseconds();
+		Nz::UInt64 phaseStartTime = updateStartTime;
+		auto EndPhase = [&](TimingHistogram& timings)
+		{
+			Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+			Nz::UInt64 phaseTime = now - phaseStartTime;
+			timings.Record(phaseTime);
+			phaseStartTime = now;
+
+			return phaseTime;
+		};
+
+		auto GetSystemsTime = [&]()
+		{
+			Nz::UInt64 systemsTime = 0;
+			for (const auto& [systemName, systemTimings] : m_updateTimings.systems)
+			{
+				if (systemTimings != &m_updateTimings.physics)
+					systemsTime += systemTimings->GetTotalDuration();
+			}
+
+			return systemsTime;
+		};
+
+		Nz::UInt64 systemsStartTime = GetSystemsTime();
+		{
+			ProfileZone("Arena::WorldUpdate");
+			m_world.Update(elapsedTime);
+		}
+		Nz::UInt64 worldTime = EndPhase(m_updateTimings.world);
+
+		// Physics runs in Nazara's PhysicsSystem3D which can't be instrumented, every other system times itself
+		Nz::UInt64 systemsTime = GetSystemsTime() - systemsStartTime;
+		Nz::UInt64 physicsTime = (worldTime > systemsTime) ? worldTime - systemsTime : 0;
+		m_updateTimings.physics.Record(physicsTime);
+
+		UpdateWorldStats(elapsedTime, worldTime, physicsTime);
+
+		ApplyCollisionEvents();
+		EndPhase(m_updateTimings.collisions);
+
+		m_projectiles.Update(elapsedTime);
+		EndPhase(m_updateTimings.projectiles);
+
 		for (Player* player : m_players)
 			player->Update(elapsedTime);
 
+		EndPhase(m_updateTimings.players);
+
 		if (m_script.GetGlobal("OnUpdate") == Nz::LuaType_Function)
 		{
+			ProfileZone("Arena::OnUpdate (Lua)");
+
 			m_script.Push(elapsedTime);
 
 			if (!m_script.Call(1, 0))
-				std::cerr << "An error occurred during OnUpdate call: " << m_script.GetLastError() << std::endl;
+				LogError(LogCategory::Script) << "An error occurred during OnUpdate call: " << m_script.GetLastError();
 		}
 		else
 			m_script.Pop();
+
+		EndPhase(m_updateTimings.script);
+
+		FlushDamageEvents();
+		FlushProjectileUpdates();
+		UpdateJoinStreams();
+		EndPhase(m_updateTimings.flush);
+
+		m_metrics.updateDuration->Observe((phaseStartTime - updateStartTime) / 1'000'000.0);
+	}
+
+	void Arena::UpdateMetrics()
+	{
+		std::size_t botCount = 0;
+		for (Player* player : m_players)
+			botCount += player->GetBotCount();
+
+		m_metrics.bots->Set(static_cast<double>(botCount));
+		m_metrics.entities->Set(static_cast<double>(m_world.GetEntities().size()));
+		m_metrics.players->Set(static_cast<double>(m_players.size()));
 	}
 
 	const Ndk::EntityHandle& Arena::CreateEntity(std::string type, std::string name, Player* owner, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
 	{
+		std::size_t prefabId = m_app->GetPrefabStore().GetEntryByName(type);
+		if (prefabId != PrefabStore::InvalidEntryId)
+			return CreatePrefab(prefabId, std::move(name), owner, position, rotation);
+
+		// Scripts may create custom entities of their own type, they get a bare (not networked) entity as before
 		const Ndk::EntityHandle& newEntity = m_world.CreateEntity();
+		newEntity->AddComponent<ArenaComponent>(*this);
 
-		if (type == "earth")
-		{
-			constexpr float radius = 50.f;
+		if (owner)
+			newEntity->AddComponent<OwnerComponent>(owner);
 
-			auto collider = Nz::SphereCollider3D::New(radius);
+		return newEntity;
+	}
 
-			newEntity->AddComponent<Ndk::CollisionComponent3D>(Nz::SphereCollider3D::New(radius));
-			newEntity->AddComponent<Ndk::NodeComponent>().SetPosition(position);
-			newEntity->AddComponent<SignatureComponent>(newEntity->GetId(), 0.000035, collider->GetRadius(), collider->ComputeVolume());
-			newEntity->AddComponent<SynchronizedComponent>(0, type, name, false, 0);
-		}
-		else if (type == "light")
-		{
-			newEntity->AddComponent<SynchronizedComponent>(1, type, name, false, 0);
+	const Ndk::EntityHandle& Arena::CreatePrefab(std::size_t prefabId, std::string name, Player* owner, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
+	{
+		const PrefabStore& prefabStore = m_app->GetPrefabStore();
+		assert(prefabId < prefabStore.GetEntryCount());
 
-			auto& node = newEntity->AddComponent<Ndk::NodeComponent>();
-			node.SetPosition(position);
-			node.SetRotation(rotation);
-		}
-		else if (type == "ball")
+		if (EntityPool* pool = m_prefabPools[prefabId].get())
 		{
-			constexpr float radius = 18.251904f / 2.f;
+			// Reuse a dormant entity and only reset its per-spawn state
+			const Ndk::EntityHandle& entity = pool->Acquire();
+			entity->GetComponent<OwnerComponent>().SetOwner(owner);
+			entity->GetComponent<SynchronizedComponent>().SetName(std::move(name));
 
-			auto collider = Nz::SphereCollider3D::New(radius);
+			if (entity->HasComponent<LifeTimeComponent>())
+				entity->GetComponent<LifeTimeComponent>().SetRemainingDuration(prefabStore.GetEntryLifeTime(prefabId));
 
-			newEntity->AddComponent<Ndk::CollisionComponent3D>(collider);
-			newEntity->AddComponent<SignatureComponent>(newEntity->GetId(), 0.0, collider->GetRadius(), collider->ComputeVolume());
-			newEntity->AddComponent<SynchronizedComponent>(4, type, name, true, 3);
+			if (entity->HasComponent<ProjectileComponent>())
+				entity->GetComponent<ProjectileComponent>().ClearHits();
 
-			auto& node = newEntity->AddComponent<Ndk::NodeComponent>();
+			auto& node = entity->GetComponent<Ndk::NodeComponent>();
 			node.SetPosition(position);
 			node.SetRotation(rotation);
 
-			auto& physComponent = newEntity->AddComponent<Ndk::PhysicsComponent3D>();
-			physComponent.SetLinearDamping(0.05f);
-			physComponent.SetMass(100.f);
-			physComponent.SetPosition(position);
-			physComponent.SetRotation(rotation);
-		}
-		else if (type == "plasmabeam")
-		{
-			auto collider = Nz::CapsuleCollider3D::New(4.f, 0.5f, Nz::Vector3f::Zero(), Nz::EulerAnglesf(0.f, 90.f, 0.f));
-
-			newEntity->AddComponent<Ndk::CollisionComponent3D>(collider);
-			newEntity->AddComponent<LifeTimeComponent>(10.f);
-			newEntity->AddComponent<ProjectileComponent>(Nz::UInt16(50 + ((m_app->GetAppTime() % 21) - 10))); //< Aléatoire du pauvre
-			newEntity->AddComponent<SignatureComponent>(newEntity->GetId(), 10'000.0, collider->ComputeAABB().GetRadius(), collider->ComputeVolume());
-			newEntity->AddComponent<SynchronizedComponent>(2, type, name, true, 0);
-
-			auto& node = newEntity->AddComponent<Ndk::NodeComponent>();
-			node.SetPosition(position);
-			node.SetRotation(rotation);
+			if (entity->HasComponent<Ndk::PhysicsComponent3D>())
+			{
+				auto& physComponent = entity->GetComponent<Ndk::PhysicsComponent3D>();
+				physComponent.SetAngularVelocity(Nz::Vector3f::Zero());
+				physComponent.SetLinearVelocity(Nz::Vector3f::Zero());
+				physComponent.SetPosition(position);
+				physComponent.SetRotation(rotation);
+			}
 
-			auto& physComponent = newEntity->AddComponent<Ndk::PhysicsComponent3D>();
-			physComponent.SetAngularDamping(Nz::Vector3f::Zero());
-			physComponent.SetLinearDamping(0.f);
-			physComponent.SetMass(1.f);
-			physComponent.SetMaterial("plasma");
-			physComponent.SetPosition(position);
-			physComponent.SetRotation(rotation);
+			return entity;
 		}
-		else if (type == "torpedo")
-		{
-			auto collider = Nz::SphereCollider3D::New(3.f);
 
-			newEntity->AddComponent<Ndk::CollisionComponent3D>(collider);
-			newEntity->AddComponent<LifeTimeComponent>(30.f);
-			newEntity->AddComponent<ProjectileComponent>(200);
-			newEntity->AddComponent<SignatureComponent>(newEntity->GetId(), 1'000.0, collider->GetRadius(), collider->ComputeVolume());
-			newEntity->AddComponent<SynchronizedComponent>(3, type, name, true, 0);
+		const Ndk::EntityHandle& newEntity = m_world.CreateEntity();
+		prefabStore.BuildEntity(prefabId, newEntity, std::move(name));
 
-			auto& node = newEntity->AddComponent<Ndk::NodeComponent>();
-			node.SetPosition(position);
-			node.SetRotation(rotation);
+		auto& node = newEntity->GetComponent<Ndk::NodeComponent>();
+		node.SetPosition(position);
+		node.SetRotation(rotation);
 
-			auto& physComponent = newEntity->AddComponent<Ndk::PhysicsComponent3D>();
-			physComponent.SetAngularDamping(Nz::Vector3f::Zero());
-			physComponent.SetLinearDamping(0.f);
-			physComponent.SetMass(1.f);
-			physComponent.SetMaterial("torpedo");
+		if (newEntity->HasComponent<Ndk::PhysicsComponent3D>())
+		{
+			auto& physComponent = newEntity->GetComponent<Ndk::PhysicsComponent3D>();
 			physComponent.SetPosition(position);
 			physComponent.SetRotation(rotation);
 		}
@@ -417,80 +576,30 @@ namespace ewn
 
 		auto& collisionComponent = newEntity->AddComponent<Ndk::CollisionComponent3D>(collider);
 
+		// Clients assume these values when predicting their spaceship movement
+		SpaceshipMovement::Parameters movementParameters;
+
 		auto& physComponent = newEntity->AddComponent<Ndk::PhysicsComponent3D>();
-		physComponent.SetMass(42.f);
-		physComponent.SetAngularDamping(Nz::Vector3f(0.4f));
-		physComponent.SetLinearDamping(0.25f);
+		physComponent.SetMass(movementParameters.mass);
+		physComponent.SetAngularDamping(movementParameters.angularDamping);
+		physComponent.SetLinearDamping(movementParameters.linearDamping);
 		physComponent.SetPosition(position);
 		physComponent.SetRotation(rotation);
 
 		auto& healthComponent = newEntity->AddComponent<HealthComponent>(1000);
+		// Health signals may fire in the middle of collision processing, their effects are applied once per tick by FlushDamageEvents
 		healthComponent.OnDeath.Connect([this](HealthComponent* health, const Ndk::EntityHandle& attacker)
 		{
-			const Ndk::EntityHandle& entity = health->GetEntity();
-
-			if (entity->HasComponent<PlayerControlledComponent>())
-			{
-				auto& shipOwner = entity->GetComponent<PlayerControlledComponent>();
-
-				Player* shipOwnerPlayer = shipOwner.GetOwner();
-				if (!shipOwnerPlayer)
-					return;
-
-				if (m_script.GetGlobal("OnPlayerDeath") == Nz::LuaType_Function)
-				{
-					m_script.Push(shipOwnerPlayer);
-
-					if (!m_script.Call(1))
-						std::cerr << "An error occurred during OnPlayerDeath call: " << m_script.GetLastError() << std::endl;
-				}
-				else
-					m_script.Pop();
-
-				if (attacker->HasComponent<OwnerComponent>())
-				{
-					auto& attackerOwner = attacker->GetComponent<OwnerComponent>();
-
-					Player* attackerPlayer = attackerOwner.GetOwner();
-					std::string attackerName = (attackerPlayer) ? attackerPlayer->GetName() : "<Disconnected>";
-
-					PrintChatMessage(attackerName + " has destroyed " + shipOwnerPlayer->GetName());
-				}
-			}
-
-			Ndk::NodeComponent& entityNode = entity->GetComponent<Ndk::NodeComponent>();
-
-			Packets::InstantiateParticleSystem particlePacket;
-			particlePacket.particleSystemId = 0; //< Explosion
-			particlePacket.position = entityNode.GetPosition();
-			particlePacket.rotation = entityNode.GetRotation();
-			particlePacket.scale = Nz::Vector3f(1.f);
-			BroadcastPacket(particlePacket);
-
-			Packets::PlaySound soundPacket;
-			soundPacket.position = entityNode.GetPosition();
-			soundPacket.soundId = 2;
-			BroadcastPacket(soundPacket);
-
-			entity->Kill();
+			auto& death = m_pendingDeaths.emplace_back();
+			death.attacker = attacker;
+			death.entity = health->GetEntity();
 		});
 
 		healthComponent.OnHealthChange.Connect([this](HealthComponent* health)
 		{
 			const Ndk::EntityHandle& entity = health->GetEntity();
-			if (!entity->HasComponent<PlayerControlledComponent>())
-				return;
-
-			Player* owner = entity->GetComponent<PlayerControlledComponent>().GetOwner();
-			if (!owner)
-				return;
-
-			Nz::UInt8 integrityPct = static_cast<Nz::UInt8>(Nz::Clamp(health->GetHealthPct() / 100.f * 255.f, 0.f, 255.f));
-
-			Packets::IntegrityUpdate integrityPacket;
-			integrityPacket.integrityValue = integrityPct;
-
-			owner->SendPacket(integrityPacket);
+			if (!m_integrityChangedEntities.Has(entity))
+				m_integrityChangedEntities.Insert(entity);
 		});
 
 		Nz::Int64 signature;
@@ -501,7 +610,7 @@ namespace ewn
 
 		newEntity->AddComponent<InputComponent>();
 		newEntity->AddComponent<SignatureComponent>(signature, 42.0, collider->ComputeAABB().GetRadius(), collider->ComputeVolume());
-		newEntity->AddComponent<SynchronizedComponent>((spaceshipHullId == 1) ? 5 : 6, "spaceship", name, true, 5);
+		newEntity->AddComponent<SynchronizedComponent>((spaceshipHullId == 1) ? m_spaceshipPrefabId : m_frigatePrefabId, "spaceship", name, true, 5);
 
 		auto& node = newEntity->AddComponent<Ndk::NodeComponent>();
 		node.SetPosition(position);
@@ -515,6 +624,142 @@ namespace ewn
 		return newEntity;
 	}
 
+	void Arena::UpdateWorldStats(float elapsedTime, Nz::UInt64 updateTime, Nz::UInt64 physicsTime)
+	{
+		m_physicsUpdateMaxTime = std::max(m_physicsUpdateMaxTime, physicsTime);
+		m_physicsUpdateTimeSum += physicsTime;
+		m_worldUpdateCount++;
+		m_worldUpdateMaxTime = std::max(m_worldUpdateMaxTime, updateTime);
+		m_worldUpdateTimeSum += updateTime;
+
+		// Stats are computed over a one second window
+		m_worldStatsTimer += elapsedTime;
+		if (m_worldStatsTimer >= 1.f)
+		{
+			m_worldStats.averagePhysicsTime = m_physicsUpdateTimeSum / m_worldUpdateCount;
+			m_worldStats.averageUpdateTime = m_worldUpdateTimeSum / m_worldUpdateCount;
+			m_worldStats.maxPhysicsTime = m_physicsUpdateMaxTime;
+			m_worldStats.maxUpdateTime = m_worldUpdateMaxTime;
+			m_worldStats.updateCount = m_worldUpdateCount;
+
+			m_physicsUpdateMaxTime = 0;
+			m_physicsUpdateTimeSum = 0;
+			m_worldStatsTimer = 0.f;
+			m_worldUpdateCount = 0;
+			m_worldUpdateMaxTime = 0;
+			m_worldUpdateTimeSum = 0;
+		}
+	}
+
+	void Arena::FlushDamageEvents()
+	{
+		// Multiple hits on the same entity during a tick only produce one integrity update
+		for (const Ndk::EntityHandle& entity : m_integrityChangedEntities)
+		{
+			if (!entity->HasComponent<PlayerControlledComponent>())
+				continue;
+
+			Player* owner = entity->GetComponent<PlayerControlledComponent>().GetOwner();
+			if (!owner)
+				continue;
+
+			const HealthComponent& health = entity->GetComponent<HealthComponent>();
+			Nz::UInt8 integrityPct = static_cast<Nz::UInt8>(Nz::Clamp(health.GetHealthPct() / 100.f * 255.f, 0.f, 255.f));
+
+			Packets::IntegrityUpdate integrityPacket;
+			integrityPacket.integrityValue = integrityPct;
+
+			owner->SendPacket(integrityPacket);
+		}
+		m_integrityChangedEntities.Clear();
+
+		// Lua callbacks may damage other entities, handle deaths appended while iterating as well
+		for (std::size_t i = 0; i < m_pendingDeaths.size(); ++i)
+		{
+			Ndk::EntityHandle entity = m_pendingDeaths[i].entity;
+			Ndk::EntityHandle attacker = m_pendingDeaths[i].attacker;
+			if (!entity)
+				continue;
+
+			if (entity->HasComponent<PlayerControlledComponent>())
+			{
+				auto& shipOwner = entity->GetComponent<PlayerControlledComponent>();
+
+				if (Player* shipOwnerPlayer = shipOwner.GetOwner())
+				{
+					if (m_script.GetGlobal("OnPlayerDeath") == Nz::LuaType_Function)
+					{
+						ProfileZone("Arena::OnPlayerDeath (Lua)");
+
+						m_script.Push(shipOwnerPlayer);
+
+						if (!m_script.Call(1))
+							LogError(LogCategory::Script) << "An error occurred during OnPlayerDeath call: " << m_script.GetLastError();
+					}
+					else
+						m_script.Pop();
+
+					if (attacker && attacker->HasComponent<OwnerComponent>())
+					{
+						auto& attackerOwner = attacker->GetComponent<OwnerComponent>();
+
+						Player* attackerPlayer = attackerOwner.GetOwner();
+						std::string attackerName = (attackerPlayer) ? attackerPlayer->GetName() : "<Disconnected>";
+
+						PrintChatMessage(attackerName + " has destroyed " + shipOwnerPlayer->GetName());
+					}
+				}
+			}
+
+			Ndk::NodeComponent& entityNode = entity->GetComponent<Ndk::NodeComponent>();
+
+			auto& particleSystem = m_pendingEffects.particleSystems.emplace_back();
+			particleSystem.particleSystemId = 0; //< Explosion
+			particleSystem.position = entityNode.GetPosition();
+			particleSystem.rotation = entityNode.GetRotation();
+			particleSystem.scale = Nz::Vector3f(1.f);
+
+			auto& sound = m_pendingEffects.sounds.emplace_back();
+			sound.position = entityNode.GetPosition();
+			sound.soundId = 2;
+
+			entity->Kill();
+		}
+		m_pendingDeaths.clear();
+
+		// Every death effect of this tick is sent in one packet
+		if (!m_pendingEffects.particleSystems.empty() || !m_pendingEffects.sounds.empty())
+		{
+			BroadcastPacket(m_pendingEffects);
+
+			m_pendingEffects.particleSystems.clear();
+			m_pendingEffects.sounds.clear();
+		}
+	}
+
+	void Arena::FlushProjectileUpdates()
+	{
+		if (!m_pendingProjectileCreations.projectiles.empty())
+		{
+			BroadcastPacket(m_pendingProjectileCreations);
+			m_pendingProjectileCreations.projectiles.clear();
+		}
+
+		if (!m_pendingProjectileDeletions.projectiles.empty())
+		{
+			BroadcastPacket(m_pendingProjectileDeletions);
+			m_pendingProjectileDeletions.projectiles.clear();
+		}
+	}
+
+	void Arena::InitializePooledEntity(std::size_t prefabId, const Ndk::EntityHandle& entity)
+	{
+		m_app->GetPrefabStore().BuildEntity(prefabId, entity);
+
+		entity->AddComponent<ArenaComponent>(*this);
+		entity->AddComponent<OwnerComponent>(nullptr);
+	}
+
 	bool Arena::LoadScript(std::string fileName)
 	{
 		m_script = Nz::LuaInstance();
@@ -528,7 +773,7 @@ namespace ewn
 
 		if (!m_script.ExecuteFromFile(fileName))
 		{
-			std::cerr << "Failed to execute arena script: " + m_script.GetLastError() << std::endl;
+			LogError(LogCategory::Script) << "Failed to execute arena script: " + m_script.GetLastError();
 			return false;
 		}
 
@@ -537,47 +782,133 @@ namespace ewn
 
 	void Arena::HandlePlayerLeave(Player* player)
 	{
-		assert(m_players.find(player) != m_players.end());
-
-		if (m_script.GetGlobal("OnPlayerLeave") == Nz::LuaType_Function)
+		if (player->IsRelay())
 		{
-			m_script.Push(player);
-
-			if (!m_script.Call(1))
-				std::cerr << "An error occurred during OnPlayerLeave call: " << m_script.GetLastError() << std::endl;
+			assert(m_relays.find(player) != m_relays.end());
+			m_relays.erase(player);
 		}
 		else
-			m_script.Pop();
+		{
+			assert(m_players.find(player) != m_players.end());
+
+			if (m_script.GetGlobal("OnPlayerLeave") == Nz::LuaType_Function)
+			{
+				ProfileZone("Arena::OnPlayerLeave (Lua)");
+
+				m_script.Push(player);
+
+				if (!m_script.Call(1))
+					LogError(LogCategory::Script) << "An error occurred during OnPlayerLeave call: " << m_script.GetLastError();
+			}
+			else
+				m_script.Pop();
+
+			player->ClearControlledEntity();
+			m_players.erase(player);
+		}
 
-		player->ClearControlledEntity();
-		m_players.erase(player);
+		auto streamIt = std::find_if(m_joinStreams.begin(), m_joinStreams.end(), [&](const JoinStream& stream) { return stream.player == player; });
+		if (streamIt != m_joinStreams.end())
+			m_joinStreams.erase(streamIt);
 	}
 
 	void Arena::HandlePlayerJoin(Player* player)
 	{
 		assert(m_players.find(player) == m_players.end());
+		assert(m_relays.find(player) == m_relays.end());
 
 		SendArenaData(player);
 
-		m_createEntitiesCache.entities.clear();
-		m_world.GetSystem<BroadcastSystem>().CreateAllEntities(m_createEntitiesCache);
+		// The world is streamed nearest entities first, starting from where the player spawns
+		Nz::Vector3f streamOrigin = Nz::Vector3f::Zero();
+		if (const Ndk::EntityHandle& controlledEntity = player->GetControlledEntity())
+			streamOrigin = controlledEntity->GetComponent<Ndk::NodeComponent>().GetPosition();
 
-		player->SendPacket(m_createEntitiesCache);
+		JoinStream& joinStream = m_joinStreams.emplace_back();
+		joinStream.player = player;
+
+		for (const Ndk::EntityHandle& entity : m_world.GetSystem<BroadcastSystem>().GetEntities())
+		{
+			auto& pendingEntity = joinStream.pendingEntities.emplace_back();
+			pendingEntity.entity = entity;
+			pendingEntity.squaredDistance = streamOrigin.SquaredDistance(entity->GetComponent<Ndk::NodeComponent>().GetPosition());
+		}
+
+		std::sort(joinStream.pendingEntities.begin(), joinStream.pendingEntities.end(), [](const JoinStream::PendingEntity& lhs, const JoinStream::PendingEntity& rhs)
+		{
+			return lhs.squaredDistance > rhs.squaredDistance;
+		});
+
+		// Surroundings are sent right away, with the arena data
+		if (SendJoinChunk(joinStream))
+			m_joinStreams.pop_back();
+
+		// Send pending projectiles to other players first, so the new player only receives them once
+		FlushProjectileUpdates();
+
+		Packets::CreateProjectiles createProjectiles;
+		m_projectiles.BuildCreatePacket(createProjectiles, m_app->GetAppTime());
+		if (!createProjectiles.projectiles.empty())
+			player->SendPacket(createProjectiles);
+
+		if (player->IsRelay())
+		{
+			// Relays don't play, the arena script never sees them
+			m_relays.insert(player);
+			return;
+		}
 
 		m_players.insert(player);
 
 		if (m_script.GetGlobal("OnPlayerJoined") == Nz::LuaType_Function)
 		{
+			ProfileZone("Arena::OnPlayerJoined (Lua)");
+
 			m_script.Push(player);
 
 			if (!m_script.Call(1))
-				std::cerr << "An error occurred during OnPlayerJoined call: " << m_script.GetLastError() << std::endl;
+				LogError(LogCategory::Script) << "An error occurred during OnPlayerJoined call: " << m_script.GetLastError();
 		}
 		else
 			m_script.Pop();
 	}
 
+	void Arena::RecordReplayKeyframe()
+	{
+		// Projectiles waiting to be broadcasted would be created twice otherwise
+		FlushProjectileUpdates();
+
+		Nz::UInt64 replayTime = GetReplayTime();
+
+		m_replayRecorder->BeginKeyframe(replayTime);
+
+		// Every chunk carries the arena data, so playback can start from any of them
+		m_replayRecorder->RecordPacket(replayTime, m_app->GetNetworkStringsPacket());
+		m_replayRecorder->RecordPacket(replayTime, m_arenaParticleSystems);
+		m_replayRecorder->RecordPacket(replayTime, m_arenaSounds);
+		m_replayRecorder->RecordPacket(replayTime, m_app->GetPrefabStore().GetArenaPrefabsPacket());
+
+		Packets::CreateEntities createEntities;
+		m_world.GetSystem<BroadcastSystem>().CreateAllEntities(createEntities);
+		if (!createEntities.entities.empty())
+			m_replayRecorder->RecordPacket(replayTime, createEntities);
+
+		Packets::CreateProjectiles createProjectiles;
+		m_projectiles.BuildCreatePacket(createProjectiles, replayTime);
+		if (!createProjectiles.projectiles.empty())
+			m_replayRecorder->RecordPacket(replayTime, createProjectiles);
+
+		m_replayRecorder->EndKeyframe();
+	}
+
 	void Arena::SendArenaData(Player* player)
+	{
+		player->SendCachedPacket(m_arenaParticleSystems);
+		player->SendCachedPacket(m_arenaSounds);
+		player->SendCachedPacket(m_app->GetPrefabStore().GetArenaPrefabsPacket());
+	}
+
+	void Arena::BuildArenaData()
 	{
 		Packets::ArenaParticleSystems arenaParticleSystems;
 		arenaParticleSystems.startId = 0;
@@ -592,7 +923,7 @@ namespace ewn
 		arenaParticleSystems.particleSystems.back().particleGroups.emplace_back();
 		arenaParticleSystems.particleSystems.back().particleGroups.back().particleGroupNameId = m_app->GetNetworkStringStore().GetStringIndex("explosion_wave");
 
-		player->SendPacket(arenaParticleSystems);
+		m_arenaParticleSystems.Update(arenaParticleSystems);
 
 		Packets::ArenaSounds arenaSoundsPacket;
 		arenaSoundsPacket.startId = 0;
@@ -609,82 +940,75 @@ namespace ewn
 		arenaSoundsPacket.sounds.emplace_back();
 		arenaSoundsPacket.sounds.back().filePath = "sounds/plasmabeam_loop.wav";
 
-		player->SendPacket(arenaSoundsPacket);
-
-		Packets::ArenaPrefabs arenaPrefabsPacket;
-		arenaPrefabsPacket.startId = 0;
-
-		// Earth
-		arenaPrefabsPacket.prefabs.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().effectNameId = m_app->GetNetworkStringStore().GetStringIndex("earth");
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().rotation = Nz::Quaternionf::Identity();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().scale = Nz::Vector3f::Unit();
-
-		// Light
-		arenaPrefabsPacket.prefabs.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().effectNameId = m_app->GetNetworkStringStore().GetStringIndex("light");
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().rotation = Nz::Quaternionf::Identity();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().scale = Nz::Vector3f::Unit();
-
-		// Plasma beam
-		arenaPrefabsPacket.prefabs.emplace_back();
-
-		arenaPrefabsPacket.prefabs.back().sounds.emplace_back();
-		arenaPrefabsPacket.prefabs.back().sounds.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().sounds.back().soundId = 3;
-
-		arenaPrefabsPacket.prefabs.back().visualEffects.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().effectNameId = m_app->GetNetworkStringStore().GetStringIndex("plasmabeam");
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().rotation = Nz::Quaternionf::Identity();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().scale = Nz::Vector3f::Unit();
-
-		// Torpedo
-		arenaPrefabsPacket.prefabs.emplace_back();
-
-		arenaPrefabsPacket.prefabs.back().sounds.emplace_back();
-		arenaPrefabsPacket.prefabs.back().sounds.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().sounds.back().soundId = 1;
-
-		arenaPrefabsPacket.prefabs.back().visualEffects.emplace_back();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().effectNameId = m_app->GetNetworkStringStore().GetStringIndex("torpedo");
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().rotation = Nz::Quaternionf::Identity();
-		arenaPrefabsPacket.prefabs.back().visualEffects.back().scale = Nz::Vector3f::Unit();
-
-		/*arenaPrefabsPacket.prefabs.back().sounds.emplace_back();
-		arenaPrefabsPacket.prefabs.back().sounds.back().soundId = 1;
-		arenaPrefabsPacket.prefabs.back().sounds.back().position = Nz::Vector3f::Zero();*/
-
-		// Ball
-		arenaPrefabsPacket.prefabs.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.back().modelId = m_app->GetNetworkStringStore().GetStringIndex("ball/ball.obj");
-		arenaPrefabsPacket.prefabs.back().models.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().models.back().rotation = Nz::Quaternionf::Identity();
-		arenaPrefabsPacket.prefabs.back().models.back().scale = Nz::Vector3f::Unit();
-
-		// Spaceship
-		arenaPrefabsPacket.prefabs.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.back().modelId = m_app->GetNetworkStringStore().GetStringIndex("spaceship/spaceship.obj");
-		arenaPrefabsPacket.prefabs.back().models.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().models.back().rotation = Nz::EulerAnglesf(0.f, 90.f, 0.f);
-		arenaPrefabsPacket.prefabs.back().models.back().scale = Nz::Vector3f(0.01f);
-
-		// Space Frigate
-		arenaPrefabsPacket.prefabs.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.emplace_back();
-		arenaPrefabsPacket.prefabs.back().models.back().modelId = m_app->GetNetworkStringStore().GetStringIndex("space_frigate_6/space_frigate_6.obj");
-		arenaPrefabsPacket.prefabs.back().models.back().position = Nz::Vector3f::Zero();
-		arenaPrefabsPacket.prefabs.back().models.back().rotation = Nz::EulerAnglesf(0.f, 90.f, 0.f);
-		arenaPrefabsPacket.prefabs.back().models.back().scale = Nz::Vector3f(0.1f);
-
-		player->SendPacket(arenaPrefabsPacket);
+		m_arenaSounds.Update(arenaSoundsPacket);
+	}
+
+	bool Arena::SendJoinChunk(JoinStream& stream)
+	{
+		BroadcastSystem& broadcastSystem = m_world.GetSystem<BroadcastSystem>();
+
+		m_joinChunk.entities.clear();
+		while (!stream.pendingEntities.empty())
+		{
+			// Entities destroyed or returned to their pool since the join are skipped, their deletion was broadcasted
+			const Ndk::EntityHandle& entity = stream.pendingEntities.back().entity;
+			if (entity && broadcastSystem.HasEntity(entity))
+			{
+				broadcastSystem.AppendEntity(entity, m_joinChunk);
+
+				// A chunk holds at least one entity, even if it's bigger than a chunk on its own
+				if (m_joinChunk.entities.size() > 1 && Packets::ComputeSize(m_joinChunk) > JoinChunkSize)
+				{
+					m_joinChunk.entities.pop_back();
+					break;
+				}
+			}
+
+			stream.pendingEntities.pop_back();
+		}
+
+		if (!m_joinChunk.entities.empty())
+			stream.player->SendPacket(m_joinChunk);
+
+		return stream.pendingEntities.empty();
+	}
+
+	void Arena::StartReplayRecording(const std::string& folder)
+	{
+		if (!Nz::Directory::Exists(folder) && !Nz::Directory::Create(folder, true))
+		{
+			LogError(LogCategory::Arena) << "(" << m_name << ") Failed to create replay folder " << folder;
+			return;
+		}
+
+		std::string fileName;
+		for (char c : m_name)
+			fileName += (std::isalnum(static_cast<unsigned char>(c)) || c == '-') ? c : '_';
+
+		// localtime isn't thread-safe, the UTC timestamp is enough to tell replays apart
+		Nz::UInt64 timestamp = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		fileName += '_' + std::to_string(timestamp) + ".ewnreplay";
+
+		try
+		{
+			m_replayRecorder = std::make_unique<ReplayRecorder>(folder + '/' + fileName, m_name, GetReplayTime());
+		}
+		catch (const std::exception& e)
+		{
+			LogError(LogCategory::Arena) << "(" << m_name << ") Failed to start replay recording: " << e.what();
+		}
+	}
+
+	void Arena::UpdateJoinStreams()
+	{
+		// One chunk per player and tick, reliable messages queued after them aren't stuck behind the whole world
+		for (auto it = m_joinStreams.begin(); it != m_joinStreams.end();)
+		{
+			if (SendJoinChunk(*it))
+				it = m_joinStreams.erase(it);
+			else
+				++it;
+		}
 	}
 
 	void Arena::SpawnSpaceship(Player* owner, Nz::Int32 spaceshipId, std::string code, std::size_t spaceshipHullId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation)
@@ -692,7 +1016,7 @@ namespace ewn
 		m_app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [this, position, rotation, sessionId = owner->GetSessionId(), spaceshipHullId, spaceshipCode = std::move(code)](DatabaseResult& result)
 		{
 			if (!result)
-				std::cerr << "Find spaceship modules failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Find spaceship modules failed: " << result.GetLastErrorMessage();
 
 			Player* ply = m_app->GetPlayerBySession(sessionId);
 			if (!ply)
@@ -714,7 +1038,7 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
+				LogError(LogCategory::Arena) << "Failed to retrieve spaceship modules: " << e.what();
 
 				ply->PrintMessage("Server: Failed to retrieve spaceship modules, please contact an administrator");
 				return;
@@ -747,105 +1071,123 @@ namespace ewn
 
 	bool Arena::HandleDefaultDefaultCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
 	{
+		// May be called from a physics thread, damage is only applied after the step
 		Ndk::EntityId firstEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(firstBody.GetUserdata()));
 		Ndk::EntityId secondEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(secondBody.GetUserdata()));
 
-		const Ndk::EntityHandle& firstEntity = m_world.GetEntity(firstEntityId);
-		const Ndk::EntityHandle& secondEntity = m_world.GetEntity(secondEntityId);
-
 		Nz::Vector3f firstVel = firstBody.GetLinearVelocity();
 		Nz::Vector3f secondVel = secondBody.GetLinearVelocity();
 
 		float relativeForce = (firstVel - secondVel).GetLength();
 
-		Nz::UInt16 damage = static_cast<Nz::UInt16>(relativeForce);
+		CollisionDamage collisionDamage;
+		collisionDamage.damage = static_cast<Nz::UInt16>(relativeForce);
+		collisionDamage.firstEntityId = firstEntityId;
+		collisionDamage.secondEntityId = secondEntityId;
 
-		if (firstEntity->HasComponent<HealthComponent>())
-		{
-			auto& health = firstEntity->GetComponent<HealthComponent>();
-			health.Damage(damage, secondEntity);
-		}
-
-		if (secondEntity->HasComponent<HealthComponent>())
-		{
-			auto& health = secondEntity->GetComponent<HealthComponent>();
-			health.Damage(damage, firstEntity);
-		}
+		std::lock_guard<std::mutex> lock(m_collisionEventMutex);
+		m_pendingCollisionDamages.push_back(collisionDamage);
 
 		return true;
 	}
 
-	bool Arena::HandlePlasmaProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
+	bool Arena::HandleTorpedoProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
 	{
-		Ndk::EntityId laserEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(firstBody.GetUserdata()));
+		// May be called from a physics thread, the explosion is only triggered after the step
+		Ndk::EntityId torpedoEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(firstBody.GetUserdata()));
 		Ndk::EntityId hitEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(secondBody.GetUserdata()));
 
-		if (secondBody.GetMaterial() == m_plasmaMaterial)
+		if (secondBody.GetMaterial() == m_torpedoMaterial)
 		{
-			assert(firstBody.GetMaterial() != m_plasmaMaterial);
-			std::swap(laserEntityId, hitEntityId);
+			assert(firstBody.GetMaterial() != m_torpedoMaterial);
+			std::swap(torpedoEntityId, hitEntityId);
 		}
 
-		const Ndk::EntityHandle& projectile = m_world.GetEntity(laserEntityId);
-		const Ndk::EntityHandle& hitEntity = m_world.GetEntity(hitEntityId);
-
-		assert(projectile->HasComponent<ProjectileComponent>());
+		TorpedoHit torpedoHit;
+		torpedoHit.hitEntityId = hitEntityId;
+		torpedoHit.torpedoEntityId = torpedoEntityId;
 
-		ProjectileComponent& projectileComponent = projectile->GetComponent<ProjectileComponent>();
-		if (projectileComponent.HasBeenHit(hitEntity))
-			return false;
+		std::lock_guard<std::mutex> lock(m_collisionEventMutex);
+		m_pendingTorpedoHits.push_back(torpedoHit);
 
-		projectileComponent.MarkAsHit(hitEntity);
+		return false;
+	}
 
-		// Deal damage if entity has a health value
-		if (hitEntity->HasComponent<HealthComponent>())
+	void Arena::AlignSystemsToTick(float tickRate)
+	{
+		// Round every system rate to a whole number of ticks, so a system always runs on the same ticks
+		// instead of drifting in and out of phase with the server loop
+		auto AlignRate = [tickRate](float rate)
 		{
-			auto& health = hitEntity->GetComponent<HealthComponent>();
-			health.Damage(projectileComponent.GetDamageValue(), projectile);
+			float tickDivider = std::max(std::round(tickRate / rate), 1.f);
+			return tickRate / tickDivider;
+		};
+
+		Ndk::BaseSystem* systems[] = {
+			&m_world.GetSystem<BroadcastSystem>(),
+			&m_world.GetSystem<InputSystem>(),
+			&m_world.GetSystem<LifeTimeSystem>(),
+			&m_world.GetSystem<NavigationSystem>(),
+			&m_world.GetSystem<ScriptSystem>()
+		};
+
+		for (Ndk::BaseSystem* system : systems)
+		{
+			if (float fixedRate = system->GetFixedUpdateRate(); fixedRate > 0.f)
+				system->SetFixedUpdateRate(AlignRate(fixedRate));
+
+			if (float maxRate = system->GetMaximumUpdateRate(); maxRate > 0.f)
+				system->SetMaximumUpdateRate(AlignRate(maxRate));
 		}
+	}
 
-		// Apply physics force
-		if (hitEntity->HasComponent<Ndk::PhysicsComponent3D>())
+	void Arena::ApplyCollisionEvents()
+	{
+		// Physics threads are idle between steps, no need to lock here
+		for (const CollisionDamage& collisionDamage : m_pendingCollisionDamages)
 		{
-			auto& hitEntityPhys = hitEntity->GetComponent<Ndk::PhysicsComponent3D>();
-			auto& projectilePhys = projectile->GetComponent<Ndk::PhysicsComponent3D>();
+			const Ndk::EntityHandle& firstEntity = m_world.GetEntity(collisionDamage.firstEntityId);
+			const Ndk::EntityHandle& secondEntity = m_world.GetEntity(collisionDamage.secondEntityId);
 
-			Nz::Vector3f projectileForce = projectilePhys.GetLinearVelocity();
-			float projectileSpeed;
-			projectileForce.Normalize(&projectileSpeed);
-			projectileForce = projectileForce * (projectileSpeed * projectileSpeed) / 2.f;
+			if (firstEntity->HasComponent<HealthComponent>())
+			{
+				auto& health = firstEntity->GetComponent<HealthComponent>();
+				health.Damage(collisionDamage.damage, secondEntity);
+			}
 
-			hitEntityPhys.AddForce(projectileForce);
+			if (secondEntity->HasComponent<HealthComponent>())
+			{
+				auto& health = secondEntity->GetComponent<HealthComponent>();
+				health.Damage(collisionDamage.damage, firstEntity);
+			}
 		}
+		m_pendingCollisionDamages.clear();
 
-		projectile->Kill(); //< Remember entity destruction is not immediate, we can still use it safely
+		for (const TorpedoHit& torpedoHit : m_pendingTorpedoHits)
+		{
+			const Ndk::EntityHandle& projectile = m_world.GetEntity(torpedoHit.torpedoEntityId);
+			const Ndk::EntityHandle& hitEntity = m_world.GetEntity(torpedoHit.hitEntityId);
 
-		return false;
-	}
+			assert(projectile->HasComponent<ProjectileComponent>());
 
-	bool Arena::HandleTorpedoProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody)
-	{
-		Ndk::EntityId torpedoEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(firstBody.GetUserdata()));
-		Ndk::EntityId hitEntityId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(secondBody.GetUserdata()));
+			// Torpedo may have already exploded during this step and been returned to its pool
+			if (!projectile->IsEnabled())
+				continue;
 
-		if (secondBody.GetMaterial() == m_torpedoMaterial)
-		{
-			assert(firstBody.GetMaterial() != m_plasmaMaterial);
-			std::swap(torpedoEntityId, hitEntityId);
-		}
+			ProjectileComponent& projectileComponent = projectile->GetComponent<ProjectileComponent>();
+			if (projectileComponent.HasBeenHit(hitEntity))
+				continue;
 
-		const Ndk::EntityHandle& projectile = m_world.GetEntity(torpedoEntityId);
-		const Ndk::EntityHandle& hitEntity = m_world.GetEntity(hitEntityId);
+			projectileComponent.MarkAsHit(hitEntity);
 
-		assert(projectile->HasComponent<ProjectileComponent>());
+			ExplodeTorpedo(projectile);
+		}
+		m_pendingTorpedoHits.clear();
+	}
 
+	void Arena::ExplodeTorpedo(const Ndk::EntityHandle& projectile)
+	{
 		ProjectileComponent& projectileComponent = projectile->GetComponent<ProjectileComponent>();
-		if (projectileComponent.HasBeenHit(hitEntity))
-			return false;
-
-		projectileComponent.MarkAsHit(hitEntity);
-
-		// Deal damage if entity has a health value
 
 		// Apply physics force
 		auto& projectilePhys = projectile->GetComponent<Ndk::PhysicsComponent3D>();
@@ -883,41 +1225,122 @@ namespace ewn
 			return true;
 		});
 
-		projectile->Kill(); //< Remember entity destruction is not immediate, we can still use it safely
+		// Neither disabling nor killing is immediate, we can still use the projectile safely
+		if (projectile->HasComponent<PooledComponent>())
+			projectile->GetComponent<PooledComponent>().ReturnToPool();
+		else
+			projectile->Kill();
+	}
 
-		return false;
+	Nz::UInt64 Arena::GetReplayTime() const
+	{
+		return m_app->GetAppTime();
+	}
+
+	void Arena::OnPlasmaProjectileHit(ProjectileSimulator* /*simulator*/, const ProjectileSimulator::HitInfo& hit)
+	{
+		m_pendingProjectileDeletions.projectiles.emplace_back(hit.projectileId);
+
+		const Ndk::EntityHandle& hitEntity = hit.hitEntity;
+		if (!hitEntity)
+			return;
+
+		// Deal damage if entity has a health value
+		if (hitEntity->HasComponent<HealthComponent>())
+		{
+			auto& health = hitEntity->GetComponent<HealthComponent>();
+			health.Damage(hit.damage, hit.emitter);
+		}
+
+		// Apply physics force
+		if (hitEntity->HasComponent<Ndk::PhysicsComponent3D>())
+		{
+			auto& hitEntityPhys = hitEntity->GetComponent<Ndk::PhysicsComponent3D>();
+
+			Nz::Vector3f projectileForce = hit.velocity;
+			float projectileSpeed;
+			projectileForce.Normalize(&projectileSpeed);
+			projectileForce = projectileForce * (projectileSpeed * projectileSpeed) / 2.f;
+
+			hitEntityPhys.AddForce(projectileForce);
+		}
 	}
 
 	void Arena::OnBroadcastEntitiesCreation(const BroadcastSystem* /*system*/, const Packets::CreateEntities& packet)
 	{
 		for (Player* player : m_players)
-			player->SendPacket(packet);
+			m_metrics.broadcastBytes->Increment(player->SendPacket(packet));
+
+		for (Player* relay : m_relays)
+			m_metrics.broadcastBytes->Increment(relay->SendPacket(packet));
+
+		if (m_replayRecorder)
+			m_replayRecorder->RecordPacket(GetReplayTime(), packet);
+
+		// Streaming players just received these entities, they must not be sent twice
+		if (!m_joinStreams.empty())
+		{
+			std::vector<Nz::UInt32> createdEntities;
+			createdEntities.reserve(packet.entities.size());
+			for (const auto& entityData : packet.entities)
+				createdEntities.push_back(entityData.entityId);
+
+			std::sort(createdEntities.begin(), createdEntities.end());
+
+			for (JoinStream& stream : m_joinStreams)
+			{
+				auto it = std::remove_if(stream.pendingEntities.begin(), stream.pendingEntities.end(), [&](const JoinStream::PendingEntity& pendingEntity)
+				{
+					return pendingEntity.entity && std::binary_search(createdEntities.begin(), createdEntities.end(), static_cast<Nz::UInt32>(pendingEntity.entity->GetId()));
+				});
+				stream.pendingEntities.erase(it, stream.pendingEntities.end());
+			}
+		}
 	}
 
 	void Arena::OnBroadcastEntitiesDestruction(const BroadcastSystem* /*system*/, const Packets::DeleteEntities& packet)
 	{
 		for (Player* player : m_players)
-			player->SendPacket(packet);
+			m_metrics.broadcastBytes->Increment(player->SendPacket(packet));
+
+		for (Player* relay : m_relays)
+			m_metrics.broadcastBytes->Increment(relay->SendPacket(packet));
+
+		if (m_replayRecorder)
+			m_replayRecorder->RecordPacket(GetReplayTime(), packet);
 	}
 
 	void Arena::OnBroadcastStateUpdate(const BroadcastSystem* /*system*/, Packets::ArenaState& statePacket)
 	{
-		static Nz::UInt16 snapshotId = 0;
-		statePacket.stateId = snapshotId++;
-
 		for (Player* player : m_players)
 		{
 			statePacket.lastProcessedInputTime = player->GetLastInputProcessedTime();
 
-			player->SendPacket(statePacket);
+			m_metrics.broadcastBytes->Increment(player->SendPacket(statePacket));
+		}
+
+		// Relays and replays have no input of their own
+		statePacket.lastProcessedInputTime = 0;
+
+		for (Player* relay : m_relays)
+			m_metrics.broadcastBytes->Increment(relay->SendPacket(statePacket));
+
+		if (m_replayRecorder)
+		{
+			// Creations and deletions were just broadcasted, every entity is known to clients: a keyframe taken now won't miss or duplicate any
+			Nz::UInt64 replayTime = GetReplayTime();
+			if (m_replayRecorder->IsKeyframeNeeded(replayTime))
+				RecordReplayKeyframe();
+
+			m_replayRecorder->RecordPacket(replayTime, statePacket);
 		}
 
 		if constexpr (sendServerGhosts)
 		{
 			// Broadcast arena state over network, for testing purposes
-			Nz::NetPacket debugState(1);
-			PacketSerializer serializer(debugState, true);
-			Packets::Serialize(serializer, statePacket);
+			Nz::NetPacket debugState;
+			PacketWriter writer(debugState, 1, Packets::ComputeSize(statePacket));
+			Packets::Serialize(writer, statePacket);
 
 			Nz::IpAddress debugAddress = Nz::IpAddress::BroadcastIpV4;
 			debugAddress.SetPort(2050);
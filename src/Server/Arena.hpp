@@ -13,9 +13,19 @@
 #include <NDK/EntityOwner.hpp>
 #include <NDK/World.hpp>
 #include <Shared/NetworkReactor.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
 #include <Shared/Protocol/Packets.hpp>
+#include <Server/EntityPool.hpp>
+#include <Server/MetricsRegistry.hpp>
+#include <Server/ProjectileSimulator.hpp>
+#include <Server/ReplayRecorder.hpp>
 #include <Server/ServerCommandStore.hpp>
+#include <Server/SystemUpdateTimings.hpp>
+#include <Server/TimingHistogram.hpp>
+#include <memory>
+#include <mutex>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace Nz
@@ -34,6 +44,9 @@ namespace ewn
 		friend Player;
 
 		public:
+			struct UpdateTimings;
+			struct WorldStats;
+
 			Arena(ServerApplication* app, std::string name, std::string scriptName);
 			Arena(const Arena&) = delete;
 			Arena(Arena&&) = delete;
@@ -43,7 +56,8 @@ namespace ewn
 			void BroadcastPacket(const T& packet, Player* exceptPlayer = nullptr);
 
 			const Ndk::EntityHandle& CreateEntity(std::string type, std::string name, Player* owner, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
-			const Ndk::EntityHandle& CreatePlasmaProjectile(Player* owner, const Ndk::EntityHandle& emitter, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
+			Nz::UInt32 CreatePlasmaProjectile(const Ndk::EntityHandle& emitter, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
+			const Ndk::EntityHandle& CreatePrefab(std::size_t prefabId, std::string name, Player* owner, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 			const Ndk::EntityHandle& CreateSpaceship(std::string name, Player* owner, std::size_t spaceshipHullId, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 			const Ndk::EntityHandle& CreateTorpedo(Player* owner, const Ndk::EntityHandle& emitter, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 
@@ -52,6 +66,9 @@ namespace ewn
 			inline const Ndk::EntityHandle& GetEntity(Ndk::EntityId entityId);
 			inline Nz::LuaInstance& GetLuaInstance();
 			inline const std::string& GetName() const;
+			inline unsigned int GetPhysicsThreadCount() const;
+			inline const UpdateTimings& GetUpdateTimings() const;
+			inline const WorldStats& GetWorldStats() const;
 
 			void HandleChatMessage(Player* sender, const std::string& message);
 
@@ -62,6 +79,8 @@ namespace ewn
 			void Reload();
 			void Reset();
 
+			void SetPhysicsThreadCount(unsigned int threadCount);
+
 			void SpawnFleet(Player* owner, const std::string& fleetName);
 			void SpawnFleet(Player* owner, const std::string& fleetName, const Nz::Vector3f& spawnPos, const Nz::Quaternionf& spawnRot);
 			void SpawnSpaceship(Player* owner, const std::string& spaceshipName, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
@@ -70,37 +89,157 @@ namespace ewn
 			const Ndk::EntityHandle& SpawnSpaceship(Player* owner, std::string code, std::size_t spaceshipHullId, const std::vector<std::size_t>& modules, const Nz::Vector3f& position, const Nz::Quaternionf& rotation);
 
 			void Update(float elapsedTime);
+			void UpdateMetrics();
 
 			Arena& operator=(const Arena&) = delete;
 			Arena& operator=(Arena&&) = delete;
 
+			// Time spent (in microseconds) in each part of Update
+			struct UpdateTimings
+			{
+				TimingHistogram collisions;
+				TimingHistogram flush;
+				TimingHistogram players;
+				TimingHistogram projectiles;
+				TimingHistogram script;
+				TimingHistogram world;
+				SystemUpdateTimings physics; //< part of world, what's left once every other system is accounted for
+				std::vector<std::pair<std::string, const SystemUpdateTimings*>> systems; //< part of world, physics first then the ones owned by each system
+			};
+
+			// Whole world update (the physics step and every system), physics is the world update minus the other systems
+			// as PhysicsSystem3D is Nazara's and can't be instrumented from the inside (it also includes the entity refresh)
+			struct WorldStats
+			{
+				Nz::UInt64 averagePhysicsTime = 0; //< microseconds
+				Nz::UInt64 averageUpdateTime = 0; //< microseconds
+				Nz::UInt64 maxPhysicsTime = 0; //< microseconds
+				Nz::UInt64 maxUpdateTime = 0; //< microseconds
+				unsigned int updateCount = 0;
+			};
+
 		private:
+			struct JoinStream;
+
+			void AlignSystemsToTick(float tickRate);
+			void ApplyCollisionEvents();
+			void ExplodeTorpedo(const Ndk::EntityHandle& projectile);
+
+			void FlushDamageEvents();
+			void FlushProjectileUpdates();
+
+			void InitializePooledEntity(std::size_t prefabId, const Ndk::EntityHandle& entity);
+
 			bool LoadScript(std::string fileName);
 
 			void HandlePlayerLeave(Player* player);
 			void HandlePlayerJoin(Player* player);
 
 			bool HandleDefaultDefaultCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody);
-			bool HandlePlasmaProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody);
 			bool HandleTorpedoProjectileCollision(const Nz::RigidBody3D& firstBody, const Nz::RigidBody3D& secondBody);
 
+			void BuildArenaData();
+
+			Nz::UInt64 GetReplayTime() const;
+
+			void OnPlasmaProjectileHit(ProjectileSimulator* simulator, const ProjectileSimulator::HitInfo& hit);
+
 			void OnBroadcastEntitiesCreation(const BroadcastSystem* system, const Packets::CreateEntities& packet);
 			void OnBroadcastEntitiesDestruction(const BroadcastSystem* system, const Packets::DeleteEntities& packet);
 			void OnBroadcastStateUpdate(const BroadcastSystem* system, Packets::ArenaState& statePacket);
 
+			void RecordReplayKeyframe();
+
 			void SendArenaData(Player* player);
+			bool SendJoinChunk(JoinStream& stream);
+
+			void StartReplayRecording(const std::string& folder);
+
+			void UpdateJoinStreams();
+
+			void UpdateWorldStats(float elapsedTime, Nz::UInt64 updateTime, Nz::UInt64 physicsTime);
+
+			// Collision callbacks may run on physics threads, they only record events applied after the step
+			struct CollisionDamage
+			{
+				Ndk::EntityId firstEntityId;
+				Ndk::EntityId secondEntityId;
+				Nz::UInt16 damage;
+			};
+
+			struct TorpedoHit
+			{
+				Ndk::EntityId hitEntityId;
+				Ndk::EntityId torpedoEntityId;
+			};
+
+			struct PendingDeath
+			{
+				Ndk::EntityHandle attacker;
+				Ndk::EntityHandle entity;
+			};
+
+			// Entities existing when a player joined, streamed over several ticks
+			struct JoinStream
+			{
+				struct PendingEntity
+				{
+					Ndk::EntityHandle entity;
+					float squaredDistance;
+				};
+
+				std::vector<PendingEntity> pendingEntities; //< farthest first, chunks are taken from the back
+				Player* player;
+			};
+
+			struct Metrics
+			{
+				MetricsRegistry::Counter* broadcastBytes;
+				MetricsRegistry::Gauge* bots;
+				MetricsRegistry::Gauge* entities;
+				MetricsRegistry::Gauge* players;
+				MetricsRegistry::Histogram* updateDuration;
+			};
 
 			Nz::LuaInstance m_script;
 			Nz::UdpSocket m_debugSocket;
+			Ndk::EntityList m_integrityChangedEntities;
 			Ndk::EntityList m_scriptControlledEntities;
 			Ndk::World m_world;
+			ProjectileSimulator m_projectiles;
+			std::size_t m_frigatePrefabId;
+			std::size_t m_plasmaBeamPrefabId;
+			std::size_t m_spaceshipPrefabId;
+			std::size_t m_torpedoPrefabId;
 			std::string m_name;
 			std::string m_scriptName;
+			std::mutex m_collisionEventMutex;
 			std::unordered_set<Player*> m_players;
-			Packets::CreateEntities m_createEntitiesCache;
+			std::unordered_set<Player*> m_relays; //< spectator relays, they receive every broadcast but scripts don't know about them
+			std::vector<CollisionDamage> m_pendingCollisionDamages;
+			std::vector<PendingDeath> m_pendingDeaths;
+			std::vector<std::unique_ptr<EntityPool>> m_prefabPools;
+			std::vector<TorpedoHit> m_pendingTorpedoHits;
+			std::unique_ptr<ReplayRecorder> m_replayRecorder;
+			CachedPacket<Packets::ArenaParticleSystems> m_arenaParticleSystems;
+			CachedPacket<Packets::ArenaSounds> m_arenaSounds;
+			std::vector<JoinStream> m_joinStreams;
+			Packets::CreateEntities m_joinChunk;
+			Packets::CreateProjectiles m_pendingProjectileCreations;
+			Packets::DeleteProjectiles m_pendingProjectileDeletions;
+			Packets::InstantiateEffects m_pendingEffects;
+			Metrics m_metrics;
+			WorldStats m_worldStats;
+			UpdateTimings m_updateTimings;
 			ServerApplication* m_app;
-			int m_plasmaMaterial;
 			int m_torpedoMaterial;
+			unsigned int m_worldUpdateCount;
+			unsigned int m_physicsThreadCount;
+			Nz::UInt64 m_physicsUpdateMaxTime;
+			Nz::UInt64 m_physicsUpdateTimeSum;
+			Nz::UInt64 m_worldUpdateMaxTime;
+			Nz::UInt64 m_worldUpdateTimeSum;
+			float m_worldStatsTimer;
 	};
 }
 
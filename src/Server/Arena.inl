@@ -13,8 +13,14 @@ namespace ewn
 		for (Player* player : m_players)
 		{
 			if (player != exceptPlayer)
-				player->SendPacket(packet);
+				m_metrics.broadcastBytes->Increment(player->SendPacket(packet));
 		}
+
+		for (Player* relay : m_relays)
+			m_metrics.broadcastBytes->Increment(relay->SendPacket(packet));
+
+		if (m_replayRecorder)
+			m_replayRecorder->RecordPacket(GetReplayTime(), packet);
 	}
 
 	inline const Ndk::EntityHandle& Arena::GetEntity(Ndk::EntityId entityId)
@@ -33,6 +39,21 @@ namespace ewn
 		return m_name;
 	}
 
+	inline unsigned int Arena::GetPhysicsThreadCount() const
+	{
+		return m_physicsThreadCount;
+	}
+
+	inline const Arena::UpdateTimings& Arena::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
+
+	inline const Arena::WorldStats& Arena::GetWorldStats() const
+	{
+		return m_worldStats;
+	}
+
 	inline bool Arena::IsEntityIdValid(Ndk::EntityId entityId) const
 	{
 		return m_world.IsEntityIdValid(entityId);
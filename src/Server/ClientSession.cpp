@@ -3,35 +3,111 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/ClientSession.hpp>
-#include <Nazara/Core/StackArray.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/MovementInputHistory.hpp>
 #include <Shared/SecureRandomGenerator.hpp>
 #include <Server/Components/OwnerComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
 #include <Server/Player.hpp>
 #include <Server/ServerApplication.hpp>
 #include <argon2/argon2.h>
+#include <algorithm>
 #include <bitset>
 #include <cassert>
 #include <cctype>
-#include <iostream>
+#include <limits>
 #include <regex>
 
 namespace ewn
 {
-	ClientSession::ClientSession(ServerApplication* app, std::size_t sessionId, std::size_t peerId, std::shared_ptr<Player> player, NetworkReactor& reactor, const ServerCommandStore& commandStore) :
+	namespace
+	{
+		// Microseconds to the milliseconds sent to clients, rounded up so they never retry too early
+		Nz::UInt32 ToRetryDelay(Nz::UInt64 delay)
+		{
+			return static_cast<Nz::UInt32>(std::min<Nz::UInt64>((delay + 999) / 1000, std::numeric_limits<Nz::UInt32>::max()));
+		}
+
+		// Compares every character even after a mismatch, so the time taken doesn't tell how much of the secret was right
+		bool CompareSecrets(const std::string& secret, const std::string& candidate)
+		{
+			if (secret.size() != candidate.size())
+				return false;
+
+			unsigned char difference = 0;
+			for (std::size_t i = 0; i < secret.size(); ++i)
+				difference |= static_cast<unsigned char>(secret[i] ^ candidate[i]);
+
+			return difference == 0;
+		}
+	}
+
+	ClientSession::ClientSession(ServerApplication* app, Nz::UInt64 sessionId, std::size_t peerId, Nz::IpAddress remoteAddress, std::shared_ptr<Player> player, NetworkReactor& reactor, const ServerCommandStore& commandStore) :
 	m_player(std::move(player)),
 	m_peerId(peerId),
+	m_remoteAddress(std::move(remoteAddress)),
 	m_sessionId(sessionId),
 	m_app(app),
 	m_networkReactor(reactor),
 	m_commandStore(commandStore)
 	{
+		m_cachedPacketVersions.fill(0);
+
+		for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			m_sentMessages[channelId] = &m_app->GetMetrics().GetCounter("erewhon_network_sent_messages_total", "Messages sent per channel, several of them can share a packet", { { "channel", std::to_string(channelId) } });
+
+		m_duplicateInputs = &m_app->GetMetrics().GetCounter("erewhon_redundant_inputs_total", "Inputs sent again by clients in later movement packets, gap fills replace inputs whose packet was lost", { { "kind", "duplicate" } });
+		m_gapFilledInputs = &m_app->GetMetrics().GetCounter("erewhon_redundant_inputs_total", "Inputs sent again by clients in later movement packets, gap fills replace inputs whose packet was lost", { { "kind", "gap_fill" } });
+	}
+
+	bool ClientSession::CheckHashingAdmission(const std::string& login, bool* serverBusy, Nz::UInt32* retryAfter)
+	{
+		assert(serverBusy && retryAfter);
+
+		// Checked before querying the database, so a flood of requests is refused without doing any work for them
+		Nz::UInt64 delay;
+		if (!m_app->ConsumeLoginAttempt(m_remoteAddress, login, &delay))
+		{
+			*serverBusy = false;
+			*retryAfter = ToRetryDelay(delay);
+			return false;
+		}
+
+		PasswordHasher& passwordHasher = m_app->GetPasswordHasher();
+		if (passwordHasher.IsSaturated())
+		{
+			*serverBusy = true;
+			*retryAfter = ToRetryDelay(passwordHasher.EstimateQueueDelay());
+			return false;
+		}
+
+		return true;
+	}
+
+	void ClientSession::FlushBundles()
+	{
+		for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			FlushBundle(static_cast<Nz::UInt8>(channelId));
+	}
+
+	void ClientSession::FlushBundle(Nz::UInt8 channelId)
+	{
+		PacketBundle& bundle = m_bundles[channelId];
+		if (bundle.IsEmpty())
+			return;
+
+		std::size_t messageCount = bundle.GetMessageCount();
+
+		Nz::NetPacket packet;
+		bundle.Flush(packet);
+
+		SendData(channelId, m_bundleFlags[channelId], std::move(packet), messageCount);
 	}
 
 	void ClientSession::HandleControlEntity(const Packets::ControlEntity& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (Arena* arena = player->GetArena())
@@ -41,14 +117,14 @@ namespace ewn
 				Ndk::EntityId entityId = static_cast<Ndk::EntityId>(data.id);
 				if (!arena->IsEntityIdValid(entityId))
 				{
-					std::cerr << "Client #" << m_peerId << " tried to control invalid entity #" << entityId << std::endl;
+					LogError(LogCategory::Player) << "Client #" << m_peerId << " tried to control invalid entity #" << entityId;
 					return;
 				}
 
 				const Ndk::EntityHandle& entity = arena->GetEntity(entityId);
 				if (!entity->HasComponent<OwnerComponent>() || entity->GetComponent<OwnerComponent>().GetOwner() != player)
 				{
-					std::cerr << "Client #" << m_peerId << " tried to control entity #" << entityId << " which doesn't belong to them" << std::endl;
+					LogError(LogCategory::Player) << "Client #" << m_peerId << " tried to control entity #" << entityId << " which doesn't belong to them";
 					return;
 				}
 
@@ -62,7 +138,7 @@ namespace ewn
 	void ClientSession::HandleCreateFleet(const Packets::CreateFleet& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.fleetName.empty())
@@ -104,7 +180,7 @@ namespace ewn
 
 			if (!success)
 			{
-				std::cerr << "Fleet creation id first pass failed: " << results.back().GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Fleet creation id first pass failed: " << results.back().GetLastErrorMessage();
 
 				Packets::CreateFleetFailure fleetFailure;
 				fleetFailure.reason = CreateFleetFailureReason::ServerError;
@@ -183,7 +259,7 @@ namespace ewn
 	void ClientSession::HandleCreateSpaceship(const Packets::CreateSpaceship& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.spaceshipName.empty())
@@ -253,10 +329,24 @@ namespace ewn
 		});
 	}
 
+	void ClientSession::HandleDeclareCachedPackets(const Packets::DeclareCachedPackets& data)
+	{
+		for (const auto& cachedPacket : data.packets)
+		{
+			// Unknown packet types are ignored, they may come from a more recent client
+			std::size_t packetId = static_cast<std::size_t>(cachedPacket.packetType);
+			if (packetId < m_cachedPacketVersions.size())
+				m_cachedPacketVersions[packetId] = cachedPacket.version;
+		}
+
+		// This is the first packet sent by the client, networked strings are needed before anything else
+		SendCachedPacket(m_app->GetNetworkStringsPacket());
+	}
+
 	void ClientSession::HandleDeleteFleet(const Packets::DeleteFleet& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		Fleet_Delete fleetDeletion;
@@ -285,7 +375,7 @@ namespace ewn
 	void ClientSession::HandleDeleteSpaceship(const Packets::DeleteSpaceship & data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		Nz::Int32 playerDatabaseId = Nz::Int32(player->GetDatabaseId());
@@ -322,7 +412,7 @@ namespace ewn
 				if (queryResults.size() < 4)
 					return;
 
-				std::cerr << "Delete spaceship transaction failed: " << queryResults.back().GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Delete spaceship transaction failed: " << queryResults.back().GetLastErrorMessage();
 
 				Player* ply = app->GetPlayerBySession(sessionId);
 				if (!ply)
@@ -356,6 +446,7 @@ namespace ewn
 		});
 	}
 
+	// Called from the main thread once the player has proven its identity (password or token)
 	void ClientSession::HandleLoginSucceeded(Nz::Int32 databaseId, bool regenerateToken)
 	{
 		// Generate connection token
@@ -367,69 +458,56 @@ namespace ewn
 			token.resize(64);
 			if (!gen(token.data(), token.size()))
 			{
-				std::cerr << "SecureRandomGenerator failed" << std::endl;
+				LogError(LogCategory::Server) << "SecureRandomGenerator failed";
 				token.clear();
 			}
 		}
 
-		m_app->RegisterCallback([app = m_app, sessionId = GetSessionId(), databaseId, connectionToken = std::move(token)]()
+		GetPlayer()->Authenticate(databaseId, [app = m_app, playerToken = std::move(token)](Player* player, bool loginSuccess)
 		{
-			Player* ply = app->GetPlayerBySession(sessionId);
-			if (!ply)
+			if (!loginSuccess)
+			{
+				LogError(LogCategory::Player) << "Failed to authenticate player #" << player->GetSession()->GetPeerId() << ": Database authentication failed";
+
+				Packets::LoginFailure loginFailure;
+				loginFailure.reason = LoginFailureReason::ServerError;
+
+				player->SendPacket(loginFailure);
 				return;
+			}
 
-			ply->Authenticate(databaseId, [app, playerToken = std::move(connectionToken)](Player* player, bool loginSuccess)
+			if (playerToken.empty())
 			{
-				if (loginSuccess)
-				{
-					if (!playerToken.empty())
-					{
-						std::string tokenAsString(128, ' ');
-						for (std::size_t i = 0; i < playerToken.size(); ++i)
-							std::sprintf(&tokenAsString[i * 2], "%02x", playerToken[i]);
+				player->SendPacket(Packets::LoginSuccess());
+				LogInfo(LogCategory::Player) << "Player #" << player->GetSession()->GetPeerId() << " authenticated as " << player->GetName();
+				return;
+			}
 
-						DatabaseTransaction dbTransaction;
-						dbTransaction.AppendPreparedStatement("DeleteAccountTokenByAccountId", { player->GetDatabaseId() });
-						dbTransaction.AppendPreparedStatement("CreateAccountToken", { player->GetDatabaseId(), tokenAsString });
+			std::string tokenAsString(128, ' ');
+			for (std::size_t i = 0; i < playerToken.size(); ++i)
+				std::sprintf(&tokenAsString[i * 2], "%02x", playerToken[i]);
 
-						app->GetGlobalDatabase().ExecuteTransaction(std::move(dbTransaction), [app, packetToken = std::move(playerToken), sessionId = player->GetSessionId()](bool transactionSucceeded, std::vector<DatabaseResult>& queryResults)
-						{
-							Player* player = app->GetPlayerBySession(sessionId);
-							if (!player)
-								return;
-
-							if (transactionSucceeded)
-							{
-								Packets::LoginSuccess loginSuccess;
-								loginSuccess.connectionToken = std::move(packetToken);
-
-								player->SendPacket(loginSuccess);
-								std::cout << "Player #" << player->GetSession()->GetPeerId() << " authenticated as " << player->GetName() << " and regenerated a connection token" << std::endl;
-							}
-							else
-							{
-								std::cout << "Failed to save token: " << queryResults.back().GetLastErrorMessage() << std::endl;
-								player->SendPacket(Packets::LoginSuccess());
-								std::cout << "Player #" << player->GetSession()->GetPeerId() << " authenticated as " << player->GetName() << std::endl;
-							}
-						});
-					}
-					else
-					{
-						player->SendPacket(Packets::LoginSuccess());
-						std::cout << "Player #" << player->GetSession()->GetPeerId() << " authenticated as " << player->GetName() << std::endl;
-					}
-				}
-				else
-				{
-					std::cerr << "Failed to authenticate player #" << player->GetSession()->GetPeerId() << ": Database authentication failed" << std::endl;
+			// The cache makes the token usable right away, the database is updated in the background
+			app->GetAccountCache().StoreToken(player->GetDatabaseId(), tokenAsString, app->GetAppTime());
 
-					Packets::LoginFailure loginFailure;
-					loginFailure.reason = LoginFailureReason::ServerError;
+			DatabaseTransaction dbTransaction;
+			dbTransaction.AppendPreparedStatement("DeleteAccountTokenByAccountId", { player->GetDatabaseId() });
+			dbTransaction.AppendPreparedStatement("CreateAccountToken", { player->GetDatabaseId(), tokenAsString });
 
-					player->SendPacket(loginFailure);
+			app->GetGlobalDatabase().ExecuteTransaction(std::move(dbTransaction), [app, token = tokenAsString](bool transactionSucceeded, std::vector<DatabaseResult>& queryResults)
+			{
+				if (!transactionSucceeded)
+				{
+					LogError(LogCategory::Database) << "Failed to save token: " << queryResults.back().GetLastErrorMessage();
+					app->GetAccountCache().RemoveToken(token);
 				}
 			});
+
+			Packets::LoginSuccess loginSuccess;
+			loginSuccess.connectionToken = std::move(playerToken);
+
+			player->SendPacket(loginSuccess);
+			LogInfo(LogCategory::Player) << "Player #" << player->GetSession()->GetPeerId() << " authenticated as " << player->GetName() << " and regenerated a connection token";
 		});
 	}
 
@@ -442,6 +520,18 @@ namespace ewn
 		if (data.login.empty() || data.login.size() > 20)
 			return;
 
+		bool serverBusy;
+		Nz::UInt32 retryAfter;
+		if (!CheckHashingAdmission(data.login, &serverBusy, &retryAfter))
+		{
+			Packets::LoginFailure loginFailure;
+			loginFailure.reason = (serverBusy) ? LoginFailureReason::ServerBusy : LoginFailureReason::TooManyAttempts;
+			loginFailure.retryAfter = retryAfter;
+
+			player->SendPacket(loginFailure);
+			return;
+		}
+
 		Accounts_QueryConnectionInfoByLogin request;
 		request.login = data.login;
 
@@ -463,7 +553,7 @@ namespace ewn
 
 			if (result.GetRowCount() == 0)
 			{
-				std::cout << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: player not found" << std::endl;
+				LogInfo(LogCategory::Player) << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: player not found";
 
 				Packets::LoginFailure loginFailure;
 				loginFailure.reason = LoginFailureReason::AccountNotFound;
@@ -474,50 +564,24 @@ namespace ewn
 
 			assert(result.GetRowCount() == 1);
 
-			ConfigFile& config = app->GetConfig();
-			const std::string& globalSalt = config.GetStringOption("Security.PasswordSalt");
+			const std::string& globalSalt = app->GetConfig().GetStringOption("Security.PasswordSalt");
 
 			Accounts_QueryConnectionInfoByLogin::Result dbResult(result);
 
-			int iCost = config.GetIntegerOption<int>("Security.Argon2.IterationCost");
-			int mCost = config.GetIntegerOption<int>("Security.Argon2.MemoryCost");
-			int tCost = config.GetIntegerOption<int>("Security.Argon2.ThreadCost");
-			int hashLength = config.GetIntegerOption<int>("Security.HashLength");
+			PasswordHasher& passwordHasher = app->GetPasswordHasher();
 
-			app->DispatchWork([app, salt = globalSalt + dbResult.salt, pass = std::move(pwd), dbPass = dbResult.password, id = dbResult.id, sessionId, login, iCost, mCost, tCost, hashLength, needToken]()
+			bool queued = passwordHasher.Hash(std::move(pwd), globalSalt + dbResult.salt, [app, dbPass = dbResult.password, id = dbResult.id, sessionId, login, needToken](int argon2Result, std::string hash)
 			{
-				Nz::StackArray<uint8_t> output = NazaraStackArrayNoInit(uint8_t, hashLength);
-				Nz::StackArray<char> outputHex = NazaraStackArrayNoInit(char, hashLength * 2 + 1);
-
-				argon2_context context;
-				std::memset(&context, 0, sizeof(argon2_context));
-
-				context.out = output.data();
-				context.outlen = uint32_t(hashLength);
-				context.pwd = reinterpret_cast<uint8_t*>(const_cast<char*>(pass.data()));
-				context.pwdlen = uint32_t(pass.size());
-				context.salt = reinterpret_cast<uint8_t*>(const_cast<char*>(salt.data()));
-				context.saltlen = uint32_t(salt.size());
-				context.t_cost = iCost;
-				context.m_cost = mCost;
-				context.lanes = tCost;
-				context.threads = tCost;
-				context.flags = ARGON2_DEFAULT_FLAGS;
-				context.version = ARGON2_VERSION_13;
-
+				// Called from a hashing thread
 				std::optional<LoginFailureReason> failure;
-				int argon2Ret = argon2_ctx(&context, argon2_type::Argon2_id);
-				if (argon2Ret == ARGON2_OK)
+				if (argon2Result == ARGON2_OK)
 				{
-					for (std::size_t i = 0; i < output.size(); ++i)
-						std::sprintf(&outputHex[i * 2], "%02x", output[i]);
-
 					// Protect against timing-attack
-					assert(dbPass.size() == outputHex.size() - 1);
+					assert(dbPass.size() == hash.size());
 
-					int isDifferent = 0;
-					for (std::size_t i = 0; i < dbPass.size(); ++i)
-						isDifferent |= (outputHex[i] ^ dbPass[i]);
+					int isDifferent = (dbPass.size() != hash.size()) ? 1 : 0;
+					for (std::size_t i = 0; i < std::min(dbPass.size(), hash.size()); ++i)
+						isDifferent |= (hash[i] ^ dbPass[i]);
 
 					if (isDifferent)
 						failure = LoginFailureReason::PasswordMismatch;
@@ -525,45 +589,49 @@ namespace ewn
 				else
 					failure = LoginFailureReason::ServerError;
 
-				if (!failure)
+				app->RegisterCallback([app, sessionId, id, login, needToken, failure, argon2Result]()
 				{
 					Player* ply = app->GetPlayerBySession(sessionId);
 					if (!ply)
 						return;
 
-					ply->GetSession()->HandleLoginSucceeded(id, needToken);
-				}
-				else
-				{
-					app->RegisterCallback([app, sessionId, login, reason = failure.value(), argon2Ret]()
+					if (!failure)
 					{
-						Player* ply = app->GetPlayerBySession(sessionId);
-						if (!ply)
-							return;
+						ply->GetSession()->HandleLoginSucceeded(id, needToken);
+						return;
+					}
 
-						Packets::LoginFailure loginFailure;
-						loginFailure.reason = reason;
+					Packets::LoginFailure loginFailure;
+					loginFailure.reason = failure.value();
 
-						ply->SendPacket(loginFailure);
+					ply->SendPacket(loginFailure);
 
-						switch (reason)
-						{
-							case LoginFailureReason::PasswordMismatch:
-								std::cout << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: password mismatch" << std::endl;
-								break;
-
-							case LoginFailureReason::ServerError:
-								std::cout << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: argon2 failure (err: " << argon2Ret << ")" << std::endl;
-								break;
-
-							case LoginFailureReason::AccountNotFound:
-							default:
-								assert(false);
-								break;
-						}
-					});
-				}
+					switch (loginFailure.reason)
+					{
+						case LoginFailureReason::PasswordMismatch:
+							LogInfo(LogCategory::Player) << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: password mismatch";
+							break;
+
+						case LoginFailureReason::ServerError:
+							LogInfo(LogCategory::Player) << "Player #" << ply->GetSession()->GetPeerId() << " authentication as " << login << " failed: argon2 failure (err: " << argon2Result << ")";
+							break;
+
+						default:
+							assert(false);
+							break;
+					}
+				});
 			});
+
+			if (!queued)
+			{
+				// The queue filled up while the account was being queried
+				Packets::LoginFailure loginFailure;
+				loginFailure.reason = LoginFailureReason::ServerBusy;
+				loginFailure.retryAfter = ToRetryDelay(passwordHasher.EstimateQueueDelay());
+
+				ply->SendPacket(loginFailure);
+			}
 		});
 	}
 
@@ -580,6 +648,24 @@ namespace ewn
 		for (std::size_t i = 0; i < data.connectionToken.size(); ++i)
 			std::sprintf(&tokenAsString[i * 2], "%02x", data.connectionToken[i]);
 
+		AccountCache& accountCache = m_app->GetAccountCache();
+
+		Nz::Int32 cachedAccountId;
+		if (accountCache.FindAccountByToken(tokenAsString, m_app->GetAppTime(), &cachedAccountId))
+		{
+			// Tokens are single-use, the database copy is deleted in the background
+			accountCache.RemoveToken(tokenAsString);
+
+			m_app->GetGlobalDatabase().ExecuteStatement("DeleteAccountToken", { tokenAsString }, [](DatabaseResult& result)
+			{
+				if (!result.IsValid())
+					LogError(LogCategory::Database) << "Failed to delete used token: " << result.GetLastErrorMessage();
+			});
+
+			HandleLoginSucceeded(cachedAccountId, data.generateConnectionToken);
+			return;
+		}
+
 		DatabaseTransaction trans;
 		trans.AppendPreparedStatement("FindAccountByToken", { tokenAsString }, [](DatabaseTransaction& transaction, DatabaseResult result) -> DatabaseResult
 		{
@@ -604,7 +690,7 @@ namespace ewn
 
 			if (!transactionSucceeded || queryResults[accountResultId].GetRowCount() == 0)
 			{
-				std::cout << "Player #" << ply->GetSession()->GetPeerId() << " authentication via token failed" << std::endl;
+				LogInfo(LogCategory::Player) << "Player #" << ply->GetSession()->GetPeerId() << " authentication via token failed";
 
 				Packets::LoginFailure loginFailure;
 				loginFailure.reason = LoginFailureReason::InvalidToken;
@@ -645,7 +731,7 @@ namespace ewn
 	void ClientSession::HandlePlayerChat(const Packets::PlayerChat& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.text.empty())
@@ -673,16 +759,27 @@ namespace ewn
 	void ClientSession::HandlePlayerMovement(const Packets::PlayerMovement& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
-		player->UpdateInput(data.inputTime, data.direction, data.rotation);
+		MovementInputHistory::DecodedInputs inputs;
+		std::size_t inputCount = MovementInputHistory::DecodePacket(data, &inputs);
+
+		// Only the most recent input is sent for the first time, the others are new only if the packet carrying them was lost
+		for (std::size_t i = 0; i < inputCount; ++i)
+		{
+			const MovementInputHistory::Input& input = inputs[i];
+
+			bool isNewInput = player->UpdateInput(input.inputTime, input.direction, input.rotation);
+			if (i + 1 < inputCount)
+				((isNewInput) ? m_gapFilledInputs : m_duplicateInputs)->Increment();
+		}
 	}
 
 	void ClientSession::HandlePlayerShoot(const Packets::PlayerShoot& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		player->Shoot();
@@ -711,7 +808,7 @@ namespace ewn
 	void ClientSession::HandleQueryFleetInfo(const Packets::QueryFleetInfo& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		player->GetFleetData(data.fleetName, [app = m_app, infoFlags = data.spaceshipInfo, sessionId = GetSessionId()](bool found, const Player::FleetData& fleet)
@@ -782,7 +879,7 @@ namespace ewn
 	void ClientSession::HandleQueryFleetList(const Packets::QueryFleetList& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		m_app->GetGlobalDatabase().ExecuteStatement("FindFleetsByOwnerId", { player->GetDatabaseId() }, [app = m_app, sessionId = GetSessionId()](DatabaseResult& result)
@@ -795,7 +892,7 @@ namespace ewn
 
 			if (!result)
 			{
-				std::cerr << "FindFleetsByOwnerId failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "FindFleetsByOwnerId failed: " << result.GetLastErrorMessage();
 				ply->SendPacket(fleetList);
 				return;
 			}
@@ -814,7 +911,7 @@ namespace ewn
 	void ClientSession::HandleQueryHullList(const Packets::QueryHullList& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		auto& spaceshipHullStore = m_app->GetSpaceshipHullStore();
@@ -852,7 +949,7 @@ namespace ewn
 	void ClientSession::HandleQueryModuleList(const Packets::QueryModuleList& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		auto& moduleStore = m_app->GetModuleStore();
@@ -891,7 +988,7 @@ namespace ewn
 	void ClientSession::HandleQuerySpaceshipInfo(const Packets::QuerySpaceshipInfo& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.spaceshipName.empty())
@@ -906,7 +1003,7 @@ namespace ewn
 
 			if (!result)
 			{
-				std::cerr << "FindSpaceshipByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "FindSpaceshipByOwnerIdAndName failed: " << result.GetLastErrorMessage();
 
 				ply->SendPacket(Packets::SpaceshipInfo());
 				return;
@@ -997,7 +1094,7 @@ namespace ewn
 	void ClientSession::HandleQuerySpaceshipList(const Packets::QuerySpaceshipList& /*data*/)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		m_app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipsByOwnerId", { Nz::Int32(player->GetDatabaseId()) }, [app = m_app, sessionId = player->GetSessionId()](DatabaseResult& result)
@@ -1046,7 +1143,7 @@ namespace ewn
 			}
 			else
 			{
-				std::cerr << "FindSpaceshipsByOwnerId failed:" << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "FindSpaceshipsByOwnerId failed:" << result.GetLastErrorMessage();
 				ply->SendPacket(Packets::SpaceshipList{});
 			}
 		});
@@ -1071,13 +1168,26 @@ namespace ewn
 		if (!std::regex_match(data.email, emailPattern))
 			return;
 
+		// Accounts don't exist yet, only the address limit applies
+		bool serverBusy;
+		Nz::UInt32 retryAfter;
+		if (!CheckHashingAdmission(std::string(), &serverBusy, &retryAfter))
+		{
+			Packets::RegisterFailure registerFailure;
+			registerFailure.reason = (serverBusy) ? RegisterFailureReason::ServerBusy : RegisterFailureReason::TooManyAttempts;
+			registerFailure.retryAfter = retryAfter;
+
+			player->SendPacket(registerFailure);
+			return;
+		}
+
 		// Generate salt
 		SecureRandomGenerator gen;
 
 		Nz::ByteArray saltBuff(32, 0);
 		if (!gen(saltBuff.GetBuffer(), saltBuff.GetSize()))
 		{
-			std::cerr << "SecureRandomGenerator failed" << std::endl;
+			LogError(LogCategory::Server) << "SecureRandomGenerator failed";
 
 			Packets::RegisterFailure registerFailure;
 			registerFailure.reason = RegisterFailureReason::ServerError;
@@ -1086,50 +1196,20 @@ namespace ewn
 			return;
 		}
 
-		ConfigFile& config = m_app->GetConfig();
-
 		// Salt password and hash it again
-		const std::string& globalSalt = config.GetStringOption("Security.PasswordSalt");
+		const std::string& globalSalt = m_app->GetConfig().GetStringOption("Security.PasswordSalt");
 
 		Nz::String userSalt = saltBuff.ToHex();
 		Nz::String salt = globalSalt + userSalt;
 
-		int iCost = config.GetIntegerOption<int>("Security.Argon2.IterationCost");
-		int mCost = config.GetIntegerOption<int>("Security.Argon2.MemoryCost");
-		int tCost = config.GetIntegerOption<int>("Security.Argon2.ThreadCost");
-		int hashLength = config.GetIntegerOption<int>("Security.HashLength");
+		PasswordHasher& passwordHasher = m_app->GetPasswordHasher();
 
-		m_app->DispatchWork([app = m_app, sessionId = player->GetSessionId(), s = std::move(salt), uSalt = std::move(userSalt), data, iCost, mCost, tCost, hashLength]()
+		bool queued = passwordHasher.Hash(data.passwordHash, salt.ToStdString(), [app = m_app, sessionId = player->GetSessionId(), uSalt = std::move(userSalt), data](int argon2Result, std::string hash)
 		{
-			Nz::StackArray<uint8_t> output = NazaraStackArrayNoInit(uint8_t, hashLength);
-
-			argon2_context context;
-			std::memset(&context, 0, sizeof(argon2_context));
-
-			context.out = output.data();
-			context.outlen = uint32_t(hashLength);
-			context.pwd = reinterpret_cast<uint8_t*>(const_cast<char*>(data.passwordHash.data()));
-			context.pwdlen = uint32_t(data.passwordHash.size());
-			context.salt = reinterpret_cast<uint8_t*>(const_cast<char*>(s.GetConstBuffer()));
-			context.saltlen = uint32_t(s.GetSize());
-			context.t_cost = iCost;
-			context.m_cost = mCost;
-			context.lanes = tCost;
-			context.threads = tCost;
-			context.flags = ARGON2_DEFAULT_FLAGS;
-			context.version = ARGON2_VERSION_13;
-
-			std::optional<LoginFailureReason> failure;
-			if (argon2_ctx(&context, argon2_type::Argon2_id) == ARGON2_OK)
+			// Called from a hashing thread
+			if (argon2Result == ARGON2_OK)
 			{
-				std::string outputHex(hashLength * 2 + 1, '\0');
-
-				for (std::size_t i = 0; i < output.size(); ++i)
-					std::sprintf(&outputHex[i * 2], "%02x", output[i]);
-
-				outputHex.resize(hashLength * 2);
-
-				app->GetGlobalDatabase().ExecuteStatement("RegisterAccount", { data.login, std::move(outputHex), uSalt.ToStdString(), data.email },
+				app->GetGlobalDatabase().ExecuteStatement("RegisterAccount", { data.login, std::move(hash), uSalt.ToStdString(), data.email },
 				[app, sessionId, login = data.login](DatabaseResult& result)
 				{
 					Player* ply = app->GetPlayerBySession(sessionId);
@@ -1138,7 +1218,7 @@ namespace ewn
 
 					if (!result.IsValid())
 					{
-						std::cerr << "RegisterAccount failed: " << result.GetLastErrorMessage() << std::endl;
+						LogError(LogCategory::Database) << "RegisterAccount failed: " << result.GetLastErrorMessage();
 
 						Packets::RegisterFailure loginFailure;
 						loginFailure.reason = RegisterFailureReason::LoginAlreadyTaken;
@@ -1149,7 +1229,7 @@ namespace ewn
 
 					ply->SendPacket(Packets::RegisterSuccess());
 
-					std::cout << "Player #" << ply->GetSession()->GetPeerId() << " registered as " << login << std::endl;
+					LogInfo(LogCategory::Player) << "Player #" << ply->GetSession()->GetPeerId() << " registered as " << login;
 				});
 			}
 			else
@@ -1167,6 +1247,52 @@ namespace ewn
 				});
 			}
 		});
+
+		if (!queued)
+		{
+			Packets::RegisterFailure registerFailure;
+			registerFailure.reason = RegisterFailureReason::ServerBusy;
+			registerFailure.retryAfter = ToRetryDelay(passwordHasher.EstimateQueueDelay());
+
+			player->SendPacket(registerFailure);
+		}
+	}
+
+	void ClientSession::HandleRelayLogin(const Packets::RelayLogin& data)
+	{
+		Player* player = GetPlayer();
+		if (player->IsAuthenticated())
+			return;
+
+		// Same limit as logins, guessing the relay secret is as slow as guessing a password
+		Nz::UInt64 delay;
+		if (!m_app->ConsumeLoginAttempt(m_remoteAddress, std::string(), &delay))
+		{
+			Packets::LoginFailure loginFailure;
+			loginFailure.reason = LoginFailureReason::TooManyAttempts;
+			loginFailure.retryAfter = ToRetryDelay(delay);
+
+			player->SendPacket(loginFailure);
+			return;
+		}
+
+		const std::string& relaySecret = m_app->GetConfig().GetStringOption("Relay.Secret");
+		if (relaySecret.empty() || !CompareSecrets(relaySecret, data.secret))
+		{
+			LogWarning(LogCategory::Player) << "Player #" << m_peerId << " (" << m_remoteAddress.ToString().ToStdString() << ") failed to authenticate as a relay";
+
+			Packets::LoginFailure loginFailure;
+			loginFailure.reason = LoginFailureReason::PasswordMismatch;
+
+			player->SendPacket(loginFailure);
+			return;
+		}
+
+		// Relays are only allowed to spectate (join/leave arenas, query them and synchronize their clock), other handlers ignore them
+		player->AuthenticateAsRelay();
+		player->SendPacket(Packets::LoginSuccess());
+
+		LogInfo(LogCategory::Player) << "Player #" << m_peerId << " (" << m_remoteAddress.ToString().ToStdString() << ") authenticated as a relay";
 	}
 
 	void ClientSession::HandleTimeSyncRequest(const Packets::TimeSyncRequest& data)
@@ -1185,7 +1311,7 @@ namespace ewn
 	void ClientSession::HandleUpdateFleet(const Packets::UpdateFleet& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.fleetName.empty())
@@ -1227,7 +1353,7 @@ namespace ewn
 
 			if (!success)
 			{
-				std::cerr << "Fleet creation id first pass failed: " << results.back().GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Fleet creation id first pass failed: " << results.back().GetLastErrorMessage();
 
 				Packets::UpdateFleetFailure fleetFailure;
 				fleetFailure.reason = UpdateFleetFailureReason::ServerError;
@@ -1316,7 +1442,7 @@ namespace ewn
 	void ClientSession::HandleUpdateSpaceship(const Packets::UpdateSpaceship& data)
 	{
 		Player* player = GetPlayer();
-		if (!player->IsAuthenticated())
+		if (!player->IsAuthenticated() || player->IsRelay())
 			return;
 
 		if (data.spaceshipName.empty() || data.spaceshipName.size() > 64)
@@ -1343,7 +1469,7 @@ namespace ewn
 		{
 			if (!result)
 			{
-				std::cerr << "FindSpaceshipIdByOwnerIdAndName failed: " << result.GetLastErrorMessage();
+				LogError(LogCategory::Database) << "FindSpaceshipIdByOwnerIdAndName failed: " << result.GetLastErrorMessage();
 
 				if (Player* ply = app->GetPlayerBySession(sessionId))
 				{
@@ -1403,7 +1529,7 @@ namespace ewn
 
 				if (!transactionSucceeded)
 				{
-					std::cerr << "Update spaceship transaction failed: " << queryResults.back().GetLastErrorMessage() << std::endl;
+					LogError(LogCategory::Database) << "Update spaceship transaction failed: " << queryResults.back().GetLastErrorMessage();
 
 					Packets::UpdateSpaceshipFailure response;
 					response.reason = UpdateSpaceshipFailureReason::ServerError;
@@ -1417,4 +1543,10 @@ namespace ewn
 		});
 	}
 
+	void ClientSession::SendData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet, std::size_t messageCount)
+	{
+		m_sentMessages[channelId]->Increment(messageCount);
+
+		m_networkReactor.SendData(m_peerId, channelId, flags, std::move(packet));
+	}
 }
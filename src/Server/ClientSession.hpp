@@ -7,8 +7,13 @@
 #ifndef EREWHON_SERVER_CLIENTSESSION_HPP
 #define EREWHON_SERVER_CLIENTSESSION_HPP
 
+#include <Shared/Config.hpp>
 #include <Shared/NetworkReactor.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/PacketBundle.hpp>
+#include <Server/MetricsRegistry.hpp>
 #include <Server/ServerCommandStore.hpp>
+#include <array>
 
 namespace ewn
 {
@@ -21,22 +26,32 @@ namespace ewn
 		friend class ServerCommandStore;
 
 		public:
-			ClientSession(ServerApplication* app, std::size_t sessionId, std::size_t peerId, std::shared_ptr<Player> player, NetworkReactor& reactor, const ServerCommandStore& commandStore);
+			ClientSession(ServerApplication* app, Nz::UInt64 sessionId, std::size_t peerId, Nz::IpAddress remoteAddress, std::shared_ptr<Player> player, NetworkReactor& reactor, const ServerCommandStore& commandStore);
 			~ClientSession() = default;
 
 			inline void Disconnect(Nz::UInt32 data = 0);
 
+			void FlushBundles();
+
 			inline std::size_t GetPeerId() const;
 			inline Player* GetPlayer();
 			inline const Player* GetPlayer() const;
-			inline std::size_t GetSessionId() const;
+			inline const Nz::IpAddress& GetRemoteAddress() const;
+			inline Nz::UInt64 GetSessionId() const;
 
-			template<typename T> void SendPacket(const T& packet);
+			template<typename T> std::size_t SendCachedPacket(const CachedPacket<T>& packet);
+			template<typename T> std::size_t SendPacket(const T& packet);
+			template<typename T> std::size_t SendPacket(const CachedPacket<T>& packet);
 
 		private:
+			bool CheckHashingAdmission(const std::string& login, bool* serverBusy, Nz::UInt32* retryAfter);
+
+			void FlushBundle(Nz::UInt8 channelId);
+
 			void HandleControlEntity(const Packets::ControlEntity& data);
 			void HandleCreateFleet(const Packets::CreateFleet& data);
 			void HandleCreateSpaceship(const Packets::CreateSpaceship& data);
+			void HandleDeclareCachedPackets(const Packets::DeclareCachedPackets& data);
 			void HandleDeleteFleet(const Packets::DeleteFleet& data);
 			void HandleDeleteSpaceship(const Packets::DeleteSpaceship& data);
 			void HandleLogin(const Packets::Login& data);
@@ -55,13 +70,24 @@ namespace ewn
 			void HandleQuerySpaceshipInfo(const Packets::QuerySpaceshipInfo& data);
 			void HandleQuerySpaceshipList(const Packets::QuerySpaceshipList& data);
 			void HandleRegister(const Packets::Register& data);
+			void HandleRelayLogin(const Packets::RelayLogin& data);
 			void HandleTimeSyncRequest(const Packets::TimeSyncRequest& data);
 			void HandleUpdateFleet(const Packets::UpdateFleet& data);
 			void HandleUpdateSpaceship(const Packets::UpdateSpaceship& data);
 
+			void SendData(Nz::UInt8 channelId, Nz::ENetPacketFlags flags, Nz::NetPacket&& packet, std::size_t messageCount);
+			template<typename T, typename D> std::size_t QueuePacket(const D& packet);
+
+			std::array<Nz::UInt32, PacketTypeCount> m_cachedPacketVersions; //< versions held by the client
+			std::array<MetricsRegistry::Counter*, NetworkChannelCount> m_sentMessages;
+			MetricsRegistry::Counter* m_duplicateInputs;
+			MetricsRegistry::Counter* m_gapFilledInputs;
+			std::array<Nz::ENetPacketFlags, NetworkChannelCount> m_bundleFlags;
+			std::array<PacketBundle, NetworkChannelCount> m_bundles;
 			std::shared_ptr<Player> m_player;
 			std::size_t m_peerId;
-			std::size_t m_sessionId;
+			Nz::IpAddress m_remoteAddress;
+			Nz::UInt64 m_sessionId;
 			ServerApplication* m_app;
 			NetworkReactor& m_networkReactor;
 			const ServerCommandStore& m_commandStore;
@@ -11,6 +11,9 @@ namespace ewn
 {
 	inline void ClientSession::Disconnect(Nz::UInt32 data)
 	{
+		// Pending messages (such as a kick reason) are sent before the disconnection
+		FlushBundles();
+
 		m_networkReactor.DisconnectPeer(m_peerId, data);
 	}
 
@@ -29,19 +32,79 @@ namespace ewn
 		return m_player.get();
 	}
 
-	inline std::size_t ClientSession::GetSessionId() const
+	inline const Nz::IpAddress& ClientSession::GetRemoteAddress() const
+	{
+		return m_remoteAddress;
+	}
+
+	inline Nz::UInt64 ClientSession::GetSessionId() const
 	{
 		return m_sessionId;
 	}
 
+	// The client keeps some packets across connections, those are only sent again if their content changed
+	template<typename T>
+	std::size_t ClientSession::SendCachedPacket(const CachedPacket<T>& packet)
+	{
+		// The version has to be received right before the packet it describes
+		assert(m_commandStore.GetOutgoingCommand<T>().channelId == m_commandStore.GetOutgoingCommand<Packets::CachedPacketVersion>().channelId);
+		assert(m_commandStore.GetOutgoingCommand<T>().flags == m_commandStore.GetOutgoingCommand<Packets::CachedPacketVersion>().flags);
+
+		Nz::UInt32& clientVersion = m_cachedPacketVersions[static_cast<std::size_t>(T::Type)];
+
+		Packets::CachedPacketVersion versionPacket;
+		versionPacket.packetType = T::Type;
+		versionPacket.version = packet.GetVersion();
+		versionPacket.useCachedPacket = (clientVersion == packet.GetVersion());
+
+		std::size_t sentSize = SendPacket(versionPacket);
+		if (versionPacket.useCachedPacket)
+			return sentSize;
+
+		clientVersion = packet.GetVersion();
+
+		return sentSize + SendPacket(packet);
+	}
+
 	template<typename T>
-	void ClientSession::SendPacket(const T& packet)
+	std::size_t ClientSession::SendPacket(const T& packet)
+	{
+		return QueuePacket<T>(packet);
+	}
+
+	template<typename T>
+	std::size_t ClientSession::SendPacket(const CachedPacket<T>& packet)
+	{
+		return QueuePacket<T>(packet);
+	}
+
+	template<typename T, typename D>
+	std::size_t ClientSession::QueuePacket(const D& packet)
 	{
 		const auto& command = m_commandStore.GetOutgoingCommand<T>();
-		
+
+		// Messages are bundled until the end of the tick, a bundle only holds messages with the same flags to keep their order and reliability
+		PacketBundle& bundle = m_bundles[command.channelId];
+		if (!bundle.IsEmpty() && m_bundleFlags[command.channelId] != command.flags)
+			FlushBundle(command.channelId);
+
+		m_bundleFlags[command.channelId] = command.flags;
+
+		if (std::size_t messageSize = bundle.Append(packet); messageSize > 0)
+			return messageSize;
+
+		FlushBundle(command.channelId);
+
+		if (std::size_t messageSize = bundle.Append(packet); messageSize > 0)
+			return messageSize;
+
+		// Too big to be bundled
 		Nz::NetPacket data;
 		m_commandStore.SerializePacket(data, packet);
 
-		m_networkReactor.SendData(m_peerId, command.channelId, command.flags, std::move(data));
+		std::size_t packetSize = data.GetDataSize();
+		SendData(command.channelId, command.flags, std::move(data), 1);
+
+		return packetSize;
 	}
 }
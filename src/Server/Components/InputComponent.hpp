@@ -22,7 +22,7 @@ namespace ewn
 
 			template<typename F> void ProcessInputs(F inputFunc);
 
-			inline void PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation);
+			inline bool PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation);
 
 			static Ndk::ComponentIndex componentIndex;
 
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Components/InputComponent.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 
 namespace ewn
 {
@@ -29,9 +30,13 @@ namespace ewn
 		}
 	}
 
-	inline void InputComponent::PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
+	// Inputs are identified by their time, an input which isn't more recent than the last one was already pushed
+	inline bool InputComponent::PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
 	{
-		assert(inputTime > m_lastInputTime);
+		Nz::UInt64 lastInputTime = (!m_inputs.empty()) ? m_inputs.back().serverTime : m_lastInputTime;
+		if (inputTime <= lastInputTime)
+			return false;
+
 		assert(movement.x >= -1.f && movement.x <= 1.f);
 		assert(movement.y >= -1.f && movement.y <= 1.f);
 		assert(movement.z >= -1.f && movement.z <= 1.f);
@@ -41,9 +46,11 @@ namespace ewn
 
 		InputData inputData;
 		inputData.serverTime = inputTime;
-		inputData.direction = movement * 50.f;
-		inputData.rotation = rotation * 200.f;
+		inputData.direction = SpaceshipMovement::ScaleDirection(movement);
+		inputData.rotation = SpaceshipMovement::ScaleRotation(rotation);
 
 		m_inputs.emplace_back(std::move(inputData));
+
+		return true;
 	}
 }
@@ -20,6 +20,8 @@ namespace ewn
 
 			inline float GetRemainingDuration() const;
 
+			inline void SetRemainingDuration(float durationInSeconds);
+
 			static Ndk::ComponentIndex componentIndex;
 
 		private:
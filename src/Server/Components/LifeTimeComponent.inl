@@ -21,4 +21,9 @@ namespace ewn
 	{
 		return m_remainingDuration;
 	}
+
+	inline void LifeTimeComponent::SetRemainingDuration(float durationInSeconds)
+	{
+		m_remainingDuration = durationInSeconds;
+	}
 }
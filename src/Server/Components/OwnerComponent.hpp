@@ -19,6 +19,8 @@ namespace ewn
 
 			inline Player* GetOwner() const;
 
+			inline void SetOwner(Player* owner);
+
 			static Ndk::ComponentIndex componentIndex;
 
 		private:
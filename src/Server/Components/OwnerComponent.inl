@@ -15,4 +15,9 @@ namespace ewn
 	{
 		return m_owner;
 	}
+
+	inline void OwnerComponent::SetOwner(Player* owner)
+	{
+		m_owner.Reset(owner);
+	}
 }
@@ -0,0 +1,33 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_POOLEDCOMPONENT_HPP
+#define EREWHON_SERVER_POOLEDCOMPONENT_HPP
+
+#include <NDK/Component.hpp>
+#include <Server/EntityPool.hpp>
+
+namespace ewn
+{
+	class PooledComponent : public Ndk::Component<PooledComponent>
+	{
+		public:
+			inline PooledComponent(EntityPool& pool);
+
+			inline EntityPool& GetPool();
+
+			inline void ReturnToPool();
+
+			static Ndk::ComponentIndex componentIndex;
+
+		private:
+			EntityPool* m_pool;
+	};
+}
+
+#include <Server/Components/PooledComponent.inl>
+
+#endif // EREWHON_SERVER_POOLEDCOMPONENT_HPP
@@ -0,0 +1,23 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Components/PooledComponent.hpp>
+
+namespace ewn
+{
+	inline PooledComponent::PooledComponent(EntityPool& pool) :
+	m_pool(&pool)
+	{
+	}
+
+	inline EntityPool& PooledComponent::GetPool()
+	{
+		return *m_pool;
+	}
+
+	inline void PooledComponent::ReturnToPool()
+	{
+		m_pool->Release(GetEntity());
+	}
+}
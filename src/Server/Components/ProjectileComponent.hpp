@@ -17,6 +17,8 @@ namespace ewn
 		public:
 			inline ProjectileComponent(Nz::UInt16 damageValue);
 
+			inline void ClearHits();
+
 			inline Nz::UInt16 GetDamageValue() const;
 
 			inline bool HasBeenHit(Ndk::Entity* entity) const;
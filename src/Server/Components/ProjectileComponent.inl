@@ -11,6 +11,11 @@ namespace ewn
 	{
 	}
 
+	inline void ProjectileComponent::ClearHits()
+	{
+		m_hitEntities.Clear();
+	}
+
 	inline Nz::UInt16 ProjectileComponent::GetDamageValue() const
 	{
 		return m_damageValue;
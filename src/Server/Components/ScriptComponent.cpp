@@ -16,6 +16,7 @@
 #include <Server/Modules/RadarModule.hpp>
 #include <Server/Modules/WeaponModule.hpp>
 #include <Server/Store/ModuleStore.hpp>
+#include <Shared/Profiler.hpp>
 #include <iostream>
 
 namespace ewn
@@ -128,6 +129,8 @@ namespace ewn
 
 	bool ScriptComponent::Run(ServerApplication* app, float elapsedTime, Nz::String* lastError)
 	{
+		ProfileZone("ScriptComponent::Run");
+
 		assert(m_core);
 
 		if (!HasValidScript())
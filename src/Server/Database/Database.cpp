@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Database/Database.hpp>
+#include <Shared/Profiler.hpp>
 
 namespace ewn
 {
@@ -15,8 +16,19 @@ namespace ewn
 		return connection;
 	}
 
+	Nz::UInt64 Database::GetWorkerBusyTime() const
+	{
+		Nz::UInt64 busyTime = 0;
+		for (const auto& workerPtr : m_workers)
+			busyTime += workerPtr->GetBusyTime();
+
+		return busyTime;
+	}
+
 	void Database::Poll()
 	{
+		ProfileZone("Database::Poll");
+
 		Result result;
 		while (m_resultQueue.try_dequeue(result))
 			HandleResult(result);
@@ -19,6 +19,8 @@
 
 namespace ewn
 {
+	class MetricsRegistry;
+
 	template<typename T>
 	struct PreparedStatement
 	{
@@ -45,8 +47,16 @@ namespace ewn
 			inline void ExecuteStatement(std::string statement, std::vector<DatabaseValue> parameters, StatementCallback callback);
 			inline void ExecuteTransaction(DatabaseTransaction transaction, TransactionCallback callback);
 
+			inline MetricsRegistry* GetMetricsRegistry() const;
+			inline const std::string& GetName() const;
+			inline std::size_t GetPendingRequestCount() const;
+			Nz::UInt64 GetWorkerBusyTime() const;
+			inline std::size_t GetWorkerCount() const;
+
 			void Poll();
 
+			inline void SetMetricsRegistry(MetricsRegistry* registry);
+
 			void SpawnWorkers(std::size_t workerCount);
 
 			void WaitForCompletion();
@@ -94,6 +104,7 @@ namespace ewn
 			inline void HandleResult(Result& result);
 			inline void SubmitResult(Result&& result);
 
+			MetricsRegistry* m_metricsRegistry;
 			RequestQueue m_requestQueue;
 			ResultQueue m_resultQueue;
 			std::string m_name;
@@ -3,10 +3,12 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/Database/Database.hpp>
+#include <cassert>
 
 namespace ewn
 {
 	inline Database::Database(std::string name, std::string dbHost, Nz::UInt16 port, std::string dbUser, std::string dbPassword, std::string dbName) :
+	m_metricsRegistry(nullptr),
 	m_name(std::move(name)),
 	m_dbHostname(std::move(dbHost)),
 	m_dbPort(port),
@@ -47,6 +49,33 @@ namespace ewn
 		m_requestQueue.enqueue(std::move(newRequest));
 	}
 
+	inline MetricsRegistry* Database::GetMetricsRegistry() const
+	{
+		return m_metricsRegistry;
+	}
+
+	inline const std::string& Database::GetName() const
+	{
+		return m_name;
+	}
+
+	inline std::size_t Database::GetPendingRequestCount() const
+	{
+		return m_requestQueue.size_approx();
+	}
+
+	inline std::size_t Database::GetWorkerCount() const
+	{
+		return m_workers.size();
+	}
+
+	inline void Database::SetMetricsRegistry(MetricsRegistry* registry)
+	{
+		// Workers cache their metrics, the registry has to be set before they're started
+		assert(m_workers.empty());
+		m_metricsRegistry = registry;
+	}
+
 	template<typename T>
 	inline DatabaseResult Database::PrepareStatement(DatabaseConnection& connection)
 	{
@@ -5,8 +5,8 @@
 #include <Server/Database/DatabaseWorker.hpp>
 #include <Server/Database/Database.hpp>
 #include <Nazara/Core/Clock.hpp>
+#include <Shared/Logger.hpp>
 #include <chrono>
-#include <iostream>
 
 namespace ewn
 {
@@ -49,6 +49,20 @@ namespace ewn
 		}, transactionStatement.statement);
 	}
 
+	void DatabaseWorker::ReportLatency(const std::string& statementName, Nz::UInt64 duration)
+	{
+		MetricsRegistry* registry = m_database.GetMetricsRegistry();
+		if (!registry)
+			return;
+
+		// Only this thread uses the cache, this prevents locking the registry for every request
+		auto it = m_statementLatencies.find(statementName);
+		if (it == m_statementLatencies.end())
+			it = m_statementLatencies.emplace(statementName, &registry->GetHistogram("erewhon_database_statement_duration_seconds", "Time spent executing database statements, transactions included", { { "database", m_database.GetName() }, { "statement", statementName } })).first;
+
+		it->second->Observe(duration / 1'000'000.0);
+	}
+
 	void DatabaseWorker::WorkerThread()
 	{
 		DatabaseConnection connection = m_database.CreateConnection();
@@ -66,11 +80,9 @@ namespace ewn
 			if (!connection.IsConnected())
 			{
 				if (wasConnected)
-					std::cerr << "Lost connection to database";
+					LogError(LogCategory::Database) << "Lost connection to database, trying again in 10 seconds...";
 				else
-					std::cerr << "Failed to connect to database: " + connection.GetLastErrorMessage();
-
-				std::cerr << "\ntrying again in 10 seconds..." << std::endl;
+					LogError(LogCategory::Database) << "Failed to connect to database: " << connection.GetLastErrorMessage() << "\ntrying again in 10 seconds...";
 
 				wasConnected = false;
 
@@ -82,7 +94,7 @@ namespace ewn
 			}
 			else if (!wasConnected)
 			{
-				std::cout << "Connection retrieved" << std::endl;
+				LogInfo(LogCategory::Database) << "Connection retrieved";
 				wasConnected = true;
 			}
 
@@ -90,6 +102,8 @@ namespace ewn
 			{
 				m_idle.store(false, std::memory_order_release);
 
+				Nz::UInt64 requestStartTime = Nz::GetElapsedMicroseconds();
+
 				std::visit([&](auto&& request)
 				{
 					using T = std::decay_t<decltype(request)>;
@@ -101,7 +115,9 @@ namespace ewn
 						resultData.result = connection.ExecPreparedStatement(request.statement, request.parameters);
 
 						if (!resultData.result)
-							std::cerr << "[Database] statement \"" << request.statement << "\" failed: " << resultData.result.GetLastErrorMessage() << std::endl;
+							LogError(LogCategory::Database) << "Statement \"" << request.statement << "\" failed: " << resultData.result.GetLastErrorMessage();
+
+						ReportLatency(request.statement, Nz::GetElapsedMicroseconds() - requestStartTime);
 
 						m_database.SubmitResult(std::move(resultData));
 					}
@@ -121,14 +137,14 @@ namespace ewn
 
 								if (!statementResult)
 								{
-									std::cerr << "[Database] Transaction failed: " << statementResult.GetLastErrorMessage();
+									LogError(LogCategory::Database) << "Transaction failed: " << statementResult.GetLastErrorMessage();
 
 									failure = true;
 									if (connection.IsConnected())
 									{
 										DatabaseResult rollbackResult = connection.Exec("ROLLBACK");
 										if (!rollbackResult)
-											std::cerr << "[Database] Rollback failed: " << rollbackResult.GetLastErrorMessage();
+											LogError(LogCategory::Database) << "Rollback failed: " << rollbackResult.GetLastErrorMessage();
 									}
 									break;
 								}
@@ -142,6 +158,8 @@ namespace ewn
 							}
 						}
 
+						ReportLatency("transaction", Nz::GetElapsedMicroseconds() - requestStartTime);
+
 						m_database.SubmitResult(std::move(result));
 					}
 					else
@@ -149,6 +167,8 @@ namespace ewn
 
 				}, request);
 
+				m_busyTime.fetch_add(Nz::GetElapsedMicroseconds() - requestStartTime, std::memory_order_relaxed);
+
 				lastRequestTime = Nz::GetElapsedMilliseconds();
 			}
 			else
@@ -11,10 +11,12 @@
 #include <Nazara/Core/Thread.hpp>
 #include <Server/Database/DatabaseConnection.hpp>
 #include <Server/Database/DatabaseTransaction.hpp>
+#include <Server/MetricsRegistry.hpp>
 #include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <string>
+#include <unordered_map>
 
 namespace ewn
 {
@@ -28,6 +30,8 @@ namespace ewn
 			DatabaseWorker(DatabaseWorker&&) = delete;
 			inline ~DatabaseWorker();
 
+			inline Nz::UInt64 GetBusyTime() const;
+
 			void ResetIdle();
 
 			void WaitForIdle();
@@ -37,12 +41,15 @@ namespace ewn
 
 		private:
 			DatabaseResult HandleTransactionStatement(DatabaseConnection& connection, DatabaseTransaction& transaction, const DatabaseTransaction::Statement& transactionStatement);
+			void ReportLatency(const std::string& statementName, Nz::UInt64 duration);
 			void WorkerThread();
 
+			std::atomic<Nz::UInt64> m_busyTime; //< microseconds
 			std::atomic_bool m_idle;
 			std::atomic_bool m_running;
 			std::condition_variable m_idleConditionVariable;
 			std::mutex m_idleMutex;
+			std::unordered_map<std::string, MetricsRegistry::Histogram*> m_statementLatencies;
 			Nz::Thread m_thread;
 			Database& m_database;
 	};
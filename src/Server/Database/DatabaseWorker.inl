@@ -7,6 +7,7 @@
 namespace ewn
 {
 	inline DatabaseWorker::DatabaseWorker(Database& database) :
+	m_busyTime(0),
 	m_idle(false),
 	m_running(true),
 	m_database(database)
@@ -21,4 +22,9 @@ namespace ewn
 		m_running.store(false, std::memory_order_release);
 		m_thread.Join();
 	}
+
+	inline Nz::UInt64 DatabaseWorker::GetBusyTime() const
+	{
+		return m_busyTime.load(std::memory_order_relaxed);
+	}
 }
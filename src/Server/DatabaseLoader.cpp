@@ -4,7 +4,7 @@
 
 #include <Server/DatabaseLoader.hpp>
 #include <Server/Database/Database.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 #include <queue>
 
 namespace ewn
@@ -29,7 +29,7 @@ namespace ewn
 		{
 			if (!data.pendingResult)
 			{
-				std::cerr << "Failed to load " << data.storeName << ": " << data.pendingResult.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Failed to load " << data.storeName << ": " << data.pendingResult.GetLastErrorMessage();
 				hasFailed = true;
 			}
 		}
@@ -42,10 +42,10 @@ namespace ewn
 		{
 			StoreData& data = m_stores[storeId];
 
-			std::cout << "Loading " << data.storeName << "..." << std::endl;
+			LogInfo(LogCategory::Store) << "Loading " << data.storeName << "...";
 			if (!data.store->FillStoreFromDatabase(app, data.pendingResult))
 			{
-				std::cerr << "Failed to fill " << data.storeName << " store" << std::endl;
+				LogError(LogCategory::Store) << "Failed to fill " << data.storeName << " store";
 				hasFailed = true;
 			}
 		}
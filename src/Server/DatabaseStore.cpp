@@ -5,7 +5,7 @@
 #include <Server/DatabaseStore.hpp>
 #include <Server/Database/Database.hpp>
 #include <Server/Database/DatabaseResult.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -19,7 +19,7 @@ namespace ewn
 				cb(FillStore(app, result));
 			else
 			{
-				std::cerr << "An error occurred on prepared statement " << m_query << ": " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "An error occurred on prepared statement " << m_query << ": " << result.GetLastErrorMessage();
 				cb(false);
 				return;
 			}
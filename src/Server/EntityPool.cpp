@@ -0,0 +1,77 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/EntityPool.hpp>
+#include <NDK/World.hpp>
+#include <Server/Components/PooledComponent.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	const Ndk::EntityHandle& EntityPool::Acquire()
+	{
+		while (!m_dormantEntities.empty())
+		{
+			Ndk::EntityHandle entity = std::move(m_dormantEntities.back());
+			m_dormantEntities.pop_back();
+
+			// Entity may have been killed while dormant (world clear)
+			if (!entity)
+				continue;
+
+			entity->Enable();
+			m_reusedCount++;
+
+			return m_world.GetEntity(entity->GetId());
+		}
+
+		return CreatePooledEntity();
+	}
+
+	void EntityPool::Clear()
+	{
+		for (const Ndk::EntityHandle& entity : m_dormantEntities)
+		{
+			if (entity)
+				entity->Kill();
+		}
+
+		m_dormantEntities.clear();
+	}
+
+	void EntityPool::Release(const Ndk::EntityHandle& entity)
+	{
+		assert(entity->HasComponent<PooledComponent>());
+
+		// Disabled entities are removed from systems (and their physics body from the simulation) until reused
+		if (!entity->IsEnabled())
+			return; //< Already released
+
+		entity->Disable();
+		m_dormantEntities.emplace_back(entity);
+	}
+
+	void EntityPool::Reserve(std::size_t count)
+	{
+		m_dormantEntities.reserve(count);
+		while (m_dormantEntities.size() < count)
+		{
+			const Ndk::EntityHandle& entity = CreatePooledEntity();
+			entity->Disable();
+
+			m_dormantEntities.emplace_back(entity);
+		}
+	}
+
+	const Ndk::EntityHandle& EntityPool::CreatePooledEntity()
+	{
+		const Ndk::EntityHandle& entity = m_world.CreateEntity();
+		m_factory(entity);
+
+		entity->AddComponent<PooledComponent>(*this);
+		m_createdCount++;
+
+		return entity;
+	}
+}
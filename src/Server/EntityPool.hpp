@@ -0,0 +1,60 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_ENTITYPOOL_HPP
+#define EREWHON_SERVER_ENTITYPOOL_HPP
+
+#include <NDK/EntityHandle.hpp>
+#include <functional>
+#include <vector>
+
+namespace Ndk
+{
+	class World;
+}
+
+namespace ewn
+{
+	// Keeps dormant (disabled) entities of a single prefab around, to reuse them instead of
+	// rebuilding their components (colliders, physics bodies, ...) on every spawn
+	class EntityPool
+	{
+		public:
+			using Factory = std::function<void(const Ndk::EntityHandle& entity)>;
+
+			inline EntityPool(Ndk::World& world, Factory factory);
+			EntityPool(const EntityPool&) = delete;
+			EntityPool(EntityPool&&) = delete;
+			~EntityPool() = default;
+
+			const Ndk::EntityHandle& Acquire();
+
+			void Clear();
+
+			inline std::size_t GetCreatedCount() const;
+			inline std::size_t GetDormantCount() const;
+			inline std::size_t GetReusedCount() const;
+
+			void Release(const Ndk::EntityHandle& entity);
+			void Reserve(std::size_t count);
+
+			EntityPool& operator=(const EntityPool&) = delete;
+			EntityPool& operator=(EntityPool&&) = delete;
+
+		private:
+			const Ndk::EntityHandle& CreatePooledEntity();
+
+			std::size_t m_createdCount;
+			std::size_t m_reusedCount;
+			std::vector<Ndk::EntityHandle> m_dormantEntities;
+			Factory m_factory;
+			Ndk::World& m_world;
+	};
+}
+
+#include <Server/EntityPool.inl>
+
+#endif // EREWHON_SERVER_ENTITYPOOL_HPP
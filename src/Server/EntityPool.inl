@@ -0,0 +1,31 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/EntityPool.hpp>
+
+namespace ewn
+{
+	inline EntityPool::EntityPool(Ndk::World& world, Factory factory) :
+	m_createdCount(0),
+	m_reusedCount(0),
+	m_factory(std::move(factory)),
+	m_world(world)
+	{
+	}
+
+	inline std::size_t EntityPool::GetCreatedCount() const
+	{
+		return m_createdCount;
+	}
+
+	inline std::size_t EntityPool::GetDormantCount() const
+	{
+		return m_dormantEntities.size();
+	}
+
+	inline std::size_t EntityPool::GetReusedCount() const
+	{
+		return m_reusedCount;
+	}
+}
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/GameWorker.hpp>
+#include <Nazara/Core/Clock.hpp>
 #include <Server/ServerApplication.hpp>
 #include <chrono>
 #include <iostream>
@@ -15,11 +16,17 @@ namespace ewn
 
 		moodycamel::ConsumerToken consumerToken(queue);
 
-		ServerApplication::WorkerFunction job;
+		// Waiting time shows whether we have enough workers (password hashing has its own threads, see PasswordHasher)
+		MetricsRegistry::Histogram& waitTime = m_app->GetMetrics().GetHistogram("erewhon_worker_queue_wait_seconds", "Time jobs waited in the game worker queue");
+
+		ServerApplication::WorkerJob job;
 		while (m_running.load(std::memory_order_acquire))
 		{
 			if (queue.wait_dequeue_timed(consumerToken, job, std::chrono::milliseconds(100)))
-				job();
+			{
+				waitTime.Observe((Nz::GetElapsedMicroseconds() - job.enqueueTime) / 1'000'000.0);
+				job.function();
+			}
 		}
 	}
 }
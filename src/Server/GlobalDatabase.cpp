@@ -3,7 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/GlobalDatabase.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -22,6 +22,7 @@ namespace ewn
 			PrepareStatement(conn, "CreateFleet", "INSERT INTO fleets(owner_id, name, last_update_date) VALUES($1, LOWER($2), NOW()) RETURNING id;", { DatabaseType::Int32, DatabaseType::Text });
 			PrepareStatement(conn, "CreateFleetSpaceship", "INSERT INTO fleet_spaceships(fleet_id, spaceship_id, position_x, position_y, position_z) VALUES($1, $2, $3, $4, $5)", { DatabaseType::Int32, DatabaseType::Int32, DatabaseType::Single, DatabaseType::Single, DatabaseType::Single });
 			PrepareStatement(conn, "CreateSpaceship", "INSERT INTO spaceships(name, script, owner_id, spaceship_hull_id, last_update_date) VALUES(LOWER($2), $3, $1, $4, NOW()) RETURNING id;", { DatabaseType::Int32, DatabaseType::Text, DatabaseType::Text, DatabaseType::Int32 });
+			PrepareStatement(conn, "DeleteAccountToken", "DELETE FROM account_tokens WHERE token = $1", { DatabaseType::Text });
 			PrepareStatement(conn, "DeleteAccountTokenByAccountId", "DELETE FROM account_tokens WHERE account_id = $1", { DatabaseType::Int32 });
 			//PrepareStatement(conn, "DeleteFleet", "DELETE FROM fleets WHERE owner_id = $1 AND name = LOWER($2)", { DatabaseType::Int32, DatabaseType::Text });
 			PrepareStatement(conn, "DeleteFleetSpaceships", "DELETE FROM fleet_spaceships WHERE fleet_id = $1", { DatabaseType::Int32 });
@@ -47,7 +48,7 @@ namespace ewn
 			PrepareStatement(conn, "RegisterAccount", "INSERT INTO accounts(login, display_name, password, password_salt, email, creation_date) VALUES (LOWER($1), $1, $2, $3, $4, NOW())", { DatabaseType::Text, DatabaseType::Text, DatabaseType::Text, DatabaseType::Text });
 			PrepareStatement(conn, "UpdateFleetNameById", "UPDATE fleets SET name=LOWER($2) WHERE id=$1", { DatabaseType::Int32, DatabaseType::Text });
 			PrepareStatement(conn, "UpdateFleetUpdateDate", "UPDATE fleets SET last_update_date=NOW() WHERE id=$1", { DatabaseType::Int32 });
-			PrepareStatement(conn, "UpdateLastLoginDate", "UPDATE accounts SET last_login_date=NOW() WHERE id=$1", { DatabaseType::Int32 });
+			PrepareStatement(conn, "UpdateLastLoginDates", "UPDATE accounts SET last_login_date=NOW() WHERE id = ANY(string_to_array($1, ',')::integer[])", { DatabaseType::Text });
 			PrepareStatement(conn, "UpdatePermissionLevel", "UPDATE accounts SET permission_level=$2 WHERE id=$1", { DatabaseType::Int32, DatabaseType::Int16 });
 			PrepareStatement(conn, "UpdateSpaceshipModule", "UPDATE spaceship_modules SET module_id=$3 WHERE spaceship_id=$1 AND module_id=$2", { DatabaseType::Int32, DatabaseType::Int32, DatabaseType::Int32 });
 			PrepareStatement(conn, "UpdateSpaceshipNameById", "UPDATE spaceships SET name=LOWER($2) WHERE id=$1", { DatabaseType::Int32, DatabaseType::Text });
@@ -56,7 +57,7 @@ namespace ewn
 		}
 		catch (const std::exception& e)
 		{
-			std::cerr << "Failed to prepare statements: " << e.what() << std::endl;
+			LogError(LogCategory::Database) << "Failed to prepare statements: " << e.what();
 			throw;
 		}
 	}
@@ -0,0 +1,190 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/MetricsRegistry.hpp>
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
+namespace ewn
+{
+	std::string MetricsRegistry::Export() const
+	{
+		std::ostringstream stream;
+		stream.precision(9);
+
+		auto WriteSample = [&](const std::string& name, const std::string& labels, auto value)
+		{
+			stream << name;
+			if (!labels.empty())
+				stream << '{' << labels << '}';
+
+			stream << ' ' << value << '\n';
+		};
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		for (const auto& pair : m_families)
+		{
+			const std::string& name = pair.first;
+			const Family& family = pair.second;
+
+			stream << "# HELP " << name << ' ' << family.help << '\n';
+			switch (family.type)
+			{
+				case MetricType::Counter:
+				{
+					stream << "# TYPE " << name << " counter\n";
+					for (const Metric<Counter>& metric : family.counters)
+						WriteSample(name, metric.labels, metric.value->GetValue());
+
+					break;
+				}
+
+				case MetricType::Gauge:
+				{
+					stream << "# TYPE " << name << " gauge\n";
+					for (const Metric<Gauge>& metric : family.gauges)
+						WriteSample(name, metric.labels, metric.value->GetValue());
+
+					break;
+				}
+
+				case MetricType::Histogram:
+				{
+					stream << "# TYPE " << name << " histogram\n";
+					for (const Metric<Histogram>& metric : family.histograms)
+					{
+						const Histogram& histogram = *metric.value;
+						std::string labelPrefix = (metric.labels.empty()) ? std::string() : metric.labels + ',';
+
+						// Prometheus buckets are cumulative
+						Nz::UInt64 cumulativeCount = 0;
+						for (std::size_t i = 0; i < histogram.m_bucketBounds.size(); ++i)
+						{
+							cumulativeCount += histogram.m_bucketCounts[i].load(std::memory_order_relaxed);
+
+							std::ostringstream bound;
+							bound << histogram.m_bucketBounds[i];
+
+							WriteSample(name + "_bucket", labelPrefix + "le=\"" + bound.str() + '"', cumulativeCount);
+						}
+
+						Nz::UInt64 count = histogram.m_count.load(std::memory_order_relaxed);
+						WriteSample(name + "_bucket", labelPrefix + "le=\"+Inf\"", std::max(count, cumulativeCount));
+						WriteSample(name + "_sum", metric.labels, histogram.m_sum.load(std::memory_order_relaxed));
+						WriteSample(name + "_count", metric.labels, std::max(count, cumulativeCount));
+					}
+					break;
+				}
+			}
+		}
+
+		return stream.str();
+	}
+
+	auto MetricsRegistry::GetCounter(const std::string& name, const std::string& help, const Labels& labels) -> Counter&
+	{
+		std::string formattedLabels = FormatLabels(labels);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Family& family = GetFamily(name, help, MetricType::Counter);
+
+		auto it = std::find_if(family.counters.begin(), family.counters.end(), [&](const Metric<Counter>& metric) { return metric.labels == formattedLabels; });
+		if (it != family.counters.end())
+			return *it->value;
+
+		return *family.counters.emplace_back(Metric<Counter>{ std::move(formattedLabels), std::make_unique<Counter>() }).value;
+	}
+
+	auto MetricsRegistry::GetGauge(const std::string& name, const std::string& help, const Labels& labels) -> Gauge&
+	{
+		std::string formattedLabels = FormatLabels(labels);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Family& family = GetFamily(name, help, MetricType::Gauge);
+
+		auto it = std::find_if(family.gauges.begin(), family.gauges.end(), [&](const Metric<Gauge>& metric) { return metric.labels == formattedLabels; });
+		if (it != family.gauges.end())
+			return *it->value;
+
+		return *family.gauges.emplace_back(Metric<Gauge>{ std::move(formattedLabels), std::make_unique<Gauge>() }).value;
+	}
+
+	auto MetricsRegistry::GetHistogram(const std::string& name, const std::string& help, const Labels& labels, std::vector<double> bucketBounds) -> Histogram&
+	{
+		assert(std::is_sorted(bucketBounds.begin(), bucketBounds.end()));
+
+		std::string formattedLabels = FormatLabels(labels);
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		Family& family = GetFamily(name, help, MetricType::Histogram);
+
+		auto it = std::find_if(family.histograms.begin(), family.histograms.end(), [&](const Metric<Histogram>& metric) { return metric.labels == formattedLabels; });
+		if (it != family.histograms.end())
+			return *it->value;
+
+		return *family.histograms.emplace_back(Metric<Histogram>{ std::move(formattedLabels), std::make_unique<Histogram>(std::move(bucketBounds)) }).value;
+	}
+
+	std::vector<double> MetricsRegistry::LatencyBuckets()
+	{
+		// In seconds, from 100us to 10s
+		return { 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1.0, 2.5, 5.0, 10.0 };
+	}
+
+	void MetricsRegistry::Histogram::Observe(double value)
+	{
+		auto it = std::lower_bound(m_bucketBounds.begin(), m_bucketBounds.end(), value);
+		if (it != m_bucketBounds.end())
+			m_bucketCounts[std::distance(m_bucketBounds.begin(), it)].fetch_add(1, std::memory_order_relaxed);
+
+		m_count.fetch_add(1, std::memory_order_relaxed);
+
+		// No fetch_add for floating-point atomics before C++20
+		double sum = m_sum.load(std::memory_order_relaxed);
+		while (!m_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed));
+	}
+
+	auto MetricsRegistry::GetFamily(const std::string& name, const std::string& help, MetricType type) -> Family&
+	{
+		auto it = m_families.find(name);
+		if (it == m_families.end())
+		{
+			Family& family = m_families[name];
+			family.help = help;
+			family.type = type;
+
+			return family;
+		}
+
+		assert(it->second.type == type);
+		return it->second;
+	}
+
+	std::string MetricsRegistry::FormatLabels(const Labels& labels)
+	{
+		std::string formattedLabels;
+		for (const auto& pair : labels)
+		{
+			if (!formattedLabels.empty())
+				formattedLabels += ',';
+
+			formattedLabels += pair.first;
+			formattedLabels += "=\"";
+			for (char c : pair.second)
+			{
+				switch (c)
+				{
+					case '\\': formattedLabels += "\\\\"; break;
+					case '"':  formattedLabels += "\\\""; break;
+					case '\n': formattedLabels += "\\n"; break;
+					default:   formattedLabels += c; break;
+				}
+			}
+			formattedLabels += '"';
+		}
+
+		return formattedLabels;
+	}
+}
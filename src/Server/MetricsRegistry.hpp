@@ -0,0 +1,129 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_METRICSREGISTRY_HPP
+#define EREWHON_SERVER_METRICSREGISTRY_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ewn
+{
+	// Holds counters, gauges and histograms which can be updated from any thread and exported in Prometheus text format
+	// Metrics are never removed, references returned by Get* stay valid as long as the registry lives
+	class MetricsRegistry
+	{
+		public:
+			class Counter;
+			class Gauge;
+			class Histogram;
+			using Labels = std::vector<std::pair<std::string, std::string>>;
+
+			MetricsRegistry() = default;
+			MetricsRegistry(const MetricsRegistry&) = delete;
+			MetricsRegistry(MetricsRegistry&&) = delete;
+			~MetricsRegistry() = default;
+
+			std::string Export() const;
+
+			Counter& GetCounter(const std::string& name, const std::string& help, const Labels& labels = {});
+			Gauge& GetGauge(const std::string& name, const std::string& help, const Labels& labels = {});
+			Histogram& GetHistogram(const std::string& name, const std::string& help, const Labels& labels = {}, std::vector<double> bucketBounds = LatencyBuckets());
+
+			MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+			MetricsRegistry& operator=(MetricsRegistry&&) = delete;
+
+			static std::vector<double> LatencyBuckets();
+
+			class Counter
+			{
+				friend MetricsRegistry;
+
+				public:
+					inline Counter();
+
+					inline Nz::UInt64 GetValue() const;
+
+					inline void Increment(Nz::UInt64 value = 1);
+					inline void SetTotal(Nz::UInt64 total); //< For counters maintained elsewhere
+
+				private:
+					std::atomic<Nz::UInt64> m_value;
+			};
+
+			class Gauge
+			{
+				friend MetricsRegistry;
+
+				public:
+					inline Gauge();
+
+					inline double GetValue() const;
+
+					inline void Set(double value);
+
+				private:
+					std::atomic<double> m_value;
+			};
+
+			class Histogram
+			{
+				friend MetricsRegistry;
+
+				public:
+					inline Histogram(std::vector<double> bucketBounds);
+
+					void Observe(double value);
+
+				private:
+					std::unique_ptr<std::atomic<Nz::UInt64>[]> m_bucketCounts;
+					std::vector<double> m_bucketBounds;
+					std::atomic<Nz::UInt64> m_count;
+					std::atomic<double> m_sum;
+			};
+
+		private:
+			enum class MetricType
+			{
+				Counter,
+				Gauge,
+				Histogram
+			};
+
+			template<typename T>
+			struct Metric
+			{
+				std::string labels; //< already formatted, without braces
+				std::unique_ptr<T> value;
+			};
+
+			struct Family
+			{
+				MetricType type;
+				std::string help;
+				std::vector<Metric<Counter>> counters;
+				std::vector<Metric<Gauge>> gauges;
+				std::vector<Metric<Histogram>> histograms;
+			};
+
+			Family& GetFamily(const std::string& name, const std::string& help, MetricType type);
+
+			static std::string FormatLabels(const Labels& labels);
+
+			mutable std::mutex m_mutex;
+			std::map<std::string, Family> m_families;
+	};
+}
+
+#include <Server/MetricsRegistry.inl>
+
+#endif // EREWHON_SERVER_METRICSREGISTRY_HPP
@@ -0,0 +1,53 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/MetricsRegistry.hpp>
+
+namespace ewn
+{
+	inline MetricsRegistry::Counter::Counter() :
+	m_value(0)
+	{
+	}
+
+	inline Nz::UInt64 MetricsRegistry::Counter::GetValue() const
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	inline void MetricsRegistry::Counter::Increment(Nz::UInt64 value)
+	{
+		m_value.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	inline void MetricsRegistry::Counter::SetTotal(Nz::UInt64 total)
+	{
+		m_value.store(total, std::memory_order_relaxed);
+	}
+
+	inline MetricsRegistry::Gauge::Gauge() :
+	m_value(0.0)
+	{
+	}
+
+	inline double MetricsRegistry::Gauge::GetValue() const
+	{
+		return m_value.load(std::memory_order_relaxed);
+	}
+
+	inline void MetricsRegistry::Gauge::Set(double value)
+	{
+		m_value.store(value, std::memory_order_relaxed);
+	}
+
+	inline MetricsRegistry::Histogram::Histogram(std::vector<double> bucketBounds) :
+	m_bucketCounts(std::make_unique<std::atomic<Nz::UInt64>[]>(bucketBounds.size())),
+	m_bucketBounds(std::move(bucketBounds)),
+	m_count(0),
+	m_sum(0.0)
+	{
+		for (std::size_t i = 0; i < m_bucketBounds.size(); ++i)
+			m_bucketCounts[i].store(0, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,112 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/MetricsServer.hpp>
+#include <Nazara/Network/SocketPoller.hpp>
+#include <Nazara/Network/TcpClient.hpp>
+#include <Server/MetricsRegistry.hpp>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace ewn
+{
+	MetricsServer::MetricsServer(const MetricsRegistry& registry, Nz::UInt16 port) :
+	m_registry(registry)
+	{
+		// Only listen on loopback, metrics are not meant to be publicly reachable
+		Nz::IpAddress listenAddress = Nz::IpAddress::LoopbackIpV4;
+		listenAddress.SetPort(port);
+
+		if (m_server.Listen(listenAddress) != Nz::SocketState_Bound)
+			throw std::runtime_error("Failed to listen on " + listenAddress.ToString().ToStdString());
+
+		m_server.EnableBlocking(false);
+
+		m_running.store(true, std::memory_order_release);
+		m_thread = Nz::Thread(&MetricsServer::ServerThread, this);
+		m_thread.SetName("MetricsServer");
+	}
+
+	MetricsServer::~MetricsServer()
+	{
+		m_running.store(false, std::memory_order_release);
+		m_thread.Join();
+	}
+
+	void MetricsServer::HandleClient(Nz::TcpClient& client)
+	{
+		constexpr std::size_t MaxRequestSize = 4096;
+		constexpr int RequestTimeout = 1000; //< ms
+
+		Nz::SocketPoller poller;
+		poller.RegisterSocket(client, Nz::SocketPollEvent_Read);
+
+		// We only care about the request line, read until the end of headers
+		std::string request;
+		std::array<char, 1024> buffer;
+		while (request.find("\r\n\r\n") == std::string::npos)
+		{
+			if (request.size() >= MaxRequestSize || !poller.Wait(RequestTimeout))
+				return;
+
+			std::size_t received;
+			if (!client.Receive(buffer.data(), buffer.size(), &received) || received == 0)
+				return;
+
+			request.append(buffer.data(), received);
+		}
+
+		std::string status;
+		std::string body;
+		if (request.compare(0, 13, "GET /metrics ") == 0)
+		{
+			status = "200 OK";
+			body = m_registry.Export();
+		}
+		else
+		{
+			status = "404 Not Found";
+			body = "Not found, try /metrics\n";
+		}
+
+		std::string response = "HTTP/1.1 " + status + "\r\n"
+		                       "Content-Type: text/plain; version=0.0.4\r\n"
+		                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+		                       "Connection: close\r\n"
+		                       "\r\n" + body;
+
+		client.EnableBlocking(true);
+
+		std::size_t offset = 0;
+		while (offset < response.size())
+		{
+			std::size_t sent;
+			if (!client.Send(response.data() + offset, response.size() - offset, &sent) || sent == 0)
+				break;
+
+			offset += sent;
+		}
+
+		client.Disconnect();
+	}
+
+	void MetricsServer::ServerThread()
+	{
+		Nz::SocketPoller poller;
+		poller.RegisterSocket(m_server, Nz::SocketPollEvent_Read);
+
+		while (m_running.load(std::memory_order_acquire))
+		{
+			// Wake up regularly to check m_running
+			if (!poller.Wait(100))
+				continue;
+
+			// Scrapes are rare and tiny, handle clients one at a time
+			Nz::TcpClient client;
+			while (m_server.AcceptClient(&client))
+				HandleClient(client);
+		}
+	}
+}
@@ -0,0 +1,44 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_METRICSSERVER_HPP
+#define EREWHON_SERVER_METRICSSERVER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Nazara/Network/TcpServer.hpp>
+#include <atomic>
+
+namespace ewn
+{
+	class MetricsRegistry;
+
+	// Minimal HTTP listener serving GET /metrics on localhost, for a local Prometheus scraper
+	class MetricsServer final
+	{
+		public:
+			MetricsServer(const MetricsRegistry& registry, Nz::UInt16 port);
+			MetricsServer(const MetricsServer&) = delete;
+			MetricsServer(MetricsServer&&) = delete;
+			~MetricsServer();
+
+			MetricsServer& operator=(const MetricsServer&) = delete;
+			MetricsServer& operator=(MetricsServer&&) = delete;
+
+		private:
+			void HandleClient(Nz::TcpClient& client);
+			void ServerThread();
+
+			std::atomic_bool m_running;
+			Nz::TcpServer m_server;
+			Nz::Thread m_thread;
+			const MetricsRegistry& m_registry;
+	};
+}
+
+#include <Server/MetricsServer.inl>
+
+#endif // EREWHON_SERVER_METRICSSERVER_HPP
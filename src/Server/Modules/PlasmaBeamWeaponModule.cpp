@@ -5,7 +5,6 @@
 #include <Server/Modules/PlasmaBeamWeaponModule.hpp>
 #include <NDK/Components/NodeComponent.hpp>
 #include <Server/Components/ArenaComponent.hpp>
-#include <Server/Components/OwnerComponent.hpp>
 
 namespace ewn
 {
@@ -15,11 +14,7 @@ namespace ewn
 		auto& spaceshipNode = spaceship->GetComponent<Ndk::NodeComponent>();
 		Arena& spaceshipArena = spaceship->GetComponent<ewn::ArenaComponent>();
 
-		Player* owner = nullptr;
-		if (spaceship->HasComponent<OwnerComponent>())
-			owner = spaceship->GetComponent<OwnerComponent>().GetOwner();
-
-		spaceshipArena.CreatePlasmaProjectile(owner, spaceship, spaceshipNode.GetPosition() + spaceshipNode.GetForward() * 12.f, spaceshipNode.GetRotation());
+		spaceshipArena.CreatePlasmaProjectile(spaceship, spaceshipNode.GetPosition() + spaceshipNode.GetForward() * 12.f, spaceshipNode.GetRotation());
 
 		Packets::PlaySound playSound;
 		playSound.position = spaceshipNode.GetPosition();
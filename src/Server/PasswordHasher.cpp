@@ -0,0 +1,158 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/PasswordHasher.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Shared/Profiler.hpp>
+#include <argon2/argon2.h>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace ewn
+{
+	namespace
+	{
+		// argon2 allocation callbacks have no user data, each hashing thread points this to its own buffer
+		thread_local std::vector<uint8_t>* s_argon2Memory = nullptr;
+
+		int AllocateArgon2Memory(uint8_t** memory, size_t bytesToAllocate)
+		{
+			assert(s_argon2Memory);
+			if (s_argon2Memory->size() < bytesToAllocate)
+				s_argon2Memory->resize(bytesToAllocate);
+
+			*memory = s_argon2Memory->data();
+			return ARGON2_OK;
+		}
+
+		void FreeArgon2Memory(uint8_t* /*memory*/, size_t /*bytesToAllocate*/)
+		{
+			// Kept for the next hash
+		}
+	}
+
+	PasswordHasher::PasswordHasher(MetricsRegistry& metrics, const Settings& settings) :
+	m_averageHashTime(0),
+	m_queueSize(0),
+	m_running(true),
+	m_rejectedJobs(metrics.GetCounter("erewhon_password_hash_rejected_total", "Password hashes refused because the hashing queue was full")),
+	m_hashTime(metrics.GetHistogram("erewhon_password_hash_seconds", "Time spent computing a password hash")),
+	m_queueWaitTime(metrics.GetHistogram("erewhon_password_hash_queue_wait_seconds", "Time password hashes waited for a hashing thread")),
+	m_settings(settings)
+	{
+		assert(m_settings.workerCount > 0);
+
+		m_threads.reserve(m_settings.workerCount);
+		for (std::size_t i = 0; i < m_settings.workerCount; ++i)
+		{
+			Nz::Thread& thread = m_threads.emplace_back(&PasswordHasher::WorkerThread, this);
+			thread.SetName("PasswordHasher");
+		}
+	}
+
+	PasswordHasher::~PasswordHasher()
+	{
+		m_running.store(false, std::memory_order_release);
+		for (Nz::Thread& thread : m_threads)
+			thread.Join();
+	}
+
+	// Approximate time (in microseconds) a new hash would wait before being computed
+	Nz::UInt64 PasswordHasher::EstimateQueueDelay() const
+	{
+		return GetQueueSize() * m_averageHashTime.load(std::memory_order_relaxed) / m_settings.workerCount;
+	}
+
+	bool PasswordHasher::Hash(std::string password, std::string salt, Callback callback)
+	{
+		// Reserve a spot before enqueuing, a concurrent call can't make the queue exceed its limit
+		std::size_t queueSize = m_queueSize.fetch_add(1, std::memory_order_relaxed);
+		if (queueSize >= m_settings.maxQueueSize)
+		{
+			m_queueSize.fetch_sub(1, std::memory_order_relaxed);
+			m_rejectedJobs.Increment();
+			return false;
+		}
+
+		Job job;
+		job.callback = std::move(callback);
+		job.enqueueTime = Nz::GetElapsedMicroseconds();
+		job.password = std::move(password);
+		job.salt = std::move(salt);
+
+		m_queue.enqueue(std::move(job));
+		return true;
+	}
+
+	void PasswordHasher::WorkerThread()
+	{
+		Profiler::SetThreadName("PasswordHasher");
+
+		std::vector<uint8_t> argon2Memory;
+		argon2Memory.resize(std::size_t(m_settings.memoryCost) * 1024); //< argon2 memory cost is expressed in KiB
+
+		s_argon2Memory = &argon2Memory;
+
+		std::vector<uint8_t> output(m_settings.hashLength);
+		std::string outputHex(m_settings.hashLength * 2 + 1, '\0');
+
+		moodycamel::ConsumerToken consumerToken(m_queue);
+
+		Job job;
+		while (m_running.load(std::memory_order_acquire))
+		{
+			if (!m_queue.wait_dequeue_timed(consumerToken, job, std::chrono::milliseconds(100)))
+				continue;
+
+			Nz::UInt64 startTime = Nz::GetElapsedMicroseconds();
+			m_queueWaitTime.Observe((startTime - job.enqueueTime) / 1'000'000.0);
+
+			argon2_context context;
+			std::memset(&context, 0, sizeof(argon2_context));
+
+			context.out = output.data();
+			context.outlen = uint32_t(output.size());
+			context.pwd = reinterpret_cast<uint8_t*>(job.password.data());
+			context.pwdlen = uint32_t(job.password.size());
+			context.salt = reinterpret_cast<uint8_t*>(job.salt.data());
+			context.saltlen = uint32_t(job.salt.size());
+			context.t_cost = m_settings.iterationCost;
+			context.m_cost = m_settings.memoryCost;
+			context.lanes = m_settings.threadCost;
+			context.threads = m_settings.threadCost;
+			context.allocate_cbk = &AllocateArgon2Memory;
+			context.free_cbk = &FreeArgon2Memory;
+			context.flags = ARGON2_DEFAULT_FLAGS;
+			context.version = ARGON2_VERSION_13;
+
+			int argon2Result = argon2_ctx(&context, argon2_type::Argon2_id);
+
+			std::string hash;
+			if (argon2Result == ARGON2_OK)
+			{
+				for (std::size_t i = 0; i < output.size(); ++i)
+					std::sprintf(&outputHex[i * 2], "%02x", output[i]);
+
+				hash.assign(outputHex.data(), output.size() * 2);
+			}
+
+			Nz::UInt64 hashTime = Nz::GetElapsedMicroseconds() - startTime;
+			m_hashTime.Observe(hashTime / 1'000'000.0);
+
+			// Only used to estimate retry delays, a racy update doesn't matter
+			Nz::UInt64 averageHashTime = m_averageHashTime.load(std::memory_order_relaxed);
+			m_averageHashTime.store((averageHashTime == 0) ? hashTime : (averageHashTime * 7 + hashTime) / 8, std::memory_order_relaxed);
+
+			m_queueSize.fetch_sub(1, std::memory_order_relaxed);
+
+			job.callback(argon2Result, std::move(hash));
+			job = Job();
+		}
+
+		s_argon2Memory = nullptr;
+	}
+}
@@ -0,0 +1,82 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_PASSWORDHASHER_HPP
+#define EREWHON_SERVER_PASSWORDHASHER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Server/MetricsRegistry.hpp>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Dedicated argon2id executor with a bounded queue, so a login flood can't exhaust memory or starve other workers
+	// Each thread keeps its argon2 memory between hashes instead of allocating MemoryCost KiB every time
+	class PasswordHasher
+	{
+		public:
+			struct Settings;
+			using Callback = std::function<void(int argon2Result, std::string hash)>; //< called from a hashing thread, hash is hexadecimal
+
+			PasswordHasher(MetricsRegistry& metrics, const Settings& settings);
+			PasswordHasher(const PasswordHasher&) = delete;
+			PasswordHasher(PasswordHasher&&) = delete;
+			~PasswordHasher();
+
+			Nz::UInt64 EstimateQueueDelay() const;
+
+			inline std::size_t GetQueueSize() const;
+
+			bool Hash(std::string password, std::string salt, Callback callback);
+
+			inline bool IsSaturated() const;
+
+			PasswordHasher& operator=(const PasswordHasher&) = delete;
+			PasswordHasher& operator=(PasswordHasher&&) = delete;
+
+			struct Settings
+			{
+				std::size_t maxQueueSize;
+				std::size_t workerCount;
+				int hashLength;
+				int iterationCost;
+				int memoryCost; //< KiB
+				int threadCost;
+			};
+
+		private:
+			struct Job
+			{
+				Callback callback;
+				std::string password;
+				std::string salt;
+				Nz::UInt64 enqueueTime; //< microseconds
+			};
+
+			void WorkerThread();
+
+			using JobQueue = moodycamel::BlockingConcurrentQueue<Job>;
+
+			std::atomic<Nz::UInt64> m_averageHashTime; //< microseconds, moving average
+			std::atomic<std::size_t> m_queueSize;
+			std::atomic_bool m_running;
+			std::vector<Nz::Thread> m_threads;
+			JobQueue m_queue;
+			MetricsRegistry::Counter& m_rejectedJobs;
+			MetricsRegistry::Histogram& m_hashTime;
+			MetricsRegistry::Histogram& m_queueWaitTime;
+			Settings m_settings;
+	};
+}
+
+#include <Server/PasswordHasher.inl>
+
+#endif // EREWHON_SERVER_PASSWORDHASHER_HPP
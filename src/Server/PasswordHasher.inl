@@ -0,0 +1,19 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/PasswordHasher.hpp>
+
+namespace ewn
+{
+	inline std::size_t PasswordHasher::GetQueueSize() const
+	{
+		return m_queueSize.load(std::memory_order_relaxed);
+	}
+
+	// Allows rejecting a request before doing any work (database queries) for it
+	inline bool PasswordHasher::IsSaturated() const
+	{
+		return GetQueueSize() >= m_settings.maxQueueSize;
+	}
+}
@@ -11,6 +11,7 @@
 #include <Server/Components/InputComponent.hpp>
 #include <Server/Components/PlayerControlledComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
+#include <Shared/Logger.hpp>
 #include <cassert>
 
 namespace ewn
@@ -22,7 +23,8 @@ namespace ewn
 	m_permissionLevel(0),
 	m_databaseId(0),
 	m_lastInputTime(0),
-	m_authenticated(false)
+	m_authenticated(false),
+	m_isRelay(false)
 	{
 	}
 
@@ -34,7 +36,17 @@ namespace ewn
 
 	void Player::Authenticate(Nz::Int32 dbId, std::function<void(Player*, bool succeeded)> authenticationCallback)
 	{
-		m_databaseId = dbId;
+		m_databaseId = dbId;
+
+		// Reconnections of recently seen accounts don't wait for the database
+		if (const AccountCache::AccountData* account = m_app->GetAccountCache().FindAccount(dbId, m_app->GetAppTime()))
+		{
+			OnAuthenticated(account->login, account->displayName, account->permissionLevel);
+			m_app->QueueLastLoginUpdate(dbId);
+
+			authenticationCallback(this, true);
+			return;
+		}
 
 		Accounts_SelectById request;
 		request.id = dbId;
@@ -46,13 +58,13 @@ namespace ewn
 
 			if (!result.IsValid())
 			{
-				std::cerr << "LoadAccount failed for player #" << ply->GetDatabaseId() << ": " << result.GetLastErrorMessage();
+				LogError(LogCategory::Database) << "LoadAccount failed for player #" << ply->GetDatabaseId() << ": " << result.GetLastErrorMessage();
 
 				cb(ply, false);
 			}
 			else if (result.GetRowCount() == 0)
 			{
-				std::cerr << "LoadAccount failed for player #" << ply->GetDatabaseId() << ": No account found";
+				LogError(LogCategory::Player) << "LoadAccount failed for player #" << ply->GetDatabaseId() << ": No account found";
 
 				cb(ply, false);
 			}
@@ -62,19 +74,31 @@ namespace ewn
 				if (results.permissionLevel < 0)
 					results.permissionLevel = 0;
 
-				ply->OnAuthenticated(std::move(results.login), std::move(results.displayName), static_cast<Nz::UInt16>(results.permissionLevel));
+				AccountCache::AccountData account;
+				account.displayName = std::move(results.displayName);
+				account.login = std::move(results.login);
+				account.permissionLevel = static_cast<Nz::UInt16>(results.permissionLevel);
+
+				app->GetAccountCache().StoreAccount(ply->GetDatabaseId(), account, app->GetAppTime());
+
+				ply->OnAuthenticated(std::move(account.login), std::move(account.displayName), account.permissionLevel);
+				app->QueueLastLoginUpdate(ply->GetDatabaseId());
 
 				cb(ply, true);
-
-				app->GetGlobalDatabase().ExecuteStatement("UpdateLastLoginDate", { Nz::Int32(ply->GetDatabaseId()) }, [dbId = ply->GetDatabaseId()](DatabaseResult& result)
-				{
-					if (!result.IsValid() || result.GetAffectedRowCount() == 0)
-						std::cerr << "Failed to update last login date for player #" << dbId << ": " << result.GetLastErrorMessage() << std::endl;
-				});
 			}
 		});
 	}
 
+	// Relays (see ErewhonRelay) have no account, they only spectate an arena to broadcast it again to their own clients
+	void Player::AuthenticateAsRelay()
+	{
+		assert(!m_authenticated);
+
+		m_authenticated = true;
+		m_displayName = "Relay #" + std::to_string(m_session->GetPeerId());
+		m_isRelay = true;
+	}
+
 	bool Player::CanShoot() const
 	{
 		return m_app->GetAppTime() - m_lastShootTime >= 500;
@@ -117,7 +141,7 @@ namespace ewn
 		app->GetGlobalDatabase().ExecuteTransaction(std::move(trans), [app, sessionId = GetSessionId(), cb = std::move(creationCallback)](bool transactionSucceeded, std::vector<DatabaseResult>& queryResults)
 		{
 			if (!transactionSucceeded)
-				std::cerr << "Create spaceship transaction failed: " << queryResults.back().GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Create spaceship transaction failed: " << queryResults.back().GetLastErrorMessage();
 
 			cb(app->GetPlayerBySession(sessionId), transactionSucceeded);
 		});
@@ -131,7 +155,7 @@ namespace ewn
 			{
 				cb(false, FleetData());
 
-				std::cerr << "FindFleetByOwnerIdAndName failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "FindFleetByOwnerIdAndName failed: " << result.GetLastErrorMessage();
 				return;
 			}
 
@@ -153,7 +177,7 @@ namespace ewn
 				{
 					fleetCallback(false, FleetData());
 
-					std::cerr << "FindFleetSpaceshipByFleetId failed: " << result.GetLastErrorMessage() << std::endl;
+					LogError(LogCategory::Database) << "FindFleetSpaceshipByFleetId failed: " << result.GetLastErrorMessage();
 					return;
 				}
 
@@ -329,7 +353,7 @@ namespace ewn
 
 		auto& spaceshipNode = m_controlledEntity->GetComponent<Ndk::NodeComponent>();
 
-		m_arena->CreatePlasmaProjectile(this, m_controlledEntity, spaceshipNode.GetPosition() + spaceshipNode.GetForward() * 12.f, spaceshipNode.GetRotation());
+		m_arena->CreatePlasmaProjectile(m_controlledEntity, spaceshipNode.GetPosition() + spaceshipNode.GetForward() * 12.f, spaceshipNode.GetRotation());
 
 		Packets::PlaySound playSound;
 		playSound.position = spaceshipNode.GetPosition();
@@ -390,31 +414,31 @@ namespace ewn
 		}
 	}
 
-	void Player::UpdateInput(Nz::UInt64 lastInputTime, Nz::Vector3f movement, Nz::Vector3f rotation)
+	bool Player::UpdateInput(Nz::UInt64 lastInputTime, Nz::Vector3f movement, Nz::Vector3f rotation)
 	{
 		//TODO: Check input time consistency and possibly kick player
 		if (lastInputTime <= m_lastInputTime)
-			return;
+			return false; //< Already received, clients send their last inputs again with every packet
 
 		m_lastInputTime = lastInputTime;
 
 		if (!m_controlledEntity)
-			return;
+			return true;
 
 		if (!std::isfinite(movement.x) ||
 		    !std::isfinite(movement.y) ||
 		    !std::isfinite(movement.z))
 		{
-			std::cout << "Client #" << GetSessionId() << " (" << m_login << " has non-finite movement: " << movement << std::endl;
-			return;
+			LogWarning(LogCategory::Player) << "Client #" << GetSessionId() << " (" << m_login << " has non-finite movement: " << movement;
+			return true;
 		}
 
 		if (!std::isfinite(rotation.x) ||
 		    !std::isfinite(rotation.y) ||
 		    !std::isfinite(rotation.z))
 		{
-			std::cout << "Client #" << GetSessionId() << " (" << m_login << " has non-finite rotation: " << movement << std::endl;
-			return;
+			LogWarning(LogCategory::Player) << "Client #" << GetSessionId() << " (" << m_login << " has non-finite rotation: " << movement;
+			return true;
 		}
 
 		// TODO: Set speed limit accordingly to spaceship data
@@ -427,10 +451,9 @@ namespace ewn
 		rotation.z = Nz::Clamp(rotation.z, -1.f, 1.f);
 
 		auto& controlComponent = m_controlledEntity->GetComponent<InputComponent>();
-		if (lastInputTime <= controlComponent.GetLastInputTime())
-			return; //< FIXME?
-
 		controlComponent.PushInput(lastInputTime, movement, rotation);
+
+		return true;
 	}
 
 	void Player::UpdatePermissionLevel(Nz::UInt16 permissionLevel, std::function<void(bool updateSucceeded)> databaseCallback)
@@ -438,12 +461,14 @@ namespace ewn
 		assert(m_authenticated);
 
 		m_permissionLevel = permissionLevel;
+		m_app->GetAccountCache().UpdatePermissionLevel(m_databaseId, permissionLevel);
+
 		m_app->GetGlobalDatabase().ExecuteStatement("UpdatePermissionLevel", { Nz::Int32(m_databaseId), Nz::Int16(permissionLevel) }, [cb = std::move(databaseCallback)](DatabaseResult& result)
 		{
 			if (!result.IsValid())
-				std::cerr << "Failed to update permission level: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Failed to update permission level: " << result.GetLastErrorMessage();
 			else if (result.GetAffectedRowCount() == 0)
-				std::cerr << "Failed to update permission level: player not found" << std::endl;
+				LogError(LogCategory::Player) << "Failed to update permission level: player not found";
 
 			if (cb)
 				cb(result.IsValid() && result.GetAffectedRowCount() > 0);
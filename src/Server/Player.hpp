@@ -32,6 +32,7 @@ namespace ewn
 			~Player();
 
 			void Authenticate(Nz::Int32 dbId, std::function<void (Player*, bool succeeded)> authenticationCallback);
+			void AuthenticateAsRelay();
 
 			bool CanShoot() const;
 
@@ -44,6 +45,7 @@ namespace ewn
 
 			inline ServerApplication* GetApp() const;
 			inline Arena* GetArena() const;
+			inline std::size_t GetBotCount() const;
 			inline const Ndk::EntityHandle& GetControlledEntity() const;
 			inline Nz::Int32 GetDatabaseId() const;
 			void GetFleetData(const std::string& fleetName, std::function<void(bool found, const FleetData& fleet)> callback, SpaceshipQueryInfoFlags infoFlags = SpaceshipQueryInfoFlags::ValueMask);
@@ -53,24 +55,26 @@ namespace ewn
 			inline const std::string& GetName() const;
 			inline ClientSession* GetSession();
 			inline const ClientSession* GetSession() const;
-			inline std::size_t GetSessionId() const;
+			inline Nz::UInt64 GetSessionId() const;
 
 			const Ndk::EntityHandle& InstantiateBot(const std::string& name, std::size_t spaceshipHullId, Nz::Vector3f positionOffset = Nz::Vector3f::Zero());
 
 			inline bool IsAuthenticated() const;
+			inline bool IsRelay() const;
 
 			void MoveToArena(Arena* arena);
 
 			void PrintMessage(std::string chatMessage);
 
-			template<typename T> void SendPacket(const T& packet);
+			template<typename T> std::size_t SendCachedPacket(const CachedPacket<T>& packet);
+			template<typename T> std::size_t SendPacket(const T& packet);
 
 			void Shoot();
 
 			void Update(float elapsedTime);
 
 			void UpdateControlledEntity(const Ndk::EntityHandle& entity);
-			void UpdateInput(Nz::UInt64 time, Nz::Vector3f direction, Nz::Vector3f rotation);
+			bool UpdateInput(Nz::UInt64 time, Nz::Vector3f direction, Nz::Vector3f rotation);
 			void UpdatePermissionLevel(Nz::UInt16 permissionLevel, std::function<void(bool updateSucceeded)> databaseCallback = nullptr);
 			void UpdateSession(ClientSession* session);
 
@@ -99,7 +103,7 @@ namespace ewn
 				std::vector<SpaceshipType> spaceshipTypes;
 			};
 
-			static constexpr std::size_t InvalidSessionId = std::numeric_limits<std::size_t>::max();
+			static constexpr Nz::UInt64 InvalidSessionId = 0; //< never a valid session handle (see SlotMap::InvalidHandle)
 
 		private:
 			void OnAuthenticated(std::string login, std::string displayName, Nz::UInt16 permissionLevel);
@@ -125,6 +129,7 @@ namespace ewn
 			Nz::UInt64 m_lastInputTime;
 			Nz::UInt64 m_lastShootTime;
 			bool m_authenticated;
+			bool m_isRelay;
 	};
 }
 
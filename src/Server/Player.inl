@@ -5,6 +5,7 @@
 #include <Server/Player.hpp>
 #include <Nazara/Network/NetPacket.hpp>
 #include <Shared/Protocol/Packets.hpp>
+#include <algorithm>
 #include <cassert>
 
 namespace ewn
@@ -34,6 +35,12 @@ namespace ewn
 		return m_controlledEntity;
 	}
 
+	inline std::size_t Player::GetBotCount() const
+	{
+		// Killed bots are only removed when replaced
+		return std::count_if(m_botEntities.begin(), m_botEntities.end(), [](const Ndk::EntityOwner& bot) { return bot.IsValid(); });
+	}
+
 	inline Nz::Int32 Player::GetDatabaseId() const
 	{
 		return m_databaseId;
@@ -64,7 +71,7 @@ namespace ewn
 		return m_session;
 	}
 
-	inline std::size_t Player::GetSessionId() const
+	inline Nz::UInt64 Player::GetSessionId() const
 	{
 		if (m_session)
 			return m_session->GetSessionId();
@@ -77,12 +84,26 @@ namespace ewn
 		return m_authenticated;
 	}
 
+	inline bool Player::IsRelay() const
+	{
+		return m_isRelay;
+	}
+
+	template<typename T>
+	std::size_t Player::SendCachedPacket(const CachedPacket<T>& packet)
+	{
+		if (!m_session)
+			return 0;
+
+		return m_session->SendCachedPacket(packet);
+	}
+
 	template<typename T>
-	void Player::SendPacket(const T& packet)
+	std::size_t Player::SendPacket(const T& packet)
 	{
 		if (!m_session)
-			return;
+			return 0;
 
-		m_session->SendPacket(packet);
+		return m_session->SendPacket(packet);
 	}
 }
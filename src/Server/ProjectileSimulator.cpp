@@ -0,0 +1,173 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/ProjectileSimulator.hpp>
+#include <Nazara/Math/Box.hpp>
+#include <Nazara/Math/Ray.hpp>
+#include <Nazara/Physics3D/PhysWorld3D.hpp>
+#include <NDK/World.hpp>
+#include <NDK/Systems/PhysicsSystem3D.hpp>
+#include <algorithm>
+
+namespace ewn
+{
+	void ProjectileSimulator::BuildCreatePacket(Packets::CreateProjectiles& packet, Nz::UInt64 currentTime) const
+	{
+		std::size_t projectileCount = m_ids.size();
+		packet.projectiles.reserve(packet.projectiles.size() + projectileCount);
+
+		for (std::size_t i = 0; i < projectileCount; ++i)
+		{
+			float speed;
+			Nz::Vector3f direction = m_velocities[i];
+			direction.Normalize(&speed);
+
+			auto& projectile = packet.projectiles.emplace_back();
+			projectile.direction = direction;
+			projectile.lifeTime = m_remainingLifeTimes[i];
+			projectile.origin = m_positions[i];
+			projectile.prefabId = m_prefabIds[i];
+			projectile.projectileId = m_ids[i];
+			projectile.spawnTime = currentTime;
+			projectile.speed = speed;
+		}
+	}
+
+	void ProjectileSimulator::Clear()
+	{
+		m_emitters.clear();
+		m_positions.clear();
+		m_velocities.clear();
+		m_ids.clear();
+		m_prefabIds.clear();
+		m_damages.clear();
+		m_remainingLifeTimes.clear();
+		m_stepAccumulator = 0.f;
+	}
+
+	Nz::UInt32 ProjectileSimulator::Spawn(Nz::UInt32 prefabId, const Ndk::EntityHandle& emitter, const Nz::Vector3f& origin, const Nz::Vector3f& direction, float speed, float lifeTime, Nz::UInt16 damage)
+	{
+		Nz::UInt32 projectileId = m_nextProjectileId++;
+
+		m_emitters.emplace_back(emitter);
+		m_positions.push_back(origin);
+		m_velocities.push_back(direction.GetNormal() * speed);
+		m_ids.push_back(projectileId);
+		m_prefabIds.push_back(prefabId);
+		m_damages.push_back(damage);
+		m_remainingLifeTimes.push_back(lifeTime);
+
+		return projectileId;
+	}
+
+	void ProjectileSimulator::Update(float elapsedTime)
+	{
+		m_stepAccumulator += elapsedTime;
+		while (m_stepAccumulator >= m_stepSize)
+		{
+			m_stepAccumulator -= m_stepSize;
+			Step(m_stepSize);
+		}
+	}
+
+	void ProjectileSimulator::RemoveProjectile(std::size_t index)
+	{
+		std::size_t lastIndex = m_ids.size() - 1;
+		if (index != lastIndex)
+		{
+			m_emitters[index] = std::move(m_emitters[lastIndex]);
+			m_positions[index] = m_positions[lastIndex];
+			m_velocities[index] = m_velocities[lastIndex];
+			m_ids[index] = m_ids[lastIndex];
+			m_prefabIds[index] = m_prefabIds[lastIndex];
+			m_damages[index] = m_damages[lastIndex];
+			m_remainingLifeTimes[index] = m_remainingLifeTimes[lastIndex];
+		}
+
+		m_emitters.pop_back();
+		m_positions.pop_back();
+		m_velocities.pop_back();
+		m_ids.pop_back();
+		m_prefabIds.pop_back();
+		m_damages.pop_back();
+		m_remainingLifeTimes.pop_back();
+	}
+
+	void ProjectileSimulator::Step(float elapsedTime)
+	{
+		constexpr float beamRadius = 0.5f;
+
+		Nz::PhysWorld3D& physWorld = m_world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld();
+
+		m_pendingHits.clear();
+		m_removedIndices.clear();
+
+		std::size_t projectileCount = m_ids.size();
+		for (std::size_t i = 0; i < projectileCount; ++i)
+		{
+			Nz::Vector3f start = m_positions[i];
+			Nz::Vector3f displacement = m_velocities[i] * elapsedTime;
+			Nz::Vector3f end = start + displacement;
+
+			// Query the broadphase for every body the swept segment may touch
+			Nz::Boxf sweptBox(start - Nz::Vector3f(beamRadius), start + Nz::Vector3f(beamRadius));
+			sweptBox.ExtendTo(end - Nz::Vector3f(beamRadius));
+			sweptBox.ExtendTo(end + Nz::Vector3f(beamRadius));
+
+			const Ndk::EntityHandle& emitter = m_emitters[i];
+			Nz::Rayf segment(start, displacement); //< Hit distances are expressed as a fraction of the segment
+
+			bool hasHit = false;
+			float closestHit = 1.f;
+			Ndk::EntityId hitEntityId = 0;
+
+			physWorld.ForEachBodyInAABB(sweptBox, [&](Nz::RigidBody3D& body)
+			{
+				Ndk::EntityId bodyId = static_cast<Ndk::EntityId>(reinterpret_cast<std::ptrdiff_t>(body.GetUserdata()));
+				if (emitter && emitter->GetId() == bodyId)
+					return true;
+
+				Nz::Boxf bodyBox = body.GetAABB();
+				Nz::Boxf inflatedBox(bodyBox.GetMinimum() - Nz::Vector3f(beamRadius), bodyBox.GetMaximum() + Nz::Vector3f(beamRadius));
+
+				float hitFraction;
+				if (segment.Intersect(inflatedBox, &hitFraction) && hitFraction <= closestHit)
+				{
+					closestHit = std::max(hitFraction, 0.f);
+					hitEntityId = bodyId;
+					hasHit = true;
+				}
+
+				return true;
+			});
+
+			if (hasHit && m_world.IsEntityIdValid(hitEntityId))
+			{
+				HitInfo& hit = m_pendingHits.emplace_back();
+				hit.damage = m_damages[i];
+				hit.emitter = emitter;
+				hit.hitEntity = m_world.GetEntity(hitEntityId);
+				hit.hitPosition = start + displacement * closestHit;
+				hit.projectileId = m_ids[i];
+				hit.velocity = m_velocities[i];
+
+				m_removedIndices.push_back(i);
+				continue;
+			}
+
+			m_positions[i] = end;
+
+			m_remainingLifeTimes[i] -= elapsedTime;
+			if (m_remainingLifeTimes[i] <= 0.f)
+				m_removedIndices.push_back(i); //< Clients expire projectiles by themselves, no need to notify them
+		}
+
+		// Indices are sorted, removing from the back keeps the remaining ones valid
+		for (auto it = m_removedIndices.rbegin(); it != m_removedIndices.rend(); ++it)
+			RemoveProjectile(*it);
+
+		for (const HitInfo& hit : m_pendingHits)
+			OnProjectileHit(this, hit);
+	}
+}
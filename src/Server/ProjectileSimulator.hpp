@@ -0,0 +1,84 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_PROJECTILESIMULATOR_HPP
+#define EREWHON_SERVER_PROJECTILESIMULATOR_HPP
+
+#include <Nazara/Core/Signal.hpp>
+#include <Nazara/Math/Vector3.hpp>
+#include <NDK/EntityHandle.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <vector>
+
+namespace Ndk
+{
+	class World;
+}
+
+namespace ewn
+{
+	// Simulates fast projectiles (plasma beams) without any entity or rigid body,
+	// by sweeping a segment against the physics broadphase each step
+	class ProjectileSimulator
+	{
+		public:
+			struct HitInfo;
+
+			inline ProjectileSimulator(Ndk::World& world, float stepSize = 1.f / 60.f);
+			ProjectileSimulator(const ProjectileSimulator&) = delete;
+			ProjectileSimulator(ProjectileSimulator&&) = delete;
+			~ProjectileSimulator() = default;
+
+			void BuildCreatePacket(Packets::CreateProjectiles& packet, Nz::UInt64 currentTime) const;
+
+			void Clear();
+
+			inline std::size_t GetProjectileCount() const;
+			inline const std::vector<Nz::UInt32>& GetProjectileIds() const;
+
+			Nz::UInt32 Spawn(Nz::UInt32 prefabId, const Ndk::EntityHandle& emitter, const Nz::Vector3f& origin, const Nz::Vector3f& direction, float speed, float lifeTime, Nz::UInt16 damage);
+
+			void Update(float elapsedTime);
+
+			ProjectileSimulator& operator=(const ProjectileSimulator&) = delete;
+			ProjectileSimulator& operator=(ProjectileSimulator&&) = delete;
+
+			struct HitInfo
+			{
+				Ndk::EntityHandle emitter;
+				Ndk::EntityHandle hitEntity;
+				Nz::UInt32 projectileId;
+				Nz::Vector3f hitPosition;
+				Nz::Vector3f velocity;
+				Nz::UInt16 damage;
+			};
+
+			NazaraSignal(OnProjectileHit, ProjectileSimulator* /*emitter*/, const HitInfo& /*hit*/);
+
+		private:
+			void RemoveProjectile(std::size_t index);
+			void Step(float elapsedTime);
+
+			// Projectiles are stored as parallel arrays (SoA), every array has the same size
+			std::vector<Ndk::EntityHandle> m_emitters;
+			std::vector<Nz::Vector3f> m_positions;
+			std::vector<Nz::Vector3f> m_velocities;
+			std::vector<Nz::UInt32> m_ids;
+			std::vector<Nz::UInt32> m_prefabIds;
+			std::vector<Nz::UInt16> m_damages;
+			std::vector<float> m_remainingLifeTimes;
+			std::vector<HitInfo> m_pendingHits;
+			std::vector<std::size_t> m_removedIndices;
+			Ndk::World& m_world;
+			Nz::UInt32 m_nextProjectileId;
+			float m_stepAccumulator;
+			float m_stepSize;
+	};
+}
+
+#include <Server/ProjectileSimulator.inl>
+
+#endif // EREWHON_SERVER_PROJECTILESIMULATOR_HPP
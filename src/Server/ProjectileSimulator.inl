@@ -0,0 +1,26 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/ProjectileSimulator.hpp>
+
+namespace ewn
+{
+	inline ProjectileSimulator::ProjectileSimulator(Ndk::World& world, float stepSize) :
+	m_world(world),
+	m_nextProjectileId(0),
+	m_stepAccumulator(0.f),
+	m_stepSize(stepSize)
+	{
+	}
+
+	inline std::size_t ProjectileSimulator::GetProjectileCount() const
+	{
+		return m_ids.size();
+	}
+
+	inline const std::vector<Nz::UInt32>& ProjectileSimulator::GetProjectileIds() const
+	{
+		return m_ids;
+	}
+}
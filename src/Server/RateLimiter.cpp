@@ -0,0 +1,56 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/RateLimiter.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	constexpr Nz::UInt64 PruneInterval = 60'000'000; //< 1min
+
+	// Returns false if the key ran out of tokens, retryAfter then receives the time (in microseconds) until the next one
+	bool RateLimiter::Consume(const std::string& key, Nz::UInt64 now, Nz::UInt64* retryAfter)
+	{
+		if (!IsEnabled())
+			return true;
+
+		if (now >= m_nextPruneTime)
+		{
+			Prune(now);
+			m_nextPruneTime = now + PruneInterval;
+		}
+
+		auto it = m_buckets.find(key);
+		if (it == m_buckets.end())
+			it = m_buckets.emplace(key, Bucket{ m_burst, now }).first;
+
+		Bucket& bucket = it->second;
+		bucket.tokens = std::min(bucket.tokens + (now - bucket.lastUpdate) * m_refillRate, m_burst);
+		bucket.lastUpdate = now;
+
+		if (bucket.tokens < 1.0)
+		{
+			if (retryAfter)
+				*retryAfter = (m_refillRate > 0.0) ? static_cast<Nz::UInt64>(std::ceil((1.0 - bucket.tokens) / m_refillRate)) : PruneInterval;
+
+			return false;
+		}
+
+		bucket.tokens -= 1.0;
+		return true;
+	}
+
+	void RateLimiter::Prune(Nz::UInt64 now)
+	{
+		for (auto it = m_buckets.begin(); it != m_buckets.end();)
+		{
+			const Bucket& bucket = it->second;
+			if (bucket.tokens + (now - bucket.lastUpdate) * m_refillRate >= m_burst)
+				it = m_buckets.erase(it);
+			else
+				++it;
+		}
+	}
+}
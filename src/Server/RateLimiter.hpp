@@ -0,0 +1,50 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_RATELIMITER_HPP
+#define EREWHON_SERVER_RATELIMITER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <string>
+#include <unordered_map>
+
+namespace ewn
+{
+	// One token bucket per key (address, login, ...), each request consumes a token and buckets refill continuously
+	// Buckets are forgotten once full again, so memory only depends on recently active keys
+	class RateLimiter
+	{
+		public:
+			inline RateLimiter();
+			~RateLimiter() = default;
+
+			bool Consume(const std::string& key, Nz::UInt64 now, Nz::UInt64* retryAfter = nullptr);
+
+			inline std::size_t GetBucketCount() const;
+
+			inline bool IsEnabled() const;
+
+			inline void SetLimits(unsigned int burst, unsigned int perMinute);
+
+		private:
+			void Prune(Nz::UInt64 now);
+
+			struct Bucket
+			{
+				double tokens;
+				Nz::UInt64 lastUpdate; //< microseconds
+			};
+
+			std::unordered_map<std::string, Bucket> m_buckets;
+			Nz::UInt64 m_nextPruneTime;
+			double m_burst;
+			double m_refillRate; //< tokens per microsecond
+	};
+}
+
+#include <Server/RateLimiter.inl>
+
+#endif // EREWHON_SERVER_RATELIMITER_HPP
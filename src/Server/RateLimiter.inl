@@ -0,0 +1,34 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/RateLimiter.hpp>
+
+namespace ewn
+{
+	inline RateLimiter::RateLimiter() :
+	m_nextPruneTime(0),
+	m_burst(0.0),
+	m_refillRate(0.0)
+	{
+	}
+
+	inline std::size_t RateLimiter::GetBucketCount() const
+	{
+		return m_buckets.size();
+	}
+
+	inline bool RateLimiter::IsEnabled() const
+	{
+		return m_burst > 0.0;
+	}
+
+	// A burst of zero disables the limiter
+	inline void RateLimiter::SetLimits(unsigned int burst, unsigned int perMinute)
+	{
+		m_burst = burst;
+		m_refillRate = perMinute / 60'000'000.0;
+
+		m_buckets.clear();
+	}
+}
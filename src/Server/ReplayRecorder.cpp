@@ -0,0 +1,172 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/ReplayRecorder.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/ReplayFormat.hpp>
+#include <Shared/Protocol/PacketSizer.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <stdexcept>
+
+namespace ewn
+{
+	ReplayRecorder::ReplayRecorder(const std::string& filePath, const std::string& arenaName, Nz::UInt64 startTime) :
+	m_filePath(filePath),
+	m_file(filePath, Nz::OpenMode_Truncate | Nz::OpenMode_WriteOnly),
+	m_chunkRecordCount(0),
+	m_keyframeSize(0),
+	m_chunkEndTime(0),
+	m_chunkStartTime(0),
+	m_hasChunk(false),
+	m_isRecordingKeyframe(false),
+	m_keyframeRequested(false),
+	m_writeFailed(false)
+	{
+		if (!m_file.IsOpen())
+			throw std::runtime_error("Failed to open " + filePath);
+
+		Nz::UInt64 startTimestamp = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		PacketSizer sizer;
+		sizer &= ReplayFormat::FileMagic;
+		sizer &= ReplayFormat::FormatVersion;
+		sizer &= startTime;
+		sizer &= startTimestamp;
+		sizer &= arenaName;
+
+		std::vector<Nz::UInt8> fileHeader(sizer.GetSize());
+
+		PacketWriter writer(fileHeader.data(), fileHeader.size());
+		writer &= ReplayFormat::FileMagic;
+		writer &= ReplayFormat::FormatVersion;
+		writer &= startTime;
+		writer &= startTimestamp;
+		writer &= arenaName;
+
+		if (m_file.Write(fileHeader.data(), fileHeader.size()) != fileHeader.size())
+			throw std::runtime_error("Failed to write " + filePath);
+
+		m_running.store(true, std::memory_order_release);
+		m_thread = Nz::Thread(&ReplayRecorder::WriterThread, this);
+		m_thread.SetName("ReplayRecorder");
+	}
+
+	ReplayRecorder::~ReplayRecorder()
+	{
+		SubmitChunk();
+
+		m_running.store(false, std::memory_order_release);
+		m_thread.Join();
+	}
+
+	// Closes the current chunk and starts a new one, packets recorded until EndKeyframe must rebuild the whole arena
+	void ReplayRecorder::BeginKeyframe(Nz::UInt64 time)
+	{
+		SubmitChunk();
+
+		m_chunk.resize(ReplayFormat::ChunkHeaderSize); //< filled when submitting the chunk
+		m_chunkEndTime = time;
+		m_chunkRecordCount = 0;
+		m_chunkStartTime = time;
+		m_hasChunk = true;
+		m_isRecordingKeyframe = true;
+		m_keyframeRequested = false;
+		m_keyframeSize = 0;
+	}
+
+	void ReplayRecorder::EndKeyframe()
+	{
+		assert(m_isRecordingKeyframe);
+
+		m_isRecordingKeyframe = false;
+		m_keyframeSize = static_cast<Nz::UInt32>(m_chunk.size() - ReplayFormat::ChunkHeaderSize);
+	}
+
+	// Appends a record header and returns a writer over the message bytes
+	PacketWriter ReplayRecorder::AppendRecord(Nz::UInt64 time, std::size_t messageSize)
+	{
+		assert(m_hasChunk);
+
+		// Packets sent before the keyframe was taken (between two ticks) are stored at the keyframe time
+		time = std::max(time, m_chunkStartTime);
+
+		CompressedUnsigned<Nz::UInt32> timeOffset(static_cast<Nz::UInt32>(time - m_chunkStartTime));
+		CompressedUnsigned<Nz::UInt32> recordSize(static_cast<Nz::UInt32>(messageSize));
+
+		PacketSizer sizer;
+		sizer &= timeOffset;
+		sizer &= recordSize;
+
+		std::size_t recordOffset = m_chunk.size();
+		m_chunk.resize(recordOffset + sizer.GetSize() + messageSize);
+
+		PacketWriter headerWriter(&m_chunk[recordOffset], sizer.GetSize());
+		headerWriter &= timeOffset;
+		headerWriter &= recordSize;
+
+		m_chunkEndTime = std::max(m_chunkEndTime, time);
+		m_chunkRecordCount++;
+
+		return PacketWriter(&m_chunk[recordOffset + sizer.GetSize()], messageSize);
+	}
+
+	void ReplayRecorder::SubmitChunk()
+	{
+		if (!m_hasChunk)
+			return;
+
+		if (m_isRecordingKeyframe)
+			EndKeyframe();
+
+		PacketWriter headerWriter(m_chunk.data(), ReplayFormat::ChunkHeaderSize);
+		headerWriter &= ReplayFormat::ChunkMagic;
+		headerWriter &= static_cast<Nz::UInt32>(m_chunk.size() - ReplayFormat::ChunkHeaderSize);
+		headerWriter &= m_keyframeSize;
+		headerWriter &= m_chunkRecordCount;
+		headerWriter &= m_chunkStartTime;
+		headerWriter &= m_chunkEndTime;
+		assert(headerWriter.GetOffset() == ReplayFormat::ChunkHeaderSize);
+
+		m_pendingChunks.enqueue(std::move(m_chunk));
+		m_hasChunk = false;
+
+		if (!m_freeChunks.try_dequeue(m_chunk))
+			m_chunk = std::vector<Nz::UInt8>();
+
+		m_chunk.clear();
+	}
+
+	void ReplayRecorder::WriteChunk(const std::vector<Nz::UInt8>& chunk)
+	{
+		if (m_writeFailed)
+			return;
+
+		// Chunks are flushed as soon as they're written, a crash only loses the chunk being recorded
+		if (m_file.Write(chunk.data(), chunk.size()) != chunk.size() || !m_file.Flush())
+		{
+			// Replays are only read up to the first incomplete chunk, writing the next ones would be pointless
+			LogError(LogCategory::Arena) << "Failed to write replay chunk to " << m_filePath << ", recording stopped";
+			m_writeFailed = true;
+		}
+	}
+
+	void ReplayRecorder::WriterThread()
+	{
+		std::vector<Nz::UInt8> chunk;
+		while (m_running.load(std::memory_order_acquire))
+		{
+			if (!m_pendingChunks.wait_dequeue_timed(chunk, std::chrono::milliseconds(100)))
+				continue;
+
+			WriteChunk(chunk);
+			m_freeChunks.enqueue(std::move(chunk));
+		}
+
+		// Last chunks, submitted by the destructor
+		while (m_pendingChunks.try_dequeue(chunk))
+			WriteChunk(chunk);
+	}
+}
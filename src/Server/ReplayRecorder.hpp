@@ -0,0 +1,77 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_REPLAYRECORDER_HPP
+#define EREWHON_SERVER_REPLAYRECORDER_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <Nazara/Core/File.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
+#include <concurrentqueue/blockingconcurrentqueue.h>
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace ewn
+{
+	// Appends the packets an arena broadcasts to a replay file (see ReplayFormat.hpp)
+	// Records are serialized in memory by the arena thread, complete chunks are handed to a writer thread so recording never waits for the disk
+	class ReplayRecorder
+	{
+		public:
+			ReplayRecorder(const std::string& filePath, const std::string& arenaName, Nz::UInt64 startTime);
+			ReplayRecorder(const ReplayRecorder&) = delete;
+			ReplayRecorder(ReplayRecorder&&) = delete;
+			~ReplayRecorder();
+
+			void BeginKeyframe(Nz::UInt64 time);
+			void EndKeyframe();
+
+			inline bool IsKeyframeNeeded(Nz::UInt64 time) const;
+
+			template<typename T> void RecordPacket(Nz::UInt64 time, const T& packet);
+			template<typename T> void RecordPacket(Nz::UInt64 time, const CachedPacket<T>& packet);
+
+			inline void RequestKeyframe();
+
+			ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+			ReplayRecorder& operator=(ReplayRecorder&&) = delete;
+
+			static constexpr Nz::UInt64 KeyframeInterval = 10'000; //< ms, longest part of a replay to read through after seeking
+			static constexpr std::size_t MaxChunkSize = 4 * 1024 * 1024;
+
+		private:
+			PacketWriter AppendRecord(Nz::UInt64 time, std::size_t messageSize);
+			void SubmitChunk();
+			void WriteChunk(const std::vector<Nz::UInt8>& chunk);
+			void WriterThread();
+
+			using ChunkQueue = moodycamel::BlockingConcurrentQueue<std::vector<Nz::UInt8>>;
+			using FreeChunkQueue = moodycamel::ConcurrentQueue<std::vector<Nz::UInt8>>;
+
+			std::atomic_bool m_running;
+			std::string m_filePath;
+			std::vector<Nz::UInt8> m_chunk;
+			ChunkQueue m_pendingChunks;
+			FreeChunkQueue m_freeChunks; //< written chunks, reused to avoid reallocating a buffer for every chunk
+			Nz::File m_file;
+			Nz::Thread m_thread;
+			Nz::UInt32 m_chunkRecordCount;
+			Nz::UInt32 m_keyframeSize;
+			Nz::UInt64 m_chunkEndTime;
+			Nz::UInt64 m_chunkStartTime;
+			bool m_hasChunk;
+			bool m_isRecordingKeyframe;
+			bool m_keyframeRequested;
+			bool m_writeFailed; //< writer thread only
+	};
+}
+
+#include <Server/ReplayRecorder.inl>
+
+#endif // EREWHON_SERVER_REPLAYRECORDER_HPP
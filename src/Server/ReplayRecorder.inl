@@ -0,0 +1,52 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/ReplayRecorder.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	inline bool ReplayRecorder::IsKeyframeNeeded(Nz::UInt64 time) const
+	{
+		if (!m_hasChunk || m_keyframeRequested)
+			return true;
+
+		return time - m_chunkStartTime >= KeyframeInterval || m_chunk.size() >= MaxChunkSize;
+	}
+
+	// Packets recorded before the first keyframe are dropped, they couldn't be replayed
+	template<typename T>
+	void ReplayRecorder::RecordPacket(Nz::UInt64 time, const T& packet)
+	{
+		if (!m_hasChunk)
+			return;
+
+		std::size_t messageSize = sizeof(Nz::UInt8) + Packets::ComputeSize(packet);
+
+		PacketWriter writer = AppendRecord(time, messageSize);
+		writer &= static_cast<Nz::UInt8>(T::Type);
+		Packets::Serialize(writer, packet);
+		assert(writer.GetOffset() == messageSize);
+	}
+
+	template<typename T>
+	void ReplayRecorder::RecordPacket(Nz::UInt64 time, const CachedPacket<T>& packet)
+	{
+		if (!m_hasChunk || !packet.IsValid())
+			return;
+
+		// Cached packets are already serialized with their type
+		const std::vector<Nz::UInt8>& packetData = packet.GetData();
+
+		PacketWriter writer = AppendRecord(time, packetData.size());
+		writer.WriteBytes(packetData.data(), packetData.size());
+	}
+
+	// Next IsKeyframeNeeded call will return true, after the arena was reset for example
+	inline void ReplayRecorder::RequestKeyframe()
+	{
+		m_keyframeRequested = true;
+	}
+}
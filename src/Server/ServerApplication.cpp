@@ -6,14 +6,22 @@
 #include <Nazara/Core/File.hpp>
 #include <Server/DatabaseLoader.hpp>
 #include <Server/Player.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
+#include <algorithm>
 
 namespace ewn
 {
+	constexpr Nz::UInt64 AccountFlushInterval = 5'000; //< 5s
+
 	ServerApplication::ServerApplication() :
 	m_sessionPool(sizeof(ClientSession)),
 	m_chatCommandStore(this),
-	m_nextSessionId(0)
+	m_networkStringsPacketCount(0),
+	m_lastAccountFlush(0),
+	m_lastDatabaseBusyTime(0),
+	m_lastDatabaseMetricsTime(Nz::GetElapsedMicroseconds()),
+	m_lastMetricsUpdate(0)
 	{
 		RegisterConfigOptions();
 		RegisterNetworkedStrings();
@@ -21,14 +29,67 @@ namespace ewn
 
 	ServerApplication::~ServerApplication()
 	{
-		for (ClientSession* session : m_sessions)
+		// Hashing threads push callbacks to the application, they must stop first
+		m_passwordHasher.reset();
+
+		m_sessions.ForEach([&](ClientSession* session)
 		{
-			if (session)
-			{
-				session->Disconnect();
-				m_sessionPool.Delete(session);
-			}
+			session->Disconnect();
+			m_sessionPool.Delete(session);
+		});
+	}
+
+	// Registration attempts have no login yet, only the address limit applies to them
+	bool ServerApplication::ConsumeLoginAttempt(const Nz::IpAddress& address, const std::string& login, Nz::UInt64* retryAfter)
+	{
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+
+		// Clients connecting from the same host share their bucket, whatever their port
+		Nz::IpAddress host = address;
+		host.SetPort(0);
+
+		if (!m_loginAddressLimiter.Consume(host.ToString().ToStdString(), now, retryAfter))
+		{
+			m_metrics.GetCounter("erewhon_login_rate_limited_total", "Login and registration attempts refused by rate limiting", { { "scope", "address" } }).Increment();
+			return false;
+		}
+
+		if (!login.empty() && !m_loginAccountLimiter.Consume(login, now, retryAfter))
+		{
+			m_metrics.GetCounter("erewhon_login_rate_limited_total", "Login and registration attempts refused by rate limiting", { { "scope", "account" } }).Increment();
+			return false;
 		}
+
+		return true;
+	}
+
+	void ServerApplication::FlushAccountUpdates()
+	{
+		m_accountCache.Prune(GetAppTime());
+
+		if (m_pendingLastLoginUpdates.empty())
+			return;
+
+		// A single statement for every player who logged in since the last flush
+		std::sort(m_pendingLastLoginUpdates.begin(), m_pendingLastLoginUpdates.end());
+		m_pendingLastLoginUpdates.erase(std::unique(m_pendingLastLoginUpdates.begin(), m_pendingLastLoginUpdates.end()), m_pendingLastLoginUpdates.end());
+
+		std::string accountIds;
+		for (Nz::Int32 accountId : m_pendingLastLoginUpdates)
+		{
+			if (!accountIds.empty())
+				accountIds += ',';
+
+			accountIds += std::to_string(accountId);
+		}
+
+		m_globalDatabase->ExecuteStatement("UpdateLastLoginDates", { std::move(accountIds) }, [accountCount = m_pendingLastLoginUpdates.size()](DatabaseResult& result)
+		{
+			if (!result.IsValid())
+				LogError(LogCategory::Database) << "Failed to update last login date of " << accountCount << " accounts: " << result.GetLastErrorMessage();
+		});
+
+		m_pendingLastLoginUpdates.clear();
 	}
 
 	Arena& ServerApplication::CreateArena(std::string name, std::string script)
@@ -37,6 +98,18 @@ namespace ewn
 		return *m_arenas.back().get();
 	}
 
+	const CachedPacket<Packets::NetworkStrings>& ServerApplication::GetNetworkStringsPacket()
+	{
+		// Strings are registered while loading, the packet is rebuilt if some were added since it was serialized
+		if (m_networkStringsPacketCount != m_stringStore.GetStringCount())
+		{
+			m_networkStringsPacket.Update(m_stringStore.BuildPacket(0));
+			m_networkStringsPacketCount = m_stringStore.GetStringCount();
+		}
+
+		return m_networkStringsPacket;
+	}
+
 	bool ServerApplication::LoadDatabase()
 	{
 		Database& globalDatabase = GetGlobalDatabase();
@@ -69,19 +142,97 @@ namespace ewn
 		return true;
 	}
 
+	bool ServerApplication::LoadPrefabs(const std::string& fileName)
+	{
+		if (!m_prefabStore.LoadFromFile(fileName, m_stringStore))
+			return false;
+
+		// Arenas rely on those prefabs to spawn spaceships and projectiles
+		for (const char* prefabName : { "frigate", "plasmabeam", "spaceship", "torpedo" })
+		{
+			if (m_prefabStore.GetEntryByName(prefabName) == PrefabStore::InvalidEntryId)
+			{
+				LogError(LogCategory::Store) << "Missing required prefab \"" << prefabName << "\" in " << fileName;
+				return false;
+			}
+		}
+
+		for (const char* prefabName : { "plasmabeam", "torpedo" })
+		{
+			if (!m_prefabStore.IsEntryProjectile(m_prefabStore.GetEntryByName(prefabName)))
+			{
+				LogError(LogCategory::Store) << "Prefab \"" << prefabName << "\" must have projectile properties";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
 	bool ServerApplication::Run()
 	{
-		float updateTime = GetUpdateTime();
+		m_tickScheduler.BeginTick();
+
+		ProfileZone("ServerApplication::Run");
+
+		Nz::UInt64 phaseStartTime = Nz::GetElapsedMicroseconds();
+		auto EndPhase = [&](TimingHistogram& timings)
+		{
+			Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+			timings.Record(now - phaseStartTime);
+			phaseStartTime = now;
+		};
+
+		// Arenas are simulated with a fixed timestep, whatever the real time between two ticks
+		float updateTime = m_tickScheduler.GetTickInterval();
 		for (const auto& arenaPtr : m_arenas)
 			arenaPtr->Update(updateTime);
 
+		EndPhase(m_tickTimings.arenas);
+
 		m_globalDatabase->Poll();
 
-		ServerCallback func;
-		while (m_callbackQueue.try_dequeue(func))
-			func();
+		EndPhase(m_tickTimings.database);
 
-		return BaseApplication::Run();
+		{
+			ProfileZone("ServerApplication::Callbacks");
+
+			ServerCallback func;
+			while (m_callbackQueue.try_dequeue(func))
+				func();
+		}
+
+		EndPhase(m_tickTimings.callbacks);
+
+		bool isRunning = BaseApplication::Run();
+
+		{
+			ProfileZone("ServerApplication::FlushBundles");
+
+			// Messages sent during the tick were bundled per client and channel
+			m_sessions.ForEach([](ClientSession* session)
+			{
+				session->FlushBundles();
+			});
+		}
+
+		EndPhase(m_tickTimings.network);
+
+		if (GetAppTime() - m_lastAccountFlush >= AccountFlushInterval)
+		{
+			FlushAccountUpdates();
+			m_lastAccountFlush = GetAppTime();
+		}
+
+		if (GetAppTime() - m_lastMetricsUpdate >= 1000)
+		{
+			UpdateMetrics();
+			m_lastMetricsUpdate = GetAppTime();
+		}
+
+		m_tickScheduler.EndTick();
+
+		return isRunning;
 	}
 
 	bool ServerApplication::BakeDefaultSpaceshipData()
@@ -95,7 +246,7 @@ namespace ewn
 		m_defaultSpaceshipData.hullId = m_spaceshipHullStore.GetEntryByName(hullName);
 		if (m_defaultSpaceshipData.hullId == m_spaceshipHullStore.InvalidEntryId)
 		{
-			std::cerr << "Failed to find default spaceship hull \"" << hullName << "\"" << std::endl;
+			LogError(LogCategory::Store) << "Failed to find default spaceship hull \"" << hullName << "\"";
 			return false;
 		}
 
@@ -107,7 +258,7 @@ namespace ewn
 			std::size_t moduleId = m_moduleStore.GetEntryByName(moduleName);
 			if (moduleId == m_moduleStore.InvalidEntryId)
 			{
-				std::cerr << "Failed to find default spaceship module \"" << moduleName << "\"" << std::endl;
+				LogError(LogCategory::Store) << "Failed to find default spaceship module \"" << moduleName << "\"";
 				return false;
 			}
 
@@ -135,7 +286,7 @@ namespace ewn
 		Nz::File file(fileName, Nz::OpenMode_ReadOnly | Nz::OpenMode_Text);
 		if (!file.IsOpen())
 		{
-			std::cerr << "Failed to open default spaceship script file \"" << fileName << "\"" << std::endl;
+			LogError(LogCategory::Store) << "Failed to open default spaceship script file \"" << fileName << "\"";
 			return false;
 		}
 
@@ -151,45 +302,42 @@ namespace ewn
 		return true;
 	}
 
-	void ServerApplication::HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data)
+	void ServerApplication::HandlePeerConnection(bool outgoing, std::size_t peerId, const Nz::IpAddress& remoteAddress, Nz::UInt32 data)
 	{
 		const std::unique_ptr<NetworkReactor>& reactor = GetReactor(peerId / GetPeerPerReactor());
 
-		if (peerId >= m_sessions.size())
-			m_sessions.resize(peerId + 1);
-
 		auto player = std::make_shared<Player>(this);
 
-		std::size_t sessionId = m_nextSessionId;
-		m_sessionIdToPeer.insert_or_assign(sessionId, peerId);
-		m_nextSessionId++;
+		// The peer id is the slot index, the generation part of the handle tells sessions of the same peer apart
+		SessionHandle sessionId = m_sessions.GetHandle(peerId);
 
-		m_sessions[peerId] = m_sessionPool.New<ClientSession>(this, sessionId, peerId, player, *reactor, m_commandStore);
+		ClientSession* session = m_sessionPool.New<ClientSession>(this, sessionId, peerId, remoteAddress, player, *reactor, m_commandStore);
+		m_sessions.Insert(peerId, session);
 
-		player->UpdateSession(m_sessions[peerId]);
+		player->UpdateSession(session);
 
-		std::cout << "Client #" << peerId << " (sess. " << sessionId << ") connected with data " << data << std::endl;
+		LogInfo(LogCategory::Network) << "Client #" << peerId << " (sess. " << sessionId << ") connected from " << remoteAddress.ToString().ToStdString() << " with data " << data;
 
-		// Send networked strings
-		m_sessions[peerId]->SendPacket(m_stringStore.BuildPacket(0));
+		// Networked strings are sent once the client declared its cached packets (see ClientSession::HandleDeclareCachedPackets)
 	}
 
 	void ServerApplication::HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data)
 	{
-		std::cout << "Client #" << peerId << " disconnected with data " << data << std::endl;
+		LogInfo(LogCategory::Network) << "Client #" << peerId << " disconnected with data " << data;
 
-		m_sessionIdToPeer.erase(m_sessions[peerId]->GetSessionId());
+		ClientSession* session = m_sessions.Get(peerId);
+		m_sessions.Remove(peerId);
 
-		m_sessionPool.Delete(m_sessions[peerId]);
-		m_sessions[peerId] = nullptr;
+		m_sessionPool.Delete(session);
 	}
 
 	void ServerApplication::HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet)
 	{
 		//std::cout << "Client #" << peerId << " sent packet of size " << packet.GetDataSize() << std::endl;
 
-		if (!m_commandStore.UnserializePacket(*m_sessions[peerId], std::move(packet)))
-			m_sessions[peerId]->Disconnect();
+		ClientSession* session = m_sessions.Get(peerId);
+		if (!m_commandStore.UnserializePacket(*session, std::move(packet)))
+			session->Disconnect();
 	}
 
 	void ServerApplication::InitGameWorkers(std::size_t workerCount)
@@ -202,6 +350,7 @@ namespace ewn
 	void ServerApplication::InitGlobalDatabase(std::size_t workerCount, std::string dbHost, Nz::UInt16 port, std::string dbUser, std::string dbPassword, std::string dbName)
 	{
 		m_globalDatabase.emplace(std::move(dbHost), port, std::move(dbUser), std::move(dbPassword), std::move(dbName));
+		m_globalDatabase->SetMetricsRegistry(&m_metrics);
 		m_globalDatabase->SpawnWorkers(workerCount);
 	}
 
@@ -216,8 +365,37 @@ namespace ewn
 
 		std::size_t gameWorkerCount = m_config.GetIntegerOption<std::size_t>("Game.WorkerCount");
 
+		PasswordHasher::Settings hasherSettings;
+		hasherSettings.hashLength = m_config.GetIntegerOption<int>("Security.HashLength");
+		hasherSettings.iterationCost = m_config.GetIntegerOption<int>("Security.Argon2.IterationCost");
+		hasherSettings.maxQueueSize = m_config.GetIntegerOption<std::size_t>("Security.Hashing.MaxQueueSize");
+		hasherSettings.memoryCost = m_config.GetIntegerOption<int>("Security.Argon2.MemoryCost");
+		hasherSettings.threadCost = m_config.GetIntegerOption<int>("Security.Argon2.ThreadCost");
+		hasherSettings.workerCount = m_config.GetIntegerOption<std::size_t>("Security.Hashing.WorkerCount");
+
+		m_accountCache.SetDuration(m_config.GetIntegerOption<Nz::UInt64>("Security.AccountCacheDuration") * 1000);
+
+		m_loginAccountLimiter.SetLimits(m_config.GetIntegerOption<unsigned int>("Security.LoginRateLimit.AccountBurst"), m_config.GetIntegerOption<unsigned int>("Security.LoginRateLimit.AccountPerMinute"));
+		m_loginAddressLimiter.SetLimits(m_config.GetIntegerOption<unsigned int>("Security.LoginRateLimit.AddressBurst"), m_config.GetIntegerOption<unsigned int>("Security.LoginRateLimit.AddressPerMinute"));
+
+		m_tickScheduler.SetTickRate(m_config.GetFloatOption<float>("Game.TickRate"));
+
 		InitGameWorkers(gameWorkerCount);
 		InitGlobalDatabase(dbWorkerCount, dbHost, dbPort, dbUser, dbPassword, dbName);
+
+		m_passwordHasher.emplace(m_metrics, hasherSettings);
+
+		if (Nz::UInt16 metricsPort = m_config.GetIntegerOption<Nz::UInt16>("Metrics.Port"); metricsPort > 0)
+		{
+			try
+			{
+				m_metricsServer = std::make_unique<MetricsServer>(m_metrics, metricsPort);
+			}
+			catch (const std::exception& e)
+			{
+				LogError(LogCategory::Network) << "Failed to start metrics server: " << e.what();
+			}
+		}
 	}
 
 	bool ServerApplication::SetupNetwork(std::size_t clientPerReactor, std::size_t reactorCount, Nz::NetProtocol protocol, Nz::UInt16 firstPort)
@@ -234,7 +412,7 @@ namespace ewn
 		}
 		catch (const std::exception& e)
 		{
-			std::cerr << "Failed to start network reactors: " << e.what() << std::endl;
+			LogError(LogCategory::Network) << "Failed to start network reactors: " << e.what();
 			return false;
 		}
 	}
@@ -251,16 +429,31 @@ namespace ewn
 		m_config.RegisterStringOption("Database.Username");
 		m_config.RegisterIntegerOption("Database.WorkerCount", 1, 100);
 
+		m_config.RegisterIntegerOption("Security.AccountCacheDuration", 0, 7 * 24 * 3600); //< seconds, 0 disables the cache
 		m_config.RegisterIntegerOption("Security.Argon2.IterationCost");
 		m_config.RegisterIntegerOption("Security.Argon2.MemoryCost");
 		m_config.RegisterIntegerOption("Security.Argon2.ThreadCost");
 		m_config.RegisterIntegerOption("Security.HashLength");
+		m_config.RegisterIntegerOption("Security.Hashing.MaxQueueSize", 1, 100'000);
+		m_config.RegisterIntegerOption("Security.Hashing.WorkerCount", 1, 100);
+		m_config.RegisterIntegerOption("Security.LoginRateLimit.AccountBurst", 0, 1'000'000); //< 0 disables the limit
+		m_config.RegisterIntegerOption("Security.LoginRateLimit.AccountPerMinute", 1, 1'000'000);
+		m_config.RegisterIntegerOption("Security.LoginRateLimit.AddressBurst", 0, 1'000'000); //< 0 disables the limit
+		m_config.RegisterIntegerOption("Security.LoginRateLimit.AddressPerMinute", 1, 1'000'000);
 		m_config.RegisterStringOption("Security.PasswordSalt");
 
 		m_config.RegisterIntegerOption("Game.MaxClients", 0, 4096); //< 4096 due to ENet limitation
+		m_config.RegisterIntegerOption("Game.PhysicsThreadCount", 0, 64);
 		m_config.RegisterIntegerOption("Game.Port", 1, 0xFFFF);
+		m_config.RegisterFloatOption("Game.TickRate", 1.0, 1000.0);
 		m_config.RegisterIntegerOption("Game.WorkerCount", 1, 100);
 
+		m_config.RegisterIntegerOption("Metrics.Port", 0, 0xFFFF); //< 0 disables the metrics endpoint
+
+		m_config.RegisterStringOption("Relay.Secret"); //< empty refuses every relay
+
+		m_config.RegisterStringOption("Replay.Folder"); //< empty disables replay recording
+
 		m_config.RegisterStringOption("DefaultSpaceship.Hull");
 		m_config.RegisterStringOption("DefaultSpaceship.Modules");
 		m_config.RegisterStringOption("DefaultSpaceship.Name");
@@ -269,13 +462,69 @@ namespace ewn
 
 	void ServerApplication::RegisterNetworkedStrings()
 	{
-		m_stringStore.RegisterString("earth");
-		m_stringStore.RegisterString("light");
-		m_stringStore.RegisterString("plasmabeam");
-		m_stringStore.RegisterString("torpedo");
 		m_stringStore.RegisterString("explosion_flare");
 		m_stringStore.RegisterString("explosion_fire");
 		m_stringStore.RegisterString("explosion_smoke");
 		m_stringStore.RegisterString("explosion_wave");
 	}
+
+	void ServerApplication::UpdateMetrics()
+	{
+		// Values owned by other threads are sampled here instead of being looked up when scraped
+		for (std::size_t reactorId = 0; reactorId < GetReactorCount(); ++reactorId)
+		{
+			const std::unique_ptr<NetworkReactor>& reactor = GetReactor(reactorId);
+			std::string reactorLabel = std::to_string(reactorId);
+
+			m_metrics.GetGauge("erewhon_network_incoming_queue_size", "Number of network events waiting to be handled by the server", { { "reactor", reactorLabel } }).Set(static_cast<double>(reactor->GetIncomingQueueSize()));
+			m_metrics.GetGauge("erewhon_network_outgoing_queue_size", "Number of network events waiting to be handled by the reactor", { { "reactor", reactorLabel } }).Set(static_cast<double>(reactor->GetOutgoingQueueSize()));
+
+			for (std::size_t channelId = 0; channelId < NetworkChannelCount; ++channelId)
+			{
+				NetworkReactor::ChannelStats stats = reactor->GetChannelStats(static_cast<Nz::UInt8>(channelId));
+				MetricsRegistry::Labels labels = { { "reactor", reactorLabel }, { "channel", std::to_string(channelId) } };
+
+				m_metrics.GetCounter("erewhon_network_received_bytes_total", "Bytes received per channel", labels).SetTotal(stats.receivedBytes);
+				m_metrics.GetCounter("erewhon_network_received_packets_total", "Packets received per channel", labels).SetTotal(stats.receivedPackets);
+				m_metrics.GetCounter("erewhon_network_sent_bytes_total", "Bytes sent per channel", labels).SetTotal(stats.sentBytes);
+				m_metrics.GetCounter("erewhon_network_sent_packets_total", "Packets sent per channel", labels).SetTotal(stats.sentPackets);
+			}
+		}
+
+		if (m_globalDatabase)
+		{
+			MetricsRegistry::Labels labels = { { "database", m_globalDatabase->GetName() } };
+
+			Nz::UInt64 busyTime = m_globalDatabase->GetWorkerBusyTime();
+			Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+
+			Nz::UInt64 elapsedTime = now - m_lastDatabaseMetricsTime;
+			std::size_t workerCount = m_globalDatabase->GetWorkerCount();
+
+			double idleRatio = 1.0;
+			if (elapsedTime > 0 && workerCount > 0)
+				idleRatio = 1.0 - std::min(static_cast<double>(busyTime - m_lastDatabaseBusyTime) / (elapsedTime * workerCount), 1.0);
+
+			m_lastDatabaseBusyTime = busyTime;
+			m_lastDatabaseMetricsTime = now;
+
+			m_metrics.GetGauge("erewhon_database_pending_requests", "Number of requests waiting for a database worker", labels).Set(static_cast<double>(m_globalDatabase->GetPendingRequestCount()));
+			m_metrics.GetGauge("erewhon_database_worker_idle_ratio", "Fraction of time database workers spent waiting for requests since the last sample", labels).Set(idleRatio);
+		}
+
+		if (m_passwordHasher)
+			m_metrics.GetGauge("erewhon_password_hash_queue_size", "Number of password hashes waiting for or being computed").Set(static_cast<double>(m_passwordHasher->GetQueueSize()));
+
+		m_metrics.GetGauge("erewhon_account_cache_entries", "Number of accounts kept in memory for fast reconnection", { { "kind", "account" } }).Set(static_cast<double>(m_accountCache.GetAccountCount()));
+		m_metrics.GetGauge("erewhon_account_cache_entries", "Number of accounts kept in memory for fast reconnection", { { "kind", "token" } }).Set(static_cast<double>(m_accountCache.GetTokenCount()));
+		m_metrics.GetGauge("erewhon_login_rate_limit_buckets", "Number of addresses and accounts tracked by login rate limiting").Set(static_cast<double>(m_loginAccountLimiter.GetBucketCount() + m_loginAddressLimiter.GetBucketCount()));
+
+		for (const auto& arenaPtr : m_arenas)
+			arenaPtr->UpdateMetrics();
+
+		m_metrics.GetCounter("erewhon_tick_overruns_total", "Ticks which took longer than the tick interval").SetTotal(m_tickScheduler.GetOverrunCount());
+		m_metrics.GetCounter("erewhon_tick_skipped_total", "Ticks dropped because the server was too late").SetTotal(m_tickScheduler.GetSkippedTickCount());
+		m_metrics.GetCounter("erewhon_ticks_total", "Ticks run by the server").SetTotal(m_tickScheduler.GetTickCount());
+		m_metrics.GetGauge("erewhon_sessions", "Number of connected client sessions").Set(static_cast<double>(m_sessions.GetCount()));
+	}
 }
@@ -8,15 +8,25 @@
 #define EREWHON_SERVER_APPLICATION_HPP
 
 #include <Shared/BaseApplication.hpp>
+#include <Shared/Protocol/CachedPacket.hpp>
 #include <Shared/Protocol/NetworkStringStore.hpp>
 #include <Nazara/Core/MemoryPool.hpp>
+#include <Server/AccountCache.hpp>
 #include <Server/Arena.hpp>
 #include <Server/GameWorker.hpp>
 #include <Server/GlobalDatabase.hpp>
+#include <Server/MetricsRegistry.hpp>
+#include <Server/MetricsServer.hpp>
+#include <Server/PasswordHasher.hpp>
+#include <Server/RateLimiter.hpp>
 #include <Server/ServerCommandStore.hpp>
 #include <Server/ServerChatCommandStore.hpp>
+#include <Server/SlotMap.hpp>
+#include <Server/TickScheduler.hpp>
+#include <Server/TimingHistogram.hpp>
 #include <Server/Store/CollisionMeshStore.hpp>
 #include <Server/Store/ModuleStore.hpp>
+#include <Server/Store/PrefabStore.hpp>
 #include <Server/Store/SpaceshipHullStore.hpp>
 #include <Server/Store/VisualMeshStore.hpp>
 #include <optional>
@@ -30,16 +40,21 @@ namespace ewn
 
 		public:
 			struct DefaultSpaceship;
+			struct TickTimings;
 			using ServerCallback = std::function<void()>;
+			using SessionHandle = SlotMap<ClientSession>::Handle;
 			using WorkerFunction = std::function<void()>;
 
 			ServerApplication();
 			virtual ~ServerApplication();
 
+			bool ConsumeLoginAttempt(const Nz::IpAddress& address, const std::string& login, Nz::UInt64* retryAfter);
+
 			Arena& CreateArena(std::string name, std::string script);
 
 			inline void DispatchWork(WorkerFunction workFunc);
 
+			inline AccountCache& GetAccountCache();
 			inline Arena* GetArena(std::size_t arenaIndex) const;
 			inline std::size_t GetArenaCount() const;
 			inline ServerChatCommandStore& GetChatCommandStore();
@@ -48,17 +63,26 @@ namespace ewn
 			inline const CollisionMeshStore& GetCollisionMeshStore() const;
 			inline const DefaultSpaceship& GetDefaultSpaceshipData() const;
 			inline Database& GetGlobalDatabase();
+			inline MetricsRegistry& GetMetrics();
 			inline ModuleStore& GetModuleStore();
 			inline const ModuleStore& GetModuleStore() const;
 			inline std::size_t GetPeerPerReactor() const;
-			inline Player* GetPlayerBySession(std::size_t sessionId);
+			inline Player* GetPlayerBySession(SessionHandle sessionId) const;
 			inline const NetworkStringStore& GetNetworkStringStore() const;
+			const CachedPacket<Packets::NetworkStrings>& GetNetworkStringsPacket();
+			inline PasswordHasher& GetPasswordHasher();
+			inline const PrefabStore& GetPrefabStore() const;
 			inline SpaceshipHullStore& GetSpaceshipHullStore();
 			inline const SpaceshipHullStore& GetSpaceshipHullStore() const;
+			inline const TickScheduler& GetTickScheduler() const;
+			inline const TickTimings& GetTickTimings() const;
 			inline VisualMeshStore& GetVisualMeshStore();
 			inline const VisualMeshStore& GetVisualMeshStore() const;
 
 			bool LoadDatabase();
+			bool LoadPrefabs(const std::string& fileName);
+
+			inline void QueueLastLoginUpdate(Nz::Int32 accountId);
 
 			bool Run() override;
 
@@ -74,15 +98,32 @@ namespace ewn
 				std::vector<std::size_t> moduleIds;
 			};
 
+			// Time spent (in microseconds) in each part of a server tick
+			struct TickTimings
+			{
+				TimingHistogram arenas;
+				TimingHistogram callbacks;
+				TimingHistogram database;
+				TimingHistogram network;
+			};
+
 		private:
+			struct WorkerJob
+			{
+				WorkerFunction function;
+				Nz::UInt64 enqueueTime; //< microseconds
+			};
+
 			using CallbackQueue = moodycamel::ConcurrentQueue<ServerCallback>;
-			using WorkerQueue = moodycamel::BlockingConcurrentQueue<WorkerFunction>;
+			using WorkerQueue = moodycamel::BlockingConcurrentQueue<WorkerJob>;
 
 			bool BakeDefaultSpaceshipData();
 
+			void FlushAccountUpdates();
+
 			inline WorkerQueue& GetWorkerQueue();
 
-			void HandlePeerConnection(bool outgoing, std::size_t peerId, Nz::UInt32 data) override;
+			void HandlePeerConnection(bool outgoing, std::size_t peerId, const Nz::IpAddress& remoteAddress, Nz::UInt32 data) override;
 			void HandlePeerDisconnection(std::size_t peerId, Nz::UInt32 data) override;
 			void HandlePeerPacket(std::size_t peerId, Nz::NetPacket&& packet) override;
 
@@ -94,22 +135,38 @@ namespace ewn
 			void RegisterConfigOptions();
 			void RegisterNetworkedStrings();
 
+			void UpdateMetrics();
+
+			MetricsRegistry m_metrics; //< declared first as database and game workers report to it until they're destroyed
 			std::optional<GlobalDatabase> m_globalDatabase;
+			std::optional<PasswordHasher> m_passwordHasher;
+			std::unique_ptr<MetricsServer> m_metricsServer;
+			std::size_t m_networkStringsPacketCount;
 			std::size_t m_peerPerReactor;
-			std::size_t m_nextSessionId;
-			std::unordered_map<std::size_t /*sessionId*/, std::size_t /*peerId*/> m_sessionIdToPeer;
 			std::vector<std::unique_ptr<GameWorker>> m_workers;
-			std::vector<ClientSession*> m_sessions;
 			std::vector<std::unique_ptr<Arena>> m_arenas;
+			std::vector<Nz::Int32> m_pendingLastLoginUpdates;
+			Nz::UInt64 m_lastAccountFlush;
+			Nz::UInt64 m_lastDatabaseBusyTime;
+			Nz::UInt64 m_lastDatabaseMetricsTime;
+			Nz::UInt64 m_lastMetricsUpdate;
 			Nz::MemoryPool m_sessionPool;
+			AccountCache m_accountCache;
 			CallbackQueue m_callbackQueue;
 			CollisionMeshStore m_collisionMeshStore;
 			DefaultSpaceship m_defaultSpaceshipData;
 			ModuleStore m_moduleStore;
+			CachedPacket<Packets::NetworkStrings> m_networkStringsPacket;
 			NetworkStringStore m_stringStore;
+			PrefabStore m_prefabStore;
+			RateLimiter m_loginAccountLimiter;
+			RateLimiter m_loginAddressLimiter;
 			ServerChatCommandStore m_chatCommandStore;
 			ServerCommandStore m_commandStore;
+			SlotMap<ClientSession> m_sessions;
 			SpaceshipHullStore m_spaceshipHullStore;
+			TickScheduler m_tickScheduler;
+			TickTimings m_tickTimings;
 			VisualMeshStore m_visualMeshStore;
 			WorkerQueue m_workerQueue;
 	};
@@ -3,12 +3,22 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/ServerApplication.hpp>
+#include <Nazara/Core/Clock.hpp>
 
 namespace ewn
 {
 	inline void ServerApplication::DispatchWork(WorkerFunction workFunc)
 	{
-		m_workerQueue.enqueue(std::move(workFunc));
+		WorkerJob job;
+		job.enqueueTime = Nz::GetElapsedMicroseconds();
+		job.function = std::move(workFunc);
+
+		m_workerQueue.enqueue(std::move(job));
+	}
+
+	inline AccountCache& ServerApplication::GetAccountCache()
+	{
+		return m_accountCache;
 	}
 
 	inline Database& ServerApplication::GetGlobalDatabase()
@@ -17,6 +27,11 @@ namespace ewn
 		return *m_globalDatabase;
 	}
 
+	inline MetricsRegistry& ServerApplication::GetMetrics()
+	{
+		return m_metrics;
+	}
+
 	inline Arena* ServerApplication::GetArena(std::size_t arenaIndex) const
 	{
 		assert(arenaIndex < m_arenas.size());
@@ -68,11 +83,11 @@ namespace ewn
 		return m_peerPerReactor;
 	}
 
-	inline Player* ServerApplication::GetPlayerBySession(std::size_t sessionId)
+	// Returns nullptr if the session disconnected since the handle was taken, even if its peer id got reused
+	inline Player* ServerApplication::GetPlayerBySession(SessionHandle sessionId) const
 	{
-		auto it = m_sessionIdToPeer.find(sessionId);
-		if (it != m_sessionIdToPeer.end())
-			return m_sessions[it->second]->GetPlayer();
+		if (ClientSession* session = m_sessions.Resolve(sessionId))
+			return session->GetPlayer();
 		else
 			return nullptr;
 	}
@@ -82,6 +97,17 @@ namespace ewn
 		return m_stringStore;
 	}
 
+	inline PasswordHasher& ServerApplication::GetPasswordHasher()
+	{
+		assert(m_passwordHasher.has_value());
+		return *m_passwordHasher;
+	}
+
+	inline const PrefabStore& ServerApplication::GetPrefabStore() const
+	{
+		return m_prefabStore;
+	}
+
 	inline SpaceshipHullStore& ServerApplication::GetSpaceshipHullStore()
 	{
 		return m_spaceshipHullStore;
@@ -92,6 +118,16 @@ namespace ewn
 		return m_spaceshipHullStore;
 	}
 
+	inline const TickScheduler& ServerApplication::GetTickScheduler() const
+	{
+		return m_tickScheduler;
+	}
+
+	inline const ServerApplication::TickTimings& ServerApplication::GetTickTimings() const
+	{
+		return m_tickTimings;
+	}
+
 	inline VisualMeshStore& ServerApplication::GetVisualMeshStore()
 	{
 		return m_visualMeshStore;
@@ -102,6 +138,12 @@ namespace ewn
 		return m_visualMeshStore;
 	}
 
+	// Last login dates aren't needed right away, they are written by batches (see FlushAccountUpdates)
+	inline void ServerApplication::QueueLastLoginUpdate(Nz::Int32 accountId)
+	{
+		m_pendingLastLoginUpdates.push_back(accountId);
+	}
+
 	inline void ServerApplication::RegisterCallback(ServerCallback callback)
 	{
 		m_callbackQueue.enqueue(std::move(callback));
@@ -3,12 +3,20 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Server/ServerChatCommandStore.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <NDK/World.hpp>
 #include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Systems/PhysicsSystem3D.hpp>
 #include <Server/Arena.hpp>
+#include <Server/EntityPool.hpp>
 #include <Server/Player.hpp>
 #include <Server/ServerApplication.hpp>
 #include <Server/Components/HealthComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
+#include <algorithm>
+#include <ctime>
 
 namespace ewn
 {
@@ -29,11 +37,14 @@ namespace ewn
 
 	void ServerChatCommandStore::BuildStore(ServerApplication* /*app*/)
 	{
+		RegisterCommand("benchpool", &ServerChatCommandStore::HandleBenchmarkPool);
 		RegisterCommand("clearbots", &ServerChatCommandStore::HandleClearBots);
 		RegisterCommand("crashserver", &ServerChatCommandStore::HandleCrashServer);
 		RegisterCommand("debugparticles", &ServerChatCommandStore::HandleDebugParticles);
+		RegisterCommand("dumptrace", &ServerChatCommandStore::HandleDumpTrace);
 		RegisterCommand("kamikaze", &ServerChatCommandStore::HandleSuicide);
 		RegisterCommand("kick", &ServerChatCommandStore::HandleKickPlayer);
+		RegisterCommand("physicsthreads", &ServerChatCommandStore::HandlePhysicsThreads);
 		RegisterCommand("reloadarena", &ServerChatCommandStore::HandleReloadArena);
 		RegisterCommand("reloadmodules", &ServerChatCommandStore::HandleReloadModules);
 		RegisterCommand("resetarena", &ServerChatCommandStore::HandleResetArena);
@@ -41,7 +52,77 @@ namespace ewn
 		RegisterCommand("stopserver", &ServerChatCommandStore::HandleStopServer);
 		RegisterCommand("suicide", &ServerChatCommandStore::HandleSuicide);
 		RegisterCommand("spawnbot", &ServerChatCommandStore::HandleSpawnBot);
+		RegisterCommand("tickstats", &ServerChatCommandStore::HandleTickStats);
 		RegisterCommand("updatepermission", &ServerChatCommandStore::HandleUpdatePermission);
+		RegisterCommand("worldstats", &ServerChatCommandStore::HandleWorldStats);
+	}
+
+	bool ServerChatCommandStore::HandleBenchmarkPool(ServerApplication* app, Player* player, std::size_t entityCount)
+	{
+		if (player->GetPermissionLevel() < 30)
+			return false;
+
+		if (entityCount < 1 || entityCount > 10'000)
+		{
+			player->PrintMessage("Invalid count, must be in range [1,10000]");
+			return false;
+		}
+
+		constexpr std::size_t roundCount = 10;
+
+		const PrefabStore& prefabStore = app->GetPrefabStore();
+		std::size_t torpedoPrefabId = prefabStore.GetEntryByName("torpedo");
+
+		// Use a scratch world to measure torpedo spawn/kill throughput without disturbing the arena
+		Ndk::World world;
+		world.GetSystem<Ndk::PhysicsSystem3D>().GetWorld().CreateMaterial("torpedo");
+
+		std::vector<Ndk::EntityHandle> entities;
+		entities.reserve(entityCount);
+
+		Nz::UInt64 startTime = Nz::GetElapsedMicroseconds();
+		for (std::size_t round = 0; round < roundCount; ++round)
+		{
+			for (std::size_t i = 0; i < entityCount; ++i)
+				prefabStore.BuildEntity(torpedoPrefabId, entities.emplace_back(world.CreateEntity()));
+
+			world.Refresh();
+
+			for (const Ndk::EntityHandle& entity : entities)
+				entity->Kill();
+
+			entities.clear();
+			world.Refresh();
+		}
+		Nz::UInt64 withoutPoolTime = Nz::GetElapsedMicroseconds() - startTime;
+
+		EntityPool pool(world, [&](const Ndk::EntityHandle& entity) { prefabStore.BuildEntity(torpedoPrefabId, entity); });
+
+		startTime = Nz::GetElapsedMicroseconds();
+		for (std::size_t round = 0; round < roundCount; ++round)
+		{
+			for (std::size_t i = 0; i < entityCount; ++i)
+				entities.emplace_back(pool.Acquire());
+
+			world.Refresh();
+
+			for (const Ndk::EntityHandle& entity : entities)
+				pool.Release(entity);
+
+			entities.clear();
+			world.Refresh();
+		}
+		Nz::UInt64 withPoolTime = Nz::GetElapsedMicroseconds() - startTime;
+
+		auto Throughput = [&](Nz::UInt64 elapsedTime)
+		{
+			return std::to_string(static_cast<Nz::UInt64>(entityCount * roundCount * 1'000'000.0 / std::max<Nz::UInt64>(elapsedTime, 1)));
+		};
+
+		player->PrintMessage("Spawn/kill per second without pool: " + Throughput(withoutPoolTime));
+		player->PrintMessage("Spawn/kill per second with pool: " + Throughput(withPoolTime) + " (" + std::to_string(pool.GetCreatedCount()) + " entities created)");
+
+		return true;
 	}
 
 	bool ServerChatCommandStore::HandleClearBots(ServerApplication* /*app*/, Player* player)
@@ -81,6 +162,34 @@ namespace ewn
 		return false;
 	}
 
+	bool ServerChatCommandStore::HandleDumpTrace(ServerApplication* /*app*/, Player* player, unsigned int duration)
+	{
+		if (player->GetPermissionLevel() < 40)
+			return false;
+
+		if constexpr (!Profiler::IsEnabled())
+		{
+			player->PrintMessage("This server was built without profiling support (see premake5 --profiling)");
+			return false;
+		}
+
+		if (duration < 1 || duration > 60)
+		{
+			player->PrintMessage("Invalid duration, must be in range [1,60]");
+			return false;
+		}
+
+		std::string filePath = "trace_" + std::to_string(std::time(nullptr)) + ".json";
+		if (!Profiler::ExportChromeTrace(filePath, duration * 1'000'000ULL))
+		{
+			player->PrintMessage("Failed to write " + filePath);
+			return false;
+		}
+
+		player->PrintMessage("Last " + std::to_string(duration) + "s written to " + filePath + " (open it with chrome://tracing)");
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleKickPlayer(ServerApplication* app, Player* player, Player* target)
 	{
 		if (player->GetPermissionLevel() < 30)
@@ -96,6 +205,25 @@ namespace ewn
 		return true;
 	}
 
+	bool ServerChatCommandStore::HandlePhysicsThreads(ServerApplication* /*app*/, Player* player, unsigned int threadCount)
+	{
+		if (player->GetPermissionLevel() < 40)
+			return false;
+
+		Arena* arena = player->GetArena();
+		if (!arena)
+			return false;
+
+		if (threadCount > 64)
+		{
+			player->PrintMessage("Invalid thread count, must be in range [0,64]");
+			return false;
+		}
+
+		arena->SetPhysicsThreadCount(threadCount);
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleReloadArena(ServerApplication * app, Player * player)
 	{
 		if (player->GetPermissionLevel() < 30)
@@ -160,7 +288,7 @@ namespace ewn
 		app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipByOwnerIdAndName", { Nz::Int32(player->GetDatabaseId()), spaceshipName }, [app, spaceshipCount, sessionId = player->GetSessionId(), spaceshipName](DatabaseResult& result)
 		{
 			if (!result)
-				std::cerr << "Find spaceship query failed: " << result.GetLastErrorMessage() << std::endl;
+				LogError(LogCategory::Database) << "Find spaceship query failed: " << result.GetLastErrorMessage();
 
 			Player* ply = app->GetPlayerBySession(sessionId);
 			if (!ply)
@@ -185,7 +313,7 @@ namespace ewn
 			app->GetGlobalDatabase().ExecuteStatement("FindSpaceshipModulesBySpaceshipId", { spaceshipId }, [app, ply, spaceshipHullId, spaceshipCount, shipName = std::move(spaceshipName), spaceshipCode = std::move(code)](DatabaseResult& result)
 			{
 				if (!result)
-					std::cerr << "Find spaceship modules failed: " << result.GetLastErrorMessage() << std::endl;
+					LogError(LogCategory::Database) << "Find spaceship modules failed: " << result.GetLastErrorMessage();
 
 				if (!ply)
 					return;
@@ -206,7 +334,7 @@ namespace ewn
 				}
 				catch (const std::exception& e)
 				{
-					std::cerr << "Failed to retrieve spaceship modules: " << e.what() << std::endl;
+					LogError(LogCategory::Database) << "Failed to retrieve spaceship modules: " << e.what();
 
 					ply->PrintMessage("Failed to retrieve spaceship modules, please contact an administrator");
 					return;
@@ -254,6 +382,38 @@ namespace ewn
 		return true;
 	}
 
+	bool ServerChatCommandStore::HandleTickStats(ServerApplication* app, Player* player)
+	{
+		if (player->GetPermissionLevel() < 20)
+			return false;
+
+		const TickScheduler& scheduler = app->GetTickScheduler();
+		player->PrintMessage(std::to_string(scheduler.GetTickRate()) + " ticks/s: " + std::to_string(scheduler.GetTickCount()) + " ticks, " + std::to_string(scheduler.GetOverrunCount()) + " overruns, " + std::to_string(scheduler.GetCatchUpTickCount()) + " catch-up ticks, " + std::to_string(scheduler.GetSkippedTickCount()) + " skipped ticks");
+		player->PrintMessage("Tick: " + scheduler.GetTickTimes().ToString());
+
+		const ServerApplication::TickTimings& tickTimings = app->GetTickTimings();
+		player->PrintMessage("- Arenas: " + tickTimings.arenas.ToString());
+		player->PrintMessage("- Callbacks: " + tickTimings.callbacks.ToString());
+		player->PrintMessage("- Database: " + tickTimings.database.ToString());
+		player->PrintMessage("- Network: " + tickTimings.network.ToString());
+
+		if (Arena* arena = player->GetArena())
+		{
+			const Arena::UpdateTimings& updateTimings = arena->GetUpdateTimings();
+			player->PrintMessage(arena->GetName() + ":");
+			player->PrintMessage("- World: " + updateTimings.world.ToString());
+			for (const auto& [systemName, systemTimings] : updateTimings.systems)
+				player->PrintMessage("  - " + systemName + ": " + systemTimings->GetHistogram().ToString());
+			player->PrintMessage("- Collisions: " + updateTimings.collisions.ToString());
+			player->PrintMessage("- Projectiles: " + updateTimings.projectiles.ToString());
+			player->PrintMessage("- Players: " + updateTimings.players.ToString());
+			player->PrintMessage("- Script: " + updateTimings.script.ToString());
+			player->PrintMessage("- Flush: " + updateTimings.flush.ToString());
+		}
+
+		return true;
+	}
+
 	bool ServerChatCommandStore::HandleUpdatePermission(ServerApplication* app, Player* player, Player* target, Nz::UInt16 permissionLevel)
 	{
 		if (permissionLevel >= player->GetPermissionLevel())
@@ -281,4 +441,20 @@ namespace ewn
 
 		return false;
 	}
+
+	bool ServerChatCommandStore::HandleWorldStats(ServerApplication* app, Player* player)
+	{
+		if (player->GetPermissionLevel() < 20)
+			return false;
+
+		for (std::size_t i = 0; i < app->GetArenaCount(); ++i)
+		{
+			Arena* arena = app->GetArena(i);
+			const Arena::WorldStats& stats = arena->GetWorldStats();
+
+			player->PrintMessage(arena->GetName() + ": " + std::to_string(stats.updateCount) + " world updates/s, avg " + std::to_string(stats.averageUpdateTime) + "us, max " + std::to_string(stats.maxUpdateTime) + "us, physics avg " + std::to_string(stats.averagePhysicsTime) + "us, max " + std::to_string(stats.maxPhysicsTime) + "us (" + std::to_string(arena->GetPhysicsThreadCount()) + " physics threads)");
+		}
+
+		return true;
+	}
 }
@@ -23,10 +23,13 @@ namespace ewn
 		private:
 			void BuildStore(ServerApplication* app);
 
+			static bool HandleBenchmarkPool(ServerApplication* app, Player* player, std::size_t entityCount);
 			static bool HandleClearBots(ServerApplication* app, Player* player);
 			static bool HandleCrashServer(ServerApplication* app, Player* player);
 			static bool HandleDebugParticles(ServerApplication* app, Player* player, unsigned int particleSystemId);
+			static bool HandleDumpTrace(ServerApplication* app, Player* player, unsigned int duration);
 			static bool HandleKickPlayer(ServerApplication* app, Player* player, Player* target);
+			static bool HandlePhysicsThreads(ServerApplication* app, Player* player, unsigned int threadCount);
 			static bool HandleReloadArena(ServerApplication* app, Player* player);
 			static bool HandleReloadModules(ServerApplication* app, Player* player);
 			static bool HandleResetArena(ServerApplication* app, Player* player);
@@ -34,7 +37,9 @@ namespace ewn
 			static bool HandleSpawnFleet(ServerApplication* app, Player* player, std::string fleetName);
 			static bool HandleSuicide(ServerApplication* app, Player* player);
 			static bool HandleStopServer(ServerApplication* app, Player* player);
+			static bool HandleTickStats(ServerApplication* app, Player* player);
 			static bool HandleUpdatePermission(ServerApplication* app, Player* player, Player* target, Nz::UInt16 permissionLevel);
+			static bool HandleWorldStats(ServerApplication* app, Player* player);
 	};
 }
 
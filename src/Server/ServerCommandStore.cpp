@@ -9,16 +9,14 @@ namespace ewn
 {
 	ServerCommandStore::ServerCommandStore()
 	{
-#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type>(#Type, [](ClientSession& session, const Packets::Type& packet) \
-{ \
-	session.Handle##Type(packet); \
-})
+#define IncomingCommand(Type) RegisterIncomingCommand<Packets::Type, &ClientSession::Handle##Type>(#Type)
 #define OutgoingCommand(Type, Flags, Channel) RegisterOutgoingCommand<Packets::Type>(#Type, Flags, Channel)
 
 		// Incoming commands
 		IncomingCommand(ControlEntity);
 		IncomingCommand(CreateFleet);
 		IncomingCommand(CreateSpaceship);
+		IncomingCommand(DeclareCachedPackets);
 		IncomingCommand(DeleteFleet);
 		IncomingCommand(DeleteSpaceship);
 		IncomingCommand(JoinArena);
@@ -36,6 +34,7 @@ namespace ewn
 		IncomingCommand(QuerySpaceshipInfo);
 		IncomingCommand(QuerySpaceshipList);
 		IncomingCommand(Register);
+		IncomingCommand(RelayLogin);
 		IncomingCommand(TimeSyncRequest);
 		IncomingCommand(UpdateFleet);
 		IncomingCommand(UpdateSpaceship);
@@ -47,21 +46,25 @@ namespace ewn
 		OutgoingCommand(ArenaSounds,               Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(ArenaState,                0,                           1);
 		OutgoingCommand(BotMessage,                Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CachedPacketVersion,       Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(ChatMessage,               Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(ControlEntity,             Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(CreateEntities,            Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(CreateFleetFailure,        Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(CreateFleetSuccess,        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(CreateProjectiles,         Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(CreateSpaceshipFailure,    Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(CreateSpaceshipSuccess,    Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(DeleteEntities,            Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(DeleteFleetFailure,        Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(DeleteFleetSuccess,        Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(DeleteProjectiles,         Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(DeleteSpaceshipFailure,    Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(DeleteSpaceshipSuccess,    Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(FleetInfo,                 Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(FleetList,                 Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(HullList,                  Nz::ENetPacketFlag_Reliable, 0);
+		OutgoingCommand(InstantiateEffects,        Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(InstantiateParticleSystem, Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(IntegrityUpdate,           Nz::ENetPacketFlag_Reliable, 0);
 		OutgoingCommand(LoginFailure,              Nz::ENetPacketFlag_Reliable, 0);
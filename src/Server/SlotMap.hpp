@@ -0,0 +1,55 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_SLOTMAP_HPP
+#define EREWHON_SERVER_SLOTMAP_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <vector>
+
+namespace ewn
+{
+	// Non-owning table of objects stored by index, referenced from the outside by generational handles
+	// A handle packs the slot index with the slot generation, which is incremented on removal:
+	// resolving it is a bounds-checked array access and a stale handle resolves to nullptr even once its slot got reused
+	template<typename T>
+	class SlotMap
+	{
+		public:
+			using Handle = Nz::UInt64;
+
+			SlotMap();
+			~SlotMap() = default;
+
+			template<typename F> void ForEach(F&& callback) const;
+
+			inline T* Get(std::size_t index) const;
+			inline std::size_t GetCount() const;
+			inline Handle GetHandle(std::size_t index) const;
+
+			void Insert(std::size_t index, T* object);
+
+			void Remove(std::size_t index);
+
+			T* Resolve(Handle handle) const;
+
+			static constexpr Handle InvalidHandle = 0;
+
+		private:
+			struct Slot
+			{
+				T* object = nullptr;
+				Nz::UInt32 generation = 1; //< handles of the first generation are never equal to InvalidHandle
+			};
+
+			std::vector<Slot> m_slots;
+			std::size_t m_count;
+	};
+}
+
+#include <Server/SlotMap.inl>
+
+#endif // EREWHON_SERVER_SLOTMAP_HPP
@@ -0,0 +1,94 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/SlotMap.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	template<typename T>
+	SlotMap<T>::SlotMap() :
+	m_count(0)
+	{
+	}
+
+	template<typename T>
+	template<typename F>
+	void SlotMap<T>::ForEach(F&& callback) const
+	{
+		for (const Slot& slot : m_slots)
+		{
+			if (slot.object)
+				callback(slot.object);
+		}
+	}
+
+	template<typename T>
+	T* SlotMap<T>::Get(std::size_t index) const
+	{
+		return (index < m_slots.size()) ? m_slots[index].object : nullptr;
+	}
+
+	template<typename T>
+	std::size_t SlotMap<T>::GetCount() const
+	{
+		return m_count;
+	}
+
+	// Returns the handle an object stored at this index is (or will be, if the slot is free) reachable with
+	template<typename T>
+	auto SlotMap<T>::GetHandle(std::size_t index) const -> Handle
+	{
+		assert(index <= 0xFFFFFFFF);
+
+		Nz::UInt32 generation = (index < m_slots.size()) ? m_slots[index].generation : Slot{}.generation;
+		return (Handle(generation) << 32) | Handle(index);
+	}
+
+	template<typename T>
+	void SlotMap<T>::Insert(std::size_t index, T* object)
+	{
+		assert(object);
+
+		if (index >= m_slots.size())
+			m_slots.resize(index + 1);
+
+		Slot& slot = m_slots[index];
+		assert(!slot.object);
+
+		slot.object = object;
+		m_count++;
+	}
+
+	template<typename T>
+	void SlotMap<T>::Remove(std::size_t index)
+	{
+		assert(index < m_slots.size() && m_slots[index].object);
+
+		Slot& slot = m_slots[index];
+		slot.object = nullptr;
+
+		// Invalidates every handle given for this slot until now (zero is skipped to keep InvalidHandle unreachable)
+		if (++slot.generation == 0)
+			slot.generation = 1;
+
+		m_count--;
+	}
+
+	template<typename T>
+	T* SlotMap<T>::Resolve(Handle handle) const
+	{
+		std::size_t index = static_cast<std::size_t>(handle & 0xFFFFFFFF);
+		Nz::UInt32 generation = static_cast<Nz::UInt32>(handle >> 32);
+
+		if (index >= m_slots.size())
+			return nullptr;
+
+		const Slot& slot = m_slots[index];
+		if (slot.generation != generation)
+			return nullptr;
+
+		return slot.object;
+	}
+}
@@ -10,7 +10,7 @@
 #include <Server/ServerApplication.hpp>
 #include <Server/Database/Database.hpp>
 #include <Server/Database/DatabaseResult.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -99,11 +99,11 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to load collision mesh #" << meshData.id << ": " << e.what() << std::endl;
+				LogError(LogCategory::Store) << "Failed to load collision mesh #" << meshData.id << ": " << e.what();
 			}
 		}
 
-		std::cout << "Loaded " << meshLoaded << " collision meshes (" << (meshCount - meshLoaded) << " errored)" << std::endl;
+		LogInfo(LogCategory::Store) << "Loaded " << meshLoaded << " collision meshes (" << (meshCount - meshLoaded) << " errored)";
 
 		return true;
 	}
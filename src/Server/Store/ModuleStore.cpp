@@ -11,7 +11,7 @@
 #include <Server/Modules/RadarModule.hpp>
 #include <Server/Modules/PlasmaBeamWeaponModule.hpp>
 #include <Server/Modules/TorpedoWeaponModule.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -22,13 +22,13 @@ namespace ewn
 		const ModuleInfo& moduleInfo = m_moduleInfos[moduleId];
 		if (!moduleInfo.doesExist)
 		{
-			std::cerr << "Failed to build module: module #" << moduleId << " does not exist" << std::endl;
+			LogError(LogCategory::Store) << "Failed to build module: module #" << moduleId << " does not exist";
 			return {};
 		}
 
 		if (!moduleInfo.isLoaded)
 		{
-			std::cerr << "Failed to build module: module #" << moduleId << " exists but failed to load" << std::endl;
+			LogError(LogCategory::Store) << "Failed to build module: module #" << moduleId << " exists but failed to load";
 			return {};
 		}
 
@@ -42,7 +42,7 @@ namespace ewn
 		}
 		catch (const std::exception& e)
 		{
-			std::cerr << "Failed to build module: module #" << moduleId << " has invalid info: " << e.what() << std::endl;
+			LogError(LogCategory::Store) << "Failed to build module: module #" << moduleId << " has invalid info: " << e.what();
 			return {};
 		}
 
@@ -139,11 +139,11 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to load module #" << id << ": " << e.what() << std::endl;
+				LogError(LogCategory::Store) << "Failed to load module #" << id << ": " << e.what();
 			}
 		}
 
-		std::cout << "Loaded " << moduleLoaded << " modules (" << (moduleCount - moduleLoaded) << " errored)" << std::endl;
+		LogInfo(LogCategory::Store) << "Loaded " << moduleLoaded << " modules (" << (moduleCount - moduleLoaded) << " errored)";
 
 		return true;
 	}
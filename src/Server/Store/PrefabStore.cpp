@@ -0,0 +1,321 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Store/PrefabStore.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Protocol/NetworkStringStore.hpp>
+#include <Nazara/Lua/LuaInstance.hpp>
+#include <Nazara/Math/EulerAngles.hpp>
+#include <NDK/Components/CollisionComponent3D.hpp>
+#include <NDK/Components/NodeComponent.hpp>
+#include <NDK/Components/PhysicsComponent3D.hpp>
+#include <Server/Components/LifeTimeComponent.hpp>
+#include <Server/Components/ProjectileComponent.hpp>
+#include <Server/Components/SignatureComponent.hpp>
+#include <Server/Components/SynchronizedComponent.hpp>
+#include <stdexcept>
+
+namespace ewn
+{
+	namespace
+	{
+		// Every helper reads from the table on top of the stack and leaves the stack as it found it
+
+		bool GetBooleanField(Nz::LuaInstance& lua, const char* fieldName, bool defaultValue)
+		{
+			bool value = defaultValue;
+			if (lua.GetField(fieldName) == Nz::LuaType_Boolean)
+				value = lua.ToBoolean(-1);
+
+			lua.Pop();
+			return value;
+		}
+
+		float GetNumberField(Nz::LuaInstance& lua, const char* fieldName, float defaultValue)
+		{
+			float value = defaultValue;
+			if (lua.GetField(fieldName) == Nz::LuaType_Number)
+				value = static_cast<float>(lua.ToNumber(-1));
+
+			lua.Pop();
+			return value;
+		}
+
+		std::string GetStringField(Nz::LuaInstance& lua, const char* fieldName, std::string defaultValue)
+		{
+			std::string value = std::move(defaultValue);
+			if (lua.GetField(fieldName) == Nz::LuaType_String)
+				value = lua.ToString(-1);
+
+			lua.Pop();
+			return value;
+		}
+
+		// Accepts either a number (used for every component) or a { x, y, z } table
+		Nz::Vector3f GetVectorField(Nz::LuaInstance& lua, const char* fieldName, const Nz::Vector3f& defaultValue)
+		{
+			Nz::Vector3f value = defaultValue;
+			switch (lua.GetField(fieldName))
+			{
+				case Nz::LuaType_Number:
+					value = Nz::Vector3f(static_cast<float>(lua.ToNumber(-1)));
+					break;
+
+				case Nz::LuaType_Table:
+				{
+					for (int i = 0; i < 3; ++i)
+					{
+						lua.PushInteger(i + 1);
+						if (lua.GetTable() != Nz::LuaType_Number)
+							throw std::runtime_error(std::string(fieldName) + " must contain three numbers");
+
+						value[i] = static_cast<float>(lua.ToNumber(-1));
+						lua.Pop();
+					}
+					break;
+				}
+
+				default:
+					break;
+			}
+
+			lua.Pop();
+			return value;
+		}
+
+		template<typename F>
+		void ForEachArrayField(Nz::LuaInstance& lua, const char* fieldName, F&& func)
+		{
+			if (lua.GetField(fieldName) == Nz::LuaType_Table)
+			{
+				for (int i = 1;; ++i)
+				{
+					lua.PushInteger(i);
+					if (lua.GetTable() == Nz::LuaType_Nil)
+					{
+						lua.Pop();
+						break;
+					}
+
+					func();
+					lua.Pop();
+				}
+			}
+
+			lua.Pop();
+		}
+	}
+
+	void PrefabStore::BuildEntity(std::size_t entryId, const Ndk::EntityHandle& entity, std::string name) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		const PrefabInfo& prefab = m_prefabInfos[entryId];
+
+		// Colliders are immutable once built, every instance of a prefab shares the same one
+		if (prefab.collider)
+			entity->AddComponent<Ndk::CollisionComponent3D>(prefab.collider);
+
+		if (prefab.lifeTime > 0.f)
+			entity->AddComponent<LifeTimeComponent>(prefab.lifeTime);
+
+		if (prefab.projectile)
+			entity->AddComponent<ProjectileComponent>(prefab.projectile->damage);
+
+		if (prefab.signature)
+			entity->AddComponent<SignatureComponent>(entity->GetId(), prefab.signature->emSignature, prefab.signature->size, prefab.signature->volume);
+
+		entity->AddComponent<SynchronizedComponent>(entryId, prefab.name, std::move(name), prefab.isMovable, prefab.networkPriority);
+		entity->AddComponent<Ndk::NodeComponent>();
+
+		if (prefab.physics)
+		{
+			const PhysicsInfo& physics = *prefab.physics;
+
+			auto& physComponent = entity->AddComponent<Ndk::PhysicsComponent3D>();
+			if (physics.angularDamping)
+				physComponent.SetAngularDamping(*physics.angularDamping);
+
+			if (physics.linearDamping)
+				physComponent.SetLinearDamping(*physics.linearDamping);
+
+			if (physics.material)
+				physComponent.SetMaterial(*physics.material);
+
+			physComponent.SetMass(physics.mass);
+		}
+	}
+
+	bool PrefabStore::LoadFromFile(const std::string& fileName, NetworkStringStore& stringStore)
+	{
+		Nz::LuaInstance lua;
+		lua.LoadLibraries();
+
+		if (!lua.ExecuteFromFile(fileName))
+		{
+			LogError(LogCategory::Store) << "Failed to parse " << fileName << ": " << lua.GetLastError();
+			return false;
+		}
+
+		if (lua.GetGlobal("Prefabs") != Nz::LuaType_Table)
+		{
+			LogError(LogCategory::Store) << fileName << " has no Prefabs table";
+			return false;
+		}
+
+		Packets::ArenaPrefabs arenaPrefabs;
+		arenaPrefabs.startId = 0;
+
+		m_arenaPrefabs.Invalidate();
+		m_prefabIndices.clear();
+		m_prefabInfos.clear();
+
+		// Prefabs are stored in a Lua array so their ids are stable
+		for (int prefabIndex = 1;; ++prefabIndex)
+		{
+			lua.PushInteger(prefabIndex);
+			if (lua.GetTable() == Nz::LuaType_Nil)
+				break;
+
+			std::size_t prefabId = m_prefabInfos.size();
+
+			try
+			{
+				if (!lua.IsOfType(-1, Nz::LuaType_Table))
+					throw std::runtime_error("table expected");
+
+				PrefabInfo& prefab = m_prefabInfos.emplace_back();
+				prefab.name = GetStringField(lua, "Name", std::string());
+				if (prefab.name.empty())
+					throw std::runtime_error("missing name");
+
+				if (!m_prefabIndices.emplace(prefab.name, prefabId).second)
+					throw std::runtime_error("name \"" + prefab.name + "\" is already used by another prefab");
+
+				prefab.isMovable = GetBooleanField(lua, "Movable", false);
+				prefab.lifeTime = GetNumberField(lua, "LifeTime", 0.f);
+				prefab.networkPriority = static_cast<Nz::UInt16>(GetNumberField(lua, "NetworkPriority", 0.f));
+				prefab.poolSize = static_cast<std::size_t>(GetNumberField(lua, "PoolSize", 0.f));
+
+				double colliderSize = 0.0;
+				double colliderVolume = 0.0;
+				if (lua.GetField("Collider") == Nz::LuaType_Table)
+				{
+					std::string colliderType = GetStringField(lua, "Type", std::string());
+					if (colliderType == "Box")
+					{
+						prefab.collider = Nz::BoxCollider3D::New(GetVectorField(lua, "Size", Nz::Vector3f::Unit()));
+						colliderSize = prefab.collider->ComputeAABB().GetRadius();
+					}
+					else if (colliderType == "Capsule")
+					{
+						prefab.collider = Nz::CapsuleCollider3D::New(GetNumberField(lua, "Length", 1.f), GetNumberField(lua, "Radius", 1.f));
+						colliderSize = prefab.collider->ComputeAABB().GetRadius();
+					}
+					else if (colliderType == "Sphere")
+					{
+						float radius = GetNumberField(lua, "Radius", 1.f);
+
+						prefab.collider = Nz::SphereCollider3D::New(radius);
+						colliderSize = radius;
+					}
+					else
+						throw std::runtime_error("unknown collider type \"" + colliderType + "\"");
+
+					colliderVolume = prefab.collider->ComputeVolume();
+				}
+				lua.Pop();
+
+				if (lua.GetField("Signature") == Nz::LuaType_Number)
+					prefab.signature = SignatureInfo{ lua.ToNumber(-1), colliderSize, colliderVolume };
+				lua.Pop();
+
+				if (lua.GetField("Physics") == Nz::LuaType_Table)
+				{
+					PhysicsInfo& physics = prefab.physics.emplace();
+					physics.mass = GetNumberField(lua, "Mass", 1.f);
+
+					// Dampings keep the physics engine defaults unless specified
+					bool hasAngularDamping = (lua.GetField("AngularDamping") != Nz::LuaType_Nil);
+					lua.Pop();
+
+					if (hasAngularDamping)
+						physics.angularDamping = GetVectorField(lua, "AngularDamping", Nz::Vector3f::Zero());
+
+					bool hasLinearDamping = (lua.GetField("LinearDamping") != Nz::LuaType_Nil);
+					lua.Pop();
+
+					if (hasLinearDamping)
+						physics.linearDamping = GetNumberField(lua, "LinearDamping", 0.f);
+
+					if (std::string material = GetStringField(lua, "Material", std::string()); !material.empty())
+						physics.material = std::move(material);
+				}
+				lua.Pop();
+
+				if (lua.GetField("Projectile") == Nz::LuaType_Table)
+				{
+					ProjectileInfo& projectile = prefab.projectile.emplace();
+					projectile.damage = static_cast<Nz::UInt16>(GetNumberField(lua, "Damage", 0.f));
+					projectile.damageVariance = static_cast<Nz::UInt16>(GetNumberField(lua, "DamageVariance", 0.f));
+					projectile.speed = GetNumberField(lua, "Speed", 0.f);
+				}
+				lua.Pop();
+
+				// Client-side part, sent as is to every player joining an arena
+				auto& networkPrefab = arenaPrefabs.prefabs.emplace_back();
+
+				ForEachArrayField(lua, "Models", [&]()
+				{
+					std::string modelPath = GetStringField(lua, "Path", std::string());
+					if (modelPath.empty())
+						throw std::runtime_error("model has no path");
+
+					Nz::Vector3f rotation = GetVectorField(lua, "Rotation", Nz::Vector3f::Zero());
+
+					auto& model = networkPrefab.models.emplace_back();
+					model.modelId = stringStore.RegisterString(std::move(modelPath));
+					model.position = GetVectorField(lua, "Position", Nz::Vector3f::Zero());
+					model.rotation = Nz::EulerAnglesf(rotation.x, rotation.y, rotation.z).ToQuaternion();
+					model.scale = GetVectorField(lua, "Scale", Nz::Vector3f::Unit());
+				});
+
+				ForEachArrayField(lua, "Sounds", [&]()
+				{
+					auto& sound = networkPrefab.sounds.emplace_back();
+					sound.position = GetVectorField(lua, "Position", Nz::Vector3f::Zero());
+					sound.soundId = static_cast<Nz::UInt32>(GetNumberField(lua, "Id", 0.f));
+				});
+
+				ForEachArrayField(lua, "VisualEffects", [&]()
+				{
+					std::string effectName = GetStringField(lua, "Name", std::string());
+					if (effectName.empty())
+						throw std::runtime_error("visual effect has no name");
+
+					Nz::Vector3f rotation = GetVectorField(lua, "Rotation", Nz::Vector3f::Zero());
+
+					auto& visualEffect = networkPrefab.visualEffects.emplace_back();
+					visualEffect.effectNameId = stringStore.RegisterString(std::move(effectName));
+					visualEffect.position = GetVectorField(lua, "Position", Nz::Vector3f::Zero());
+					visualEffect.rotation = Nz::EulerAnglesf(rotation.x, rotation.y, rotation.z).ToQuaternion();
+					visualEffect.scale = GetVectorField(lua, "Scale", Nz::Vector3f::Unit());
+				});
+			}
+			catch (const std::exception& e)
+			{
+				LogError(LogCategory::Store) << "Failed to load prefab #" << prefabId << " from " << fileName << ": " << e.what();
+				return false;
+			}
+
+			lua.Pop();
+		}
+
+		// Prefabs are the same for every arena and every client, they're serialized once
+		m_arenaPrefabs.Update(arenaPrefabs);
+
+		LogInfo(LogCategory::Store) << "Loaded " << m_prefabInfos.size() << " prefabs";
+
+		return true;
+	}
+}
@@ -0,0 +1,95 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_PREFABSTORE_HPP
+#define EREWHON_SERVER_PREFABSTORE_HPP
+
+#include <Shared/Protocol/CachedPacket.hpp>
+#include <Shared/Protocol/Packets.hpp>
+#include <Nazara/Physics3D/Collider3D.hpp>
+#include <NDK/EntityHandle.hpp>
+#include <limits>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ewn
+{
+	class NetworkStringStore;
+
+	// Entity prefabs, loaded once from a Lua file and shared by every arena
+	// The prefab id sent to clients is the index of the prefab in this store
+	class PrefabStore
+	{
+		public:
+			struct ProjectileInfo;
+
+			PrefabStore() = default;
+			~PrefabStore() = default;
+
+			void BuildEntity(std::size_t entryId, const Ndk::EntityHandle& entity, std::string name = std::string()) const;
+
+			inline const CachedPacket<Packets::ArenaPrefabs>& GetArenaPrefabsPacket() const;
+			inline std::size_t GetEntryByName(const std::string& entryName) const;
+			inline const Nz::Collider3DRef& GetEntryCollider(std::size_t entryId) const;
+			inline std::size_t GetEntryCount() const;
+			inline float GetEntryLifeTime(std::size_t entryId) const;
+			inline const std::string& GetEntryName(std::size_t entryId) const;
+			inline std::size_t GetEntryPoolSize(std::size_t entryId) const;
+			inline const ProjectileInfo& GetEntryProjectileInfo(std::size_t entryId) const;
+
+			inline bool IsEntryProjectile(std::size_t entryId) const;
+
+			bool LoadFromFile(const std::string& fileName, NetworkStringStore& stringStore);
+
+			struct ProjectileInfo
+			{
+				Nz::UInt16 damage = 0;
+				Nz::UInt16 damageVariance = 0;
+				float speed = 0.f;
+			};
+
+			static constexpr std::size_t InvalidEntryId = std::numeric_limits<std::size_t>::max();
+
+		private:
+			struct PhysicsInfo
+			{
+				std::optional<Nz::Vector3f> angularDamping;
+				std::optional<float> linearDamping;
+				std::optional<std::string> material;
+				float mass = 1.f;
+			};
+
+			struct SignatureInfo
+			{
+				double emSignature;
+				double size;
+				double volume;
+			};
+
+			struct PrefabInfo
+			{
+				Nz::Collider3DRef collider;
+				std::optional<PhysicsInfo> physics;
+				std::optional<ProjectileInfo> projectile;
+				std::optional<SignatureInfo> signature;
+				std::size_t poolSize = 0;
+				std::string name;
+				Nz::UInt16 networkPriority = 0;
+				bool isMovable = false;
+				float lifeTime = 0.f;
+			};
+
+			std::unordered_map<std::string, std::size_t> m_prefabIndices;
+			std::vector<PrefabInfo> m_prefabInfos;
+			CachedPacket<Packets::ArenaPrefabs> m_arenaPrefabs;
+	};
+}
+
+#include <Server/Store/PrefabStore.inl>
+
+#endif // EREWHON_SERVER_PREFABSTORE_HPP
@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/Store/PrefabStore.hpp>
+#include <cassert>
+
+namespace ewn
+{
+	inline const CachedPacket<Packets::ArenaPrefabs>& PrefabStore::GetArenaPrefabsPacket() const
+	{
+		return m_arenaPrefabs;
+	}
+
+	inline std::size_t PrefabStore::GetEntryByName(const std::string& entryName) const
+	{
+		auto it = m_prefabIndices.find(entryName);
+		if (it != m_prefabIndices.end())
+			return it->second;
+		else
+			return InvalidEntryId;
+	}
+
+	inline const Nz::Collider3DRef& PrefabStore::GetEntryCollider(std::size_t entryId) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		return m_prefabInfos[entryId].collider;
+	}
+
+	inline std::size_t PrefabStore::GetEntryCount() const
+	{
+		return m_prefabInfos.size();
+	}
+
+	inline float PrefabStore::GetEntryLifeTime(std::size_t entryId) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		return m_prefabInfos[entryId].lifeTime;
+	}
+
+	inline const std::string& PrefabStore::GetEntryName(std::size_t entryId) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		return m_prefabInfos[entryId].name;
+	}
+
+	inline std::size_t PrefabStore::GetEntryPoolSize(std::size_t entryId) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		return m_prefabInfos[entryId].poolSize;
+	}
+
+	inline const PrefabStore::ProjectileInfo& PrefabStore::GetEntryProjectileInfo(std::size_t entryId) const
+	{
+		assert(IsEntryProjectile(entryId));
+		return *m_prefabInfos[entryId].projectile;
+	}
+
+	inline bool PrefabStore::IsEntryProjectile(std::size_t entryId) const
+	{
+		assert(entryId < m_prefabInfos.size());
+		return m_prefabInfos[entryId].projectile.has_value();
+	}
+}
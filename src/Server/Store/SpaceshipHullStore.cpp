@@ -7,7 +7,7 @@
 #include <Server/Database/Database.hpp>
 #include <Server/Database/DatabaseResult.hpp>
 #include <Server/Store/CollisionMeshStore.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -51,11 +51,11 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to load spaceship hull #" << id << ": " << e.what() << std::endl;
+				LogError(LogCategory::Store) << "Failed to load spaceship hull #" << id << ": " << e.what();
 			}
 		}
 
-		std::cout << "Loaded " << hullLoaded << " spaceship hulls (" << (hullCount - hullLoaded) << " errored)" << std::endl;
+		LogInfo(LogCategory::Store) << "Loaded " << hullLoaded << " spaceship hulls (" << (hullCount - hullLoaded) << " errored)";
 
 		return true;
 	}
@@ -64,7 +64,7 @@ namespace ewn
 	{
 		if (!result)
 		{
-			std::cerr << "LoadSpaceshipHullSlots for hull id " << hullId << " failed: " << result.GetLastErrorMessage();
+			LogError(LogCategory::Database) << "LoadSpaceshipHullSlots for hull id " << hullId << " failed: " << result.GetLastErrorMessage();
 			return;
 		}
 
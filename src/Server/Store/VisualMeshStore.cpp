@@ -5,7 +5,7 @@
 #include <Server/Store/VisualMeshStore.hpp>
 #include <Server/Database/Database.hpp>
 #include <Server/Database/DatabaseResult.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 
 namespace ewn
 {
@@ -36,11 +36,11 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to load visual mesh #" << id << ": " << e.what() << std::endl;
+				LogError(LogCategory::Store) << "Failed to load visual mesh #" << id << ": " << e.what();
 			}
 		}
 
-		std::cout << "Loaded " << meshLoaded << " visual meshes (" << (meshCount - meshLoaded) << " errored)" << std::endl;
+		LogInfo(LogCategory::Store) << "Loaded " << meshLoaded << " visual meshes (" << (meshCount - meshLoaded) << " errored)";
 
 		return true;
 	}
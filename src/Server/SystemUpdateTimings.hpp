@@ -0,0 +1,56 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_SYSTEMUPDATETIMINGS_HPP
+#define EREWHON_SERVER_SYSTEMUPDATETIMINGS_HPP
+
+#include <Server/MetricsRegistry.hpp>
+#include <Server/TimingHistogram.hpp>
+
+namespace ewn
+{
+	// Time spent in a system OnUpdate, recorded from inside it so ticks where a rate-limited system doesn't run aren't counted
+	class SystemUpdateTimings
+	{
+		public:
+			class Scope;
+
+			inline SystemUpdateTimings();
+			~SystemUpdateTimings() = default;
+
+			inline const TimingHistogram& GetHistogram() const;
+			inline Nz::UInt64 GetTotalDuration() const;
+
+			inline void Record(Nz::UInt64 duration);
+
+			inline void SetMetric(MetricsRegistry::Histogram* metric);
+
+			class Scope
+			{
+				public:
+					inline Scope(SystemUpdateTimings& timings);
+					Scope(const Scope&) = delete;
+					Scope(Scope&&) = delete;
+					inline ~Scope();
+
+					Scope& operator=(const Scope&) = delete;
+					Scope& operator=(Scope&&) = delete;
+
+				private:
+					SystemUpdateTimings& m_timings;
+					Nz::UInt64 m_startTime;
+			};
+
+		private:
+			MetricsRegistry::Histogram* m_metric; //< optional, seconds
+			TimingHistogram m_histogram;
+			Nz::UInt64 m_totalDuration; //< microseconds, since creation
+	};
+}
+
+#include <Server/SystemUpdateTimings.inl>
+
+#endif // EREWHON_SERVER_SYSTEMUPDATETIMINGS_HPP
@@ -0,0 +1,51 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/SystemUpdateTimings.hpp>
+#include <Nazara/Core/Clock.hpp>
+
+namespace ewn
+{
+	inline SystemUpdateTimings::SystemUpdateTimings() :
+	m_metric(nullptr),
+	m_totalDuration(0)
+	{
+	}
+
+	inline const TimingHistogram& SystemUpdateTimings::GetHistogram() const
+	{
+		return m_histogram;
+	}
+
+	// Never reset, the difference between two calls is the time the system took in between (0 if it didn't run)
+	inline Nz::UInt64 SystemUpdateTimings::GetTotalDuration() const
+	{
+		return m_totalDuration;
+	}
+
+	inline void SystemUpdateTimings::Record(Nz::UInt64 duration)
+	{
+		m_histogram.Record(duration);
+		m_totalDuration += duration;
+
+		if (m_metric)
+			m_metric->Observe(duration / 1'000'000.0);
+	}
+
+	inline void SystemUpdateTimings::SetMetric(MetricsRegistry::Histogram* metric)
+	{
+		m_metric = metric;
+	}
+
+	inline SystemUpdateTimings::Scope::Scope(SystemUpdateTimings& timings) :
+	m_timings(timings),
+	m_startTime(Nz::GetElapsedMicroseconds())
+	{
+	}
+
+	inline SystemUpdateTimings::Scope::~Scope()
+	{
+		m_timings.Record(Nz::GetElapsedMicroseconds() - m_startTime);
+	}
+}
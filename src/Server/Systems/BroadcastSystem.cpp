@@ -11,6 +11,7 @@
 #include <NDK/Components/PhysicsComponent3D.hpp>
 #include <Server/ServerApplication.hpp>
 #include <Server/Systems/InputSystem.hpp>
+#include <Shared/Profiler.hpp>
 #include <cassert>
 
 namespace ewn
@@ -51,6 +52,9 @@ namespace ewn
 
 	void BroadcastSystem::OnUpdate(float /*elapsedTime*/)
 	{
+		ProfileZone("BroadcastSystem::OnUpdate");
+		SystemUpdateTimings::Scope updateTimingScope(m_updateTimings);
+
 		static constexpr std::size_t HeaderSize = sizeof(Nz::UInt16) + 2 * sizeof(Nz::UInt64) + sizeof(Nz::UInt32);
 		static constexpr std::size_t EntitySize = sizeof(Packets::ArenaState::Entity);
 		static constexpr std::size_t EntityMaxSize = 1300;
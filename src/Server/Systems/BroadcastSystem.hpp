@@ -9,6 +9,7 @@
 
 #include <NDK/EntityList.hpp>
 #include <NDK/System.hpp>
+#include <Server/SystemUpdateTimings.hpp>
 #include <Shared/Protocol/Packets.hpp>
 #include <vector>
 
@@ -29,6 +30,9 @@ namespace ewn
 			NazaraSignal(BroadcastEntitiesDestruction, const BroadcastSystem*, const Packets::DeleteEntities& /*packet*/);
 			NazaraSignal(BroadcastStateUpdate, const BroadcastSystem*, Packets::ArenaState& /*statePacket*/);
 
+			inline SystemUpdateTimings& GetUpdateTimings();
+			inline const SystemUpdateTimings& GetUpdateTimings() const;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
@@ -53,6 +57,7 @@ namespace ewn
 			ServerApplication* m_app;
 			float m_stateUpdateAccumulator;
 			float m_stateUpdateFrequency;
+			SystemUpdateTimings m_updateTimings;
 	};
 }
 
@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline SystemUpdateTimings& BroadcastSystem::GetUpdateTimings()
+	{
+		return m_updateTimings;
+	}
+
+	inline const SystemUpdateTimings& BroadcastSystem::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
 }
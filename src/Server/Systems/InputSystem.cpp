@@ -6,6 +6,8 @@
 #include <Nazara/Utility/Node.hpp>
 #include <NDK/Components/PhysicsComponent3D.hpp>
 #include <Server/Components/InputComponent.hpp>
+#include <Shared/Profiler.hpp>
+#include <Shared/SpaceshipMovement.hpp>
 #include <iostream>
 
 namespace ewn
@@ -18,6 +20,9 @@ namespace ewn
 
 	void InputSystem::OnUpdate(float /*elapsedTime*/)
 	{
+		ProfileZone("InputSystem::OnUpdate");
+		SystemUpdateTimings::Scope updateTimingScope(m_updateTimings);
+
 		for (const Ndk::EntityHandle& spaceship : GetEntities())
 		{
 			auto& spaceshipPhysics = spaceship->GetComponent<Ndk::PhysicsComponent3D>();
@@ -26,19 +31,11 @@ namespace ewn
 			Nz::UInt64 lastInput = spaceshipInput.GetLastInputTime();
 			spaceshipInput.ProcessInputs([&] (Nz::UInt64 time, const Nz::Vector3f& movement, const Nz::Vector3f& rotation)
 			{
-				static constexpr float AngularMultiplier = 3000.f;
-				static constexpr float ForceMultiplier = 15000.f;
-
+				// Clients predict their spaceship movement with the same model, see SpaceshipPrediction
 				float inputElapsedTime = (lastInput != 0) ? (time - lastInput) / 1000.f : 0.f;
 
-				Nz::Vector3f totalMovement = inputElapsedTime * movement;
-				Nz::Vector3f totalRotation = inputElapsedTime * rotation;
-
-				spaceshipPhysics.AddForce(ForceMultiplier * totalMovement, Nz::CoordSys_Local);
-				spaceshipPhysics.AddTorque(AngularMultiplier * totalRotation, Nz::CoordSys_Global);
-
-				/*std::cout << "At " << time << ": Move by " << totalMovement << " (final pos: " << spaceshipPhysics.GetPosition() << ")\n";
-				std::cout << "   " << time << ": Rotate by " << totalRotation << " (final pos: " << spaceshipPhysics.GetRotation().ToEulerAngles() << ')' << std::endl;*/
+				spaceshipPhysics.AddForce(SpaceshipMovement::ComputeForce(inputElapsedTime, movement), Nz::CoordSys_Local);
+				spaceshipPhysics.AddTorque(SpaceshipMovement::ComputeTorque(inputElapsedTime, rotation), Nz::CoordSys_Global);
 
 				lastInput = time;
 			});
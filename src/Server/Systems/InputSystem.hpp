@@ -8,6 +8,7 @@
 #define EREWHON_SERVER_INPUTSYSTEM_HPP
 
 #include <NDK/System.hpp>
+#include <Server/SystemUpdateTimings.hpp>
 
 namespace ewn
 {
@@ -16,10 +17,15 @@ namespace ewn
 		public:
 			InputSystem();
 
+			inline SystemUpdateTimings& GetUpdateTimings();
+			inline const SystemUpdateTimings& GetUpdateTimings() const;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnUpdate(float elapsedTime) override;
+
+			SystemUpdateTimings m_updateTimings;
 	};
 }
 
@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline SystemUpdateTimings& InputSystem::GetUpdateTimings()
+	{
+		return m_updateTimings;
+	}
+
+	inline const SystemUpdateTimings& InputSystem::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
 }
@@ -4,6 +4,8 @@
 
 #include <Server/Systems/LifeTimeSystem.hpp>
 #include <Server/Components/LifeTimeComponent.hpp>
+#include <Server/Components/PooledComponent.hpp>
+#include <Shared/Profiler.hpp>
 
 namespace ewn
 {
@@ -14,12 +16,20 @@ namespace ewn
 
 	void LifeTimeSystem::OnUpdate(float elapsedTime)
 	{
+		ProfileZone("LifeTimeSystem::OnUpdate");
+		SystemUpdateTimings::Scope updateTimingScope(m_updateTimings);
+
 		for (const Ndk::EntityHandle& entity : GetEntities())
 		{
 			LifeTimeComponent& lifeTime = entity->GetComponent<LifeTimeComponent>();
 
 			if (lifeTime.DecreaseDuration(elapsedTime))
-				entity->Kill();
+			{
+				if (entity->HasComponent<PooledComponent>())
+					entity->GetComponent<PooledComponent>().ReturnToPool();
+				else
+					entity->Kill();
+			}
 		}
 	}
 
@@ -8,6 +8,7 @@
 #define EREWHON_SERVER_LIFETIMESYSTEM_HPP
 
 #include <NDK/System.hpp>
+#include <Server/SystemUpdateTimings.hpp>
 
 namespace ewn
 {
@@ -17,10 +18,15 @@ namespace ewn
 			LifeTimeSystem();
 			~LifeTimeSystem() = default;
 
+			inline SystemUpdateTimings& GetUpdateTimings();
+			inline const SystemUpdateTimings& GetUpdateTimings() const;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnUpdate(float elapsedTime) override;
+
+			SystemUpdateTimings m_updateTimings;
 	};
 }
 
@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline SystemUpdateTimings& LifeTimeSystem::GetUpdateTimings()
+	{
+		return m_updateTimings;
+	}
+
+	inline const SystemUpdateTimings& LifeTimeSystem::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
 }
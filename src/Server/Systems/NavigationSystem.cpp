@@ -9,6 +9,7 @@
 #include <Server/Components/NavigationComponent.hpp>
 #include <Server/Components/PlayerControlledComponent.hpp>
 #include <Server/ServerApplication.hpp>
+#include <Shared/Profiler.hpp>
 
 namespace ewn
 {
@@ -22,6 +23,9 @@ namespace ewn
 
 	void NavigationSystem::OnUpdate(float elapsedTime)
 	{
+		ProfileZone("NavigationSystem::OnUpdate");
+		SystemUpdateTimings::Scope updateTimingScope(m_updateTimings);
+
 		Nz::UInt64 appTime = m_app->GetAppTime();
 
 		for (const Ndk::EntityHandle& entity : GetEntities())
@@ -8,6 +8,7 @@
 #define EREWHON_SERVER_NAVIGATIONSYSTEM_HPP
 
 #include <NDK/System.hpp>
+#include <Server/SystemUpdateTimings.hpp>
 
 namespace ewn
 {
@@ -18,12 +19,16 @@ namespace ewn
 		public:
 			NavigationSystem(ServerApplication* app);
 
+			inline SystemUpdateTimings& GetUpdateTimings();
+			inline const SystemUpdateTimings& GetUpdateTimings() const;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
 			void OnUpdate(float elapsedTime) override;
 
 			ServerApplication* m_app;
+			SystemUpdateTimings m_updateTimings;
 	};
 }
 
@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline SystemUpdateTimings& NavigationSystem::GetUpdateTimings()
+	{
+		return m_updateTimings;
+	}
+
+	inline const SystemUpdateTimings& NavigationSystem::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
 }
@@ -7,6 +7,7 @@
 #include <Server/Components/OwnerComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
 #include <Server/Components/SynchronizedComponent.hpp>
+#include <Shared/Profiler.hpp>
 
 namespace ewn
 {
@@ -21,6 +22,9 @@ namespace ewn
 
 	void ScriptSystem::OnUpdate(float elapsedTime)
 	{
+		ProfileZone("ScriptSystem::OnUpdate");
+		SystemUpdateTimings::Scope updateTimingScope(m_updateTimings);
+
 		for (const Ndk::EntityHandle& entity : GetEntities())
 		{
 			ScriptComponent& script = entity->GetComponent<ScriptComponent>();
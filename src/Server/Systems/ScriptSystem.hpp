@@ -8,6 +8,7 @@
 #define EREWHON_SERVER_SCRIPTSYSTEM_HPP
 
 #include <NDK/System.hpp>
+#include <Server/SystemUpdateTimings.hpp>
 
 namespace ewn
 {
@@ -20,6 +21,9 @@ namespace ewn
 			ScriptSystem(ServerApplication* app, Arena* arena);
 			~ScriptSystem() = default;
 
+			inline SystemUpdateTimings& GetUpdateTimings();
+			inline const SystemUpdateTimings& GetUpdateTimings() const;
+
 			static Ndk::SystemIndex systemIndex;
 
 		private:
@@ -27,6 +31,7 @@ namespace ewn
 
 			Arena* m_arena;
 			ServerApplication* m_app;
+			SystemUpdateTimings m_updateTimings;
 	};
 }
 
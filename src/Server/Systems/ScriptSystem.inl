@@ -6,4 +6,13 @@
 
 namespace ewn
 {
+	inline SystemUpdateTimings& ScriptSystem::GetUpdateTimings()
+	{
+		return m_updateTimings;
+	}
+
+	inline const SystemUpdateTimings& ScriptSystem::GetUpdateTimings() const
+	{
+		return m_updateTimings;
+	}
 }
@@ -0,0 +1,64 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/TickScheduler.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <cassert>
+#include <thread>
+
+namespace ewn
+{
+	void TickScheduler::BeginTick()
+	{
+		// OS sleep granularity is around a millisecond (or worse), spin for the last part of the wait
+		constexpr Nz::UInt64 spinDuration = 2'000;
+
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+		if (m_nextTickTime == 0)
+			m_nextTickTime = now;
+
+		if (now < m_nextTickTime)
+		{
+			Nz::UInt64 remainingTime = m_nextTickTime - now;
+			if (remainingTime > spinDuration)
+				Nz::Thread::Sleep(static_cast<Nz::UInt32>((remainingTime - spinDuration) / 1000));
+
+			while ((now = Nz::GetElapsedMicroseconds()) < m_nextTickTime)
+				std::this_thread::yield();
+		}
+		else if (Nz::UInt64 lateTicks = (now - m_nextTickTime) / m_tickDuration; lateTicks > 0)
+		{
+			if (lateTicks > m_maxCatchUpTicks)
+			{
+				// Catching up would take too long and make things worse, forget about those ticks
+				m_skippedTickCount += lateTicks;
+				m_nextTickTime = now;
+			}
+			else
+				m_catchUpTickCount++;
+		}
+
+		m_nextTickTime += m_tickDuration;
+		m_tickStartTime = now;
+	}
+
+	void TickScheduler::EndTick()
+	{
+		Nz::UInt64 tickTime = Nz::GetElapsedMicroseconds() - m_tickStartTime;
+		if (tickTime > m_tickDuration)
+			m_overrunCount++;
+
+		m_tickCount++;
+		m_tickTimes.Record(tickTime);
+	}
+
+	void TickScheduler::SetTickRate(float tickRate)
+	{
+		assert(tickRate > 0.f);
+
+		m_tickDuration = static_cast<Nz::UInt64>(1'000'000.f / tickRate);
+		m_tickRate = tickRate;
+	}
+}
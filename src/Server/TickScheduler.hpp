@@ -0,0 +1,53 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_TICKSCHEDULER_HPP
+#define EREWHON_SERVER_TICKSCHEDULER_HPP
+
+#include <Server/TimingHistogram.hpp>
+
+namespace ewn
+{
+	// Paces the server main loop at a fixed tick rate
+	// A late tick is run immediately to catch up, unless we're too late in which case the backlog is dropped
+	class TickScheduler
+	{
+		public:
+			inline TickScheduler(float tickRate = 60.f, unsigned int maxCatchUpTicks = 5);
+			~TickScheduler() = default;
+
+			void BeginTick();
+			void EndTick();
+
+			inline Nz::UInt64 GetCatchUpTickCount() const;
+			inline Nz::UInt64 GetOverrunCount() const;
+			inline Nz::UInt64 GetSkippedTickCount() const;
+			inline Nz::UInt64 GetTickCount() const;
+			inline float GetTickInterval() const;
+			inline float GetTickRate() const;
+			inline const TimingHistogram& GetTickTimes() const;
+
+			inline void ResetStats();
+
+			void SetTickRate(float tickRate);
+
+		private:
+			TimingHistogram m_tickTimes;
+			Nz::UInt64 m_catchUpTickCount;
+			Nz::UInt64 m_nextTickTime;
+			Nz::UInt64 m_overrunCount;
+			Nz::UInt64 m_skippedTickCount;
+			Nz::UInt64 m_tickCount;
+			Nz::UInt64 m_tickDuration; //< microseconds
+			Nz::UInt64 m_tickStartTime;
+			unsigned int m_maxCatchUpTicks;
+			float m_tickRate;
+	};
+}
+
+#include <Server/TickScheduler.inl>
+
+#endif // EREWHON_SERVER_TICKSCHEDULER_HPP
@@ -0,0 +1,61 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/TickScheduler.hpp>
+
+namespace ewn
+{
+	inline TickScheduler::TickScheduler(float tickRate, unsigned int maxCatchUpTicks) :
+	m_nextTickTime(0),
+	m_tickStartTime(0),
+	m_maxCatchUpTicks(maxCatchUpTicks)
+	{
+		SetTickRate(tickRate);
+		ResetStats();
+	}
+
+	inline Nz::UInt64 TickScheduler::GetCatchUpTickCount() const
+	{
+		return m_catchUpTickCount;
+	}
+
+	inline Nz::UInt64 TickScheduler::GetOverrunCount() const
+	{
+		return m_overrunCount;
+	}
+
+	inline Nz::UInt64 TickScheduler::GetSkippedTickCount() const
+	{
+		return m_skippedTickCount;
+	}
+
+	inline Nz::UInt64 TickScheduler::GetTickCount() const
+	{
+		return m_tickCount;
+	}
+
+	inline float TickScheduler::GetTickInterval() const
+	{
+		return 1.f / m_tickRate;
+	}
+
+	inline float TickScheduler::GetTickRate() const
+	{
+		return m_tickRate;
+	}
+
+	inline const TimingHistogram& TickScheduler::GetTickTimes() const
+	{
+		return m_tickTimes;
+	}
+
+	inline void TickScheduler::ResetStats()
+	{
+		m_catchUpTickCount = 0;
+		m_overrunCount = 0;
+		m_skippedTickCount = 0;
+		m_tickCount = 0;
+		m_tickTimes.Clear();
+	}
+}
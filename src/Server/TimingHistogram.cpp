@@ -0,0 +1,32 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/TimingHistogram.hpp>
+
+namespace ewn
+{
+	Nz::UInt64 TimingHistogram::GetPercentile(float percentile) const
+	{
+		if (m_sampleCount == 0)
+			return 0;
+
+		// Returns the upper bound of the bucket containing the percentile
+		Nz::UInt64 threshold = static_cast<Nz::UInt64>(m_sampleCount * percentile / 100.f);
+
+		Nz::UInt64 sampleCount = 0;
+		for (std::size_t i = 0; i < BucketCount - 1; ++i)
+		{
+			sampleCount += m_buckets[i];
+			if (sampleCount > threshold)
+				return std::min(Nz::UInt64(2) << i, m_maximum);
+		}
+
+		return m_maximum;
+	}
+
+	std::string TimingHistogram::ToString() const
+	{
+		return std::to_string(m_sampleCount) + " samples, avg " + std::to_string(GetAverage()) + "us, p50 " + std::to_string(GetPercentile(50.f)) + "us, p99 " + std::to_string(GetPercentile(99.f)) + "us, max " + std::to_string(m_maximum) + "us";
+	}
+}
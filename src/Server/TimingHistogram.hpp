@@ -0,0 +1,47 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#pragma once
+
+#ifndef EREWHON_SERVER_TIMINGHISTOGRAM_HPP
+#define EREWHON_SERVER_TIMINGHISTOGRAM_HPP
+
+#include <Nazara/Prerequisites.hpp>
+#include <array>
+#include <string>
+
+namespace ewn
+{
+	// Duration histogram (in microseconds) using power-of-two buckets, cheap enough to be fed every tick
+	class TimingHistogram
+	{
+		public:
+			static constexpr std::size_t BucketCount = 20; //< Last bucket holds everything over ~0.5s
+
+			inline TimingHistogram();
+			~TimingHistogram() = default;
+
+			inline void Clear();
+
+			inline Nz::UInt64 GetAverage() const;
+			inline Nz::UInt64 GetBucketSampleCount(std::size_t bucketIndex) const;
+			inline Nz::UInt64 GetMaximum() const;
+			Nz::UInt64 GetPercentile(float percentile) const;
+			inline Nz::UInt64 GetSampleCount() const;
+
+			inline void Record(Nz::UInt64 duration);
+
+			std::string ToString() const;
+
+		private:
+			std::array<Nz::UInt64, BucketCount> m_buckets;
+			Nz::UInt64 m_maximum;
+			Nz::UInt64 m_sampleCount;
+			Nz::UInt64 m_sum;
+	};
+}
+
+#include <Server/TimingHistogram.inl>
+
+#endif // EREWHON_SERVER_TIMINGHISTOGRAM_HPP
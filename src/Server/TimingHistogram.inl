@@ -0,0 +1,57 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Server" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Server/TimingHistogram.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace ewn
+{
+	inline TimingHistogram::TimingHistogram()
+	{
+		Clear();
+	}
+
+	inline void TimingHistogram::Clear()
+	{
+		m_buckets.fill(0);
+		m_maximum = 0;
+		m_sampleCount = 0;
+		m_sum = 0;
+	}
+
+	inline Nz::UInt64 TimingHistogram::GetAverage() const
+	{
+		return (m_sampleCount > 0) ? m_sum / m_sampleCount : 0;
+	}
+
+	inline Nz::UInt64 TimingHistogram::GetBucketSampleCount(std::size_t bucketIndex) const
+	{
+		assert(bucketIndex < BucketCount);
+		return m_buckets[bucketIndex];
+	}
+
+	inline Nz::UInt64 TimingHistogram::GetMaximum() const
+	{
+		return m_maximum;
+	}
+
+	inline Nz::UInt64 TimingHistogram::GetSampleCount() const
+	{
+		return m_sampleCount;
+	}
+
+	inline void TimingHistogram::Record(Nz::UInt64 duration)
+	{
+		// Bucket #i holds durations in [2^i, 2^(i+1)[ (bucket #0 also holds zero)
+		std::size_t bucketIndex = 0;
+		while (bucketIndex < BucketCount - 1 && (duration >> (bucketIndex + 1)) != 0)
+			bucketIndex++;
+
+		m_buckets[bucketIndex]++;
+		m_maximum = std::max(m_maximum, duration);
+		m_sampleCount++;
+		m_sum += duration;
+	}
+}
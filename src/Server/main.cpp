@@ -11,6 +11,7 @@
 #include <Server/Components/NavigationComponent.hpp>
 #include <Server/Components/OwnerComponent.hpp>
 #include <Server/Components/PlayerControlledComponent.hpp>
+#include <Server/Components/PooledComponent.hpp>
 #include <Server/Components/ProjectileComponent.hpp>
 #include <Server/Components/ScriptComponent.hpp>
 #include <Server/Components/SignatureComponent.hpp>
@@ -21,13 +22,21 @@
 #include <Server/Systems/NavigationSystem.hpp>
 #include <Server/Systems/ScriptSystem.hpp>
 #include <Server/Systems/InputSystem.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/Profiler.hpp>
 #include <Nazara/Core/Initializer.hpp>
-#include <Nazara/Core/Thread.hpp>
 #include <Nazara/Network/Network.hpp>
 #include <NDK/Sdk.hpp>
 
 int main()
 {
+	ewn::Profiler::SetThreadName("Main");
+
+	// Those can be triggered by clients, don't let them flood the console
+	ewn::Logger::SetRateLimit(ewn::LogCategory::Chat, 50);
+	ewn::Logger::SetRateLimit(ewn::LogCategory::Network, 50);
+	ewn::Logger::SetRateLimit(ewn::LogCategory::Player, 50);
+
 	Nz::Initializer<Nz::Network, Ndk::Sdk> nazara; //< Init SDK before application because of custom components/systems
 
 	Nz::Initializer<ewn::ArenaInterface> binding;
@@ -41,6 +50,7 @@ int main()
 	Ndk::InitializeComponent<ewn::NavigationComponent>("NavigCmp");
 	Ndk::InitializeComponent<ewn::OwnerComponent>("OwnrComp");
 	Ndk::InitializeComponent<ewn::PlayerControlledComponent>("PlyCtrl");
+	Ndk::InitializeComponent<ewn::PooledComponent>("PoolComp");
 	Ndk::InitializeComponent<ewn::ProjectileComponent>("Prjctile");
 	Ndk::InitializeComponent<ewn::ScriptComponent>("ScrptCmp");
 	Ndk::InitializeComponent<ewn::SignatureComponent>("SignCmp");
@@ -54,13 +64,19 @@ int main()
 	ewn::ServerApplication app;
 	if (!app.LoadConfig("sconfig.lua"))
 	{
-		std::cerr << "Failed to load config file" << std::endl;
+		ewn::LogError(ewn::LogCategory::Server) << "Failed to load config file";
 		return EXIT_FAILURE;
 	}
 
 	if (!app.LoadDatabase())
 	{
-		std::cerr << "Failed to load database" << std::endl;
+		ewn::LogError(ewn::LogCategory::Server) << "Failed to load database";
+		return EXIT_FAILURE;
+	}
+
+	if (!app.LoadPrefabs("prefabs.lua"))
+	{
+		ewn::LogError(ewn::LogCategory::Server) << "Failed to load prefabs";
 		return EXIT_FAILURE;
 	}
 
@@ -71,26 +87,15 @@ int main()
 	const ewn::ConfigFile& config = app.GetConfig();
 	if (!app.SetupNetwork(config.GetIntegerOption<std::size_t>("Game.MaxClients"), 1, Nz::NetProtocol_Any, config.GetIntegerOption<Nz::UInt16>("Game.Port")))
 	{
-		std::cerr << "Failed to setup network" << std::endl;
+		ewn::LogError(ewn::LogCategory::Server) << "Failed to setup network";
 		return EXIT_FAILURE;
 	}
 
-	std::cout << "Server ready." << std::endl;
+	ewn::LogInfo(ewn::LogCategory::Server) << "Server ready.";
 
-	//Nz::UInt64 lastUpdate = Nz::GetElapsedMilliseconds();
-	//unsigned int updateCount = 0;
-	while (app.Run())
-	{
-		/*Nz::UInt64 now = Nz::GetElapsedMilliseconds();
-		if (now - lastUpdate >= 1000)
-		{
-			std::cout << "Update per seconds: " << updateCount << std::endl;
-			updateCount = 0;
-			lastUpdate = now;
-		}
-		updateCount++;*/
-		Nz::Thread::Sleep(1);
-	}
+	// Run() waits for the next tick by itself
+	while (app.Run());
 
-	std::cout << "Goodbye" << std::endl;
+	ewn::LogInfo(ewn::LogCategory::Server) << "Goodbye";
+	ewn::Logger::Flush();
 }
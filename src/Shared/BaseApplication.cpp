@@ -15,7 +15,7 @@ namespace ewn
 
 		for (const auto& reactorPtr : m_reactors)
 		{
-			reactorPtr->Poll([&](bool outgoing, std::size_t clientId, Nz::UInt32 data) { HandlePeerConnection(outgoing, clientId, data); },
+			reactorPtr->Poll([&](bool outgoing, std::size_t clientId, const Nz::IpAddress& remoteAddress, Nz::UInt32 data) { HandlePeerConnection(outgoing, clientId, remoteAddress, data); },
 			                 [&](std::size_t clientId, Nz::UInt32 data) { HandlePeerDisconnection(clientId, data); },
 			                 [&](std::size_t clientId, Nz::NetPacket&& packet) { HandlePeerPacket(clientId, std::move(packet)); },
 			                 [&](std::size_t clientId, const NetworkReactor::PeerInfo& peerInfo) { HandlePeerInfo(clientId, peerInfo); });
@@ -3,9 +3,9 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/ConfigFile.hpp>
+#include <Shared/Logger.hpp>
 #include <Shared/Utils.hpp>
 #include <Nazara/Lua/LuaInstance.hpp>
-#include <iostream>
 
 namespace ewn
 {
@@ -37,7 +37,7 @@ namespace ewn
 
 		if (!configFile.ExecuteFromFile(fileName))
 		{
-			std::cerr << "Failed to parse " << fileName << ": " << configFile.GetLastError() << std::endl;
+			LogError(LogCategory::Config) << "Failed to parse " << fileName << ": " << configFile.GetLastError();
 			return false;
 		}
 
@@ -61,7 +61,7 @@ namespace ewn
 
 			if (!PushLuaVariable(optionName))
 			{
-				std::cerr << "Missing config option \"" << optionName << "\"" << std::endl;
+				LogError(LogCategory::Config) << "Missing config option \"" << optionName << "\"";
 				return false;
 			}
 
@@ -115,11 +115,11 @@ namespace ewn
 			}
 			catch (const std::exception& e)
 			{
-				std::cerr << "Failed to get " << optionName << ": " << e.what() << std::endl;
+				LogError(LogCategory::Config) << "Failed to get " << optionName << ": " << e.what();
 			}
 			catch (...)
 			{
-				std::cerr << "Failed to get " << optionName << ": " << configFile.ToString(-1) << std::endl;
+				LogError(LogCategory::Config) << "Failed to get " << optionName << ": " << configFile.ToString(-1);
 				configFile.Pop(configFile.GetStackTop());
 			}
 
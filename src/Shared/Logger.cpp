@@ -0,0 +1,281 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Logger.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Nazara/Core/Thread.hpp>
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+
+namespace ewn
+{
+	namespace
+	{
+		std::atomic_bool s_shutdown(false);
+
+		// Started on first use, stopped (after writing everything left) when the program exits
+		class LogWriter
+		{
+			public:
+				LogWriter(void(*function)()) :
+				m_thread(function)
+				{
+					m_thread.SetName("Logger");
+				}
+
+				~LogWriter()
+				{
+					s_shutdown.store(true, std::memory_order_release);
+					m_thread.Join();
+				}
+
+			private:
+				Nz::Thread m_thread;
+		};
+	}
+
+	void Logger::Flush()
+	{
+		while (Drain());
+	}
+
+	bool Logger::ShouldLog(LogLevel level, LogCategory category)
+	{
+		if (level < GetMinimumLevel())
+			return false;
+
+		assert(static_cast<std::size_t>(category) < CategoryCount);
+		CategoryState& categoryState = s_categories[static_cast<std::size_t>(category)];
+
+		unsigned int rateLimit = categoryState.rateLimit.load(std::memory_order_relaxed);
+		if (rateLimit == 0)
+			return true;
+
+		// Fixed one-second windows, slightly racy on window change but we don't need to be exact
+		Nz::UInt64 now = Nz::GetElapsedMilliseconds();
+		Nz::UInt64 windowStart = categoryState.windowStart.load(std::memory_order_relaxed);
+		if (now - windowStart >= 1000 && categoryState.windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+			categoryState.windowCount.store(0, std::memory_order_relaxed);
+
+		if (categoryState.windowCount.fetch_add(1, std::memory_order_relaxed) >= rateLimit)
+		{
+			categoryState.suppressedCount.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		return true;
+	}
+
+	bool Logger::Drain()
+	{
+		std::lock_guard<std::mutex> drainLock(s_drainMutex);
+
+		{
+			std::lock_guard<std::mutex> queueLock(s_queueMutex);
+			for (auto it = s_queues.begin(); it != s_queues.end();)
+			{
+				ThreadQueue& queue = **it;
+
+				std::size_t readIndex = queue.readIndex.load(std::memory_order_relaxed);
+				std::size_t writeIndex = queue.writeIndex.load(std::memory_order_acquire);
+				for (std::size_t i = readIndex; i < writeIndex; ++i)
+					s_pendingRecords.emplace_back(std::move(queue.records[i % QueueCapacity]));
+
+				queue.readIndex.store(writeIndex, std::memory_order_release);
+
+				if (Nz::UInt64 droppedCount = queue.droppedCount.exchange(0, std::memory_order_relaxed); droppedCount > 0)
+				{
+					Record& record = s_pendingRecords.emplace_back();
+					record.category = LogCategory::Server;
+					record.level = LogLevel::Warning;
+					record.message = "[Logger] " + std::to_string(droppedCount) + " messages dropped, thread #" + std::to_string(queue.threadId) + " logs too fast";
+					record.threadId = queue.threadId;
+					record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+				}
+
+				// Forget about exited threads once everything they logged has been written
+				if (it->use_count() == 1)
+					it = s_queues.erase(it);
+				else
+					++it;
+			}
+		}
+
+		for (std::size_t i = 0; i < CategoryCount; ++i)
+		{
+			if (Nz::UInt64 suppressedCount = s_categories[i].suppressedCount.exchange(0, std::memory_order_relaxed); suppressedCount > 0)
+			{
+				Record& record = s_pendingRecords.emplace_back();
+				record.category = static_cast<LogCategory>(i);
+				record.level = LogLevel::Warning;
+				record.message = "[Logger] " + std::to_string(suppressedCount) + " messages suppressed by rate limit";
+				record.threadId = 0;
+				record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			}
+		}
+
+		if (s_pendingRecords.empty())
+			return false;
+
+		// Threads are drained one after the other, restore a global ordering
+		std::stable_sort(s_pendingRecords.begin(), s_pendingRecords.end(), [](const Record& lhs, const Record& rhs)
+		{
+			return lhs.timestamp < rhs.timestamp;
+		});
+
+		for (const Record& record : s_pendingRecords)
+			Write(record);
+
+		std::cout.flush();
+		std::cerr.flush();
+
+		s_pendingRecords.clear();
+		return true;
+	}
+
+	auto Logger::GetThreadQueue() -> ThreadQueue&
+	{
+		thread_local std::shared_ptr<ThreadQueue> threadQueue = []()
+		{
+			static std::atomic<std::size_t> nextThreadId(0);
+
+			auto queue = std::make_shared<ThreadQueue>();
+			queue->threadId = nextThreadId++;
+
+			std::lock_guard<std::mutex> lock(s_queueMutex);
+			s_queues.push_back(queue);
+
+			return queue;
+		}();
+
+		return *threadQueue;
+	}
+
+	void Logger::Submit(LogLevel level, LogCategory category, std::string message)
+	{
+		static LogWriter writer(&Logger::WriterThread);
+
+		Record record;
+		record.category = category;
+		record.level = level;
+		record.message = std::move(message);
+		record.timestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+
+		// Logging from static destructors, after the writer is gone
+		if (s_shutdown.load(std::memory_order_acquire))
+		{
+			record.threadId = 0;
+
+			std::lock_guard<std::mutex> drainLock(s_drainMutex);
+			Write(record);
+			return;
+		}
+
+		ThreadQueue& queue = GetThreadQueue();
+		record.threadId = queue.threadId;
+
+		std::size_t writeIndex = queue.writeIndex.load(std::memory_order_relaxed);
+		if (writeIndex - queue.readIndex.load(std::memory_order_acquire) >= QueueCapacity)
+		{
+			queue.droppedCount.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		queue.records[writeIndex % QueueCapacity] = std::move(record);
+		queue.writeIndex.store(writeIndex + 1, std::memory_order_release);
+	}
+
+	void Logger::Write(const Record& record)
+	{
+		std::time_t seconds = static_cast<std::time_t>(record.timestamp / 1'000'000);
+		unsigned int milliseconds = static_cast<unsigned int>((record.timestamp / 1000) % 1000);
+
+		// Only called with s_drainMutex held, localtime isn't thread-safe
+		std::ostream& stream = (record.level >= LogLevel::Warning) ? std::cerr : std::cout;
+		stream << std::put_time(std::localtime(&seconds), "%Y-%m-%d %H:%M:%S") << '.' << std::setfill('0') << std::setw(3) << milliseconds << std::setfill(' ');
+		stream << " [" << EnumToString(record.level) << "] [" << EnumToString(record.category) << "] " << record.message << '\n';
+	}
+
+	void Logger::WriterThread()
+	{
+		while (!s_shutdown.load(std::memory_order_acquire))
+		{
+			if (!Drain())
+				Nz::Thread::Sleep(5);
+		}
+
+		Flush();
+	}
+
+	const char* EnumToString(LogCategory category)
+	{
+		switch (category)
+		{
+			case LogCategory::Arena:
+				return "Arena";
+
+			case LogCategory::Chat:
+				return "Chat";
+
+			case LogCategory::Client:
+				return "Client";
+
+			case LogCategory::Config:
+				return "Config";
+
+			case LogCategory::Database:
+				return "Database";
+
+			case LogCategory::Network:
+				return "Network";
+
+			case LogCategory::Player:
+				return "Player";
+
+			case LogCategory::Script:
+				return "Script";
+
+			case LogCategory::Server:
+				return "Server";
+
+			case LogCategory::Store:
+				return "Store";
+		}
+
+		assert(!"Unhandled enum value");
+		return nullptr;
+	}
+
+	const char* EnumToString(LogLevel level)
+	{
+		switch (level)
+		{
+			case LogLevel::Debug:
+				return "Debug";
+
+			case LogLevel::Info:
+				return "Info";
+
+			case LogLevel::Warning:
+				return "Warning";
+
+			case LogLevel::Error:
+				return "Error";
+		}
+
+		assert(!"Unhandled enum value");
+		return nullptr;
+	}
+
+	std::array<Logger::CategoryState, Logger::CategoryCount> Logger::s_categories;
+	std::atomic<LogLevel> Logger::s_minimumLevel(LogLevel::Info);
+	std::mutex Logger::s_drainMutex;
+	std::mutex Logger::s_queueMutex;
+	std::vector<std::shared_ptr<Logger::ThreadQueue>> Logger::s_queues;
+	std::vector<Logger::Record> Logger::s_pendingRecords;
+}
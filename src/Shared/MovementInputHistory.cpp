@@ -0,0 +1,125 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/MovementInputHistory.hpp>
+#include <algorithm>
+#include <cassert>
+
+namespace ewn
+{
+	namespace
+	{
+		constexpr Nz::UInt64 MaxRedundantInputAge = 1000; //< Older inputs are not worth sending again, prediction doesn't replay them either
+	}
+
+	MovementInputHistory::MovementInputHistory() :
+	m_previousInputCount(0)
+	{
+	}
+
+	MovementInputHistory::Input MovementInputHistory::PushInput(Nz::UInt64 inputTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation, Packets::PlayerMovement* packet)
+	{
+		assert(packet);
+
+		// Server time went back (clock resynchronization), the server will ignore this input and the previous ones can't be delta-encoded
+		if (m_previousInputCount > 0 && inputTime <= m_previousInputs[0].inputTime)
+			Clear();
+
+		while (m_previousInputCount > 0 && inputTime - m_previousInputs[m_previousInputCount - 1].inputTime > MaxRedundantInputAge)
+			m_previousInputCount--;
+
+		SentInput input;
+		input.inputTime = inputTime;
+		for (std::size_t i = 0; i < 3; ++i)
+		{
+			input.values[i] = Quantize(direction[i]);
+			input.values[3 + i] = Quantize(rotation[i]);
+		}
+
+		packet->inputTime = inputTime;
+		packet->values = input.values;
+		packet->previousInputs.resize(m_previousInputCount);
+
+		// Consecutive inputs are usually close to each other, deltas mostly fit in a single byte
+		const SentInput* nextInput = &input;
+		for (std::size_t i = 0; i < m_previousInputCount; ++i)
+		{
+			const SentInput& previousInput = m_previousInputs[i];
+
+			auto& previousInputData = packet->previousInputs[i];
+			previousInputData.timeDelta = static_cast<Nz::UInt32>(nextInput->inputTime - previousInput.inputTime);
+			for (std::size_t j = 0; j < previousInput.values.size(); ++j)
+				previousInputData.valueDeltas[j] = static_cast<Nz::Int16>(int(previousInput.values[j]) - int(nextInput->values[j]));
+
+			nextInput = &previousInput;
+		}
+
+		std::size_t newInputCount = std::min(m_previousInputCount + 1, MaxRedundantInputs);
+		std::move_backward(m_previousInputs.begin(), m_previousInputs.begin() + newInputCount - 1, m_previousInputs.begin() + newInputCount);
+		m_previousInputs[0] = input;
+		m_previousInputCount = newInputCount;
+
+		return DequantizeInput(inputTime, input.values);
+	}
+
+	// Fills inputs from the oldest to the most recent one and returns how many there are
+	std::size_t MovementInputHistory::DecodePacket(const Packets::PlayerMovement& packet, DecodedInputs* inputs)
+	{
+		assert(inputs);
+
+		Nz::UInt64 inputTime = packet.inputTime;
+		QuantizedValues values = packet.values;
+
+		std::size_t inputCount = 0;
+		(*inputs)[inputCount++] = DequantizeInput(inputTime, values);
+
+		// Walk back from the most recent input and stop at the first inconsistent one
+		std::size_t previousInputCount = std::min(packet.previousInputs.size(), MaxRedundantInputs);
+		for (std::size_t i = 0; i < previousInputCount; ++i)
+		{
+			const auto& previousInputData = packet.previousInputs[i];
+
+			Nz::UInt32 timeDelta = previousInputData.timeDelta;
+			if (timeDelta == 0 || timeDelta >= inputTime)
+				break;
+
+			QuantizedValues previousValues;
+
+			bool isValid = true;
+			for (std::size_t j = 0; j < values.size(); ++j)
+			{
+				int value = int(values[j]) + Nz::Int16(previousInputData.valueDeltas[j]);
+				if (value < 0 || value > QuantizedMax)
+				{
+					isValid = false;
+					break;
+				}
+
+				previousValues[j] = static_cast<Nz::UInt8>(value);
+			}
+
+			if (!isValid)
+				break;
+
+			inputTime -= timeDelta;
+			values = previousValues;
+
+			(*inputs)[inputCount++] = DequantizeInput(inputTime, values);
+		}
+
+		std::reverse(inputs->begin(), inputs->begin() + inputCount);
+
+		return inputCount;
+	}
+
+	MovementInputHistory::Input MovementInputHistory::DequantizeInput(Nz::UInt64 inputTime, const QuantizedValues& values)
+	{
+		Input input;
+		input.inputTime = inputTime;
+		input.direction = Nz::Vector3f(Dequantize(values[0]), Dequantize(values[1]), Dequantize(values[2]));
+		input.rotation = Nz::Vector3f(Dequantize(values[3]), Dequantize(values[4]), Dequantize(values[5]));
+
+		return input;
+	}
+}
@@ -4,6 +4,7 @@
 
 #include <Shared/NetworkReactor.hpp>
 #include <Shared/Config.hpp>
+#include <Shared/Profiler.hpp>
 #include <Shared/Utils.hpp>
 #include <cassert>
 #include <condition_variable>
@@ -84,6 +85,20 @@ namespace ewn
 		m_outgoingQueue.enqueue(std::move(outgoingData));
 	}
 
+	auto NetworkReactor::GetChannelStats(Nz::UInt8 channelId) const -> ChannelStats
+	{
+		assert(channelId < m_channelStats.size());
+		const AtomicChannelStats& channelStats = m_channelStats[channelId];
+
+		ChannelStats stats;
+		stats.receivedBytes = channelStats.receivedBytes.load(std::memory_order_relaxed);
+		stats.receivedPackets = channelStats.receivedPackets.load(std::memory_order_relaxed);
+		stats.sentBytes = channelStats.sentBytes.load(std::memory_order_relaxed);
+		stats.sentPackets = channelStats.sentPackets.load(std::memory_order_relaxed);
+
+		return stats;
+	}
+
 	void NetworkReactor::QueryInfo(std::size_t peerId)
 	{
 		assert(peerId >= m_firstId);
@@ -117,6 +132,8 @@ namespace ewn
 		moodycamel::ConsumerToken outgoingToken(m_outgoingQueue);
 		moodycamel::ProducerToken incomingToken(m_incomingQueue);
 
+		Profiler::SetThreadName("NetworkReactor");
+
 		while (m_running.load(std::memory_order_acquire))
 		{
 			ReceivePackets(incomingToken);
@@ -149,6 +166,9 @@ namespace ewn
 		Nz::ENetEvent event;
 		if (m_host.Service(&event, 5) > 0)
 		{
+			// Don't include the Service wait in the zone
+			ProfileZone("NetworkReactor::ReceivePackets");
+
 			do
 			{
 				switch (event.type)
@@ -178,6 +198,7 @@ namespace ewn
 						IncomingEvent::ConnectEvent connectEvent;
 						connectEvent.data = event.data;
 						connectEvent.outgoingConnection = (event.type == Nz::ENetEventType::OutgoingConnect);
+						connectEvent.remoteAddress = event.peer->GetAddress();
 
 						IncomingEvent newEvent;
 						newEvent.peerId = m_firstId + peerId;
@@ -191,6 +212,13 @@ namespace ewn
 					{
 						Nz::UInt16 peerId = event.peer->GetPeerId();
 
+						if (event.channelId < m_channelStats.size())
+						{
+							AtomicChannelStats& channelStats = m_channelStats[event.channelId];
+							channelStats.receivedBytes.fetch_add(event.packet->data.GetDataSize(), std::memory_order_relaxed);
+							channelStats.receivedPackets.fetch_add(1, std::memory_order_relaxed);
+						}
+
 						IncomingEvent::PacketEvent packetEvent;
 						packetEvent.packet = std::move(event.packet->data);
 
@@ -212,6 +240,8 @@ namespace ewn
 
 	void NetworkReactor::SendPackets(const moodycamel::ProducerToken& producterToken, const moodycamel::ConsumerToken& token)
 	{
+		ProfileZone("NetworkReactor::SendPackets");
+
 		OutgoingEvent outEvent;
 		while (m_outgoingQueue.try_dequeue(outEvent))
 		{
@@ -257,7 +287,16 @@ namespace ewn
 				else if constexpr (std::is_same_v<T, OutgoingEvent::PacketEvent>)
 				{
 					if (Nz::ENetPeer* peer = m_clients[outEvent.peerId])
+					{
+						if (arg.channelId < m_channelStats.size())
+						{
+							AtomicChannelStats& channelStats = m_channelStats[arg.channelId];
+							channelStats.sentBytes.fetch_add(arg.packet.GetDataSize(), std::memory_order_relaxed);
+							channelStats.sentPackets.fetch_add(1, std::memory_order_relaxed);
+						}
+
 						peer->Send(arg.channelId, arg.flags, std::move(arg.packet));
+					}
 				}
 				else if constexpr (std::is_same_v<T, OutgoingEvent::QueryPeerInfo>)
 				{
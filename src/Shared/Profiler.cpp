@@ -0,0 +1,140 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Profiler.hpp>
+#include <Nazara/Core/Clock.hpp>
+#include <Shared/Logger.hpp>
+#include <algorithm>
+#include <fstream>
+
+namespace ewn
+{
+	namespace
+	{
+		std::string EscapeJson(const std::string& str)
+		{
+			std::string escaped;
+			escaped.reserve(str.size());
+
+			for (char c : str)
+			{
+				if (c == '"' || c == '\\')
+					escaped += '\\';
+
+				escaped += c;
+			}
+
+			return escaped;
+		}
+	}
+
+	bool Profiler::ExportChromeTrace(const std::string& filePath, Nz::UInt64 duration)
+	{
+		std::ofstream file(filePath, std::ios::out | std::ios::trunc);
+		if (!file.is_open())
+		{
+			LogError(LogCategory::Server) << "Failed to open " << filePath << " for writing";
+			return false;
+		}
+
+		Nz::UInt64 now = Nz::GetElapsedMicroseconds();
+		Nz::UInt64 minTime = (now > duration) ? now - duration : 0;
+
+		std::vector<std::shared_ptr<ThreadBuffer>> threadBuffers;
+		{
+			std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+			threadBuffers = s_threadBuffers;
+		}
+
+		struct ZoneData
+		{
+			const char* name;
+			Nz::UInt64 startTime;
+			Nz::UInt64 endTime;
+		};
+
+		std::vector<ZoneData> zones;
+		zones.reserve(RingBufferSize);
+
+		bool first = true;
+		auto BeginEvent = [&]() -> std::ofstream&
+		{
+			if (!first)
+				file << ",\n";
+
+			first = false;
+			return file;
+		};
+
+		file << "{\"traceEvents\":[\n";
+		for (const auto& bufferPtr : threadBuffers)
+		{
+			ThreadBuffer& buffer = *bufferPtr;
+
+			{
+				std::lock_guard<std::mutex> lock(buffer.nameMutex);
+				if (!buffer.name.empty())
+					BeginEvent() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer.threadId << R"(,"args":{"name":")" << EscapeJson(buffer.name) << "\"}}";
+			}
+
+			Nz::UInt64 writeIndex = buffer.writeIndex.load(std::memory_order_acquire);
+			Nz::UInt64 firstIndex = (writeIndex > RingBufferSize) ? writeIndex - RingBufferSize : 0;
+
+			zones.clear();
+			for (Nz::UInt64 i = firstIndex; i < writeIndex; ++i)
+			{
+				const ZoneEntry& entry = buffer.zones[i % RingBufferSize];
+				zones.push_back({ entry.name.load(std::memory_order_relaxed), entry.startTime.load(std::memory_order_relaxed), entry.endTime.load(std::memory_order_relaxed) });
+			}
+
+			// Drop the entries the thread may have overwritten while we were copying them
+			std::atomic_thread_fence(std::memory_order_acquire);
+			Nz::UInt64 reserveIndex = buffer.reserveIndex.load(std::memory_order_relaxed);
+			Nz::UInt64 firstValidIndex = (reserveIndex > RingBufferSize) ? reserveIndex - RingBufferSize : 0;
+
+			for (Nz::UInt64 i = std::max(firstIndex, firstValidIndex); i < writeIndex; ++i)
+			{
+				const ZoneData& zone = zones[i - firstIndex];
+				if (zone.endTime < minTime)
+					continue;
+
+				BeginEvent() << R"({"name":")" << zone.name << R"(","ph":"X","pid":1,"tid":)" << buffer.threadId << R"(,"ts":)" << zone.startTime << R"(,"dur":)" << (zone.endTime - zone.startTime) << "}";
+			}
+		}
+		file << "\n]}\n";
+
+		return file.good();
+	}
+
+	void Profiler::SetThreadName(std::string name)
+	{
+		if constexpr (!IsEnabled())
+			return;
+
+		ThreadBuffer& buffer = GetThreadBuffer();
+
+		std::lock_guard<std::mutex> lock(buffer.nameMutex);
+		buffer.name = std::move(name);
+	}
+
+	auto Profiler::GetThreadBuffer() -> ThreadBuffer&
+	{
+		// Buffers are owned by s_threadBuffers as well, so zones of finished threads can still be exported
+		thread_local std::shared_ptr<ThreadBuffer> threadBuffer = []()
+		{
+			auto buffer = std::make_shared<ThreadBuffer>();
+
+			std::lock_guard<std::mutex> lock(s_threadBufferMutex);
+			buffer->threadId = s_threadBuffers.size();
+			s_threadBuffers.push_back(buffer);
+
+			return buffer;
+		}();
+
+		return *threadBuffer;
+	}
+
+	std::mutex Profiler::s_threadBufferMutex;
+	std::vector<std::shared_ptr<Profiler::ThreadBuffer>> Profiler::s_threadBuffers;
+}
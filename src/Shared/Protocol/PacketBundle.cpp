@@ -0,0 +1,21 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/Protocol/PacketBundle.hpp>
+
+namespace ewn
+{
+	void PacketBundle::Flush(Nz::NetPacket& packet)
+	{
+		assert(!IsEmpty());
+
+		// A lone message doesn't need the bundle framing
+		if (m_messageCount == 1)
+			packet.Reset(0, m_buffer.data() + m_firstMessageOffset, m_buffer.size() - m_firstMessageOffset);
+		else
+			packet.Reset(0, m_buffer.data(), m_buffer.size());
+
+		Clear();
+	}
+}
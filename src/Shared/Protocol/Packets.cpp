@@ -5,507 +5,768 @@
 #include <Shared/Protocol/Packets.hpp>
 #include <Nazara/Core/Algorithm.hpp>
 #include <Nazara/Math/Vector3.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
+#include <Shared/Protocol/PacketSizer.hpp>
+#include <Shared/Protocol/PacketWriter.hpp>
 #include <Shared/Utils.hpp>
+#include <type_traits>
 
 namespace ewn
 {
 	namespace Packets
 	{
-		void Serialize(PacketSerializer& serializer, ArenaList& data)
+		namespace
 		{
-			serializer.SerializeArraySize(data.arenas);
-			for (auto& arenaData : data.arenas)
-				serializer &= arenaData.arenaName;
-		}
+			// Packets are const when measured or written, and only modified when read
+			template<typename S, typename T> using PacketData = std::conditional_t<S::IsWriting, const T, T>;
 
-		void Serialize(PacketSerializer& serializer, ArenaPrefabs& data)
-		{
-			serializer &= data.startId;
+			// Packets are reused between reads, an optional field missing from the packet must not keep its previous value
+			template<typename S, typename T>
+			void ResetField(S& /*serializer*/, T& field)
+			{
+				if constexpr (!S::IsWriting)
+					field = T();
+			}
 
-			serializer.SerializeArraySize(data.prefabs);
-			for (auto& prefabs : data.prefabs)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ArenaList>& data)
 			{
-				serializer.SerializeArraySize(prefabs.models);
-				for (auto& model : prefabs.models)
-				{
-					serializer &= model.modelId;
-					serializer &= model.rotation;
-					serializer &= model.position;
-					serializer &= model.scale;
-				}
+				serializer.SerializeArraySize(data.arenas);
+				for (auto& arenaData : data.arenas)
+					serializer &= arenaData.arenaName;
+			}
 
-				serializer.SerializeArraySize(prefabs.sounds);
-				for (auto& sound : prefabs.sounds)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ArenaPrefabs>& data)
+			{
+				serializer &= data.startId;
+
+				serializer.SerializeArraySize(data.prefabs);
+				for (auto& prefabs : data.prefabs)
 				{
-					serializer &= sound.soundId;
-					serializer &= sound.position;
+					serializer.SerializeArraySize(prefabs.models);
+					for (auto& model : prefabs.models)
+					{
+						serializer &= model.modelId;
+						serializer &= model.rotation;
+						serializer &= model.position;
+						serializer &= model.scale;
+					}
+
+					serializer.SerializeArraySize(prefabs.sounds);
+					for (auto& sound : prefabs.sounds)
+					{
+						serializer &= sound.soundId;
+						serializer &= sound.position;
+					}
+
+					serializer.SerializeArraySize(prefabs.visualEffects);
+					for (auto& effect : prefabs.visualEffects)
+					{
+						serializer &= effect.effectNameId;
+						serializer &= effect.rotation;
+						serializer &= effect.position;
+						serializer &= effect.scale;
+					}
 				}
+			}
+
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ArenaParticleSystems>& data)
+			{
+				serializer &= data.startId;
 
-				serializer.SerializeArraySize(prefabs.visualEffects);
-				for (auto& effect : prefabs.visualEffects)
+				serializer.SerializeArraySize(data.particleSystems);
+				for (auto& particleSystem : data.particleSystems)
 				{
-					serializer &= effect.effectNameId;
-					serializer &= effect.rotation;
-					serializer &= effect.position;
-					serializer &= effect.scale;
+					serializer.SerializeArraySize(particleSystem.particleGroups);
+					for (auto& particleGroup : particleSystem.particleGroups)
+						serializer &= particleGroup.particleGroupNameId;
 				}
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, ArenaParticleSystems& data)
-		{
-			serializer &= data.startId;
-
-			serializer.SerializeArraySize(data.particleSystems);
-			for (auto& particleSystem : data.particleSystems)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ArenaSounds>& data)
 			{
-				serializer.SerializeArraySize(particleSystem.particleGroups);
-				for (auto& particleGroup : particleSystem.particleGroups)
-					serializer &= particleGroup.particleGroupNameId;
+				serializer &= data.startId;
+
+				serializer.SerializeArraySize(data.sounds);
+				for (auto& sound : data.sounds)
+					serializer &= sound.filePath;
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, ArenaSounds& data)
-		{
-			serializer &= data.startId;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ArenaState>& data)
+			{
+				serializer &= data.stateId;
+				serializer &= data.serverTime;
+				serializer &= data.lastProcessedInputTime;
 
-			serializer.SerializeArraySize(data.sounds);
-			for (auto& sound : data.sounds)
-				serializer &= sound.filePath;
-		}
+				serializer.SerializeArraySize(data.entities);
+				for (auto& entity : data.entities)
+				{
+					serializer &= entity.id;
+					serializer &= entity.position;
+					serializer &= entity.rotation;
+					serializer &= entity.angularVelocity;
+					serializer &= entity.linearVelocity;
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, ArenaState& data)
-		{
-			serializer &= data.stateId;
-			serializer &= data.serverTime;
-			serializer &= data.lastProcessedInputTime;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, BotMessage>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.messageType);
+				serializer &= data.errorMessage;
+			}
 
-			serializer.SerializeArraySize(data.entities);
-			for (auto& entity : data.entities)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CachedPacketVersion>& data)
 			{
-				serializer &= entity.id;
-				serializer &= entity.position;
-				serializer &= entity.rotation;
-				serializer &= entity.angularVelocity;
-				serializer &= entity.linearVelocity;
+				serializer.template Serialize<Nz::UInt8>(data.packetType);
+				serializer &= data.version;
+				serializer.template Serialize<Nz::UInt8>(data.useCachedPacket);
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, BotMessage& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.messageType);
-			serializer &= data.errorMessage;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ChatMessage>& data)
+			{
+				serializer &= data.message;
+			}
 
-		void Serialize(PacketSerializer& serializer, ChatMessage& data)
-		{
-			serializer &= data.message;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ControlEntity>& data)
+			{
+				serializer &= data.id;
+			}
 
-		void Serialize(PacketSerializer& serializer, ControlEntity& data)
-		{
-			serializer &= data.id;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateEntities>& data)
+			{
+				serializer.SerializeArraySize(data.entities);
+				for (auto& entityData : data.entities)
+				{
+					serializer &= entityData.angularVelocity;
+					serializer &= entityData.entityId;
+					serializer &= entityData.linearVelocity;
+					serializer &= entityData.position;
+					serializer &= entityData.prefabId;
+					serializer &= entityData.rotation;
+					serializer &= entityData.visualName;
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, CreateEntities& data)
-		{
-			serializer.SerializeArraySize(data.entities);
-			for (auto& entityData : data.entities)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateFleet>& data)
 			{
-				serializer &= entityData.angularVelocity;
-				serializer &= entityData.entityId;
-				serializer &= entityData.linearVelocity;
-				serializer &= entityData.position;
-				serializer &= entityData.prefabId;
-				serializer &= entityData.rotation;
-				serializer &= entityData.visualName;
+				serializer &= data.fleetName;
+				serializer.SerializeArraySize(data.spaceshipNames);
+				for (auto& name : data.spaceshipNames)
+					serializer &= name;
+
+				serializer.SerializeArraySize(data.spaceships);
+				for (auto& spaceship : data.spaceships)
+				{
+					serializer &= spaceship.spaceshipNameId;
+					serializer &= spaceship.spaceshipPosition;
+				}
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, CreateFleet& data)
-		{
-			serializer &= data.fleetName;
-			serializer.SerializeArraySize(data.spaceshipNames);
-			for (auto& name : data.spaceshipNames)
-				serializer &= name;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateFleetFailure>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.reason);
+			}
 
-			serializer.SerializeArraySize(data.spaceships);
-			for (auto& spaceship : data.spaceships)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateFleetSuccess>& data)
 			{
-				serializer &= spaceship.spaceshipNameId;
-				serializer &= spaceship.spaceshipPosition;
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, CreateFleetFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateProjectiles>& data)
+			{
+				serializer.SerializeArraySize(data.projectiles);
+				for (auto& projectile : data.projectiles)
+				{
+					serializer &= projectile.direction;
+					serializer &= projectile.lifeTime;
+					serializer &= projectile.origin;
+					serializer &= projectile.prefabId;
+					serializer &= projectile.projectileId;
+					serializer &= projectile.spawnTime;
+					serializer &= projectile.speed;
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, CreateFleetSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateSpaceship>& data)
+			{
+				serializer &= data.hullId;
+				serializer &= data.spaceshipName;
+				serializer &= data.spaceshipCode;
 
-		void Serialize(PacketSerializer& serializer, CreateSpaceship& data)
-		{
-			serializer &= data.hullId;
-			serializer &= data.spaceshipName;
-			serializer &= data.spaceshipCode;
+				serializer.SerializeArraySize(data.modules);
+				for (auto& moduleInfo : data.modules)
+				{
+					serializer.template Serialize<Nz::UInt8>(moduleInfo.type);
+					serializer &= moduleInfo.moduleId;
+				}
+			}
 
-			serializer.SerializeArraySize(data.modules);
-			for (auto& moduleInfo : data.modules)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateSpaceshipFailure>& data)
 			{
-				serializer.Serialize<Nz::UInt8>(moduleInfo.type);
-				serializer &= moduleInfo.moduleId;
+				serializer.template Serialize<Nz::UInt8>(data.reason);
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, CreateSpaceshipFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, CreateSpaceshipSuccess>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, CreateSpaceshipSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeclareCachedPackets>& data)
+			{
+				serializer.SerializeArraySize(data.packets);
+				for (auto& packet : data.packets)
+				{
+					serializer.template Serialize<Nz::UInt8>(packet.packetType);
+					serializer &= packet.version;
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteEntities& data)
-		{
-			serializer.SerializeArraySize(data.entities);
-			for (auto& id : data.entities)
-				serializer &= id;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteEntities>& data)
+			{
+				serializer.SerializeArraySize(data.entities);
+				for (auto& id : data.entities)
+					serializer &= id;
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteFleet& data)
-		{
-			serializer &= data.fleetName;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteFleet>& data)
+			{
+				serializer &= data.fleetName;
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteFleetFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteFleetFailure>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.reason);
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteFleetSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteFleetSuccess>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteSpaceship& data)
-		{
-			serializer &= data.spaceshipName;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteProjectiles>& data)
+			{
+				serializer.SerializeArraySize(data.projectiles);
+				for (auto& id : data.projectiles)
+					serializer &= id;
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteSpaceshipFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteSpaceship>& data)
+			{
+				serializer &= data.spaceshipName;
+			}
 
-		void Serialize(PacketSerializer& serializer, DeleteSpaceshipSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteSpaceshipFailure>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.reason);
+			}
 
-		void Serialize(PacketSerializer& serializer, FleetInfo& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.spaceshipInfo);
-			serializer &= data.fleetName;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, DeleteSpaceshipSuccess>& data)
+			{
+			}
 
-			serializer.SerializeArraySize(data.spaceshipTypes);
-			for (auto& spaceshipType : data.spaceshipTypes)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, FleetInfo>& data)
 			{
-				serializer &= spaceshipType.dimensions;
-				serializer &= spaceshipType.scale;
+				serializer.template Serialize<Nz::UInt8>(data.spaceshipInfo);
+				serializer &= data.fleetName;
 
-				if (data.spaceshipInfo & SpaceshipQueryInfo::Code)
-					serializer &= spaceshipType.script;
+				serializer.SerializeArraySize(data.spaceshipTypes);
+				for (auto& spaceshipType : data.spaceshipTypes)
+				{
+					serializer &= spaceshipType.dimensions;
+					serializer &= spaceshipType.scale;
 
-				if (data.spaceshipInfo & SpaceshipQueryInfo::HullModelPath)
-					serializer &= spaceshipType.hullModelPath;
+					if (data.spaceshipInfo & SpaceshipQueryInfo::Code)
+						serializer &= spaceshipType.script;
+					else
+						ResetField(serializer, spaceshipType.script);
 
-				if (data.spaceshipInfo & SpaceshipQueryInfo::Modules)
-				{
-					serializer.SerializeArraySize(spaceshipType.modules);
-					for (auto& moduleData : spaceshipType.modules)
+					if (data.spaceshipInfo & SpaceshipQueryInfo::HullModelPath)
+						serializer &= spaceshipType.hullModelPath;
+					else
+						ResetField(serializer, spaceshipType.hullModelPath);
+
+					if (data.spaceshipInfo & SpaceshipQueryInfo::Modules)
 					{
-						serializer &= moduleData.currentModule;
-						serializer.Serialize<Nz::UInt8>(moduleData.type);
+						serializer.SerializeArraySize(spaceshipType.modules);
+						for (auto& moduleData : spaceshipType.modules)
+						{
+							serializer &= moduleData.currentModule;
+							serializer.template Serialize<Nz::UInt8>(moduleData.type);
+						}
 					}
+					else
+						ResetField(serializer, spaceshipType.modules);
+
+					if (data.spaceshipInfo & SpaceshipQueryInfo::Name)
+						serializer &= spaceshipType.name;
+					else
+						ResetField(serializer, spaceshipType.name);
 				}
 
-				if (data.spaceshipInfo & SpaceshipQueryInfo::Name)
-					serializer &= spaceshipType.name;
+				serializer.SerializeArraySize(data.spaceships);
+				for (auto& spaceship : data.spaceships)
+				{
+					serializer &= spaceship.position;
+					serializer &= spaceship.spaceshipType;
+				}
 			}
 
-			serializer.SerializeArraySize(data.spaceships);
-			for (auto& spaceship : data.spaceships)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, FleetList>& data)
 			{
-				serializer &= spaceship.position;
-				serializer &= spaceship.spaceshipType;
+				serializer.SerializeArraySize(data.fleets);
+				for (auto& fleet : data.fleets)
+					serializer &= fleet.name;
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, FleetList& data)
-		{
-			serializer.SerializeArraySize(data.fleets);
-			for (auto& fleet : data.fleets)
-				serializer &= fleet.name;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, HullList>& data)
+			{
+				serializer.SerializeArraySize(data.hulls);
+				for (auto& hullInfo : data.hulls)
+				{
+					serializer &= hullInfo.hullId;
+					serializer &= hullInfo.hullModelPathId;
+					serializer &= hullInfo.name;
+					serializer &= hullInfo.description;
+
+					serializer.SerializeArraySize(hullInfo.slots);
+					for (auto& slotInfo : hullInfo.slots)
+						serializer.template Serialize<Nz::UInt8>(slotInfo.type);
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, HullList& data)
-		{
-			serializer.SerializeArraySize(data.hulls);
-			for (auto& hullInfo : data.hulls)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, InstantiateEffects>& data)
 			{
-				serializer &= hullInfo.hullId;
-				serializer &= hullInfo.hullModelPathId;
-				serializer &= hullInfo.name;
-				serializer &= hullInfo.description;
+				serializer.SerializeArraySize(data.particleSystems);
+				for (auto& particleSystem : data.particleSystems)
+				{
+					serializer &= particleSystem.particleSystemId;
+					serializer &= particleSystem.rotation;
+					serializer &= particleSystem.position;
+					serializer &= particleSystem.scale;
+				}
 
-				serializer.SerializeArraySize(hullInfo.slots);
-				for (auto& slotInfo : hullInfo.slots)
-					serializer.Serialize<Nz::UInt8>(slotInfo.type);
+				serializer.SerializeArraySize(data.sounds);
+				for (auto& sound : data.sounds)
+				{
+					serializer &= sound.soundId;
+					serializer &= sound.position;
+				}
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, InstantiateParticleSystem& data)
-		{
-			serializer &= data.particleSystemId;
-			serializer &= data.rotation;
-			serializer &= data.position;
-			serializer &= data.scale;
-		}
-
-		void Serialize(PacketSerializer& serializer, IntegrityUpdate& data)
-		{
-			serializer &= data.integrityValue;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, InstantiateParticleSystem>& data)
+			{
+				serializer &= data.particleSystemId;
+				serializer &= data.rotation;
+				serializer &= data.position;
+				serializer &= data.scale;
+			}
 
-		void Serialize(PacketSerializer & serializer, LeaveArena& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, IntegrityUpdate>& data)
+			{
+				serializer &= data.integrityValue;
+			}
 
-		void Serialize(PacketSerializer& serializer, JoinArena& data)
-		{
-			serializer &= data.arenaIndex;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, LeaveArena>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, Login& data)
-		{
-			serializer &= data.login;
-			serializer &= data.passwordHash;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, JoinArena>& data)
+			{
+				serializer &= data.arenaIndex;
+			}
 
-			serializer.Serialize<Nz::UInt8>(data.generateConnectionToken);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, Login>& data)
+			{
+				serializer &= data.login;
+				serializer &= data.passwordHash;
 
-		void Serialize(PacketSerializer& serializer, LoginByToken& data)
-		{
-			serializer.SerializeArraySize(data.connectionToken);
-			for (auto& data : data.connectionToken)
-				serializer &= data;
+				serializer.template Serialize<Nz::UInt8>(data.generateConnectionToken);
+			}
 
-			serializer.Serialize<Nz::UInt8>(data.generateConnectionToken);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, LoginByToken>& data)
+			{
+				serializer.SerializeArraySize(data.connectionToken);
+				for (auto& data : data.connectionToken)
+					serializer &= data;
 
-		void Serialize(PacketSerializer& serializer, LoginFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+				serializer.template Serialize<Nz::UInt8>(data.generateConnectionToken);
+			}
 
-		void Serialize(PacketSerializer& serializer, LoginSuccess& data)
-		{
-			serializer.SerializeArraySize(data.connectionToken);
-			for (auto& data : data.connectionToken)
-				serializer &= data;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, LoginFailure>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.reason);
+				serializer &= data.retryAfter;
+			}
 
-		void Serialize(PacketSerializer& serializer, ModuleList& data)
-		{
-			// Modules
-			serializer.SerializeArraySize(data.modules);
-			for (auto& moduleTypeInfo : data.modules)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, LoginSuccess>& data)
 			{
-				serializer.Serialize<Nz::UInt8>(moduleTypeInfo.type);
+				serializer.SerializeArraySize(data.connectionToken);
+				for (auto& data : data.connectionToken)
+					serializer &= data;
+			}
 
-				// Available modules
-				serializer.SerializeArraySize(moduleTypeInfo.availableModules);
-				for (auto& moduleInfo : moduleTypeInfo.availableModules)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, ModuleList>& data)
+			{
+				// Modules
+				serializer.SerializeArraySize(data.modules);
+				for (auto& moduleTypeInfo : data.modules)
 				{
-					serializer &= moduleInfo.moduleId;
-					serializer &= moduleInfo.moduleName;
+					serializer.template Serialize<Nz::UInt8>(moduleTypeInfo.type);
+
+					// Available modules
+					serializer.SerializeArraySize(moduleTypeInfo.availableModules);
+					for (auto& moduleInfo : moduleTypeInfo.availableModules)
+					{
+						serializer &= moduleInfo.moduleId;
+						serializer &= moduleInfo.moduleName;
+					}
 				}
 			}
-		}
-
-		void Serialize(PacketSerializer& serializer, NetworkStrings& data)
-		{
-			serializer &= data.startId;
 
-			serializer.SerializeArraySize(data.strings);
-			for (auto& string : data.strings)
-				serializer &= string;
-		}
-
-		void Serialize(PacketSerializer& serializer, PlayerChat& data)
-		{
-			serializer &= data.text;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, NetworkStrings>& data)
+			{
+				serializer &= data.startId;
 
-		void Serialize(PacketSerializer& serializer, PlayerMovement& data)
-		{
-			serializer &= data.inputTime;
-			serializer &= data.direction;
-			serializer &= data.rotation;
-		}
+				serializer.SerializeArraySize(data.strings);
+				for (auto& string : data.strings)
+					serializer &= string;
+			}
 
-		void Serialize(PacketSerializer& serializer, PlayerShoot& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, PlayerChat>& data)
+			{
+				serializer &= data.text;
+			}
 
-		void Serialize(PacketSerializer& serializer, PlaySound& data)
-		{
-			serializer &= data.soundId;
-			serializer &= data.position;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, PlayerMovement>& data)
+			{
+				serializer &= data.inputTime;
+				for (auto& value : data.values)
+					serializer &= value;
 
-		void Serialize(PacketSerializer& serializer, QueryArenaList& data)
-		{
-		}
+				serializer.SerializeArraySize(data.previousInputs);
+				for (auto& previousInput : data.previousInputs)
+				{
+					serializer &= previousInput.timeDelta;
+					for (auto& valueDelta : previousInput.valueDeltas)
+						serializer &= valueDelta;
+				}
+			}
 
-		void Serialize(PacketSerializer& serializer, QueryFleetInfo& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.spaceshipInfo);
-			serializer &= data.fleetName;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, PlayerShoot>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, QueryFleetList& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, PlaySound>& data)
+			{
+				serializer &= data.soundId;
+				serializer &= data.position;
+			}
 
-		void Serialize(PacketSerializer& serializer, QueryHullList& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QueryArenaList>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, QueryModuleList& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QueryFleetInfo>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.spaceshipInfo);
+				serializer &= data.fleetName;
+			}
 
-		void Serialize(PacketSerializer& serializer, QuerySpaceshipInfo& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.info);
-			serializer &= data.spaceshipName;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QueryFleetList>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, QuerySpaceshipList& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QueryHullList>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, Register& data)
-		{
-			serializer &= data.login;
-			serializer &= data.email;
-			serializer &= data.passwordHash;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QueryModuleList>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, RegisterFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QuerySpaceshipInfo>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.info);
+				serializer &= data.spaceshipName;
+			}
 
-		void Serialize(PacketSerializer& serializer, RegisterSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, QuerySpaceshipList>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, SpaceshipInfo& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.info);
-			serializer &= data.collisionBox;
-			serializer &= data.hullId;
-			serializer &= data.scale;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, Register>& data)
+			{
+				serializer &= data.login;
+				serializer &= data.email;
+				serializer &= data.passwordHash;
+			}
 
-			if (data.info & SpaceshipQueryInfo::Code)
-				serializer &= data.code;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, RegisterFailure>& data)
+			{
+				serializer.template Serialize<Nz::UInt8>(data.reason);
+				serializer &= data.retryAfter;
+			}
 
-			if (data.info & SpaceshipQueryInfo::HullModelPath)
-				serializer &= data.hullModelPath;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, RegisterSuccess>& data)
+			{
+			}
 
-			if (data.info & SpaceshipQueryInfo::Name)
-				serializer &= data.spaceshipName;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, RelayLogin>& data)
+			{
+				serializer &= data.secret;
+			}
 
-			if (data.info & SpaceshipQueryInfo::Modules)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, SpaceshipInfo>& data)
 			{
-				serializer.SerializeArraySize(data.modules);
-				for (auto& moduleInfo : data.modules)
+				serializer.template Serialize<Nz::UInt8>(data.info);
+				serializer &= data.collisionBox;
+				serializer &= data.hullId;
+				serializer &= data.scale;
+
+				if (data.info & SpaceshipQueryInfo::Code)
+					serializer &= data.code;
+				else
+					ResetField(serializer, data.code);
+
+				if (data.info & SpaceshipQueryInfo::HullModelPath)
+					serializer &= data.hullModelPath;
+				else
+					ResetField(serializer, data.hullModelPath);
+
+				if (data.info & SpaceshipQueryInfo::Name)
+					serializer &= data.spaceshipName;
+				else
+					ResetField(serializer, data.spaceshipName);
+
+				if (data.info & SpaceshipQueryInfo::Modules)
 				{
-					serializer &= moduleInfo.currentModule;
-					serializer.Serialize<Nz::UInt8>(moduleInfo.type);
+					serializer.SerializeArraySize(data.modules);
+					for (auto& moduleInfo : data.modules)
+					{
+						serializer &= moduleInfo.currentModule;
+						serializer.template Serialize<Nz::UInt8>(moduleInfo.type);
+					}
 				}
+				else
+					ResetField(serializer, data.modules);
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, SpaceshipList& data)
-		{
-			serializer.SerializeArraySize(data.spaceships);
-			for (auto& spaceship : data.spaceships)
-				serializer &= spaceship.name;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, SpaceshipList>& data)
+			{
+				serializer.SerializeArraySize(data.spaceships);
+				for (auto& spaceship : data.spaceships)
+					serializer &= spaceship.name;
+			}
 
-		void Serialize(PacketSerializer& serializer, TimeSyncRequest& data)
-		{
-			serializer &= data.requestId;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, TimeSyncRequest>& data)
+			{
+				serializer &= data.requestId;
+			}
 
-		void Serialize(PacketSerializer& serializer, TimeSyncResponse& data)
-		{
-			serializer &= data.requestId;
-			serializer &= data.serverTime;
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, TimeSyncResponse>& data)
+			{
+				serializer &= data.requestId;
+				serializer &= data.serverTime;
+			}
 
-		void Serialize(PacketSerializer& serializer, UpdateFleet& data)
-		{
-			serializer &= data.fleetName;
-			serializer &= data.newFleetName;
-			serializer.SerializeArraySize(data.spaceshipNames);
-			for (auto& name : data.spaceshipNames)
-				serializer &= name;
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateFleet>& data)
+			{
+				serializer &= data.fleetName;
+				serializer &= data.newFleetName;
+				serializer.SerializeArraySize(data.spaceshipNames);
+				for (auto& name : data.spaceshipNames)
+					serializer &= name;
+
+				serializer.SerializeArraySize(data.spaceships);
+				for (auto& spaceship : data.spaceships)
+				{
+					serializer &= spaceship.spaceshipNameId;
+					serializer &= spaceship.spaceshipPosition;
+				}
+			}
 
-			serializer.SerializeArraySize(data.spaceships);
-			for (auto& spaceship : data.spaceships)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateFleetFailure>& data)
 			{
-				serializer &= spaceship.spaceshipNameId;
-				serializer &= spaceship.spaceshipPosition;
+				serializer.template Serialize<Nz::UInt8>(data.reason);
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, UpdateFleetFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateFleetSuccess>& data)
+			{
+			}
 
-		void Serialize(PacketSerializer& serializer, UpdateFleetSuccess& data)
-		{
-		}
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateSpaceship>& data)
+			{
+				serializer &= data.spaceshipName;
+				serializer &= data.newSpaceshipName;
+				serializer &= data.newSpaceshipCode;
 
-		void Serialize(PacketSerializer& serializer, UpdateSpaceship& data)
-		{
-			serializer &= data.spaceshipName;
-			serializer &= data.newSpaceshipName;
-			serializer &= data.newSpaceshipCode;
+				serializer.SerializeArraySize(data.modifiedModules);
+				for (auto& moduleInfo : data.modifiedModules)
+				{
+					serializer &= moduleInfo.moduleName;
+					serializer &= moduleInfo.oldModuleName;
+					serializer.template Serialize<Nz::UInt8>(moduleInfo.type);
+				}
+			}
 
-			serializer.SerializeArraySize(data.modifiedModules);
-			for (auto& moduleInfo : data.modifiedModules)
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateSpaceshipFailure>& data)
 			{
-				serializer &= moduleInfo.moduleName;
-				serializer &= moduleInfo.oldModuleName;
-				serializer.Serialize<Nz::UInt8>(moduleInfo.type);
+				serializer.template Serialize<Nz::UInt8>(data.reason);
 			}
-		}
 
-		void Serialize(PacketSerializer& serializer, UpdateSpaceshipFailure& data)
-		{
-			serializer.Serialize<Nz::UInt8>(data.reason);
+			template<typename S>
+			void SerializeFields(S& serializer, PacketData<S, UpdateSpaceshipSuccess>& data)
+			{
+			}
 		}
 
-		void Serialize(PacketSerializer& serializer, UpdateSpaceshipSuccess& data)
-		{
-		}
+#define DefinePacketSerializer(Type) \
+		std::size_t ComputeSize(const Type& data) \
+		{ \
+			PacketSizer sizer; \
+			SerializeFields(sizer, data); \
+			\
+			return sizer.GetSize(); \
+		} \
+		\
+		void Serialize(PacketWriter& writer, const Type& data) \
+		{ \
+			SerializeFields(writer, data); \
+		} \
+		\
+		bool Unserialize(PacketReader& reader, Type& data) \
+		{ \
+			SerializeFields(reader, data); \
+			\
+			return !reader.HasFailed(); \
+		}
+
+		DefinePacketSerializer(ArenaList)
+		DefinePacketSerializer(ArenaParticleSystems)
+		DefinePacketSerializer(ArenaPrefabs)
+		DefinePacketSerializer(ArenaSounds)
+		DefinePacketSerializer(ArenaState)
+		DefinePacketSerializer(BotMessage)
+		DefinePacketSerializer(CachedPacketVersion)
+		DefinePacketSerializer(ChatMessage)
+		DefinePacketSerializer(ControlEntity)
+		DefinePacketSerializer(CreateEntities)
+		DefinePacketSerializer(CreateFleet)
+		DefinePacketSerializer(CreateFleetFailure)
+		DefinePacketSerializer(CreateFleetSuccess)
+		DefinePacketSerializer(CreateProjectiles)
+		DefinePacketSerializer(CreateSpaceship)
+		DefinePacketSerializer(CreateSpaceshipFailure)
+		DefinePacketSerializer(CreateSpaceshipSuccess)
+		DefinePacketSerializer(DeclareCachedPackets)
+		DefinePacketSerializer(DeleteEntities)
+		DefinePacketSerializer(DeleteFleet)
+		DefinePacketSerializer(DeleteFleetFailure)
+		DefinePacketSerializer(DeleteFleetSuccess)
+		DefinePacketSerializer(DeleteProjectiles)
+		DefinePacketSerializer(DeleteSpaceship)
+		DefinePacketSerializer(DeleteSpaceshipFailure)
+		DefinePacketSerializer(DeleteSpaceshipSuccess)
+		DefinePacketSerializer(FleetInfo)
+		DefinePacketSerializer(FleetList)
+		DefinePacketSerializer(HullList)
+		DefinePacketSerializer(InstantiateEffects)
+		DefinePacketSerializer(InstantiateParticleSystem)
+		DefinePacketSerializer(IntegrityUpdate)
+		DefinePacketSerializer(JoinArena)
+		DefinePacketSerializer(LeaveArena)
+		DefinePacketSerializer(Login)
+		DefinePacketSerializer(LoginByToken)
+		DefinePacketSerializer(LoginFailure)
+		DefinePacketSerializer(LoginSuccess)
+		DefinePacketSerializer(ModuleList)
+		DefinePacketSerializer(NetworkStrings)
+		DefinePacketSerializer(PlaySound)
+		DefinePacketSerializer(PlayerChat)
+		DefinePacketSerializer(PlayerMovement)
+		DefinePacketSerializer(PlayerShoot)
+		DefinePacketSerializer(QueryArenaList)
+		DefinePacketSerializer(QueryFleetInfo)
+		DefinePacketSerializer(QueryFleetList)
+		DefinePacketSerializer(QueryHullList)
+		DefinePacketSerializer(QueryModuleList)
+		DefinePacketSerializer(QuerySpaceshipInfo)
+		DefinePacketSerializer(QuerySpaceshipList)
+		DefinePacketSerializer(Register)
+		DefinePacketSerializer(RegisterFailure)
+		DefinePacketSerializer(RegisterSuccess)
+		DefinePacketSerializer(RelayLogin)
+		DefinePacketSerializer(SpaceshipInfo)
+		DefinePacketSerializer(SpaceshipList)
+		DefinePacketSerializer(TimeSyncRequest)
+		DefinePacketSerializer(TimeSyncResponse)
+		DefinePacketSerializer(UpdateFleet)
+		DefinePacketSerializer(UpdateFleetFailure)
+		DefinePacketSerializer(UpdateFleetSuccess)
+		DefinePacketSerializer(UpdateSpaceship)
+		DefinePacketSerializer(UpdateSpaceshipFailure)
+		DefinePacketSerializer(UpdateSpaceshipSuccess)
+
+#undef DefinePacketSerializer
 	}
 }
@@ -0,0 +1,270 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/ReplayReader.hpp>
+#include <Shared/Logger.hpp>
+#include <Shared/ReplayFormat.hpp>
+#include <Shared/Protocol/PacketReader.hpp>
+#include <algorithm>
+#include <cassert>
+
+#ifdef NAZARA_PLATFORM_WINDOWS
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ewn
+{
+	ReplayReader::ReplayReader() :
+	m_data(nullptr),
+	m_size(0),
+	m_startTime(0),
+	m_startTimestamp(0)
+#ifdef NAZARA_PLATFORM_WINDOWS
+	, m_fileHandle(INVALID_HANDLE_VALUE),
+	m_mappingHandle(nullptr)
+#endif
+	{
+	}
+
+	ReplayReader::~ReplayReader()
+	{
+		Close();
+	}
+
+	void ReplayReader::Close()
+	{
+		UnmapFile();
+
+		m_arenaName.clear();
+		m_chunks.clear();
+		m_startTime = 0;
+		m_startTimestamp = 0;
+	}
+
+	// Returns the chunk whose keyframe is the closest before time (the first one if time is before the recording)
+	std::size_t ReplayReader::FindChunk(Nz::UInt64 time) const
+	{
+		if (m_chunks.empty())
+			return InvalidChunk;
+
+		auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), time, [](Nz::UInt64 value, const Chunk& chunk) { return value < chunk.startTime; });
+		if (it == m_chunks.begin())
+			return 0;
+
+		return static_cast<std::size_t>(std::distance(m_chunks.begin(), it)) - 1;
+	}
+
+	bool ReplayReader::Open(const std::string& filePath)
+	{
+		Close();
+
+		if (!MapFile(filePath))
+			return false;
+
+		if (!BuildIndex())
+		{
+			LogError(LogCategory::Server) << "\"" << filePath << "\" is not a valid replay file";
+			Close();
+			return false;
+		}
+
+		return true;
+	}
+
+	// Calls callback for every record of a chunk, keyframe records included (see Record::isKeyframe)
+	bool ReplayReader::ReadChunk(std::size_t chunkIndex, const RecordCallback& callback) const
+	{
+		assert(chunkIndex < m_chunks.size());
+		const Chunk& chunk = m_chunks[chunkIndex];
+
+		const Nz::UInt8* payload = m_data + chunk.offset;
+		PacketReader reader(payload, chunk.payloadSize);
+
+		Record record;
+		for (Nz::UInt32 i = 0; i < chunk.recordCount; ++i)
+		{
+			record.isKeyframe = (reader.GetOffset() < chunk.keyframeSize);
+
+			CompressedUnsigned<Nz::UInt32> timeOffset;
+			CompressedUnsigned<Nz::UInt32> messageSize;
+			reader &= timeOffset;
+			reader &= messageSize;
+
+			std::size_t messageOffset = reader.GetOffset();
+
+			PacketReader messageReader = reader.ExtractReader(messageSize);
+
+			Nz::UInt8 packetType;
+			messageReader &= packetType;
+
+			if (reader.HasFailed() || messageReader.HasFailed() || packetType >= PacketTypeCount)
+				return false;
+
+			record.data = payload + messageOffset + sizeof(Nz::UInt8);
+			record.size = messageSize - sizeof(Nz::UInt8);
+			record.time = chunk.startTime + timeOffset;
+			record.type = static_cast<PacketType>(packetType);
+
+			if (!callback(record))
+				break;
+		}
+
+		return true;
+	}
+
+	// Calls callback for the keyframe preceding time and every record up to time, then returns the chunk index
+	// Playback goes on with the records of this chunk later than time, then with the following chunks (skipping their keyframe)
+	std::size_t ReplayReader::Seek(Nz::UInt64 time, const RecordCallback& callback) const
+	{
+		std::size_t chunkIndex = FindChunk(time);
+		if (chunkIndex == InvalidChunk)
+			return InvalidChunk;
+
+		bool succeeded = ReadChunk(chunkIndex, [&](const Record& record)
+		{
+			if (!record.isKeyframe && record.time > time)
+				return false;
+
+			return callback(record);
+		});
+
+		return (succeeded) ? chunkIndex : InvalidChunk;
+	}
+
+	bool ReplayReader::BuildIndex()
+	{
+		PacketReader reader(m_data, m_size);
+
+		Nz::UInt32 fileMagic;
+		Nz::UInt16 formatVersion;
+		reader &= fileMagic;
+		reader &= formatVersion;
+		reader &= m_startTime;
+		reader &= m_startTimestamp;
+		reader &= m_arenaName;
+
+		if (reader.HasFailed() || fileMagic != ReplayFormat::FileMagic || formatVersion != ReplayFormat::FormatVersion)
+			return false;
+
+		// Chunks are only read until the first incomplete one, a crashed server may not have written the last one entirely
+		while (reader.GetRemainingSize() >= ReplayFormat::ChunkHeaderSize)
+		{
+			Nz::UInt32 chunkMagic;
+			Chunk chunk;
+			reader &= chunkMagic;
+			reader &= chunk.payloadSize;
+			reader &= chunk.keyframeSize;
+			reader &= chunk.recordCount;
+			reader &= chunk.startTime;
+			reader &= chunk.endTime;
+
+			if (chunkMagic != ReplayFormat::ChunkMagic || chunk.keyframeSize > chunk.payloadSize || chunk.payloadSize > reader.GetRemainingSize())
+				break;
+
+			chunk.offset = reader.GetOffset();
+			reader.ExtractReader(chunk.payloadSize);
+
+			m_chunks.push_back(chunk);
+		}
+
+		return true;
+	}
+
+	bool ReplayReader::MapFile(const std::string& filePath)
+	{
+#ifdef NAZARA_PLATFORM_WINDOWS
+		m_fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (m_fileHandle == INVALID_HANDLE_VALUE)
+		{
+			LogError(LogCategory::Server) << "Failed to open \"" << filePath << "\": " << ::GetLastError();
+			return false;
+		}
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(m_fileHandle, &fileSize) || fileSize.QuadPart == 0)
+		{
+			LogError(LogCategory::Server) << "\"" << filePath << "\" is empty or its size can't be retrieved";
+			UnmapFile();
+			return false;
+		}
+
+		m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* data = (m_mappingHandle) ? MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if (!data)
+		{
+			LogError(LogCategory::Server) << "Failed to map \"" << filePath << "\": " << ::GetLastError();
+			UnmapFile();
+			return false;
+		}
+
+		m_size = static_cast<std::size_t>(fileSize.QuadPart);
+#else
+		int fileDescriptor = open(filePath.c_str(), O_RDONLY);
+		if (fileDescriptor < 0)
+		{
+			LogError(LogCategory::Server) << "Failed to open \"" << filePath << "\": " << errno;
+			return false;
+		}
+
+		struct stat fileInfo;
+		if (fstat(fileDescriptor, &fileInfo) != 0 || fileInfo.st_size == 0)
+		{
+			LogError(LogCategory::Server) << "\"" << filePath << "\" is empty or its size can't be retrieved";
+			close(fileDescriptor);
+			return false;
+		}
+
+		std::size_t fileSize = static_cast<std::size_t>(fileInfo.st_size);
+
+		// The mapping keeps the file referenced, the descriptor isn't needed anymore
+		void* data = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+		close(fileDescriptor);
+
+		if (data == MAP_FAILED)
+		{
+			LogError(LogCategory::Server) << "Failed to map \"" << filePath << "\": " << errno;
+			return false;
+		}
+
+		m_size = fileSize;
+#endif
+
+		m_data = static_cast<const Nz::UInt8*>(data);
+		return true;
+	}
+
+	void ReplayReader::UnmapFile()
+	{
+#ifdef NAZARA_PLATFORM_WINDOWS
+		if (m_data)
+			UnmapViewOfFile(m_data);
+
+		if (m_mappingHandle)
+		{
+			CloseHandle(m_mappingHandle);
+			m_mappingHandle = nullptr;
+		}
+
+		if (m_fileHandle != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(m_fileHandle);
+			m_fileHandle = INVALID_HANDLE_VALUE;
+		}
+#else
+		if (m_data)
+			munmap(const_cast<Nz::UInt8*>(m_data), m_size);
+#endif
+
+		m_data = nullptr;
+		m_size = 0;
+	}
+}
@@ -3,8 +3,8 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/SecureRandomGenerator.hpp>
+#include <Shared/Logger.hpp>
 #include <Shared/SystemRandomGenerator.hpp>
-#include <iostream>
 
 namespace ewn
 {
@@ -16,7 +16,7 @@ namespace ewn
 		}
 		catch (const std::exception& e)
 		{
-			std::cerr << "Failed to create secure random generator: " << e.what() << std::endl;
+			LogError(LogCategory::Server) << "Failed to create secure random generator: " << e.what();
 		}
 	}
 
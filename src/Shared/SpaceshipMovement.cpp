@@ -0,0 +1,47 @@
+// Copyright (C) 2018 Jérôme Leclercq
+// This file is part of the "Erewhon Shared" project
+// For conditions of distribution and use, see copyright notice in LICENSE
+
+#include <Shared/SpaceshipMovement.hpp>
+#include <Shared/Utils.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace ewn
+{
+	// Same as what InputSystem does, except the force is turned into a velocity change right away
+	void SpaceshipMovement::ApplyInput(State& state, const Parameters& parameters, float inputElapsedTime, const Nz::Vector3f& direction, const Nz::Vector3f& rotation)
+	{
+		Nz::Vector3f force = state.rotation * ComputeForce(inputElapsedTime, direction);
+		state.linearVelocity += force * (StepSize / parameters.mass);
+
+		// Torque is global but inertia is expressed in local space
+		Nz::Vector3f localTorque = state.rotation.GetConjugate() * ComputeTorque(inputElapsedTime, rotation);
+		Nz::Vector3f localAcceleration = localTorque / parameters.inertia;
+
+		state.angularVelocity += state.rotation * localAcceleration * StepSize;
+	}
+
+	void SpaceshipMovement::Integrate(State& state, const Parameters& parameters, float elapsedTime)
+	{
+		while (elapsedTime > 0.f)
+		{
+			float stepTime = std::min(elapsedTime, StepSize);
+			elapsedTime -= stepTime;
+
+			// Newton damping factors are given for 60 steps per second
+			float dampingExponent = stepTime * 60.f;
+
+			state.linearVelocity *= std::pow(1.f - parameters.linearDamping, dampingExponent);
+
+			Nz::Vector3f localAngularVelocity = state.rotation.GetConjugate() * state.angularVelocity;
+			localAngularVelocity.x *= std::pow(1.f - parameters.angularDamping.x, dampingExponent);
+			localAngularVelocity.y *= std::pow(1.f - parameters.angularDamping.y, dampingExponent);
+			localAngularVelocity.z *= std::pow(1.f - parameters.angularDamping.z, dampingExponent);
+			state.angularVelocity = state.rotation * localAngularVelocity;
+
+			state.position += state.linearVelocity * stepTime;
+			state.rotation = IntegrateRotation(state.rotation, state.angularVelocity, stepTime);
+		}
+	}
+}
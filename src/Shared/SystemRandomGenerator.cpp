@@ -3,7 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/SystemRandomGenerator.hpp>
-#include <iostream>
+#include <Shared/Logger.hpp>
 #include <stdexcept>
 
 namespace ewn
@@ -26,7 +26,7 @@ namespace ewn
 	{
 #ifdef NAZARA_PLATFORM_WINDOWS
 		if (!CryptReleaseContext(m_provider, 0))
-			std::cerr << "Failed to free HCRYPTPROV: " << ::GetLastError() << std::endl;
+			LogError(LogCategory::Server) << "Failed to free HCRYPTPROV: " << ::GetLastError();
 #endif
 	}
 
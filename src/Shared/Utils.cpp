@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in LICENSE
 
 #include <Shared/Utils.hpp>
+#include <cmath>
 
 namespace ewn
 {
@@ -35,4 +36,20 @@ namespace ewn
 		// move the camera a bit towards the target
 		return currentPos + displacement;
 	}
+
+	// Rotates by a global angular velocity (in radians per second) applied during elapsedTime
+	Nz::Quaternionf IntegrateRotation(const Nz::Quaternionf& rotation, const Nz::Vector3f& angularVelocity, float elapsedTime)
+	{
+		float angularSpeed = angularVelocity.GetLength();
+		if (Nz::NumberEquals(angularSpeed, 0.f))
+			return rotation;
+
+		float halfAngle = angularSpeed * elapsedTime * 0.5f;
+		Nz::Vector3f axis = angularVelocity / angularSpeed * std::sin(halfAngle);
+
+		Nz::Quaternionf newRotation = Nz::Quaternionf(std::cos(halfAngle), axis.x, axis.y, axis.z) * rotation;
+		newRotation.Normalize();
+
+		return newRotation;
+	}
 }